@@ -3,20 +3,40 @@
 
 #pragma once
 
+#include "AudioBufferView.h"
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <memory_resource>
+#include <type_traits>
 
 namespace edsp
 {
 
+// all channels share one contiguous allocation
+// every channel starts at a 64 byte boundary, consecutive channels are getChannelStride() samples apart
+// memory is only allocated if the requested size exceeds the capacity, use reserve() to preallocate
 template <typename SampleType, int MAX_CHANNELS>
 class AudioBuffer
 {
+    static_assert(std::is_trivial_v<SampleType>, "SampleType must be a trivial type");
+
 public:
+    static constexpr std::size_t alignment = 64;
+
     AudioBuffer() = default;
 
-    AudioBuffer(int channels, int samples)
+    // all allocations are made from memoryResource, e.g. a pool or arena that is set up at application start
+    explicit AudioBuffer(std::pmr::memory_resource* memoryResource) noexcept
+            : mMemoryResource(memoryResource)
+    {
+        assert(memoryResource != nullptr);
+    }
+
+    AudioBuffer(int channels, int samples, std::pmr::memory_resource* memoryResource = std::pmr::get_default_resource())
+            : mMemoryResource(memoryResource)
     {
+        assert(memoryResource != nullptr);
         setSize(channels, samples);
     }
 
@@ -32,49 +52,55 @@ public:
     // allow moving
     AudioBuffer(AudioBuffer&& other) noexcept
     {
-        mChannels = other.mChannels;
-        mSamples = other.mSamples;
-        for (int channel = 0; channel < mChannels; ++channel)
-        {
-            mBuffer[channel] = other.mBuffer[channel];
-            other.mBuffer[channel] = nullptr;
-        }
-        other.mChannels = 0;
-        other.mSamples = 0;
+        moveFrom(other);
     }
     AudioBuffer& operator=(AudioBuffer&& other) noexcept
     {
         if (&other == this)
             return *this;
 
-        deallocateBuffer(); // this does not do anything if other is empty
-
-        mChannels = other.mChannels;
-        mSamples = other.mSamples;
-        for (int channel = 0; channel < mChannels; ++channel)
-        {
-            mBuffer[channel] = other.mBuffer[channel];
-            other.mBuffer[channel] = nullptr;
-        }
-        other.mChannels = 0;
-        other.mSamples = 0;
+        deallocateBuffer(); // this does not do anything if this buffer is empty
+        moveFrom(other);
 
         return *this;
     }
 
+    // does not allocate if channels and samples fit into the capacity
     void setSize(int channels, int samples)
     {
         assert(channels <= MAX_CHANNELS);
         assert(channels > 0 && samples > 0);
-        if (channels == mChannels && samples == mSamples)
-            return;
-
-        if (mChannels != 0 && mSamples != 0)
-            deallocateBuffer();
 
+        reserve(channels, samples);
         mChannels = channels;
         mSamples = samples;
-        allocateBuffer();
+    }
+
+    // preallocates memory for up to the given number of channels and samples, e.g. call at application start
+    // the content of the buffer is lost if memory has to be allocated
+    void reserve(int channels, int samples)
+    {
+        assert(channels <= MAX_CHANNELS);
+        assert(channels > 0 && samples > 0);
+        if (channels <= mChannelCapacity && samples <= mSampleCapacity)
+            return;
+
+        reallocateBuffer(std::max(channels, mChannelCapacity), std::max(samples, mSampleCapacity));
+    }
+
+    int getChannelCapacity() const noexcept
+    {
+        return mChannelCapacity;
+    }
+
+    int getSampleCapacity() const noexcept
+    {
+        return mSampleCapacity;
+    }
+
+    std::pmr::memory_resource* getMemoryResource() const noexcept
+    {
+        return mMemoryResource;
     }
 
     const SampleType** getArrayOfReadPointers() const noexcept
@@ -103,6 +129,18 @@ public:
         return mBuffer[channel];
     }
 
+    AudioBufferView<const SampleType> getReadView() const noexcept
+    {
+        assert(mChannels > 0 && mSamples > 0);
+        return {mBuffer, mChannels, mSamples};
+    }
+
+    AudioBufferView<SampleType> getWriteView() noexcept
+    {
+        assert(mChannels > 0 && mSamples > 0);
+        return {mBuffer, mChannels, mSamples};
+    }
+
     SampleType getSample(int channel, int sample) const noexcept
     {
         assert(mChannels > 0 && mSamples > 0);
@@ -111,7 +149,7 @@ public:
         return mBuffer[channel][sample];
     }
 
-    SampleType setSample(int channel, int sample, SampleType value) noexcept
+    void setSample(int channel, int sample, SampleType value) noexcept
     {
         assert(mChannels > 0 && mSamples > 0);
         assert(channel >= 0 && channel < mChannels);
@@ -129,31 +167,93 @@ public:
         return mSamples;
     }
 
+    // distance in samples between the beginnings of two consecutive channels
+    int getChannelStride() const noexcept
+    {
+        return mChannelStride;
+    }
+
 private:
-    void allocateBuffer()
+    static int calculateChannelStride(int samples) noexcept
+    {
+        constexpr int samplesPerAlignment = sizeof(SampleType) < alignment ? static_cast<int>(alignment / sizeof(SampleType)) : 1;
+        int channelStride = (samples + samplesPerAlignment - 1) / samplesPerAlignment * samplesPerAlignment;
+
+        // channels that are a multiple of 4 KiB apart map to the same cache sets, add one cache line of padding
+        if ((static_cast<std::size_t>(channelStride) * sizeof(SampleType)) % 4096 == 0)
+            channelStride += samplesPerAlignment;
+
+        return channelStride;
+    }
+
+    // allocates the new memory before releasing the old one, the buffer stays valid if the allocation throws
+    void reallocateBuffer(int channelCapacity, int sampleCapacity)
     {
-        for (int channel = 0; channel < mChannels; ++channel)
-            mBuffer[channel] = new SampleType[static_cast<std::size_t>(mSamples)];
+        const int channelStride = calculateChannelStride(sampleCapacity);
+        const std::size_t allocatedBytes = static_cast<std::size_t>(channelCapacity) * static_cast<std::size_t>(channelStride) * sizeof(SampleType);
+        auto* data = static_cast<SampleType*>(mMemoryResource->allocate(allocatedBytes, alignment));
+
+        deallocateBuffer();
+
+        mData = data;
+        mAllocatedBytes = allocatedBytes;
+        mChannelStride = channelStride;
+        mChannelCapacity = channelCapacity;
+        mSampleCapacity = sampleCapacity;
+        for (int channel = 0; channel < mChannelCapacity; ++channel)
+            mBuffer[channel] = mData + static_cast<std::size_t>(channel) * static_cast<std::size_t>(mChannelStride);
     }
 
     void deallocateBuffer() noexcept
     {
-        if (mChannels != 0 && mSamples != 0)
+        if (mData != nullptr)
+        {
+            mMemoryResource->deallocate(mData, mAllocatedBytes, alignment);
+            mData = nullptr;
+        }
+
+        for (int channel = 0; channel < mChannelCapacity; ++channel)
+            mBuffer[channel] = nullptr;
+
+        mAllocatedBytes = 0;
+        mChannelStride = 0;
+        mChannelCapacity = 0;
+        mSampleCapacity = 0;
+    }
+
+    void moveFrom(AudioBuffer& other) noexcept
+    {
+        mChannels = other.mChannels;
+        mSamples = other.mSamples;
+        mChannelCapacity = other.mChannelCapacity;
+        mSampleCapacity = other.mSampleCapacity;
+        mChannelStride = other.mChannelStride;
+        mAllocatedBytes = other.mAllocatedBytes;
+        mData = other.mData;
+        mMemoryResource = other.mMemoryResource;
+        for (int channel = 0; channel < mChannelCapacity; ++channel)
         {
-            for (int channel = 0; channel < mChannels; ++channel)
-            {
-                if (mBuffer[channel] != nullptr)
-                {
-                    delete[] mBuffer[channel];
-                    mBuffer[channel] = nullptr;
-                }
-            }
+            mBuffer[channel] = other.mBuffer[channel];
+            other.mBuffer[channel] = nullptr;
         }
+        other.mChannels = 0;
+        other.mSamples = 0;
+        other.mChannelCapacity = 0;
+        other.mSampleCapacity = 0;
+        other.mChannelStride = 0;
+        other.mAllocatedBytes = 0;
+        other.mData = nullptr;
     }
 
     int mChannels = 0;
     int mSamples = 0;
+    int mChannelCapacity = 0;
+    int mSampleCapacity = 0;
+    int mChannelStride = 0;
+    std::size_t mAllocatedBytes = 0;
+    SampleType* mData = nullptr;
     SampleType* mBuffer[MAX_CHANNELS] = {};
+    std::pmr::memory_resource* mMemoryResource = std::pmr::get_default_resource();
 };
 
 } // namespace edsp
@@ -0,0 +1,271 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+// conversion between float and 16 bit, packed 24 bit and 32 bit integer samples
+// integer samples are scaled to [-1, 1), float samples are clamped to the integer range and rounded to the nearest integer
+// the interleaved to planar and planar to interleaved overloads convert and transpose blocks that stay in the L1 cache
+
+#include "AudioBufferHelpers.h"
+#include "AudioBufferSimd.h"
+#include "AudioBufferView.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+
+namespace edsp
+{
+
+// packed little endian 24 bit sample, e.g. the samples of a 24 bit WAV file
+struct PackedInt24
+{
+    std::uint8_t bytes[3];
+};
+
+static_assert(sizeof(PackedInt24) == 3, "PackedInt24 must not be padded");
+
+// triangular probability density function dither with an amplitude of +-1 LSB
+// every instance generates an independent noise sequence, use one instance per stream
+// 32 bit samples are never dithered because float samples do not have more than 24 bits of resolution
+class TpdfDither
+{
+public:
+    explicit TpdfDither(std::uint32_t seed = 1) noexcept
+    {
+        reset(seed);
+    }
+
+    void reset(std::uint32_t seed) noexcept
+    {
+        // spread the seed over all lanes, a xorshift state must not be zero
+        for (int lane = 0; lane < simd::ditherLanes; ++lane)
+        {
+            std::uint32_t state = seed + static_cast<std::uint32_t>(lane + 1) * 0x9e3779b9u;
+            state = (state ^ (state >> 16)) * 0x85ebca6bu;
+            state = (state ^ (state >> 13)) * 0xc2b2ae35u;
+            state ^= state >> 16;
+            mState[lane] = state != 0 ? state : 0x9e3779b9u;
+        }
+    }
+
+    std::uint32_t* getState() noexcept
+    {
+        return mState;
+    }
+
+private:
+    std::uint32_t mState[simd::ditherLanes] = {};
+};
+
+namespace detail
+{
+
+template <typename SampleType>
+inline constexpr bool isIntegerSampleType = std::is_same_v<SampleType, std::int16_t> || std::is_same_v<SampleType, PackedInt24> || std::is_same_v<SampleType, std::int32_t>;
+
+// samples per block of the interleaved to planar and planar to interleaved conversions
+inline constexpr int conversionBlockSize = 1024;
+
+inline void convertToFloat(const std::int16_t* source, float* destination, int samples) noexcept
+{
+    simd::int16ToFloat(source, destination, samples);
+}
+
+inline void convertToFloat(const PackedInt24* source, float* destination, int samples) noexcept
+{
+    simd::int24ToFloat(reinterpret_cast<const std::uint8_t*>(source), destination, samples);
+}
+
+inline void convertToFloat(const std::int32_t* source, float* destination, int samples) noexcept
+{
+    simd::int32ToFloat(source, destination, samples);
+}
+
+inline void convertFromFloat(const float* source, std::int16_t* destination, int samples, TpdfDither* dither) noexcept
+{
+    simd::floatToInt16(source, destination, samples, dither != nullptr ? dither->getState() : nullptr);
+}
+
+inline void convertFromFloat(const float* source, PackedInt24* destination, int samples, TpdfDither* dither) noexcept
+{
+    simd::floatToInt24(source, reinterpret_cast<std::uint8_t*>(destination), samples, dither != nullptr ? dither->getState() : nullptr);
+}
+
+inline void convertFromFloat(const float* source, std::int32_t* destination, int samples, TpdfDither*) noexcept
+{
+    simd::floatToInt32(source, destination, samples);
+}
+
+// converts interleaved frames into a contiguous float block
+template <typename IntegerType>
+inline void convertFramesToFloat(AudioBufferInterleavedView<const IntegerType> source, float* destination)
+{
+    const int channels = source.getNumChannels();
+    if (source.isContiguous())
+    {
+        convertToFloat(source.getReadPointer(), destination, channels * source.getNumSamples());
+        return;
+    }
+
+    for (int sample = 0; sample < source.getNumSamples(); ++sample)
+        convertToFloat(source.getReadPointer() + static_cast<std::ptrdiff_t>(sample) * source.getFrameStride(), destination + static_cast<std::ptrdiff_t>(sample) * channels, channels);
+}
+
+// converts a contiguous float block into interleaved frames
+template <typename IntegerType>
+inline void convertFramesFromFloat(const float* source, AudioBufferInterleavedView<IntegerType> destination, TpdfDither* dither)
+{
+    const int channels = destination.getNumChannels();
+    if (destination.isContiguous())
+    {
+        convertFromFloat(source, destination.getWritePointer(), channels * destination.getNumSamples(), dither);
+        return;
+    }
+
+    for (int sample = 0; sample < destination.getNumSamples(); ++sample)
+        convertFromFloat(source + static_cast<std::ptrdiff_t>(sample) * channels, destination.getWritePointer() + static_cast<std::ptrdiff_t>(sample) * destination.getFrameStride(), channels, dither);
+}
+
+} // namespace detail
+
+template <typename IntegerType>
+inline void convertSamples(const IntegerType* sourceBuffer, float* destinationBuffer, int samples)
+{
+    static_assert(detail::isIntegerSampleType<IntegerType>, "source must be std::int16_t, PackedInt24 or std::int32_t");
+    assert(samples >= 0);
+    detail::convertToFloat(sourceBuffer, destinationBuffer, samples);
+}
+
+template <typename IntegerType>
+inline void convertSamples(const float* sourceBuffer, IntegerType* destinationBuffer, int samples, TpdfDither* dither = nullptr)
+{
+    static_assert(detail::isIntegerSampleType<IntegerType>, "destination must be std::int16_t, PackedInt24 or std::int32_t");
+    assert(samples >= 0);
+    detail::convertFromFloat(sourceBuffer, destinationBuffer, samples, dither);
+}
+
+template <typename SourceSampleType>
+inline void convertSamples(AudioBufferInterleavedView<SourceSampleType> sourceBuffer, AudioBufferInterleavedView<float> destinationBuffer)
+{
+    using IntegerType = std::remove_const_t<SourceSampleType>;
+    static_assert(detail::isIntegerSampleType<IntegerType>, "source must be std::int16_t, PackedInt24 or std::int32_t");
+    assert(sourceBuffer.getNumChannels() == destinationBuffer.getNumChannels());
+    assert(sourceBuffer.getNumSamples() == destinationBuffer.getNumSamples());
+
+    const int channels = destinationBuffer.getNumChannels();
+    if (destinationBuffer.isContiguous())
+    {
+        detail::convertFramesToFloat<IntegerType>(sourceBuffer, destinationBuffer.getWritePointer());
+        return;
+    }
+
+    for (int sample = 0; sample < destinationBuffer.getNumSamples(); ++sample)
+        detail::convertToFloat(sourceBuffer.getReadPointer() + static_cast<std::ptrdiff_t>(sample) * sourceBuffer.getFrameStride(), destinationBuffer.getWritePointer() + static_cast<std::ptrdiff_t>(sample) * destinationBuffer.getFrameStride(), channels);
+}
+
+template <typename IntegerType>
+inline void convertSamples(AudioBufferInterleavedView<const float> sourceBuffer, AudioBufferInterleavedView<IntegerType> destinationBuffer, TpdfDither* dither = nullptr)
+{
+    static_assert(detail::isIntegerSampleType<IntegerType>, "destination must be std::int16_t, PackedInt24 or std::int32_t");
+    assert(sourceBuffer.getNumChannels() == destinationBuffer.getNumChannels());
+    assert(sourceBuffer.getNumSamples() == destinationBuffer.getNumSamples());
+
+    const int channels = destinationBuffer.getNumChannels();
+    if (sourceBuffer.isContiguous())
+    {
+        detail::convertFramesFromFloat(sourceBuffer.getReadPointer(), destinationBuffer, dither);
+        return;
+    }
+
+    for (int sample = 0; sample < destinationBuffer.getNumSamples(); ++sample)
+        detail::convertFromFloat(sourceBuffer.getReadPointer() + static_cast<std::ptrdiff_t>(sample) * sourceBuffer.getFrameStride(), destinationBuffer.getWritePointer() + static_cast<std::ptrdiff_t>(sample) * destinationBuffer.getFrameStride(), channels, dither);
+}
+
+// interleaved integer samples to planar float samples
+template <typename SourceSampleType>
+inline void convertSamples(AudioBufferInterleavedView<SourceSampleType> sourceBuffer, AudioBufferView<float> destinationBuffer)
+{
+    using IntegerType = std::remove_const_t<SourceSampleType>;
+    static_assert(detail::isIntegerSampleType<IntegerType>, "source must be std::int16_t, PackedInt24 or std::int32_t");
+    assert(sourceBuffer.getNumChannels() == destinationBuffer.getNumChannels());
+    assert(sourceBuffer.getNumSamples() == destinationBuffer.getNumSamples());
+
+    const int channels = destinationBuffer.getNumChannels();
+    const int samples = destinationBuffer.getNumSamples();
+
+    // a single frame has to fit into a block
+    if (channels > detail::conversionBlockSize)
+    {
+        for (int channel = 0; channel < channels; channel += detail::conversionBlockSize)
+        {
+            const int groupChannels = std::min(detail::conversionBlockSize, channels - channel);
+            convertSamples(sourceBuffer.getSubView(channel, groupChannels), destinationBuffer.getSubView(channel, groupChannels));
+        }
+        return;
+    }
+
+    alignas(64) float block[detail::conversionBlockSize];
+    const int blockFrames = detail::conversionBlockSize / channels;
+    for (int sample = 0; sample < samples; sample += blockFrames)
+    {
+        const int frames = std::min(blockFrames, samples - sample);
+        const AudioBufferInterleavedView<const IntegerType> source = sourceBuffer.getSubBlock(sample, frames);
+        detail::convertFramesToFloat<IntegerType>(source, block);
+        deinterleaveSamples(AudioBufferInterleavedView<const float>{block, channels, frames}, destinationBuffer.getSubBlock(sample, frames));
+    }
+}
+
+// planar float samples to interleaved integer samples
+template <typename SourceSampleType, typename IntegerType>
+inline void convertSamples(AudioBufferView<SourceSampleType> sourceBuffer, AudioBufferInterleavedView<IntegerType> destinationBuffer, TpdfDither* dither = nullptr)
+{
+    static_assert(std::is_same_v<std::remove_const_t<SourceSampleType>, float>, "source must be float");
+    static_assert(detail::isIntegerSampleType<IntegerType>, "destination must be std::int16_t, PackedInt24 or std::int32_t");
+    assert(sourceBuffer.getNumChannels() == destinationBuffer.getNumChannels());
+    assert(sourceBuffer.getNumSamples() == destinationBuffer.getNumSamples());
+
+    const int channels = destinationBuffer.getNumChannels();
+    const int samples = destinationBuffer.getNumSamples();
+
+    // a single frame has to fit into a block
+    if (channels > detail::conversionBlockSize)
+    {
+        for (int channel = 0; channel < channels; channel += detail::conversionBlockSize)
+        {
+            const int groupChannels = std::min(detail::conversionBlockSize, channels - channel);
+            convertSamples(sourceBuffer.getSubView(channel, groupChannels), destinationBuffer.getSubView(channel, groupChannels), dither);
+        }
+        return;
+    }
+
+    alignas(64) float block[detail::conversionBlockSize];
+    const int blockFrames = detail::conversionBlockSize / channels;
+    for (int sample = 0; sample < samples; sample += blockFrames)
+    {
+        const int frames = std::min(blockFrames, samples - sample);
+        interleaveSamples(AudioBufferView<const float>{sourceBuffer.getSubBlock(sample, frames)}, AudioBufferInterleavedView<float>{block, channels, frames});
+        detail::convertFramesFromFloat(block, destinationBuffer.getSubBlock(sample, frames), dither);
+    }
+}
+
+//
+// pointer overloads
+//
+
+// interleaved integer samples to planar float samples
+template <typename IntegerType>
+inline void convertSamples(const IntegerType* sourceBuffer, float** destinationBuffer, int channels, int samples)
+{
+    convertSamples(AudioBufferInterleavedView<const IntegerType>{sourceBuffer, channels, samples}, AudioBufferView<float>{destinationBuffer, channels, samples});
+}
+
+// planar float samples to interleaved integer samples
+template <typename IntegerType>
+inline void convertSamples(const float** sourceBuffer, IntegerType* destinationBuffer, int channels, int samples, TpdfDither* dither = nullptr)
+{
+    convertSamples(AudioBufferView<const float>{sourceBuffer, channels, samples}, AudioBufferInterleavedView<IntegerType>{destinationBuffer, channels, samples}, dither);
+}
+
+} // namespace edsp
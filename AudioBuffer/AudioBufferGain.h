@@ -0,0 +1,438 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+// gain, gain ramp, mix, pan and level measurement functions for planar and interleaved buffers
+// the gain of a ramp starts at startGain and moves linearly towards endGain, which is reached one frame after the buffer
+// consecutive blocks therefore ramp seamlessly if the endGain of one block is the startGain of the next one
+
+#include "AudioBufferSimd.h"
+#include "AudioBufferView.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <type_traits>
+
+namespace edsp
+{
+
+namespace detail
+{
+
+// excludes a parameter from template argument deduction, e.g. applyGain(floatBuffer, 2, 512, 0.5) compiles
+template <typename T>
+struct NonDeducedHelper
+{
+    using Type = T;
+};
+template <typename T>
+using NonDeduced = typename NonDeducedHelper<T>::Type;
+
+// destination = source * gain or destination += source * gain, the gain of frame n is startGain + n * (endGain - startGain) / samples
+template <bool ACCUMULATE, typename SampleType>
+inline void processGain(AudioBufferView<const SampleType> source, AudioBufferView<SampleType> destination, SampleType startGain, SampleType endGain)
+{
+    assert(source.getNumChannels() == destination.getNumChannels());
+    assert(source.getNumSamples() == destination.getNumSamples());
+
+    const int samples = destination.getNumSamples();
+    const SampleType gainIncrement = (endGain - startGain) / static_cast<SampleType>(samples);
+
+    for (int channel = 0; channel < destination.getNumChannels(); ++channel)
+    {
+        const SampleType* sourceChannel = source.getReadPointer(channel);
+        SampleType* destinationChannel = destination.getWritePointer(channel);
+
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            if (startGain == endGain)
+                simd::gain<ACCUMULATE>(sourceChannel, destinationChannel, samples, startGain);
+            else
+                simd::gainRamp<ACCUMULATE>(sourceChannel, destinationChannel, samples, startGain, gainIncrement, 1);
+        }
+        else
+        {
+            for (int sample = 0; sample < samples; ++sample)
+            {
+                const SampleType gain = startGain + static_cast<SampleType>(sample) * gainIncrement;
+                if constexpr (ACCUMULATE)
+                    destinationChannel[sample] += sourceChannel[sample] * gain;
+                else
+                    destinationChannel[sample] = sourceChannel[sample] * gain;
+            }
+        }
+    }
+}
+
+template <bool ACCUMULATE, typename SampleType>
+inline void processGain(AudioBufferInterleavedView<const SampleType> source, AudioBufferInterleavedView<SampleType> destination, SampleType startGain, SampleType endGain)
+{
+    assert(source.getNumChannels() == destination.getNumChannels());
+    assert(source.getNumSamples() == destination.getNumSamples());
+
+    const int channels = destination.getNumChannels();
+    const int samples = destination.getNumSamples();
+    const SampleType gainIncrement = (endGain - startGain) / static_cast<SampleType>(samples);
+
+    if constexpr (std::is_same_v<SampleType, float>)
+    {
+        if (source.isContiguous() && destination.isContiguous())
+        {
+            if (startGain == endGain)
+                simd::gain<ACCUMULATE>(source.getReadPointer(), destination.getWritePointer(), channels * samples, startGain);
+            else
+                simd::gainRamp<ACCUMULATE>(source.getReadPointer(), destination.getWritePointer(), channels * samples, startGain, gainIncrement, channels);
+            return;
+        }
+    }
+
+    for (int sample = 0; sample < samples; ++sample)
+    {
+        const SampleType gain = startGain + static_cast<SampleType>(sample) * gainIncrement;
+        const SampleType* sourceFrame = source.getReadPointer() + static_cast<std::ptrdiff_t>(sample) * source.getFrameStride();
+        SampleType* destinationFrame = destination.getWritePointer() + static_cast<std::ptrdiff_t>(sample) * destination.getFrameStride();
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            if constexpr (ACCUMULATE)
+                destinationFrame[channel] += sourceFrame[channel] * gain;
+            else
+                destinationFrame[channel] = sourceFrame[channel] * gain;
+        }
+    }
+}
+
+// the SIMD kernel sums in float, the blocks are summed in double so the rounding error does not grow with the length
+inline double sumOfSquares(const float* samples, int count)
+{
+    constexpr int blockSize = 1024;
+
+    double result = 0.0;
+    for (int blockStart = 0; blockStart < count; blockStart += blockSize)
+        result += static_cast<double>(simd::sumOfSquares(samples + blockStart, std::min(blockSize, count - blockStart)));
+    return result;
+}
+
+} // namespace detail
+
+//
+// AudioBufferView and AudioBufferInterleavedView
+//
+
+template <typename SampleType>
+inline void applyGain(AudioBufferView<SampleType> buffer, detail::NonDeduced<SampleType> gain)
+{
+    detail::processGain<false, SampleType>(buffer, buffer, gain, gain);
+}
+
+template <typename SampleType>
+inline void applyGain(AudioBufferInterleavedView<SampleType> buffer, detail::NonDeduced<SampleType> gain)
+{
+    detail::processGain<false, SampleType>(buffer, buffer, gain, gain);
+}
+
+template <typename SampleType>
+inline void applyGainRamp(AudioBufferView<SampleType> buffer, detail::NonDeduced<SampleType> startGain, detail::NonDeduced<SampleType> endGain)
+{
+    detail::processGain<false, SampleType>(buffer, buffer, startGain, endGain);
+}
+
+template <typename SampleType>
+inline void applyGainRamp(AudioBufferInterleavedView<SampleType> buffer, detail::NonDeduced<SampleType> startGain, detail::NonDeduced<SampleType> endGain)
+{
+    detail::processGain<false, SampleType>(buffer, buffer, startGain, endGain);
+}
+
+template <typename SourceSampleType, typename SampleType>
+inline void copyBufferWithGain(AudioBufferView<SourceSampleType> sourceBuffer, AudioBufferView<SampleType> destinationBuffer, detail::NonDeduced<SampleType> gain)
+{
+    static_assert(std::is_same_v<std::remove_const_t<SourceSampleType>, SampleType>, "source and destination must have the same sample type");
+    detail::processGain<false, SampleType>(sourceBuffer, destinationBuffer, gain, gain);
+}
+
+template <typename SourceSampleType, typename SampleType>
+inline void copyBufferWithGain(AudioBufferInterleavedView<SourceSampleType> sourceBuffer, AudioBufferInterleavedView<SampleType> destinationBuffer, detail::NonDeduced<SampleType> gain)
+{
+    static_assert(std::is_same_v<std::remove_const_t<SourceSampleType>, SampleType>, "source and destination must have the same sample type");
+    detail::processGain<false, SampleType>(sourceBuffer, destinationBuffer, gain, gain);
+}
+
+template <typename SourceSampleType, typename SampleType>
+inline void copyBufferWithGainRamp(AudioBufferView<SourceSampleType> sourceBuffer, AudioBufferView<SampleType> destinationBuffer, detail::NonDeduced<SampleType> startGain, detail::NonDeduced<SampleType> endGain)
+{
+    static_assert(std::is_same_v<std::remove_const_t<SourceSampleType>, SampleType>, "source and destination must have the same sample type");
+    detail::processGain<false, SampleType>(sourceBuffer, destinationBuffer, startGain, endGain);
+}
+
+template <typename SourceSampleType, typename SampleType>
+inline void copyBufferWithGainRamp(AudioBufferInterleavedView<SourceSampleType> sourceBuffer, AudioBufferInterleavedView<SampleType> destinationBuffer, detail::NonDeduced<SampleType> startGain, detail::NonDeduced<SampleType> endGain)
+{
+    static_assert(std::is_same_v<std::remove_const_t<SourceSampleType>, SampleType>, "source and destination must have the same sample type");
+    detail::processGain<false, SampleType>(sourceBuffer, destinationBuffer, startGain, endGain);
+}
+
+template <typename SourceSampleType, typename SampleType>
+inline void addBufferWithGain(AudioBufferView<SourceSampleType> sourceBuffer, AudioBufferView<SampleType> destinationBuffer, detail::NonDeduced<SampleType> gain)
+{
+    static_assert(std::is_same_v<std::remove_const_t<SourceSampleType>, SampleType>, "source and destination must have the same sample type");
+    detail::processGain<true, SampleType>(sourceBuffer, destinationBuffer, gain, gain);
+}
+
+template <typename SourceSampleType, typename SampleType>
+inline void addBufferWithGain(AudioBufferInterleavedView<SourceSampleType> sourceBuffer, AudioBufferInterleavedView<SampleType> destinationBuffer, detail::NonDeduced<SampleType> gain)
+{
+    static_assert(std::is_same_v<std::remove_const_t<SourceSampleType>, SampleType>, "source and destination must have the same sample type");
+    detail::processGain<true, SampleType>(sourceBuffer, destinationBuffer, gain, gain);
+}
+
+// mixes the source into the destination with a gain ramp in a single pass
+template <typename SourceSampleType, typename SampleType>
+inline void addBufferWithGainRamp(AudioBufferView<SourceSampleType> sourceBuffer, AudioBufferView<SampleType> destinationBuffer, detail::NonDeduced<SampleType> startGain, detail::NonDeduced<SampleType> endGain)
+{
+    static_assert(std::is_same_v<std::remove_const_t<SourceSampleType>, SampleType>, "source and destination must have the same sample type");
+    detail::processGain<true, SampleType>(sourceBuffer, destinationBuffer, startGain, endGain);
+}
+
+template <typename SourceSampleType, typename SampleType>
+inline void addBufferWithGainRamp(AudioBufferInterleavedView<SourceSampleType> sourceBuffer, AudioBufferInterleavedView<SampleType> destinationBuffer, detail::NonDeduced<SampleType> startGain, detail::NonDeduced<SampleType> endGain)
+{
+    static_assert(std::is_same_v<std::remove_const_t<SourceSampleType>, SampleType>, "source and destination must have the same sample type");
+    detail::processGain<true, SampleType>(sourceBuffer, destinationBuffer, startGain, endGain);
+}
+
+// constant power pan law: -1 is hard left, 0 is center (-3 dB on both channels), 1 is hard right
+template <typename SampleType>
+inline void getPanGains(SampleType pan, SampleType& leftGain, SampleType& rightGain)
+{
+    assert(pan >= static_cast<SampleType>(-1) && pan <= static_cast<SampleType>(1));
+    const SampleType angle = (pan + static_cast<SampleType>(1)) * static_cast<SampleType>(0.785398163397448309616); // pi / 4
+    leftGain = std::cos(angle);
+    rightGain = std::sin(angle);
+}
+
+// mixes a mono source into a stereo destination
+// the gains are interpolated linearly between the constant power gains of startPan and endPan
+template <typename SourceSampleType, typename SampleType>
+inline void addBufferWithPan(AudioBufferView<SourceSampleType> sourceBuffer, AudioBufferView<SampleType> destinationBuffer, detail::NonDeduced<SampleType> startPan, detail::NonDeduced<SampleType> endPan)
+{
+    static_assert(std::is_same_v<std::remove_const_t<SourceSampleType>, SampleType>, "source and destination must have the same sample type");
+    assert(sourceBuffer.getNumChannels() == 1);
+    assert(destinationBuffer.getNumChannels() == 2);
+
+    SampleType startLeft, startRight, endLeft, endRight;
+    getPanGains(startPan, startLeft, startRight);
+    getPanGains(endPan, endLeft, endRight);
+    detail::processGain<true, SampleType>(sourceBuffer, destinationBuffer.getSubView(0, 1), startLeft, endLeft);
+    detail::processGain<true, SampleType>(sourceBuffer, destinationBuffer.getSubView(1, 1), startRight, endRight);
+}
+
+template <typename SourceSampleType, typename SampleType>
+inline void addBufferWithPan(AudioBufferInterleavedView<SourceSampleType> sourceBuffer, AudioBufferInterleavedView<SampleType> destinationBuffer, detail::NonDeduced<SampleType> startPan, detail::NonDeduced<SampleType> endPan)
+{
+    static_assert(std::is_same_v<std::remove_const_t<SourceSampleType>, SampleType>, "source and destination must have the same sample type");
+    assert(sourceBuffer.getNumChannels() == 1);
+    assert(destinationBuffer.getNumChannels() == 2);
+
+    SampleType startLeft, startRight, endLeft, endRight;
+    getPanGains(startPan, startLeft, startRight);
+    getPanGains(endPan, endLeft, endRight);
+    detail::processGain<true, SampleType>(sourceBuffer, destinationBuffer.getSubView(0, 1), startLeft, endLeft);
+    detail::processGain<true, SampleType>(sourceBuffer, destinationBuffer.getSubView(1, 1), startRight, endRight);
+}
+
+// maximum absolute sample value of all channels
+template <typename SampleType>
+inline std::remove_const_t<SampleType> getPeak(AudioBufferView<SampleType> buffer)
+{
+    using ValueType = std::remove_const_t<SampleType>;
+
+    ValueType peak = 0;
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        const ValueType* samples = buffer.getReadPointer(channel);
+        if constexpr (std::is_same_v<ValueType, float>)
+            peak = std::max(peak, simd::absMax(samples, buffer.getNumSamples()));
+        else
+            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+                peak = std::max(peak, std::abs(samples[sample]));
+    }
+    return peak;
+}
+
+template <typename SampleType>
+inline std::remove_const_t<SampleType> getPeak(AudioBufferInterleavedView<SampleType> buffer)
+{
+    using ValueType = std::remove_const_t<SampleType>;
+
+    if constexpr (std::is_same_v<ValueType, float>)
+    {
+        if (buffer.isContiguous())
+            return simd::absMax(buffer.getReadPointer(), buffer.getNumChannels() * buffer.getNumSamples());
+    }
+
+    ValueType peak = 0;
+    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            peak = std::max(peak, std::abs(buffer.getSample(channel, sample)));
+    return peak;
+}
+
+// root mean square of all samples of all channels, use getSubView() to measure a single channel
+template <typename SampleType>
+inline std::remove_const_t<SampleType> getRms(AudioBufferView<SampleType> buffer)
+{
+    using ValueType = std::remove_const_t<SampleType>;
+
+    double sumOfSquares = 0.0;
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        const ValueType* samples = buffer.getReadPointer(channel);
+        if constexpr (std::is_same_v<ValueType, float>)
+            sumOfSquares += detail::sumOfSquares(samples, buffer.getNumSamples());
+        else
+            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+                sumOfSquares += static_cast<double>(samples[sample]) * static_cast<double>(samples[sample]);
+    }
+    const double totalSamples = static_cast<double>(buffer.getNumChannels()) * static_cast<double>(buffer.getNumSamples());
+    return static_cast<ValueType>(std::sqrt(sumOfSquares / totalSamples));
+}
+
+template <typename SampleType>
+inline std::remove_const_t<SampleType> getRms(AudioBufferInterleavedView<SampleType> buffer)
+{
+    using ValueType = std::remove_const_t<SampleType>;
+    const double totalSamples = static_cast<double>(buffer.getNumChannels()) * static_cast<double>(buffer.getNumSamples());
+
+    if constexpr (std::is_same_v<ValueType, float>)
+    {
+        if (buffer.isContiguous())
+            return static_cast<ValueType>(std::sqrt(detail::sumOfSquares(buffer.getReadPointer(), buffer.getNumChannels() * buffer.getNumSamples()) / totalSamples));
+    }
+
+    double sumOfSquares = 0.0;
+    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            const auto value = static_cast<double>(buffer.getSample(channel, sample));
+            sumOfSquares += value * value;
+        }
+    }
+    return static_cast<ValueType>(std::sqrt(sumOfSquares / totalSamples));
+}
+
+//
+// planar (SampleType**) and interleaved (SampleType*) buffers
+//
+
+template <typename SampleType>
+inline void applyGain(SampleType** buffer, int channels, int samples, detail::NonDeduced<SampleType> gain)
+{
+    applyGain(AudioBufferView<SampleType>{buffer, channels, samples}, gain);
+}
+
+template <typename SampleType>
+inline void applyGain(SampleType* buffer, int channels, int samples, detail::NonDeduced<SampleType> gain)
+{
+    applyGain(AudioBufferInterleavedView<SampleType>{buffer, channels, samples}, gain);
+}
+
+template <typename SampleType>
+inline void applyGainRamp(SampleType** buffer, int channels, int samples, detail::NonDeduced<SampleType> startGain, detail::NonDeduced<SampleType> endGain)
+{
+    applyGainRamp(AudioBufferView<SampleType>{buffer, channels, samples}, startGain, endGain);
+}
+
+template <typename SampleType>
+inline void applyGainRamp(SampleType* buffer, int channels, int samples, detail::NonDeduced<SampleType> startGain, detail::NonDeduced<SampleType> endGain)
+{
+    applyGainRamp(AudioBufferInterleavedView<SampleType>{buffer, channels, samples}, startGain, endGain);
+}
+
+template <typename SampleType>
+inline void copyBufferWithGain(const SampleType** sourceBuffer, SampleType** destinationBuffer, int channels, int samples, detail::NonDeduced<SampleType> gain)
+{
+    copyBufferWithGain(AudioBufferView<const SampleType>{sourceBuffer, channels, samples}, AudioBufferView<SampleType>{destinationBuffer, channels, samples}, gain);
+}
+
+template <typename SampleType>
+inline void copyBufferWithGain(const SampleType* sourceBuffer, SampleType* destinationBuffer, int channels, int samples, detail::NonDeduced<SampleType> gain)
+{
+    copyBufferWithGain(AudioBufferInterleavedView<const SampleType>{sourceBuffer, channels, samples}, AudioBufferInterleavedView<SampleType>{destinationBuffer, channels, samples}, gain);
+}
+
+template <typename SampleType>
+inline void copyBufferWithGainRamp(const SampleType** sourceBuffer, SampleType** destinationBuffer, int channels, int samples, detail::NonDeduced<SampleType> startGain, detail::NonDeduced<SampleType> endGain)
+{
+    copyBufferWithGainRamp(AudioBufferView<const SampleType>{sourceBuffer, channels, samples}, AudioBufferView<SampleType>{destinationBuffer, channels, samples}, startGain, endGain);
+}
+
+template <typename SampleType>
+inline void copyBufferWithGainRamp(const SampleType* sourceBuffer, SampleType* destinationBuffer, int channels, int samples, detail::NonDeduced<SampleType> startGain, detail::NonDeduced<SampleType> endGain)
+{
+    copyBufferWithGainRamp(AudioBufferInterleavedView<const SampleType>{sourceBuffer, channels, samples}, AudioBufferInterleavedView<SampleType>{destinationBuffer, channels, samples}, startGain, endGain);
+}
+
+template <typename SampleType>
+inline void addBufferWithGain(const SampleType** sourceBuffer, SampleType** destinationBuffer, int channels, int samples, detail::NonDeduced<SampleType> gain)
+{
+    addBufferWithGain(AudioBufferView<const SampleType>{sourceBuffer, channels, samples}, AudioBufferView<SampleType>{destinationBuffer, channels, samples}, gain);
+}
+
+template <typename SampleType>
+inline void addBufferWithGain(const SampleType* sourceBuffer, SampleType* destinationBuffer, int channels, int samples, detail::NonDeduced<SampleType> gain)
+{
+    addBufferWithGain(AudioBufferInterleavedView<const SampleType>{sourceBuffer, channels, samples}, AudioBufferInterleavedView<SampleType>{destinationBuffer, channels, samples}, gain);
+}
+
+template <typename SampleType>
+inline void addBufferWithGainRamp(const SampleType** sourceBuffer, SampleType** destinationBuffer, int channels, int samples, detail::NonDeduced<SampleType> startGain, detail::NonDeduced<SampleType> endGain)
+{
+    addBufferWithGainRamp(AudioBufferView<const SampleType>{sourceBuffer, channels, samples}, AudioBufferView<SampleType>{destinationBuffer, channels, samples}, startGain, endGain);
+}
+
+template <typename SampleType>
+inline void addBufferWithGainRamp(const SampleType* sourceBuffer, SampleType* destinationBuffer, int channels, int samples, detail::NonDeduced<SampleType> startGain, detail::NonDeduced<SampleType> endGain)
+{
+    addBufferWithGainRamp(AudioBufferInterleavedView<const SampleType>{sourceBuffer, channels, samples}, AudioBufferInterleavedView<SampleType>{destinationBuffer, channels, samples}, startGain, endGain);
+}
+
+// mono source, planar stereo destination
+template <typename SampleType>
+inline void addBufferWithPan(const SampleType* sourceBuffer, SampleType** destinationBuffer, int samples, detail::NonDeduced<SampleType> startPan, detail::NonDeduced<SampleType> endPan)
+{
+    addBufferWithPan(AudioBufferView<const SampleType>{&sourceBuffer, 1, samples}, AudioBufferView<SampleType>{destinationBuffer, 2, samples}, startPan, endPan);
+}
+
+// mono source, interleaved stereo destination
+template <typename SampleType>
+inline void addBufferWithPan(const SampleType* sourceBuffer, SampleType* destinationBuffer, int samples, detail::NonDeduced<SampleType> startPan, detail::NonDeduced<SampleType> endPan)
+{
+    addBufferWithPan(AudioBufferInterleavedView<const SampleType>{sourceBuffer, 1, samples}, AudioBufferInterleavedView<SampleType>{destinationBuffer, 2, samples}, startPan, endPan);
+}
+
+template <typename SampleType>
+inline SampleType getPeak(const SampleType** buffer, int channels, int samples)
+{
+    return getPeak(AudioBufferView<const SampleType>{buffer, channels, samples});
+}
+
+template <typename SampleType>
+inline SampleType getPeak(const SampleType* buffer, int channels, int samples)
+{
+    return getPeak(AudioBufferInterleavedView<const SampleType>{buffer, channels, samples});
+}
+
+template <typename SampleType>
+inline SampleType getRms(const SampleType** buffer, int channels, int samples)
+{
+    return getRms(AudioBufferView<const SampleType>{buffer, channels, samples});
+}
+
+template <typename SampleType>
+inline SampleType getRms(const SampleType* buffer, int channels, int samples)
+{
+    return getRms(AudioBufferInterleavedView<const SampleType>{buffer, channels, samples});
+}
+
+} // namespace edsp
@@ -3,10 +3,13 @@
 
 #pragma once
 
+#include "AudioBufferSimd.h"
+#include "AudioBufferView.h"
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstring>
+#include <type_traits>
 
 namespace edsp
 {
@@ -38,6 +41,13 @@ inline void addBuffer(const SampleType** sourceBuffer, SampleType** destinationB
     assert(channels > 0);
     assert(samples > 0);
 
+    if constexpr (std::is_same_v<SampleType, float>)
+    {
+        for (int channel = 0; channel < channels; ++channel)
+            simd::add(sourceBuffer[channel], destinationBuffer[channel], samples);
+        return;
+    }
+
     for (int channel = 0; channel < channels; ++channel)
         for (int sample = 0; sample < samples; ++sample)
             destinationBuffer[channel][sample] += sourceBuffer[channel][sample];
@@ -49,19 +59,165 @@ inline void addBuffer(const SampleType* sourceBuffer, SampleType* destinationBuf
     assert(channels > 0);
     assert(samples > 0);
 
+    if constexpr (std::is_same_v<SampleType, float>)
+    {
+        simd::add(sourceBuffer, destinationBuffer, channels * samples);
+        return;
+    }
+
     for (int i = 0; i < channels * samples; ++i)
         destinationBuffer[i] += sourceBuffer[i];
 }
 
+// interleave/deinterleave with a channel count known at compile time
+// float buffers with 1, 2, 4, 6 or 8 channels use shuffle-based SIMD transposes, everything else is fully unrolled
+template <int CHANNELS, typename SampleType>
+inline void interleaveSamples(const SampleType** sourceBuffer, SampleType* destinationBuffer, int samples)
+{
+    static_assert(CHANNELS > 0, "CHANNELS must be greater than 0");
+    assert(samples > 0);
+
+    if constexpr (CHANNELS == 1)
+        std::memcpy(destinationBuffer, sourceBuffer[0], static_cast<std::size_t>(samples) * sizeof(SampleType));
+    else if constexpr (std::is_same_v<SampleType, float> && CHANNELS == 2)
+        simd::interleaveStereo(sourceBuffer[0], sourceBuffer[1], destinationBuffer, samples);
+    else if constexpr (std::is_same_v<SampleType, float> && CHANNELS == 4)
+        simd::interleave4(sourceBuffer, destinationBuffer, 4, samples);
+    else if constexpr (std::is_same_v<SampleType, float> && CHANNELS == 6)
+        simd::interleave6(sourceBuffer, destinationBuffer, samples);
+    else if constexpr (std::is_same_v<SampleType, float> && CHANNELS == 8)
+        simd::interleave8(sourceBuffer, destinationBuffer, 8, samples);
+    else
+    {
+        for (int sample = 0; sample < samples; ++sample)
+            for (int channel = 0; channel < CHANNELS; ++channel)
+                destinationBuffer[sample * CHANNELS + channel] = sourceBuffer[channel][sample];
+    }
+}
+
+template <int CHANNELS, typename SampleType>
+inline void deinterleaveSamples(const SampleType* sourceBuffer, SampleType** destinationBuffer, int samples)
+{
+    static_assert(CHANNELS > 0, "CHANNELS must be greater than 0");
+    assert(samples > 0);
+
+    if constexpr (CHANNELS == 1)
+        std::memcpy(destinationBuffer[0], sourceBuffer, static_cast<std::size_t>(samples) * sizeof(SampleType));
+    else if constexpr (std::is_same_v<SampleType, float> && CHANNELS == 2)
+        simd::deinterleaveStereo(sourceBuffer, destinationBuffer[0], destinationBuffer[1], samples);
+    else if constexpr (std::is_same_v<SampleType, float> && CHANNELS == 4)
+        simd::deinterleave4(sourceBuffer, destinationBuffer, 4, samples);
+    else if constexpr (std::is_same_v<SampleType, float> && CHANNELS == 6)
+        simd::deinterleave6(sourceBuffer, destinationBuffer, samples);
+    else if constexpr (std::is_same_v<SampleType, float> && CHANNELS == 8)
+        simd::deinterleave8(sourceBuffer, destinationBuffer, 8, samples);
+    else
+    {
+        for (int sample = 0; sample < samples; ++sample)
+            for (int channel = 0; channel < CHANNELS; ++channel)
+                destinationBuffer[channel][sample] = sourceBuffer[sample * CHANNELS + channel];
+    }
+}
+
+namespace detail
+{
+
+// transposes blocks of frames so all channels of one block stay in the L1 cache, even for large channel counts
+// consecutive destination frames are frameStride samples apart
+template <typename SampleType, typename SourcePointerFunction>
+inline void interleaveSamplesBlocked(SourcePointerFunction getSourcePointer, SampleType* destinationBuffer, int channels, int frameStride, int samples)
+{
+    constexpr int blockSize = 64;
+
+    for (int blockStart = 0; blockStart < samples; blockStart += blockSize)
+    {
+        const int blockSamples = std::min(blockSize, samples - blockStart);
+        SampleType* destination = destinationBuffer + static_cast<std::ptrdiff_t>(blockStart) * frameStride;
+
+        // transpose groups of 4 channels, the remaining channels are copied one by one
+        int channel = 0;
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            for (; channel + 4 <= channels; channel += 4)
+            {
+                const float* group[4] = {getSourcePointer(channel) + blockStart, getSourcePointer(channel + 1) + blockStart,
+                                         getSourcePointer(channel + 2) + blockStart, getSourcePointer(channel + 3) + blockStart};
+                simd::interleave4(group, destination + channel, frameStride, blockSamples);
+            }
+        }
+
+        for (; channel < channels; ++channel)
+        {
+            const SampleType* source = getSourcePointer(channel) + blockStart;
+            for (int sample = 0; sample < blockSamples; ++sample)
+                destination[sample * frameStride + channel] = source[sample];
+        }
+    }
+}
+
+// consecutive source frames are frameStride samples apart
+template <typename SampleType, typename DestinationPointerFunction>
+inline void deinterleaveSamplesBlocked(const SampleType* sourceBuffer, DestinationPointerFunction getDestinationPointer, int channels, int frameStride, int samples)
+{
+    constexpr int blockSize = 64;
+
+    for (int blockStart = 0; blockStart < samples; blockStart += blockSize)
+    {
+        const int blockSamples = std::min(blockSize, samples - blockStart);
+        const SampleType* source = sourceBuffer + static_cast<std::ptrdiff_t>(blockStart) * frameStride;
+
+        // transpose groups of 4 channels, the remaining channels are copied one by one
+        int channel = 0;
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            for (; channel + 4 <= channels; channel += 4)
+            {
+                float* group[4] = {getDestinationPointer(channel) + blockStart, getDestinationPointer(channel + 1) + blockStart,
+                                   getDestinationPointer(channel + 2) + blockStart, getDestinationPointer(channel + 3) + blockStart};
+                simd::deinterleave4(source + channel, group, frameStride, blockSamples);
+            }
+        }
+
+        for (; channel < channels; ++channel)
+        {
+            SampleType* destination = getDestinationPointer(channel) + blockStart;
+            for (int sample = 0; sample < blockSamples; ++sample)
+                destination[sample] = source[sample * frameStride + channel];
+        }
+    }
+}
+
+} // namespace detail
+
 template <typename SampleType>
 inline void interleaveSamples(const SampleType** sourceBuffer, SampleType* destinationBuffer, int channels, int samples)
 {
     assert(channels > 0);
     assert(samples > 0);
 
-    for (int channel = 0; channel < channels; ++channel)
-        for (int sample = 0; sample < samples; ++sample)
-            destinationBuffer[sample * channels + channel] = sourceBuffer[channel][sample];
+    switch (channels)
+    {
+        case 1:
+            interleaveSamples<1>(sourceBuffer, destinationBuffer, samples);
+            return;
+        case 2:
+            interleaveSamples<2>(sourceBuffer, destinationBuffer, samples);
+            return;
+        case 4:
+            interleaveSamples<4>(sourceBuffer, destinationBuffer, samples);
+            return;
+        case 6:
+            interleaveSamples<6>(sourceBuffer, destinationBuffer, samples);
+            return;
+        case 8:
+            interleaveSamples<8>(sourceBuffer, destinationBuffer, samples);
+            return;
+        default:
+            detail::interleaveSamplesBlocked([sourceBuffer](int channel)
+                                             { return sourceBuffer[channel]; },
+                                             destinationBuffer, channels, channels, samples);
+            return;
+    }
 }
 
 template <typename SampleType>
@@ -70,9 +226,149 @@ inline void deinterleaveSamples(const SampleType* sourceBuffer, SampleType** des
     assert(channels > 0);
     assert(samples > 0);
 
-    for (int sample = 0; sample < samples; ++sample)
+    switch (channels)
+    {
+        case 1:
+            deinterleaveSamples<1>(sourceBuffer, destinationBuffer, samples);
+            return;
+        case 2:
+            deinterleaveSamples<2>(sourceBuffer, destinationBuffer, samples);
+            return;
+        case 4:
+            deinterleaveSamples<4>(sourceBuffer, destinationBuffer, samples);
+            return;
+        case 6:
+            deinterleaveSamples<6>(sourceBuffer, destinationBuffer, samples);
+            return;
+        case 8:
+            deinterleaveSamples<8>(sourceBuffer, destinationBuffer, samples);
+            return;
+        default:
+            detail::deinterleaveSamplesBlocked(sourceBuffer, [destinationBuffer](int channel)
+                                               { return destinationBuffer[channel]; },
+                                               channels, channels, samples);
+            return;
+    }
+}
+
+//
+// overloads for AudioBufferView and AudioBufferInterleavedView
+//
+
+template <typename SampleType>
+inline void clearBuffer(AudioBufferView<SampleType> buffer)
+{
+    const std::size_t bufferSize = static_cast<std::size_t>(buffer.getNumSamples()) * sizeof(SampleType);
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        std::memset(buffer.getWritePointer(channel), 0, bufferSize);
+}
+
+template <typename SampleType>
+inline void clearBuffer(AudioBufferInterleavedView<SampleType> buffer)
+{
+    if (buffer.isContiguous())
+    {
+        clearBuffer(buffer.getWritePointer(), buffer.getNumChannels(), buffer.getNumSamples());
+        return;
+    }
+
+    const std::size_t frameSize = static_cast<std::size_t>(buffer.getNumChannels()) * sizeof(SampleType);
+    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+        std::memset(buffer.getWritePointer() + static_cast<std::ptrdiff_t>(sample) * buffer.getFrameStride(), 0, frameSize);
+}
+
+template <typename SourceSampleType, typename SampleType>
+inline void addBuffer(AudioBufferView<SourceSampleType> sourceBuffer, AudioBufferView<SampleType> destinationBuffer)
+{
+    static_assert(std::is_same_v<std::remove_const_t<SourceSampleType>, SampleType>, "source and destination must have the same sample type");
+    assert(sourceBuffer.getNumChannels() == destinationBuffer.getNumChannels());
+    assert(sourceBuffer.getNumSamples() == destinationBuffer.getNumSamples());
+
+    const int samples = destinationBuffer.getNumSamples();
+    for (int channel = 0; channel < destinationBuffer.getNumChannels(); ++channel)
+    {
+        const SampleType* source = sourceBuffer.getReadPointer(channel);
+        SampleType* destination = destinationBuffer.getWritePointer(channel);
+
+        if constexpr (std::is_same_v<SampleType, float>)
+            simd::add(source, destination, samples);
+        else
+            for (int sample = 0; sample < samples; ++sample)
+                destination[sample] += source[sample];
+    }
+}
+
+template <typename SourceSampleType, typename SampleType>
+inline void addBuffer(AudioBufferInterleavedView<SourceSampleType> sourceBuffer, AudioBufferInterleavedView<SampleType> destinationBuffer)
+{
+    static_assert(std::is_same_v<std::remove_const_t<SourceSampleType>, SampleType>, "source and destination must have the same sample type");
+    assert(sourceBuffer.getNumChannels() == destinationBuffer.getNumChannels());
+    assert(sourceBuffer.getNumSamples() == destinationBuffer.getNumSamples());
+
+    const int channels = destinationBuffer.getNumChannels();
+    if (sourceBuffer.isContiguous() && destinationBuffer.isContiguous())
+    {
+        addBuffer(sourceBuffer.getReadPointer(), destinationBuffer.getWritePointer(), channels, destinationBuffer.getNumSamples());
+        return;
+    }
+
+    for (int sample = 0; sample < destinationBuffer.getNumSamples(); ++sample)
+    {
+        const SampleType* source = sourceBuffer.getReadPointer() + static_cast<std::ptrdiff_t>(sample) * sourceBuffer.getFrameStride();
+        SampleType* destination = destinationBuffer.getWritePointer() + static_cast<std::ptrdiff_t>(sample) * destinationBuffer.getFrameStride();
+        for (int channel = 0; channel < channels; ++channel)
+            destination[channel] += source[channel];
+    }
+}
+
+template <typename SourceSampleType, typename SampleType>
+inline void interleaveSamples(AudioBufferView<SourceSampleType> sourceBuffer, AudioBufferInterleavedView<SampleType> destinationBuffer)
+{
+    static_assert(std::is_same_v<std::remove_const_t<SourceSampleType>, SampleType>, "source and destination must have the same sample type");
+    assert(sourceBuffer.getNumChannels() == destinationBuffer.getNumChannels());
+    assert(sourceBuffer.getNumSamples() == destinationBuffer.getNumSamples());
+
+    const int channels = destinationBuffer.getNumChannels();
+    const int samples = destinationBuffer.getNumSamples();
+
+    // use the compile-time channel count specializations if possible
+    if (destinationBuffer.isContiguous() && channels <= 8)
+    {
+        const SampleType* source[8] = {};
         for (int channel = 0; channel < channels; ++channel)
-            destinationBuffer[channel][sample] = sourceBuffer[channels * sample + channel];
+            source[channel] = sourceBuffer.getReadPointer(channel);
+        interleaveSamples(source, destinationBuffer.getWritePointer(), channels, samples);
+        return;
+    }
+
+    detail::interleaveSamplesBlocked([&sourceBuffer](int channel)
+                                     { return sourceBuffer.getReadPointer(channel); },
+                                     destinationBuffer.getWritePointer(), channels, destinationBuffer.getFrameStride(), samples);
+}
+
+template <typename SourceSampleType, typename SampleType>
+inline void deinterleaveSamples(AudioBufferInterleavedView<SourceSampleType> sourceBuffer, AudioBufferView<SampleType> destinationBuffer)
+{
+    static_assert(std::is_same_v<std::remove_const_t<SourceSampleType>, SampleType>, "source and destination must have the same sample type");
+    assert(sourceBuffer.getNumChannels() == destinationBuffer.getNumChannels());
+    assert(sourceBuffer.getNumSamples() == destinationBuffer.getNumSamples());
+
+    const int channels = destinationBuffer.getNumChannels();
+    const int samples = destinationBuffer.getNumSamples();
+
+    // use the compile-time channel count specializations if possible
+    if (sourceBuffer.isContiguous() && channels <= 8)
+    {
+        SampleType* destination[8] = {};
+        for (int channel = 0; channel < channels; ++channel)
+            destination[channel] = destinationBuffer.getWritePointer(channel);
+        deinterleaveSamples(sourceBuffer.getReadPointer(), destination, channels, samples);
+        return;
+    }
+
+    detail::deinterleaveSamplesBlocked(sourceBuffer.getReadPointer(), [&destinationBuffer](int channel)
+                                       { return destinationBuffer.getWritePointer(channel); },
+                                       channels, sourceBuffer.getFrameStride(), samples);
 }
 
 } // namespace edsp
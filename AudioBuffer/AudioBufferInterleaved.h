@@ -3,20 +3,37 @@
 
 #pragma once
 
+#include "AudioBufferView.h"
 #include <cassert>
 #include <cstddef>
+#include <memory_resource>
+#include <type_traits>
 
 namespace edsp
 {
 
+// memory is only allocated if the requested size exceeds the capacity, use reserve() to preallocate
 template <typename SampleType>
 class AudioBufferInterleaved
 {
+    static_assert(std::is_trivial_v<SampleType>, "SampleType must be a trivial type");
+
 public:
+    static constexpr std::size_t alignment = 64;
+
     AudioBufferInterleaved() = default;
 
-    AudioBufferInterleaved(int channels, int samples)
+    // all allocations are made from memoryResource, e.g. a pool or arena that is set up at application start
+    explicit AudioBufferInterleaved(std::pmr::memory_resource* memoryResource) noexcept
+            : mMemoryResource(memoryResource)
     {
+        assert(memoryResource != nullptr);
+    }
+
+    AudioBufferInterleaved(int channels, int samples, std::pmr::memory_resource* memoryResource = std::pmr::get_default_resource())
+            : mMemoryResource(memoryResource)
+    {
+        assert(memoryResource != nullptr);
         setSize(channels, samples);
     }
 
@@ -32,42 +49,50 @@ public:
     // allow moving
     AudioBufferInterleaved(AudioBufferInterleaved&& other) noexcept
     {
-        mChannels = other.mChannels;
-        mSamples = other.mSamples;
-        mBuffer = other.mBuffer;
-        other.mChannels = 0;
-        other.mSamples = 0;
-        other.mBuffer = nullptr;
+        moveFrom(other);
     }
     AudioBufferInterleaved& operator=(AudioBufferInterleaved&& other) noexcept
     {
         if (&other == this)
             return *this;
 
-        deallocateBuffer(); // this does not do anything if other is empty
-
-        mChannels = other.mChannels;
-        mSamples = other.mSamples;
-        mBuffer = other.mBuffer;
-        other.mChannels = 0;
-        other.mSamples = 0;
-        other.mBuffer = nullptr;
+        deallocateBuffer(); // this does not do anything if this buffer is empty
+        moveFrom(other);
 
         return *this;
     }
 
+    // does not allocate if channels * samples fits into the capacity
     void setSize(int channels, int samples)
     {
         assert(channels > 0 && samples > 0);
-        if (channels == mChannels && samples == mSamples)
-            return;
-
-        if (mChannels != 0 && mSamples != 0)
-            deallocateBuffer();
 
+        reserve(channels, samples);
         mChannels = channels;
         mSamples = samples;
-        allocateBuffer();
+    }
+
+    // preallocates memory for up to channels * samples samples, e.g. call at application start
+    // the content of the buffer is lost if memory has to be allocated
+    void reserve(int channels, int samples)
+    {
+        assert(channels > 0 && samples > 0);
+        const std::size_t totalSamples = static_cast<std::size_t>(channels) * static_cast<std::size_t>(samples);
+        if (totalSamples <= mCapacity)
+            return;
+
+        reallocateBuffer(totalSamples);
+    }
+
+    // number of samples (all channels) that fit into the buffer without allocating
+    std::size_t getCapacity() const noexcept
+    {
+        return mCapacity;
+    }
+
+    std::pmr::memory_resource* getMemoryResource() const noexcept
+    {
+        return mMemoryResource;
     }
 
     const SampleType* getReadPointer() const noexcept
@@ -82,6 +107,18 @@ public:
         return mBuffer;
     }
 
+    AudioBufferInterleavedView<const SampleType> getReadView() const noexcept
+    {
+        assert(mChannels > 0 && mSamples > 0);
+        return {mBuffer, mChannels, mSamples};
+    }
+
+    AudioBufferInterleavedView<SampleType> getWriteView() noexcept
+    {
+        assert(mChannels > 0 && mSamples > 0);
+        return {mBuffer, mChannels, mSamples};
+    }
+
     SampleType getSample(int channel, int sample) const noexcept
     {
         assert(mChannels > 0 && mSamples > 0);
@@ -90,7 +127,7 @@ public:
         return mBuffer[sample * mChannels + channel];
     }
 
-    SampleType setSample(int channel, int sample, SampleType value) noexcept
+    void setSample(int channel, int sample, SampleType value) noexcept
     {
         assert(mChannels > 0 && mSamples > 0);
         assert(channel >= 0 && channel < mChannels);
@@ -109,27 +146,45 @@ public:
     }
 
 private:
-    void allocateBuffer()
+    // allocates the new memory before releasing the old one, the buffer stays valid if the allocation throws
+    void reallocateBuffer(std::size_t capacity)
     {
-        const std::size_t totalSamples = static_cast<std::size_t>(mChannels) * static_cast<std::size_t>(mSamples);
-        mBuffer = new SampleType[totalSamples];
+        auto* buffer = static_cast<SampleType*>(mMemoryResource->allocate(capacity * sizeof(SampleType), alignment));
+
+        deallocateBuffer();
+
+        mBuffer = buffer;
+        mCapacity = capacity;
     }
 
     void deallocateBuffer() noexcept
     {
-        if (mChannels != 0 && mSamples != 0)
+        if (mBuffer != nullptr)
         {
-            if (mBuffer != nullptr)
-            {
-                delete[] mBuffer;
-                mBuffer = nullptr;
-            }
+            mMemoryResource->deallocate(mBuffer, mCapacity * sizeof(SampleType), alignment);
+            mBuffer = nullptr;
         }
+        mCapacity = 0;
+    }
+
+    void moveFrom(AudioBufferInterleaved& other) noexcept
+    {
+        mChannels = other.mChannels;
+        mSamples = other.mSamples;
+        mCapacity = other.mCapacity;
+        mBuffer = other.mBuffer;
+        mMemoryResource = other.mMemoryResource;
+        other.mChannels = 0;
+        other.mSamples = 0;
+        other.mCapacity = 0;
+        other.mBuffer = nullptr;
     }
 
     int mChannels = 0;
     int mSamples = 0;
+    std::size_t mCapacity = 0;
     SampleType* mBuffer = nullptr;
+    std::pmr::memory_resource* mMemoryResource = std::pmr::get_default_resource();
 };
 
 } // namespace edsp
@@ -0,0 +1,2142 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+// SIMD kernels used by AudioBufferHelpers.h, AudioBufferGain.h, AudioBufferConversion.h, LookAheadLimiter.h and PolyphaseResampler.h
+// the instruction set is detected once at runtime and every kernel returns exactly the same result as the scalar code,
+// except for sumOfSquares() and polyphaseFilter() (summation order), test.cpp compares the kernels of every supported instruction set
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define EDSP_SIMD_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define EDSP_SIMD_TARGET(x)
+    #else
+        #define EDSP_SIMD_TARGET(x) __attribute__((target(x)))
+    #endif
+    // GCC 12 reports the undefined pass-through operand of most AVX-512 intrinsics as uninitialized wherever they are inlined (GCC bug 105593),
+    // even _mm512_castps512_ps256(), so the warnings are disabled around the AVX-512 kernels
+    #if defined(__GNUC__) && !defined(__clang__)
+        #define EDSP_SIMD_AVX512_BEGIN _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wuninitialized\"") _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+        #define EDSP_SIMD_AVX512_END _Pragma("GCC diagnostic pop")
+    #else
+        #define EDSP_SIMD_AVX512_BEGIN
+        #define EDSP_SIMD_AVX512_END
+    #endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define EDSP_SIMD_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace edsp
+{
+
+enum class SimdLevel
+{
+    Scalar,
+    Sse2,
+    Avx2,
+    Avx512,
+    Neon
+};
+
+inline SimdLevel detectSimdLevel() noexcept
+{
+#if defined(EDSP_DISABLE_SIMD)
+    return SimdLevel::Scalar;
+#elif defined(EDSP_SIMD_X86)
+    #if defined(_MSC_VER) && !defined(__clang__)
+    int info[4] = {};
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    const bool sse2 = (info[3] & (1 << 26)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+
+    // the OS has to save the ymm (and zmm) registers on context switches
+    const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    const bool ymmEnabled = (xcr0 & 0x06) == 0x06;
+    const bool zmmEnabled = (xcr0 & 0xe6) == 0xe6;
+
+    bool avx2 = false;
+    bool avx512 = false;
+    if (maxLeaf >= 7)
+    {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+        avx512 = (info[1] & (1 << 16)) != 0;
+    }
+
+    if (avx && avx2 && avx512 && ymmEnabled && zmmEnabled)
+        return SimdLevel::Avx512;
+    if (avx && avx2 && ymmEnabled)
+        return SimdLevel::Avx2;
+    if (sse2)
+        return SimdLevel::Sse2;
+    return SimdLevel::Scalar;
+    #else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SimdLevel::Avx512;
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::Avx2;
+    if (__builtin_cpu_supports("sse2"))
+        return SimdLevel::Sse2;
+    return SimdLevel::Scalar;
+    #endif
+#elif defined(EDSP_SIMD_NEON)
+    return SimdLevel::Neon;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+// the detection only runs on the first call
+inline SimdLevel getSimdLevel() noexcept
+{
+    static const SimdLevel simdLevel = detectSimdLevel();
+    return simdLevel;
+}
+
+// GCC contracts multiply-add into FMA instructions within target("avx2") and target("avx512f") functions even without -march,
+// and clang contracts the scalar code with -mfma, so the kernels would round differently, the contraction is disabled for all of them
+#if defined(__clang__)
+    #pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+    #pragma GCC push_options
+    #pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace simd
+{
+
+//
+// scalar reference kernels
+//
+
+inline void addScalar(const float* source, float* destination, int samples) noexcept
+{
+    for (int i = 0; i < samples; ++i)
+        destination[i] += source[i];
+}
+
+inline void interleaveStereoScalar(const float* left, const float* right, float* destination, int samples) noexcept
+{
+    for (int sample = 0; sample < samples; ++sample)
+    {
+        destination[2 * sample] = left[sample];
+        destination[2 * sample + 1] = right[sample];
+    }
+}
+
+inline void deinterleaveStereoScalar(const float* source, float* left, float* right, int samples) noexcept
+{
+    for (int sample = 0; sample < samples; ++sample)
+    {
+        left[sample] = source[2 * sample];
+        right[sample] = source[2 * sample + 1];
+    }
+}
+
+// writes channels [0, channels) of every frame, consecutive frames are frameStride samples apart
+inline void interleaveScalar(const float* const* source, float* destination, int channels, int frameStride, int samples) noexcept
+{
+    for (int sample = 0; sample < samples; ++sample)
+        for (int channel = 0; channel < channels; ++channel)
+            destination[sample * frameStride + channel] = source[channel][sample];
+}
+
+// reads channels [0, channels) of every frame, consecutive frames are frameStride samples apart
+inline void deinterleaveScalar(const float* source, float* const* destination, int channels, int frameStride, int samples) noexcept
+{
+    for (int sample = 0; sample < samples; ++sample)
+        for (int channel = 0; channel < channels; ++channel)
+            destination[channel][sample] = source[sample * frameStride + channel];
+}
+
+// destination = source * gain, or destination += source * gain if ACCUMULATE is true
+template <bool ACCUMULATE>
+inline void gainScalar(const float* source, float* destination, int samples, float gain) noexcept
+{
+    for (int i = 0; i < samples; ++i)
+    {
+        if constexpr (ACCUMULATE)
+            destination[i] += source[i] * gain;
+        else
+            destination[i] = source[i] * gain;
+    }
+}
+
+// like gainScalar, but the gain of frame n is startGain + n * gainIncrement
+// samples counts all samples of all channels, firstSample is the position of source[0] within the interleaved stream
+template <bool ACCUMULATE>
+inline void gainRampScalar(const float* source, float* destination, int samples, float startGain, float gainIncrement, int channels, int firstSample = 0) noexcept
+{
+    int frame = firstSample / channels;
+    int channel = firstSample % channels;
+    for (int i = 0; i < samples; ++i)
+    {
+        const float gain = startGain + static_cast<float>(frame) * gainIncrement;
+        if constexpr (ACCUMULATE)
+            destination[i] += source[i] * gain;
+        else
+            destination[i] = source[i] * gain;
+
+        if (++channel == channels)
+        {
+            channel = 0;
+            ++frame;
+        }
+    }
+}
+
+inline float absMaxScalar(const float* source, int samples, float result = 0.0f) noexcept
+{
+    for (int i = 0; i < samples; ++i)
+        result = std::max(result, std::fabs(source[i]));
+    return result;
+}
+
+// maxima[i] = max(maxima[i], |source[i]|)
+inline void absMaxAccumulateScalar(const float* source, float* maxima, int samples) noexcept
+{
+    for (int i = 0; i < samples; ++i)
+        maxima[i] = std::max(maxima[i], std::fabs(source[i]));
+}
+
+// outputs the delayed samples with gain, clamped to [-limit, limit] and multiplied by makeupGain, buffer is stored in delayLine
+inline void delayGainClampScalar(float* buffer, float* delayLine, const float* gains, int samples, float limit, float makeupGain) noexcept
+{
+    for (int i = 0; i < samples; ++i)
+    {
+        const float delayedSample = delayLine[i];
+        delayLine[i] = buffer[i];
+        buffer[i] = std::clamp(delayedSample * gains[i], -limit, limit) * makeupGain;
+    }
+}
+
+inline float sumOfSquaresScalar(const float* source, int samples) noexcept
+{
+    float result = 0.0f;
+    for (int i = 0; i < samples; ++i)
+        result += source[i] * source[i];
+    return result;
+}
+
+inline float dotProductScalar(const float* a, const float* b, int samples, float result = 0.0f) noexcept
+{
+    for (int i = 0; i < samples; ++i)
+        result += a[i] * b[i];
+    return result;
+}
+
+// polyphase FIR, destination[i * destinationStride] = sum of coefficients[phases[i] * taps + k] * source[positions[i] + k] for k in [0, taps)
+inline void polyphaseFilterScalar(const float* source, const float* coefficients, const int* positions, const int* phases, int taps, float* destination, int destinationStride, int samples) noexcept
+{
+    for (int sample = 0; sample < samples; ++sample)
+        destination[sample * destinationStride] = dotProductScalar(coefficients + static_cast<std::ptrdiff_t>(phases[sample]) * taps, source + positions[sample], taps);
+}
+
+// sample format conversion, integer samples are scaled to [-1, 1)
+// float samples are clamped to the integer range and rounded to the nearest integer
+// ditherState is nullptr or points to ditherLanes xorshift states, sample i of a call uses the state i % ditherLanes
+constexpr int ditherLanes = 16;
+
+// triangular dither between -1 and 1 LSB, the difference of two 16 bit uniform random numbers
+inline float ditherScalar(std::uint32_t& state) noexcept
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return static_cast<float>(static_cast<std::int32_t>(state >> 16) - static_cast<std::int32_t>(state & 0xffff)) * (1.0f / 65536.0f);
+}
+
+// the argument order of min and max matches the SIMD instructions, NaN is converted to the minimum
+inline std::int32_t roundSample(float value, float minimum, float maximum) noexcept
+{
+    return static_cast<std::int32_t>(std::lrint(std::min(maximum, std::max(minimum, value))));
+}
+
+inline void int16ToFloatScalar(const std::int16_t* source, float* destination, int samples) noexcept
+{
+    for (int i = 0; i < samples; ++i)
+        destination[i] = static_cast<float>(source[i]) * (1.0f / 32768.0f);
+}
+
+inline void floatToInt16Scalar(const float* source, std::int16_t* destination, int samples, std::uint32_t* ditherState) noexcept
+{
+    for (int i = 0; i < samples; ++i)
+    {
+        float value = source[i] * 32768.0f;
+        if (ditherState != nullptr)
+            value += ditherScalar(ditherState[i % ditherLanes]);
+        destination[i] = static_cast<std::int16_t>(roundSample(value, -32768.0f, 32767.0f));
+    }
+}
+
+// packed little endian 24 bit samples, 3 bytes per sample
+inline void int24ToFloatScalar(const std::uint8_t* source, float* destination, int samples) noexcept
+{
+    for (int i = 0; i < samples; ++i)
+    {
+        const std::uint8_t* bytes = source + static_cast<std::size_t>(i) * 3;
+        const std::uint32_t value = static_cast<std::uint32_t>(bytes[0]) << 8 | static_cast<std::uint32_t>(bytes[1]) << 16 | static_cast<std::uint32_t>(bytes[2]) << 24;
+        destination[i] = static_cast<float>(static_cast<std::int32_t>(value) >> 8) * (1.0f / 8388608.0f);
+    }
+}
+
+inline void floatToInt24Scalar(const float* source, std::uint8_t* destination, int samples, std::uint32_t* ditherState) noexcept
+{
+    for (int i = 0; i < samples; ++i)
+    {
+        float value = source[i] * 8388608.0f;
+        if (ditherState != nullptr)
+            value += ditherScalar(ditherState[i % ditherLanes]);
+        const auto result = static_cast<std::uint32_t>(roundSample(value, -8388608.0f, 8388607.0f));
+        std::uint8_t* bytes = destination + static_cast<std::size_t>(i) * 3;
+        bytes[0] = static_cast<std::uint8_t>(result);
+        bytes[1] = static_cast<std::uint8_t>(result >> 8);
+        bytes[2] = static_cast<std::uint8_t>(result >> 16);
+    }
+}
+
+inline void int32ToFloatScalar(const std::int32_t* source, float* destination, int samples) noexcept
+{
+    for (int i = 0; i < samples; ++i)
+        destination[i] = static_cast<float>(source[i]) * (1.0f / 2147483648.0f);
+}
+
+// 2147483520 is the largest float below 2^31
+inline void floatToInt32Scalar(const float* source, std::int32_t* destination, int samples) noexcept
+{
+    for (int i = 0; i < samples; ++i)
+        destination[i] = roundSample(source[i] * 2147483648.0f, -2147483648.0f, 2147483520.0f);
+}
+
+#if defined(EDSP_SIMD_X86)
+
+//
+// SSE2
+//
+
+EDSP_SIMD_TARGET("sse2") inline void addSse2(const float* source, float* destination, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+        _mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i), _mm_loadu_ps(source + i)));
+    addScalar(source + i, destination + i, samples - i);
+}
+
+EDSP_SIMD_TARGET("sse2") inline void interleaveStereoSse2(const float* left, const float* right, float* destination, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        const __m128 l = _mm_loadu_ps(left + i);
+        const __m128 r = _mm_loadu_ps(right + i);
+        _mm_storeu_ps(destination + 2 * i, _mm_unpacklo_ps(l, r));     // l0 r0 l1 r1
+        _mm_storeu_ps(destination + 2 * i + 4, _mm_unpackhi_ps(l, r)); // l2 r2 l3 r3
+    }
+    interleaveStereoScalar(left + i, right + i, destination + 2 * i, samples - i);
+}
+
+EDSP_SIMD_TARGET("sse2") inline void deinterleaveStereoSse2(const float* source, float* left, float* right, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        const __m128 a = _mm_loadu_ps(source + 2 * i);     // l0 r0 l1 r1
+        const __m128 b = _mm_loadu_ps(source + 2 * i + 4); // l2 r2 l3 r3
+        _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    deinterleaveStereoScalar(source + 2 * i, left + i, right + i, samples - i);
+}
+
+EDSP_SIMD_TARGET("sse2") inline void interleave4Sse2(const float* const* source, float* destination, int frameStride, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        __m128 c0 = _mm_loadu_ps(source[0] + i);
+        __m128 c1 = _mm_loadu_ps(source[1] + i);
+        __m128 c2 = _mm_loadu_ps(source[2] + i);
+        __m128 c3 = _mm_loadu_ps(source[3] + i);
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+        _mm_storeu_ps(destination + i * frameStride, c0);
+        _mm_storeu_ps(destination + (i + 1) * frameStride, c1);
+        _mm_storeu_ps(destination + (i + 2) * frameStride, c2);
+        _mm_storeu_ps(destination + (i + 3) * frameStride, c3);
+    }
+    const float* tail[4] = {source[0] + i, source[1] + i, source[2] + i, source[3] + i};
+    interleaveScalar(tail, destination + i * frameStride, 4, frameStride, samples - i);
+}
+
+EDSP_SIMD_TARGET("sse2") inline void deinterleave4Sse2(const float* source, float* const* destination, int frameStride, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        __m128 f0 = _mm_loadu_ps(source + i * frameStride);
+        __m128 f1 = _mm_loadu_ps(source + (i + 1) * frameStride);
+        __m128 f2 = _mm_loadu_ps(source + (i + 2) * frameStride);
+        __m128 f3 = _mm_loadu_ps(source + (i + 3) * frameStride);
+        _MM_TRANSPOSE4_PS(f0, f1, f2, f3);
+        _mm_storeu_ps(destination[0] + i, f0);
+        _mm_storeu_ps(destination[1] + i, f1);
+        _mm_storeu_ps(destination[2] + i, f2);
+        _mm_storeu_ps(destination[3] + i, f3);
+    }
+    float* tail[4] = {destination[0] + i, destination[1] + i, destination[2] + i, destination[3] + i};
+    deinterleaveScalar(source + i * frameStride, tail, 4, frameStride, samples - i);
+}
+
+EDSP_SIMD_TARGET("sse2") inline void interleave6Sse2(const float* const* source, float* destination, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        // channels 0-3 are transposed, channels 4 and 5 are zipped into pairs
+        __m128 f0 = _mm_loadu_ps(source[0] + i);
+        __m128 f1 = _mm_loadu_ps(source[1] + i);
+        __m128 f2 = _mm_loadu_ps(source[2] + i);
+        __m128 f3 = _mm_loadu_ps(source[3] + i);
+        _MM_TRANSPOSE4_PS(f0, f1, f2, f3);
+        const __m128 c4 = _mm_loadu_ps(source[4] + i);
+        const __m128 c5 = _mm_loadu_ps(source[5] + i);
+        const __m128 pairs01 = _mm_unpacklo_ps(c4, c5); // frames 0 and 1 of channels 4 and 5
+        const __m128 pairs23 = _mm_unpackhi_ps(c4, c5); // frames 2 and 3 of channels 4 and 5
+
+        float* frames = destination + i * 6;
+        _mm_storeu_ps(frames, f0);
+        _mm_storeu_ps(frames + 4, _mm_movelh_ps(pairs01, f1));
+        _mm_storeu_ps(frames + 8, _mm_shuffle_ps(f1, pairs01, _MM_SHUFFLE(3, 2, 3, 2)));
+        _mm_storeu_ps(frames + 12, f2);
+        _mm_storeu_ps(frames + 16, _mm_movelh_ps(pairs23, f3));
+        _mm_storeu_ps(frames + 20, _mm_shuffle_ps(f3, pairs23, _MM_SHUFFLE(3, 2, 3, 2)));
+    }
+    const float* tail[6] = {source[0] + i, source[1] + i, source[2] + i, source[3] + i, source[4] + i, source[5] + i};
+    interleaveScalar(tail, destination + i * 6, 6, 6, samples - i);
+}
+
+EDSP_SIMD_TARGET("sse2") inline void deinterleave6Sse2(const float* source, float* const* destination, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        const float* frames = source + i * 6;
+        const __m128 v0 = _mm_loadu_ps(frames);
+        const __m128 v1 = _mm_loadu_ps(frames + 4);
+        const __m128 v2 = _mm_loadu_ps(frames + 8);
+        const __m128 v3 = _mm_loadu_ps(frames + 12);
+        const __m128 v4 = _mm_loadu_ps(frames + 16);
+        const __m128 v5 = _mm_loadu_ps(frames + 20);
+
+        __m128 c0 = v0;
+        __m128 c1 = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(1, 0, 3, 2));
+        __m128 c2 = v3;
+        __m128 c3 = _mm_shuffle_ps(v4, v5, _MM_SHUFFLE(1, 0, 3, 2));
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+        const __m128 pairs01 = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(3, 2, 1, 0));
+        const __m128 pairs23 = _mm_shuffle_ps(v4, v5, _MM_SHUFFLE(3, 2, 1, 0));
+
+        _mm_storeu_ps(destination[0] + i, c0);
+        _mm_storeu_ps(destination[1] + i, c1);
+        _mm_storeu_ps(destination[2] + i, c2);
+        _mm_storeu_ps(destination[3] + i, c3);
+        _mm_storeu_ps(destination[4] + i, _mm_shuffle_ps(pairs01, pairs23, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(destination[5] + i, _mm_shuffle_ps(pairs01, pairs23, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    float* tail[6] = {destination[0] + i, destination[1] + i, destination[2] + i, destination[3] + i, destination[4] + i, destination[5] + i};
+    deinterleaveScalar(source + i * 6, tail, 6, 6, samples - i);
+}
+
+EDSP_SIMD_TARGET("sse2") inline void interleave8Sse2(const float* const* source, float* destination, int frameStride, int samples) noexcept
+{
+    interleave4Sse2(source, destination, frameStride, samples);
+    interleave4Sse2(source + 4, destination + 4, frameStride, samples);
+}
+
+EDSP_SIMD_TARGET("sse2") inline void deinterleave8Sse2(const float* source, float* const* destination, int frameStride, int samples) noexcept
+{
+    deinterleave4Sse2(source, destination, frameStride, samples);
+    deinterleave4Sse2(source + 4, destination + 4, frameStride, samples);
+}
+
+template <bool ACCUMULATE>
+EDSP_SIMD_TARGET("sse2") inline void gainSse2(const float* source, float* destination, int samples, float gain) noexcept
+{
+    const __m128 gainVector = _mm_set1_ps(gain);
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        __m128 result = _mm_mul_ps(_mm_loadu_ps(source + i), gainVector);
+        if constexpr (ACCUMULATE)
+            result = _mm_add_ps(_mm_loadu_ps(destination + i), result);
+        _mm_storeu_ps(destination + i, result);
+    }
+    gainScalar<ACCUMULATE>(source + i, destination + i, samples - i, gain);
+}
+
+template <bool ACCUMULATE>
+EDSP_SIMD_TARGET("sse2") inline void gainRampSse2(const float* source, float* destination, int samples, float startGain, float gainIncrement, int channels) noexcept
+{
+    // every lane tracks the frame and the channel of its sample, both are advanced by 4 samples per iteration
+    __m128 frame = _mm_setr_ps(static_cast<float>(0 / channels), static_cast<float>(1 / channels), static_cast<float>(2 / channels), static_cast<float>(3 / channels));
+    __m128 channel = _mm_setr_ps(static_cast<float>(0 % channels), static_cast<float>(1 % channels), static_cast<float>(2 % channels), static_cast<float>(3 % channels));
+    const __m128 frameStep = _mm_set1_ps(static_cast<float>(4 / channels));
+    const __m128 channelStep = _mm_set1_ps(static_cast<float>(4 % channels));
+    const __m128 numChannels = _mm_set1_ps(static_cast<float>(channels));
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 start = _mm_set1_ps(startGain);
+    const __m128 increment = _mm_set1_ps(gainIncrement);
+
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        const __m128 gain = _mm_add_ps(start, _mm_mul_ps(frame, increment));
+        __m128 result = _mm_mul_ps(_mm_loadu_ps(source + i), gain);
+        if constexpr (ACCUMULATE)
+            result = _mm_add_ps(_mm_loadu_ps(destination + i), result);
+        _mm_storeu_ps(destination + i, result);
+
+        channel = _mm_add_ps(channel, channelStep);
+        frame = _mm_add_ps(frame, frameStep);
+        const __m128 wrapped = _mm_cmpge_ps(channel, numChannels);
+        channel = _mm_sub_ps(channel, _mm_and_ps(wrapped, numChannels));
+        frame = _mm_add_ps(frame, _mm_and_ps(wrapped, one));
+    }
+    gainRampScalar<ACCUMULATE>(source + i, destination + i, samples - i, startGain, gainIncrement, channels, i);
+}
+
+EDSP_SIMD_TARGET("sse2") inline float absMaxSse2(const float* source, int samples) noexcept
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 maximum = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+        maximum = _mm_max_ps(maximum, _mm_andnot_ps(signMask, _mm_loadu_ps(source + i)));
+
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, maximum);
+    return absMaxScalar(source + i, samples - i, absMaxScalar(lanes, 4));
+}
+
+EDSP_SIMD_TARGET("sse2") inline void absMaxAccumulateSse2(const float* source, float* maxima, int samples) noexcept
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+        _mm_storeu_ps(maxima + i, _mm_max_ps(_mm_loadu_ps(maxima + i), _mm_andnot_ps(signMask, _mm_loadu_ps(source + i))));
+    absMaxAccumulateScalar(source + i, maxima + i, samples - i);
+}
+
+EDSP_SIMD_TARGET("sse2") inline void delayGainClampSse2(float* buffer, float* delayLine, const float* gains, int samples, float limit, float makeupGain) noexcept
+{
+    const __m128 maximum = _mm_set1_ps(limit);
+    const __m128 minimum = _mm_set1_ps(-limit);
+    const __m128 makeup = _mm_set1_ps(makeupGain);
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        const __m128 delayedSample = _mm_loadu_ps(delayLine + i);
+        _mm_storeu_ps(delayLine + i, _mm_loadu_ps(buffer + i));
+        const __m128 value = _mm_mul_ps(delayedSample, _mm_loadu_ps(gains + i));
+        _mm_storeu_ps(buffer + i, _mm_mul_ps(_mm_min_ps(_mm_max_ps(value, minimum), maximum), makeup));
+    }
+    delayGainClampScalar(buffer + i, delayLine + i, gains + i, samples - i, limit, makeupGain);
+}
+
+EDSP_SIMD_TARGET("sse2") inline float sumOfSquaresSse2(const float* source, int samples) noexcept
+{
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+    {
+        const __m128 a = _mm_loadu_ps(source + i);
+        const __m128 b = _mm_loadu_ps(source + i + 4);
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(a, a));
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(b, b));
+    }
+
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(sum0, sum1));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sumOfSquaresScalar(source + i, samples - i);
+}
+
+EDSP_SIMD_TARGET("sse2") inline void polyphaseFilterSse2(const float* source, const float* coefficients, const int* positions, const int* phases, int taps, float* destination, int destinationStride, int samples) noexcept
+{
+    for (int sample = 0; sample < samples; ++sample)
+    {
+        const float* input = source + positions[sample];
+        const float* phase = coefficients + static_cast<std::ptrdiff_t>(phases[sample]) * taps;
+        __m128 sum0 = _mm_setzero_ps();
+        __m128 sum1 = _mm_setzero_ps();
+        int tap = 0;
+        for (; tap + 8 <= taps; tap += 8)
+        {
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(phase + tap), _mm_loadu_ps(input + tap)));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(phase + tap + 4), _mm_loadu_ps(input + tap + 4)));
+        }
+
+        __m128 sum = _mm_add_ps(sum0, sum1);
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+        destination[sample * destinationStride] = dotProductScalar(phase + tap, input + tap, taps - tap, _mm_cvtss_f32(sum));
+    }
+}
+
+// advances 4 xorshift states and returns their triangular dither
+EDSP_SIMD_TARGET("sse2") inline __m128 ditherSse2(__m128i& state) noexcept
+{
+    state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+    state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+    state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+    const __m128i difference = _mm_sub_epi32(_mm_srli_epi32(state, 16), _mm_and_si128(state, _mm_set1_epi32(0xffff)));
+    return _mm_mul_ps(_mm_cvtepi32_ps(difference), _mm_set1_ps(1.0f / 65536.0f));
+}
+
+EDSP_SIMD_TARGET("sse2") inline void int16ToFloatSse2(const std::int16_t* source, float* destination, int samples) noexcept
+{
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+    {
+        // every 32 bit lane holds the sample twice, the arithmetic shift leaves the sign extended sample
+        const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(input, input), 16);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(input, input), 16);
+        _mm_storeu_ps(destination + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+        _mm_storeu_ps(destination + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+    }
+    int16ToFloatScalar(source + i, destination + i, samples - i);
+}
+
+EDSP_SIMD_TARGET("sse2") inline void floatToInt16Sse2(const float* source, std::int16_t* destination, int samples, std::uint32_t* ditherState) noexcept
+{
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    const __m128 minimum = _mm_set1_ps(-32768.0f);
+    const __m128 maximum = _mm_set1_ps(32767.0f);
+
+    __m128i state[4] = {};
+    if (ditherState != nullptr)
+        for (int k = 0; k < 4; ++k)
+            state[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ditherState + 4 * k));
+
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        __m128i result[4];
+        for (int k = 0; k < 4; ++k)
+        {
+            __m128 value = _mm_mul_ps(_mm_loadu_ps(source + i + 4 * k), scale);
+            if (ditherState != nullptr)
+                value = _mm_add_ps(value, ditherSse2(state[k]));
+            result[k] = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(value, minimum), maximum));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packs_epi32(result[0], result[1]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 8), _mm_packs_epi32(result[2], result[3]));
+    }
+
+    if (ditherState != nullptr)
+        for (int k = 0; k < 4; ++k)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(ditherState + 4 * k), state[k]);
+    floatToInt16Scalar(source + i, destination + i, samples - i, ditherState);
+}
+
+EDSP_SIMD_TARGET("sse2") inline void int32ToFloatSse2(const std::int32_t* source, float* destination, int samples) noexcept
+{
+    const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+        _mm_storeu_ps(destination + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i))), scale));
+    int32ToFloatScalar(source + i, destination + i, samples - i);
+}
+
+EDSP_SIMD_TARGET("sse2") inline void floatToInt32Sse2(const float* source, std::int32_t* destination, int samples) noexcept
+{
+    const __m128 scale = _mm_set1_ps(2147483648.0f);
+    const __m128 minimum = _mm_set1_ps(-2147483648.0f);
+    const __m128 maximum = _mm_set1_ps(2147483520.0f);
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        const __m128 value = _mm_mul_ps(_mm_loadu_ps(source + i), scale);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(value, minimum), maximum)));
+    }
+    floatToInt32Scalar(source + i, destination + i, samples - i);
+}
+
+//
+// AVX2
+//
+
+EDSP_SIMD_TARGET("avx2") inline void addAvx2(const float* source, float* destination, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        const __m256 a = _mm256_add_ps(_mm256_loadu_ps(destination + i), _mm256_loadu_ps(source + i));
+        const __m256 b = _mm256_add_ps(_mm256_loadu_ps(destination + i + 8), _mm256_loadu_ps(source + i + 8));
+        _mm256_storeu_ps(destination + i, a);
+        _mm256_storeu_ps(destination + i + 8, b);
+    }
+    for (; i + 8 <= samples; i += 8)
+        _mm256_storeu_ps(destination + i, _mm256_add_ps(_mm256_loadu_ps(destination + i), _mm256_loadu_ps(source + i)));
+    addScalar(source + i, destination + i, samples - i);
+}
+
+EDSP_SIMD_TARGET("avx2") inline void interleaveStereoAvx2(const float* left, const float* right, float* destination, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+    {
+        const __m256 l = _mm256_loadu_ps(left + i);
+        const __m256 r = _mm256_loadu_ps(right + i);
+        const __m256 lo = _mm256_unpacklo_ps(l, r); // l0 r0 l1 r1 | l4 r4 l5 r5
+        const __m256 hi = _mm256_unpackhi_ps(l, r); // l2 r2 l3 r3 | l6 r6 l7 r7
+        _mm256_storeu_ps(destination + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(destination + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    interleaveStereoScalar(left + i, right + i, destination + 2 * i, samples - i);
+}
+
+EDSP_SIMD_TARGET("avx2") inline void deinterleaveStereoAvx2(const float* source, float* left, float* right, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+    {
+        const __m256 a = _mm256_loadu_ps(source + 2 * i);     // l0 r0 l1 r1 | l2 r2 l3 r3
+        const __m256 b = _mm256_loadu_ps(source + 2 * i + 8); // l4 r4 l5 r5 | l6 r6 l7 r7
+        const __m256 lo = _mm256_permute2f128_ps(a, b, 0x20); // l0 r0 l1 r1 | l4 r4 l5 r5
+        const __m256 hi = _mm256_permute2f128_ps(a, b, 0x31); // l2 r2 l3 r3 | l6 r6 l7 r7
+        _mm256_storeu_ps(left + i, _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm256_storeu_ps(right + i, _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    deinterleaveStereoScalar(source + 2 * i, left + i, right + i, samples - i);
+}
+
+// transposes 8 rows of 8 floats in place
+EDSP_SIMD_TARGET("avx2") inline void transpose8x8Avx2(__m256* rows) noexcept
+{
+    const __m256 t0 = _mm256_unpacklo_ps(rows[0], rows[1]);
+    const __m256 t1 = _mm256_unpackhi_ps(rows[0], rows[1]);
+    const __m256 t2 = _mm256_unpacklo_ps(rows[2], rows[3]);
+    const __m256 t3 = _mm256_unpackhi_ps(rows[2], rows[3]);
+    const __m256 t4 = _mm256_unpacklo_ps(rows[4], rows[5]);
+    const __m256 t5 = _mm256_unpackhi_ps(rows[4], rows[5]);
+    const __m256 t6 = _mm256_unpacklo_ps(rows[6], rows[7]);
+    const __m256 t7 = _mm256_unpackhi_ps(rows[6], rows[7]);
+
+    const __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+    rows[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+    rows[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+    rows[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+    rows[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+    rows[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+    rows[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+    rows[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+    rows[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+}
+
+EDSP_SIMD_TARGET("avx2") inline void interleave8Avx2(const float* const* source, float* destination, int frameStride, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+    {
+        __m256 rows[8];
+        for (int channel = 0; channel < 8; ++channel)
+            rows[channel] = _mm256_loadu_ps(source[channel] + i);
+        transpose8x8Avx2(rows);
+        for (int frame = 0; frame < 8; ++frame)
+            _mm256_storeu_ps(destination + (i + frame) * frameStride, rows[frame]);
+    }
+    const float* tail[8] = {source[0] + i, source[1] + i, source[2] + i, source[3] + i, source[4] + i, source[5] + i, source[6] + i, source[7] + i};
+    interleaveScalar(tail, destination + i * frameStride, 8, frameStride, samples - i);
+}
+
+EDSP_SIMD_TARGET("avx2") inline void deinterleave8Avx2(const float* source, float* const* destination, int frameStride, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+    {
+        __m256 rows[8];
+        for (int frame = 0; frame < 8; ++frame)
+            rows[frame] = _mm256_loadu_ps(source + (i + frame) * frameStride);
+        transpose8x8Avx2(rows);
+        for (int channel = 0; channel < 8; ++channel)
+            _mm256_storeu_ps(destination[channel] + i, rows[channel]);
+    }
+    float* tail[8] = {destination[0] + i, destination[1] + i, destination[2] + i, destination[3] + i, destination[4] + i, destination[5] + i, destination[6] + i, destination[7] + i};
+    deinterleaveScalar(source + i * frameStride, tail, 8, frameStride, samples - i);
+}
+
+template <bool ACCUMULATE>
+EDSP_SIMD_TARGET("avx2") inline void gainAvx2(const float* source, float* destination, int samples, float gain) noexcept
+{
+    const __m256 gainVector = _mm256_set1_ps(gain);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+    {
+        __m256 result = _mm256_mul_ps(_mm256_loadu_ps(source + i), gainVector);
+        if constexpr (ACCUMULATE)
+            result = _mm256_add_ps(_mm256_loadu_ps(destination + i), result);
+        _mm256_storeu_ps(destination + i, result);
+    }
+    gainScalar<ACCUMULATE>(source + i, destination + i, samples - i, gain);
+}
+
+template <bool ACCUMULATE>
+EDSP_SIMD_TARGET("avx2") inline void gainRampAvx2(const float* source, float* destination, int samples, float startGain, float gainIncrement, int channels) noexcept
+{
+    // every lane tracks the frame and the channel of its sample, both are advanced by 8 samples per iteration
+    alignas(32) float laneFrames[8];
+    alignas(32) float laneChannels[8];
+    for (int lane = 0; lane < 8; ++lane)
+    {
+        laneFrames[lane] = static_cast<float>(lane / channels);
+        laneChannels[lane] = static_cast<float>(lane % channels);
+    }
+    __m256 frame = _mm256_load_ps(laneFrames);
+    __m256 channel = _mm256_load_ps(laneChannels);
+    const __m256 frameStep = _mm256_set1_ps(static_cast<float>(8 / channels));
+    const __m256 channelStep = _mm256_set1_ps(static_cast<float>(8 % channels));
+    const __m256 numChannels = _mm256_set1_ps(static_cast<float>(channels));
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 start = _mm256_set1_ps(startGain);
+    const __m256 increment = _mm256_set1_ps(gainIncrement);
+
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+    {
+        const __m256 gain = _mm256_add_ps(start, _mm256_mul_ps(frame, increment));
+        __m256 result = _mm256_mul_ps(_mm256_loadu_ps(source + i), gain);
+        if constexpr (ACCUMULATE)
+            result = _mm256_add_ps(_mm256_loadu_ps(destination + i), result);
+        _mm256_storeu_ps(destination + i, result);
+
+        channel = _mm256_add_ps(channel, channelStep);
+        frame = _mm256_add_ps(frame, frameStep);
+        const __m256 wrapped = _mm256_cmp_ps(channel, numChannels, _CMP_GE_OQ);
+        channel = _mm256_sub_ps(channel, _mm256_and_ps(wrapped, numChannels));
+        frame = _mm256_add_ps(frame, _mm256_and_ps(wrapped, one));
+    }
+    gainRampScalar<ACCUMULATE>(source + i, destination + i, samples - i, startGain, gainIncrement, channels, i);
+}
+
+EDSP_SIMD_TARGET("avx2") inline float absMaxAvx2(const float* source, int samples) noexcept
+{
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    __m256 maximum = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+        maximum = _mm256_max_ps(maximum, _mm256_andnot_ps(signMask, _mm256_loadu_ps(source + i)));
+
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, maximum);
+    return absMaxScalar(source + i, samples - i, absMaxScalar(lanes, 8));
+}
+
+EDSP_SIMD_TARGET("avx2") inline void absMaxAccumulateAvx2(const float* source, float* maxima, int samples) noexcept
+{
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+        _mm256_storeu_ps(maxima + i, _mm256_max_ps(_mm256_loadu_ps(maxima + i), _mm256_andnot_ps(signMask, _mm256_loadu_ps(source + i))));
+    absMaxAccumulateScalar(source + i, maxima + i, samples - i);
+}
+
+EDSP_SIMD_TARGET("avx2") inline void delayGainClampAvx2(float* buffer, float* delayLine, const float* gains, int samples, float limit, float makeupGain) noexcept
+{
+    const __m256 maximum = _mm256_set1_ps(limit);
+    const __m256 minimum = _mm256_set1_ps(-limit);
+    const __m256 makeup = _mm256_set1_ps(makeupGain);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+    {
+        const __m256 delayedSample = _mm256_loadu_ps(delayLine + i);
+        _mm256_storeu_ps(delayLine + i, _mm256_loadu_ps(buffer + i));
+        const __m256 value = _mm256_mul_ps(delayedSample, _mm256_loadu_ps(gains + i));
+        _mm256_storeu_ps(buffer + i, _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(value, minimum), maximum), makeup));
+    }
+    delayGainClampScalar(buffer + i, delayLine + i, gains + i, samples - i, limit, makeupGain);
+}
+
+EDSP_SIMD_TARGET("avx2") inline float sumOfSquaresAvx2(const float* source, int samples) noexcept
+{
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        const __m256 a = _mm256_loadu_ps(source + i);
+        const __m256 b = _mm256_loadu_ps(source + i + 8);
+        sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(a, a));
+        sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(b, b));
+    }
+
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, _mm256_add_ps(sum0, sum1));
+    float result = sumOfSquaresScalar(source + i, samples - i);
+    for (float lane : lanes)
+        result += lane;
+    return result;
+}
+
+EDSP_SIMD_TARGET("avx2") inline void polyphaseFilterAvx2(const float* source, const float* coefficients, const int* positions, const int* phases, int taps, float* destination, int destinationStride, int samples) noexcept
+{
+    for (int sample = 0; sample < samples; ++sample)
+    {
+        const float* input = source + positions[sample];
+        const float* phase = coefficients + static_cast<std::ptrdiff_t>(phases[sample]) * taps;
+        __m256 sum0 = _mm256_setzero_ps();
+        __m256 sum1 = _mm256_setzero_ps();
+        int tap = 0;
+        for (; tap + 16 <= taps; tap += 16)
+        {
+            sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_loadu_ps(phase + tap), _mm256_loadu_ps(input + tap)));
+            sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_loadu_ps(phase + tap + 8), _mm256_loadu_ps(input + tap + 8)));
+        }
+
+        const __m256 sum256 = _mm256_add_ps(sum0, sum1);
+        __m128 sum = _mm_add_ps(_mm256_castps256_ps128(sum256), _mm256_extractf128_ps(sum256, 1));
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+        destination[sample * destinationStride] = dotProductScalar(phase + tap, input + tap, taps - tap, _mm_cvtss_f32(sum));
+    }
+}
+
+// advances 8 xorshift states and returns their triangular dither
+EDSP_SIMD_TARGET("avx2") inline __m256 ditherAvx2(__m256i& state) noexcept
+{
+    state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 13));
+    state = _mm256_xor_si256(state, _mm256_srli_epi32(state, 17));
+    state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 5));
+    const __m256i difference = _mm256_sub_epi32(_mm256_srli_epi32(state, 16), _mm256_and_si256(state, _mm256_set1_epi32(0xffff)));
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(difference), _mm256_set1_ps(1.0f / 65536.0f));
+}
+
+EDSP_SIMD_TARGET("avx2") inline void int16ToFloatAvx2(const std::int16_t* source, float* destination, int samples) noexcept
+{
+    const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+    {
+        const __m256i input = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)));
+        _mm256_storeu_ps(destination + i, _mm256_mul_ps(_mm256_cvtepi32_ps(input), scale));
+    }
+    int16ToFloatScalar(source + i, destination + i, samples - i);
+}
+
+EDSP_SIMD_TARGET("avx2") inline void floatToInt16Avx2(const float* source, std::int16_t* destination, int samples, std::uint32_t* ditherState) noexcept
+{
+    const __m256 scale = _mm256_set1_ps(32768.0f);
+    const __m256 minimum = _mm256_set1_ps(-32768.0f);
+    const __m256 maximum = _mm256_set1_ps(32767.0f);
+
+    __m256i state[2] = {};
+    if (ditherState != nullptr)
+        for (int k = 0; k < 2; ++k)
+            state[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ditherState + 8 * k));
+
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        __m256i result[2];
+        for (int k = 0; k < 2; ++k)
+        {
+            __m256 value = _mm256_mul_ps(_mm256_loadu_ps(source + i + 8 * k), scale);
+            if (ditherState != nullptr)
+                value = _mm256_add_ps(value, ditherAvx2(state[k]));
+            result[k] = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(value, minimum), maximum));
+        }
+        // packs works within 128 bit lanes, the permutation restores the sample order
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(result[0], result[1]), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), packed);
+    }
+
+    if (ditherState != nullptr)
+        for (int k = 0; k < 2; ++k)
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(ditherState + 8 * k), state[k]);
+    floatToInt16Scalar(source + i, destination + i, samples - i, ditherState);
+}
+
+EDSP_SIMD_TARGET("avx2") inline void int24ToFloatAvx2(const std::uint8_t* source, float* destination, int samples) noexcept
+{
+    // bytes 0-11 go to the lower lane and bytes 12-23 to the upper lane, every sample is moved to the upper 3 bytes of a 32 bit lane
+    const __m256i permutation = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+    const __m256i shuffle = _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+                                             -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    const __m256 scale = _mm256_set1_ps(1.0f / 8388608.0f);
+
+    // every iteration reads 32 bytes but only converts the first 24
+    int i = 0;
+    for (; i * 3 + 32 <= samples * 3; i += 8)
+    {
+        const __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + static_cast<std::size_t>(i) * 3));
+        const __m256i value = _mm256_srai_epi32(_mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(input, permutation), shuffle), 8);
+        _mm256_storeu_ps(destination + i, _mm256_mul_ps(_mm256_cvtepi32_ps(value), scale));
+    }
+    int24ToFloatScalar(source + static_cast<std::size_t>(i) * 3, destination + i, samples - i);
+}
+
+EDSP_SIMD_TARGET("avx2") inline void floatToInt24Avx2(const float* source, std::uint8_t* destination, int samples, std::uint32_t* ditherState) noexcept
+{
+    // packs the lower 3 bytes of every 32 bit lane into the first 12 bytes of each 128 bit lane and joins both lanes
+    const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                             0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    const __m256i permutation = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+    const __m256 scale = _mm256_set1_ps(8388608.0f);
+    const __m256 minimum = _mm256_set1_ps(-8388608.0f);
+    const __m256 maximum = _mm256_set1_ps(8388607.0f);
+
+    __m256i state[2] = {};
+    if (ditherState != nullptr)
+        for (int k = 0; k < 2; ++k)
+            state[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ditherState + 8 * k));
+
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        for (int k = 0; k < 2; ++k)
+        {
+            __m256 value = _mm256_mul_ps(_mm256_loadu_ps(source + i + 8 * k), scale);
+            if (ditherState != nullptr)
+                value = _mm256_add_ps(value, ditherAvx2(state[k]));
+            const __m256i result = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(value, minimum), maximum));
+            const __m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(result, shuffle), permutation);
+
+            std::uint8_t* bytes = destination + static_cast<std::size_t>(i + 8 * k) * 3;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), _mm256_castsi256_si128(packed));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(bytes + 16), _mm256_extracti128_si256(packed, 1));
+        }
+    }
+
+    if (ditherState != nullptr)
+        for (int k = 0; k < 2; ++k)
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(ditherState + 8 * k), state[k]);
+    floatToInt24Scalar(source + i, destination + static_cast<std::size_t>(i) * 3, samples - i, ditherState);
+}
+
+EDSP_SIMD_TARGET("avx2") inline void int32ToFloatAvx2(const std::int32_t* source, float* destination, int samples) noexcept
+{
+    const __m256 scale = _mm256_set1_ps(1.0f / 2147483648.0f);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+        _mm256_storeu_ps(destination + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i))), scale));
+    int32ToFloatScalar(source + i, destination + i, samples - i);
+}
+
+EDSP_SIMD_TARGET("avx2") inline void floatToInt32Avx2(const float* source, std::int32_t* destination, int samples) noexcept
+{
+    const __m256 scale = _mm256_set1_ps(2147483648.0f);
+    const __m256 minimum = _mm256_set1_ps(-2147483648.0f);
+    const __m256 maximum = _mm256_set1_ps(2147483520.0f);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+    {
+        const __m256 value = _mm256_mul_ps(_mm256_loadu_ps(source + i), scale);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(value, minimum), maximum)));
+    }
+    floatToInt32Scalar(source + i, destination + i, samples - i);
+}
+
+//
+// AVX-512
+//
+
+EDSP_SIMD_AVX512_BEGIN
+
+EDSP_SIMD_TARGET("avx512f") inline void addAvx512(const float* source, float* destination, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+        _mm512_storeu_ps(destination + i, _mm512_add_ps(_mm512_loadu_ps(destination + i), _mm512_loadu_ps(source + i)));
+    if (i < samples)
+    {
+        const __mmask16 mask = static_cast<__mmask16>((1u << (samples - i)) - 1u);
+        const __m512 sum = _mm512_add_ps(_mm512_maskz_loadu_ps(mask, destination + i), _mm512_maskz_loadu_ps(mask, source + i));
+        _mm512_mask_storeu_ps(destination + i, mask, sum);
+    }
+}
+
+EDSP_SIMD_TARGET("avx512f") inline void interleaveStereoAvx512(const float* left, const float* right, float* destination, int samples) noexcept
+{
+    const __m512i lowIndices = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+    const __m512i highIndices = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        const __m512 l = _mm512_loadu_ps(left + i);
+        const __m512 r = _mm512_loadu_ps(right + i);
+        _mm512_storeu_ps(destination + 2 * i, _mm512_permutex2var_ps(l, lowIndices, r));
+        _mm512_storeu_ps(destination + 2 * i + 16, _mm512_permutex2var_ps(l, highIndices, r));
+    }
+    interleaveStereoScalar(left + i, right + i, destination + 2 * i, samples - i);
+}
+
+EDSP_SIMD_TARGET("avx512f") inline void deinterleaveStereoAvx512(const float* source, float* left, float* right, int samples) noexcept
+{
+    const __m512i evenIndices = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+    const __m512i oddIndices = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        const __m512 a = _mm512_loadu_ps(source + 2 * i);
+        const __m512 b = _mm512_loadu_ps(source + 2 * i + 16);
+        _mm512_storeu_ps(left + i, _mm512_permutex2var_ps(a, evenIndices, b));
+        _mm512_storeu_ps(right + i, _mm512_permutex2var_ps(a, oddIndices, b));
+    }
+    deinterleaveStereoScalar(source + 2 * i, left + i, right + i, samples - i);
+}
+
+template <bool ACCUMULATE>
+EDSP_SIMD_TARGET("avx512f") inline void gainAvx512(const float* source, float* destination, int samples, float gain) noexcept
+{
+    const __m512 gainVector = _mm512_set1_ps(gain);
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        __m512 result = _mm512_mul_ps(_mm512_loadu_ps(source + i), gainVector);
+        if constexpr (ACCUMULATE)
+            result = _mm512_add_ps(_mm512_loadu_ps(destination + i), result);
+        _mm512_storeu_ps(destination + i, result);
+    }
+    gainScalar<ACCUMULATE>(source + i, destination + i, samples - i, gain);
+}
+
+template <bool ACCUMULATE>
+EDSP_SIMD_TARGET("avx512f") inline void gainRampAvx512(const float* source, float* destination, int samples, float startGain, float gainIncrement, int channels) noexcept
+{
+    // every lane tracks the frame and the channel of its sample, both are advanced by 16 samples per iteration
+    alignas(64) float laneFrames[16];
+    alignas(64) float laneChannels[16];
+    for (int lane = 0; lane < 16; ++lane)
+    {
+        laneFrames[lane] = static_cast<float>(lane / channels);
+        laneChannels[lane] = static_cast<float>(lane % channels);
+    }
+    __m512 frame = _mm512_load_ps(laneFrames);
+    __m512 channel = _mm512_load_ps(laneChannels);
+    const __m512 frameStep = _mm512_set1_ps(static_cast<float>(16 / channels));
+    const __m512 channelStep = _mm512_set1_ps(static_cast<float>(16 % channels));
+    const __m512 numChannels = _mm512_set1_ps(static_cast<float>(channels));
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 start = _mm512_set1_ps(startGain);
+    const __m512 increment = _mm512_set1_ps(gainIncrement);
+
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        const __m512 gain = _mm512_add_ps(start, _mm512_mul_ps(frame, increment));
+        __m512 result = _mm512_mul_ps(_mm512_loadu_ps(source + i), gain);
+        if constexpr (ACCUMULATE)
+            result = _mm512_add_ps(_mm512_loadu_ps(destination + i), result);
+        _mm512_storeu_ps(destination + i, result);
+
+        channel = _mm512_add_ps(channel, channelStep);
+        frame = _mm512_add_ps(frame, frameStep);
+        const __mmask16 wrapped = _mm512_cmp_ps_mask(channel, numChannels, _CMP_GE_OQ);
+        channel = _mm512_mask_sub_ps(channel, wrapped, channel, numChannels);
+        frame = _mm512_mask_add_ps(frame, wrapped, frame, one);
+    }
+    gainRampScalar<ACCUMULATE>(source + i, destination + i, samples - i, startGain, gainIncrement, channels, i);
+}
+
+EDSP_SIMD_TARGET("avx512f") inline float absMaxAvx512(const float* source, int samples) noexcept
+{
+    __m512 maximum = _mm512_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+        maximum = _mm512_max_ps(maximum, _mm512_abs_ps(_mm512_loadu_ps(source + i)));
+    return absMaxScalar(source + i, samples - i, _mm512_reduce_max_ps(maximum));
+}
+
+EDSP_SIMD_TARGET("avx512f") inline void absMaxAccumulateAvx512(const float* source, float* maxima, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+        _mm512_storeu_ps(maxima + i, _mm512_max_ps(_mm512_loadu_ps(maxima + i), _mm512_abs_ps(_mm512_loadu_ps(source + i))));
+    absMaxAccumulateScalar(source + i, maxima + i, samples - i);
+}
+
+EDSP_SIMD_TARGET("avx512f") inline void delayGainClampAvx512(float* buffer, float* delayLine, const float* gains, int samples, float limit, float makeupGain) noexcept
+{
+    const __m512 maximum = _mm512_set1_ps(limit);
+    const __m512 minimum = _mm512_set1_ps(-limit);
+    const __m512 makeup = _mm512_set1_ps(makeupGain);
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        const __m512 delayedSample = _mm512_loadu_ps(delayLine + i);
+        _mm512_storeu_ps(delayLine + i, _mm512_loadu_ps(buffer + i));
+        const __m512 value = _mm512_mul_ps(delayedSample, _mm512_loadu_ps(gains + i));
+        _mm512_storeu_ps(buffer + i, _mm512_mul_ps(_mm512_min_ps(_mm512_max_ps(value, minimum), maximum), makeup));
+    }
+    delayGainClampScalar(buffer + i, delayLine + i, gains + i, samples - i, limit, makeupGain);
+}
+
+EDSP_SIMD_TARGET("avx512f") inline float sumOfSquaresAvx512(const float* source, int samples) noexcept
+{
+    __m512 sum0 = _mm512_setzero_ps();
+    __m512 sum1 = _mm512_setzero_ps();
+    int i = 0;
+    for (; i + 32 <= samples; i += 32)
+    {
+        const __m512 a = _mm512_loadu_ps(source + i);
+        const __m512 b = _mm512_loadu_ps(source + i + 16);
+        sum0 = _mm512_add_ps(sum0, _mm512_mul_ps(a, a));
+        sum1 = _mm512_add_ps(sum1, _mm512_mul_ps(b, b));
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1)) + sumOfSquaresScalar(source + i, samples - i);
+}
+
+EDSP_SIMD_TARGET("avx512f") inline void polyphaseFilterAvx512(const float* source, const float* coefficients, const int* positions, const int* phases, int taps, float* destination, int destinationStride, int samples) noexcept
+{
+    for (int sample = 0; sample < samples; ++sample)
+    {
+        const float* input = source + positions[sample];
+        const float* phase = coefficients + static_cast<std::ptrdiff_t>(phases[sample]) * taps;
+        __m512 sum0 = _mm512_setzero_ps();
+        __m512 sum1 = _mm512_setzero_ps();
+        int tap = 0;
+        for (; tap + 32 <= taps; tap += 32)
+        {
+            sum0 = _mm512_add_ps(sum0, _mm512_mul_ps(_mm512_loadu_ps(phase + tap), _mm512_loadu_ps(input + tap)));
+            sum1 = _mm512_add_ps(sum1, _mm512_mul_ps(_mm512_loadu_ps(phase + tap + 16), _mm512_loadu_ps(input + tap + 16)));
+        }
+        if (tap + 16 <= taps)
+        {
+            sum0 = _mm512_add_ps(sum0, _mm512_mul_ps(_mm512_loadu_ps(phase + tap), _mm512_loadu_ps(input + tap)));
+            tap += 16;
+        }
+        destination[sample * destinationStride] = dotProductScalar(phase + tap, input + tap, taps - tap, _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1)));
+    }
+}
+
+// advances 16 xorshift states and returns their triangular dither
+EDSP_SIMD_TARGET("avx512f") inline __m512 ditherAvx512(__m512i& state) noexcept
+{
+    state = _mm512_xor_si512(state, _mm512_slli_epi32(state, 13));
+    state = _mm512_xor_si512(state, _mm512_srli_epi32(state, 17));
+    state = _mm512_xor_si512(state, _mm512_slli_epi32(state, 5));
+    const __m512i difference = _mm512_sub_epi32(_mm512_srli_epi32(state, 16), _mm512_and_si512(state, _mm512_set1_epi32(0xffff)));
+    return _mm512_mul_ps(_mm512_cvtepi32_ps(difference), _mm512_set1_ps(1.0f / 65536.0f));
+}
+
+EDSP_SIMD_TARGET("avx512f") inline void int16ToFloatAvx512(const std::int16_t* source, float* destination, int samples) noexcept
+{
+    const __m512 scale = _mm512_set1_ps(1.0f / 32768.0f);
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        const __m512i input = _mm512_cvtepi16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i)));
+        _mm512_storeu_ps(destination + i, _mm512_mul_ps(_mm512_cvtepi32_ps(input), scale));
+    }
+    int16ToFloatScalar(source + i, destination + i, samples - i);
+}
+
+EDSP_SIMD_TARGET("avx512f") inline void floatToInt16Avx512(const float* source, std::int16_t* destination, int samples, std::uint32_t* ditherState) noexcept
+{
+    const __m512 scale = _mm512_set1_ps(32768.0f);
+    const __m512 minimum = _mm512_set1_ps(-32768.0f);
+    const __m512 maximum = _mm512_set1_ps(32767.0f);
+
+    __m512i state = _mm512_setzero_si512();
+    if (ditherState != nullptr)
+        state = _mm512_loadu_si512(ditherState);
+
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        __m512 value = _mm512_mul_ps(_mm512_loadu_ps(source + i), scale);
+        if (ditherState != nullptr)
+            value = _mm512_add_ps(value, ditherAvx512(state));
+        const __m512i result = _mm512_cvtps_epi32(_mm512_min_ps(_mm512_max_ps(value, minimum), maximum));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm512_cvtsepi32_epi16(result));
+    }
+
+    if (ditherState != nullptr)
+        _mm512_storeu_si512(ditherState, state);
+    floatToInt16Scalar(source + i, destination + i, samples - i, ditherState);
+}
+
+EDSP_SIMD_TARGET("avx512f") inline void int32ToFloatAvx512(const std::int32_t* source, float* destination, int samples) noexcept
+{
+    const __m512 scale = _mm512_set1_ps(1.0f / 2147483648.0f);
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+        _mm512_storeu_ps(destination + i, _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_loadu_si512(source + i)), scale));
+    int32ToFloatScalar(source + i, destination + i, samples - i);
+}
+
+EDSP_SIMD_TARGET("avx512f") inline void floatToInt32Avx512(const float* source, std::int32_t* destination, int samples) noexcept
+{
+    const __m512 scale = _mm512_set1_ps(2147483648.0f);
+    const __m512 minimum = _mm512_set1_ps(-2147483648.0f);
+    const __m512 maximum = _mm512_set1_ps(2147483520.0f);
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        const __m512 value = _mm512_mul_ps(_mm512_loadu_ps(source + i), scale);
+        _mm512_storeu_si512(destination + i, _mm512_cvtps_epi32(_mm512_min_ps(_mm512_max_ps(value, minimum), maximum)));
+    }
+    floatToInt32Scalar(source + i, destination + i, samples - i);
+}
+
+EDSP_SIMD_AVX512_END
+
+#elif defined(EDSP_SIMD_NEON)
+
+//
+// NEON
+//
+
+inline void addNeon(const float* source, float* destination, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+        vst1q_f32(destination + i, vaddq_f32(vld1q_f32(destination + i), vld1q_f32(source + i)));
+    addScalar(source + i, destination + i, samples - i);
+}
+
+inline void interleaveStereoNeon(const float* left, const float* right, float* destination, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        float32x4x2_t frames;
+        frames.val[0] = vld1q_f32(left + i);
+        frames.val[1] = vld1q_f32(right + i);
+        vst2q_f32(destination + 2 * i, frames);
+    }
+    interleaveStereoScalar(left + i, right + i, destination + 2 * i, samples - i);
+}
+
+inline void deinterleaveStereoNeon(const float* source, float* left, float* right, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        const float32x4x2_t frames = vld2q_f32(source + 2 * i);
+        vst1q_f32(left + i, frames.val[0]);
+        vst1q_f32(right + i, frames.val[1]);
+    }
+    deinterleaveStereoScalar(source + 2 * i, left + i, right + i, samples - i);
+}
+
+// transposes 4 rows of 4 floats in place
+inline void transpose4x4Neon(float32x4_t& r0, float32x4_t& r1, float32x4_t& r2, float32x4_t& r3) noexcept
+{
+    const float32x4x2_t t01 = vtrnq_f32(r0, r1); // r0[0] r1[0] r0[2] r1[2] | r0[1] r1[1] r0[3] r1[3]
+    const float32x4x2_t t23 = vtrnq_f32(r2, r3);
+    r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+    r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+    r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+    r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+inline void interleave4Neon(const float* const* source, float* destination, int frameStride, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        float32x4_t c0 = vld1q_f32(source[0] + i);
+        float32x4_t c1 = vld1q_f32(source[1] + i);
+        float32x4_t c2 = vld1q_f32(source[2] + i);
+        float32x4_t c3 = vld1q_f32(source[3] + i);
+        transpose4x4Neon(c0, c1, c2, c3);
+        vst1q_f32(destination + i * frameStride, c0);
+        vst1q_f32(destination + (i + 1) * frameStride, c1);
+        vst1q_f32(destination + (i + 2) * frameStride, c2);
+        vst1q_f32(destination + (i + 3) * frameStride, c3);
+    }
+    const float* tail[4] = {source[0] + i, source[1] + i, source[2] + i, source[3] + i};
+    interleaveScalar(tail, destination + i * frameStride, 4, frameStride, samples - i);
+}
+
+inline void deinterleave4Neon(const float* source, float* const* destination, int frameStride, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        float32x4_t f0 = vld1q_f32(source + i * frameStride);
+        float32x4_t f1 = vld1q_f32(source + (i + 1) * frameStride);
+        float32x4_t f2 = vld1q_f32(source + (i + 2) * frameStride);
+        float32x4_t f3 = vld1q_f32(source + (i + 3) * frameStride);
+        transpose4x4Neon(f0, f1, f2, f3);
+        vst1q_f32(destination[0] + i, f0);
+        vst1q_f32(destination[1] + i, f1);
+        vst1q_f32(destination[2] + i, f2);
+        vst1q_f32(destination[3] + i, f3);
+    }
+    float* tail[4] = {destination[0] + i, destination[1] + i, destination[2] + i, destination[3] + i};
+    deinterleaveScalar(source + i * frameStride, tail, 4, frameStride, samples - i);
+}
+
+inline void interleave8Neon(const float* const* source, float* destination, int frameStride, int samples) noexcept
+{
+    interleave4Neon(source, destination, frameStride, samples);
+    interleave4Neon(source + 4, destination + 4, frameStride, samples);
+}
+
+inline void deinterleave8Neon(const float* source, float* const* destination, int frameStride, int samples) noexcept
+{
+    deinterleave4Neon(source, destination, frameStride, samples);
+    deinterleave4Neon(source + 4, destination + 4, frameStride, samples);
+}
+
+template <bool ACCUMULATE>
+inline void gainNeon(const float* source, float* destination, int samples, float gain) noexcept
+{
+    const float32x4_t gainVector = vdupq_n_f32(gain);
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        float32x4_t result = vmulq_f32(vld1q_f32(source + i), gainVector);
+        if constexpr (ACCUMULATE)
+            result = vaddq_f32(vld1q_f32(destination + i), result);
+        vst1q_f32(destination + i, result);
+    }
+    gainScalar<ACCUMULATE>(source + i, destination + i, samples - i, gain);
+}
+
+template <bool ACCUMULATE>
+inline void gainRampNeon(const float* source, float* destination, int samples, float startGain, float gainIncrement, int channels) noexcept
+{
+    // every lane tracks the frame and the channel of its sample, both are advanced by 4 samples per iteration
+    const float laneFrames[4] = {static_cast<float>(0 / channels), static_cast<float>(1 / channels), static_cast<float>(2 / channels), static_cast<float>(3 / channels)};
+    const float laneChannels[4] = {static_cast<float>(0 % channels), static_cast<float>(1 % channels), static_cast<float>(2 % channels), static_cast<float>(3 % channels)};
+    float32x4_t frame = vld1q_f32(laneFrames);
+    float32x4_t channel = vld1q_f32(laneChannels);
+    const float32x4_t frameStep = vdupq_n_f32(static_cast<float>(4 / channels));
+    const float32x4_t channelStep = vdupq_n_f32(static_cast<float>(4 % channels));
+    const float32x4_t numChannels = vdupq_n_f32(static_cast<float>(channels));
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t start = vdupq_n_f32(startGain);
+    const float32x4_t increment = vdupq_n_f32(gainIncrement);
+
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        const float32x4_t gain = vaddq_f32(start, vmulq_f32(frame, increment));
+        float32x4_t result = vmulq_f32(vld1q_f32(source + i), gain);
+        if constexpr (ACCUMULATE)
+            result = vaddq_f32(vld1q_f32(destination + i), result);
+        vst1q_f32(destination + i, result);
+
+        channel = vaddq_f32(channel, channelStep);
+        frame = vaddq_f32(frame, frameStep);
+        const uint32x4_t wrapped = vcgeq_f32(channel, numChannels);
+        channel = vsubq_f32(channel, vbslq_f32(wrapped, numChannels, zero));
+        frame = vaddq_f32(frame, vbslq_f32(wrapped, one, zero));
+    }
+    gainRampScalar<ACCUMULATE>(source + i, destination + i, samples - i, startGain, gainIncrement, channels, i);
+}
+
+inline float absMaxNeon(const float* source, int samples) noexcept
+{
+    float32x4_t maximum = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+        maximum = vmaxq_f32(maximum, vabsq_f32(vld1q_f32(source + i)));
+
+    float lanes[4];
+    vst1q_f32(lanes, maximum);
+    return absMaxScalar(source + i, samples - i, absMaxScalar(lanes, 4));
+}
+
+inline void absMaxAccumulateNeon(const float* source, float* maxima, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+        vst1q_f32(maxima + i, vmaxq_f32(vld1q_f32(maxima + i), vabsq_f32(vld1q_f32(source + i))));
+    absMaxAccumulateScalar(source + i, maxima + i, samples - i);
+}
+
+inline void delayGainClampNeon(float* buffer, float* delayLine, const float* gains, int samples, float limit, float makeupGain) noexcept
+{
+    const float32x4_t maximum = vdupq_n_f32(limit);
+    const float32x4_t minimum = vdupq_n_f32(-limit);
+    const float32x4_t makeup = vdupq_n_f32(makeupGain);
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        const float32x4_t delayedSample = vld1q_f32(delayLine + i);
+        vst1q_f32(delayLine + i, vld1q_f32(buffer + i));
+        const float32x4_t value = vmulq_f32(delayedSample, vld1q_f32(gains + i));
+        vst1q_f32(buffer + i, vmulq_f32(vminq_f32(vmaxq_f32(value, minimum), maximum), makeup));
+    }
+    delayGainClampScalar(buffer + i, delayLine + i, gains + i, samples - i, limit, makeupGain);
+}
+
+inline float sumOfSquaresNeon(const float* source, int samples) noexcept
+{
+    float32x4_t sum0 = vdupq_n_f32(0.0f);
+    float32x4_t sum1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+    {
+        const float32x4_t a = vld1q_f32(source + i);
+        const float32x4_t b = vld1q_f32(source + i + 4);
+        sum0 = vaddq_f32(sum0, vmulq_f32(a, a));
+        sum1 = vaddq_f32(sum1, vmulq_f32(b, b));
+    }
+
+    float lanes[4];
+    vst1q_f32(lanes, vaddq_f32(sum0, sum1));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sumOfSquaresScalar(source + i, samples - i);
+}
+
+inline void polyphaseFilterNeon(const float* source, const float* coefficients, const int* positions, const int* phases, int taps, float* destination, int destinationStride, int samples) noexcept
+{
+    for (int sample = 0; sample < samples; ++sample)
+    {
+        const float* input = source + positions[sample];
+        const float* phase = coefficients + static_cast<std::ptrdiff_t>(phases[sample]) * taps;
+        float32x4_t sum0 = vdupq_n_f32(0.0f);
+        float32x4_t sum1 = vdupq_n_f32(0.0f);
+        int tap = 0;
+        for (; tap + 8 <= taps; tap += 8)
+        {
+            sum0 = vaddq_f32(sum0, vmulq_f32(vld1q_f32(phase + tap), vld1q_f32(input + tap)));
+            sum1 = vaddq_f32(sum1, vmulq_f32(vld1q_f32(phase + tap + 4), vld1q_f32(input + tap + 4)));
+        }
+
+        float lanes[4];
+        vst1q_f32(lanes, vaddq_f32(sum0, sum1));
+        destination[sample * destinationStride] = dotProductScalar(phase + tap, input + tap, taps - tap, lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    }
+}
+
+
+inline void int16ToFloatNeon(const std::int16_t* source, float* destination, int samples) noexcept
+{
+    const float32x4_t scale = vdupq_n_f32(1.0f / 32768.0f);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+    {
+        const int16x8_t input = vld1q_s16(source + i);
+        vst1q_f32(destination + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(input))), scale));
+        vst1q_f32(destination + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(input))), scale));
+    }
+    int16ToFloatScalar(source + i, destination + i, samples - i);
+}
+
+inline void int32ToFloatNeon(const std::int32_t* source, float* destination, int samples) noexcept
+{
+    const float32x4_t scale = vdupq_n_f32(1.0f / 2147483648.0f);
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+        vst1q_f32(destination + i, vmulq_f32(vcvtq_f32_s32(vld1q_s32(source + i)), scale));
+    int32ToFloatScalar(source + i, destination + i, samples - i);
+}
+
+    // rounding to nearest (vcvtnq) requires ARMv8
+    #if defined(__aarch64__) || defined(_M_ARM64)
+        #define EDSP_SIMD_NEON_ROUNDING 1
+
+// advances 4 xorshift states and returns their triangular dither
+inline float32x4_t ditherNeon(uint32x4_t& state) noexcept
+{
+    state = veorq_u32(state, vshlq_n_u32(state, 13));
+    state = veorq_u32(state, vshrq_n_u32(state, 17));
+    state = veorq_u32(state, vshlq_n_u32(state, 5));
+    const int32x4_t difference = vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(state, 16)), vreinterpretq_s32_u32(vandq_u32(state, vdupq_n_u32(0xffff))));
+    return vmulq_f32(vcvtq_f32_s32(difference), vdupq_n_f32(1.0f / 65536.0f));
+}
+
+inline void floatToInt16Neon(const float* source, std::int16_t* destination, int samples, std::uint32_t* ditherState) noexcept
+{
+    const float32x4_t scale = vdupq_n_f32(32768.0f);
+    const float32x4_t minimum = vdupq_n_f32(-32768.0f);
+    const float32x4_t maximum = vdupq_n_f32(32767.0f);
+
+    uint32x4_t state[4] = {};
+    if (ditherState != nullptr)
+        for (int k = 0; k < 4; ++k)
+            state[k] = vld1q_u32(ditherState + 4 * k);
+
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        int32x4_t result[4];
+        for (int k = 0; k < 4; ++k)
+        {
+            float32x4_t value = vmulq_f32(vld1q_f32(source + i + 4 * k), scale);
+            if (ditherState != nullptr)
+                value = vaddq_f32(value, ditherNeon(state[k]));
+            result[k] = vcvtnq_s32_f32(vminq_f32(vmaxq_f32(value, minimum), maximum));
+        }
+        vst1q_s16(destination + i, vcombine_s16(vqmovn_s32(result[0]), vqmovn_s32(result[1])));
+        vst1q_s16(destination + i + 8, vcombine_s16(vqmovn_s32(result[2]), vqmovn_s32(result[3])));
+    }
+
+    if (ditherState != nullptr)
+        for (int k = 0; k < 4; ++k)
+            vst1q_u32(ditherState + 4 * k, state[k]);
+    floatToInt16Scalar(source + i, destination + i, samples - i, ditherState);
+}
+
+inline void floatToInt32Neon(const float* source, std::int32_t* destination, int samples) noexcept
+{
+    const float32x4_t scale = vdupq_n_f32(2147483648.0f);
+    const float32x4_t minimum = vdupq_n_f32(-2147483648.0f);
+    const float32x4_t maximum = vdupq_n_f32(2147483520.0f);
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        const float32x4_t value = vmulq_f32(vld1q_f32(source + i), scale);
+        vst1q_s32(destination + i, vcvtnq_s32_f32(vminq_f32(vmaxq_f32(value, minimum), maximum)));
+    }
+    floatToInt32Scalar(source + i, destination + i, samples - i);
+}
+    #endif
+
+#endif
+
+//
+// dispatchers
+//
+
+inline void add(const float* source, float* destination, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+            addAvx512(source, destination, samples);
+            return;
+        case SimdLevel::Avx2:
+            addAvx2(source, destination, samples);
+            return;
+        case SimdLevel::Sse2:
+            addSse2(source, destination, samples);
+            return;
+#elif defined(EDSP_SIMD_NEON)
+        case SimdLevel::Neon:
+            addNeon(source, destination, samples);
+            return;
+#endif
+        default:
+            addScalar(source, destination, samples);
+            return;
+    }
+}
+
+inline void interleaveStereo(const float* left, const float* right, float* destination, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+            interleaveStereoAvx512(left, right, destination, samples);
+            return;
+        case SimdLevel::Avx2:
+            interleaveStereoAvx2(left, right, destination, samples);
+            return;
+        case SimdLevel::Sse2:
+            interleaveStereoSse2(left, right, destination, samples);
+            return;
+#elif defined(EDSP_SIMD_NEON)
+        case SimdLevel::Neon:
+            interleaveStereoNeon(left, right, destination, samples);
+            return;
+#endif
+        default:
+            interleaveStereoScalar(left, right, destination, samples);
+            return;
+    }
+}
+
+inline void deinterleaveStereo(const float* source, float* left, float* right, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+            deinterleaveStereoAvx512(source, left, right, samples);
+            return;
+        case SimdLevel::Avx2:
+            deinterleaveStereoAvx2(source, left, right, samples);
+            return;
+        case SimdLevel::Sse2:
+            deinterleaveStereoSse2(source, left, right, samples);
+            return;
+#elif defined(EDSP_SIMD_NEON)
+        case SimdLevel::Neon:
+            deinterleaveStereoNeon(source, left, right, samples);
+            return;
+#endif
+        default:
+            deinterleaveStereoScalar(source, left, right, samples);
+            return;
+    }
+}
+
+// frameStride >= 4
+inline void interleave4(const float* const* source, float* destination, int frameStride, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+        case SimdLevel::Avx2:
+        case SimdLevel::Sse2:
+            interleave4Sse2(source, destination, frameStride, samples);
+            return;
+#elif defined(EDSP_SIMD_NEON)
+        case SimdLevel::Neon:
+            interleave4Neon(source, destination, frameStride, samples);
+            return;
+#endif
+        default:
+            interleaveScalar(source, destination, 4, frameStride, samples);
+            return;
+    }
+}
+
+// frameStride >= 4
+inline void deinterleave4(const float* source, float* const* destination, int frameStride, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+        case SimdLevel::Avx2:
+        case SimdLevel::Sse2:
+            deinterleave4Sse2(source, destination, frameStride, samples);
+            return;
+#elif defined(EDSP_SIMD_NEON)
+        case SimdLevel::Neon:
+            deinterleave4Neon(source, destination, frameStride, samples);
+            return;
+#endif
+        default:
+            deinterleaveScalar(source, destination, 4, frameStride, samples);
+            return;
+    }
+}
+
+inline void interleave6(const float* const* source, float* destination, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+        case SimdLevel::Avx2:
+        case SimdLevel::Sse2:
+            interleave6Sse2(source, destination, samples);
+            return;
+#endif
+        default:
+            interleaveScalar(source, destination, 6, 6, samples);
+            return;
+    }
+}
+
+inline void deinterleave6(const float* source, float* const* destination, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+        case SimdLevel::Avx2:
+        case SimdLevel::Sse2:
+            deinterleave6Sse2(source, destination, samples);
+            return;
+#endif
+        default:
+            deinterleaveScalar(source, destination, 6, 6, samples);
+            return;
+    }
+}
+
+// frameStride >= 8
+inline void interleave8(const float* const* source, float* destination, int frameStride, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+        case SimdLevel::Avx2:
+            interleave8Avx2(source, destination, frameStride, samples);
+            return;
+        case SimdLevel::Sse2:
+            interleave8Sse2(source, destination, frameStride, samples);
+            return;
+#elif defined(EDSP_SIMD_NEON)
+        case SimdLevel::Neon:
+            interleave8Neon(source, destination, frameStride, samples);
+            return;
+#endif
+        default:
+            interleaveScalar(source, destination, 8, frameStride, samples);
+            return;
+    }
+}
+
+// frameStride >= 8
+inline void deinterleave8(const float* source, float* const* destination, int frameStride, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+        case SimdLevel::Avx2:
+            deinterleave8Avx2(source, destination, frameStride, samples);
+            return;
+        case SimdLevel::Sse2:
+            deinterleave8Sse2(source, destination, frameStride, samples);
+            return;
+#elif defined(EDSP_SIMD_NEON)
+        case SimdLevel::Neon:
+            deinterleave8Neon(source, destination, frameStride, samples);
+            return;
+#endif
+        default:
+            deinterleaveScalar(source, destination, 8, frameStride, samples);
+            return;
+    }
+}
+
+// destination = source * gain, or destination += source * gain if ACCUMULATE is true, source may equal destination
+template <bool ACCUMULATE>
+inline void gain(const float* source, float* destination, int samples, float gain) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+            gainAvx512<ACCUMULATE>(source, destination, samples, gain);
+            return;
+        case SimdLevel::Avx2:
+            gainAvx2<ACCUMULATE>(source, destination, samples, gain);
+            return;
+        case SimdLevel::Sse2:
+            gainSse2<ACCUMULATE>(source, destination, samples, gain);
+            return;
+#elif defined(EDSP_SIMD_NEON)
+        case SimdLevel::Neon:
+            gainNeon<ACCUMULATE>(source, destination, samples, gain);
+            return;
+#endif
+        default:
+            gainScalar<ACCUMULATE>(source, destination, samples, gain);
+            return;
+    }
+}
+
+// like gain(), but the gain of frame n is startGain + n * gainIncrement
+// samples counts all samples of all channels, use channels = 1 for planar data
+template <bool ACCUMULATE>
+inline void gainRamp(const float* source, float* destination, int samples, float startGain, float gainIncrement, int channels) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+            gainRampAvx512<ACCUMULATE>(source, destination, samples, startGain, gainIncrement, channels);
+            return;
+        case SimdLevel::Avx2:
+            gainRampAvx2<ACCUMULATE>(source, destination, samples, startGain, gainIncrement, channels);
+            return;
+        case SimdLevel::Sse2:
+            gainRampSse2<ACCUMULATE>(source, destination, samples, startGain, gainIncrement, channels);
+            return;
+#elif defined(EDSP_SIMD_NEON)
+        case SimdLevel::Neon:
+            gainRampNeon<ACCUMULATE>(source, destination, samples, startGain, gainIncrement, channels);
+            return;
+#endif
+        default:
+            gainRampScalar<ACCUMULATE>(source, destination, samples, startGain, gainIncrement, channels);
+            return;
+    }
+}
+
+// maximum absolute value, exactly the same result for every instruction set
+inline float absMax(const float* source, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+            return absMaxAvx512(source, samples);
+        case SimdLevel::Avx2:
+            return absMaxAvx2(source, samples);
+        case SimdLevel::Sse2:
+            return absMaxSse2(source, samples);
+#elif defined(EDSP_SIMD_NEON)
+        case SimdLevel::Neon:
+            return absMaxNeon(source, samples);
+#endif
+        default:
+            return absMaxScalar(source, samples);
+    }
+}
+
+// maxima[i] = max(maxima[i], |source[i]|), exactly the same result for every instruction set
+inline void absMaxAccumulate(const float* source, float* maxima, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+            absMaxAccumulateAvx512(source, maxima, samples);
+            return;
+        case SimdLevel::Avx2:
+            absMaxAccumulateAvx2(source, maxima, samples);
+            return;
+        case SimdLevel::Sse2:
+            absMaxAccumulateSse2(source, maxima, samples);
+            return;
+#elif defined(EDSP_SIMD_NEON)
+        case SimdLevel::Neon:
+            absMaxAccumulateNeon(source, maxima, samples);
+            return;
+#endif
+        default:
+            absMaxAccumulateScalar(source, maxima, samples);
+            return;
+    }
+}
+
+// delay line and gain stage of LookAheadLimiter, exactly the same result for every instruction set
+inline void delayGainClamp(float* buffer, float* delayLine, const float* gains, int samples, float limit, float makeupGain) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+            delayGainClampAvx512(buffer, delayLine, gains, samples, limit, makeupGain);
+            return;
+        case SimdLevel::Avx2:
+            delayGainClampAvx2(buffer, delayLine, gains, samples, limit, makeupGain);
+            return;
+        case SimdLevel::Sse2:
+            delayGainClampSse2(buffer, delayLine, gains, samples, limit, makeupGain);
+            return;
+#elif defined(EDSP_SIMD_NEON)
+        case SimdLevel::Neon:
+            delayGainClampNeon(buffer, delayLine, gains, samples, limit, makeupGain);
+            return;
+#endif
+        default:
+            delayGainClampScalar(buffer, delayLine, gains, samples, limit, makeupGain);
+            return;
+    }
+}
+
+// the summation order depends on the instruction set, results may differ in the last bits
+inline float sumOfSquares(const float* source, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+            return sumOfSquaresAvx512(source, samples);
+        case SimdLevel::Avx2:
+            return sumOfSquaresAvx2(source, samples);
+        case SimdLevel::Sse2:
+            return sumOfSquaresSse2(source, samples);
+#elif defined(EDSP_SIMD_NEON)
+        case SimdLevel::Neon:
+            return sumOfSquaresNeon(source, samples);
+#endif
+        default:
+            return sumOfSquaresScalar(source, samples);
+    }
+}
+
+// polyphase FIR, destination[i * destinationStride] = sum of coefficients[phases[i] * taps + k] * source[positions[i] + k] for k in [0, taps)
+// the summation order depends on the instruction set, results may differ in the last bits
+inline void polyphaseFilter(const float* source, const float* coefficients, const int* positions, const int* phases, int taps, float* destination, int destinationStride, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+            polyphaseFilterAvx512(source, coefficients, positions, phases, taps, destination, destinationStride, samples);
+            return;
+        case SimdLevel::Avx2:
+            polyphaseFilterAvx2(source, coefficients, positions, phases, taps, destination, destinationStride, samples);
+            return;
+        case SimdLevel::Sse2:
+            polyphaseFilterSse2(source, coefficients, positions, phases, taps, destination, destinationStride, samples);
+            return;
+#elif defined(EDSP_SIMD_NEON)
+        case SimdLevel::Neon:
+            polyphaseFilterNeon(source, coefficients, positions, phases, taps, destination, destinationStride, samples);
+            return;
+#endif
+        default:
+            polyphaseFilterScalar(source, coefficients, positions, phases, taps, destination, destinationStride, samples);
+            return;
+    }
+}
+
+// integer to float conversion, exactly the same result for every instruction set
+inline void int16ToFloat(const std::int16_t* source, float* destination, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+            int16ToFloatAvx512(source, destination, samples);
+            return;
+        case SimdLevel::Avx2:
+            int16ToFloatAvx2(source, destination, samples);
+            return;
+        case SimdLevel::Sse2:
+            int16ToFloatSse2(source, destination, samples);
+            return;
+#elif defined(EDSP_SIMD_NEON)
+        case SimdLevel::Neon:
+            int16ToFloatNeon(source, destination, samples);
+            return;
+#endif
+        default:
+            int16ToFloatScalar(source, destination, samples);
+            return;
+    }
+}
+
+inline void int24ToFloat(const std::uint8_t* source, float* destination, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+        case SimdLevel::Avx2:
+            int24ToFloatAvx2(source, destination, samples);
+            return;
+#endif
+        default:
+            int24ToFloatScalar(source, destination, samples);
+            return;
+    }
+}
+
+inline void int32ToFloat(const std::int32_t* source, float* destination, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+            int32ToFloatAvx512(source, destination, samples);
+            return;
+        case SimdLevel::Avx2:
+            int32ToFloatAvx2(source, destination, samples);
+            return;
+        case SimdLevel::Sse2:
+            int32ToFloatSse2(source, destination, samples);
+            return;
+#elif defined(EDSP_SIMD_NEON)
+        case SimdLevel::Neon:
+            int32ToFloatNeon(source, destination, samples);
+            return;
+#endif
+        default:
+            int32ToFloatScalar(source, destination, samples);
+            return;
+    }
+}
+
+// float to integer conversion, ditherState is nullptr or points to ditherLanes states that are advanced by the call
+inline void floatToInt16(const float* source, std::int16_t* destination, int samples, std::uint32_t* ditherState) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+            floatToInt16Avx512(source, destination, samples, ditherState);
+            return;
+        case SimdLevel::Avx2:
+            floatToInt16Avx2(source, destination, samples, ditherState);
+            return;
+        case SimdLevel::Sse2:
+            floatToInt16Sse2(source, destination, samples, ditherState);
+            return;
+#elif defined(EDSP_SIMD_NEON_ROUNDING)
+        case SimdLevel::Neon:
+            floatToInt16Neon(source, destination, samples, ditherState);
+            return;
+#endif
+        default:
+            floatToInt16Scalar(source, destination, samples, ditherState);
+            return;
+    }
+}
+
+inline void floatToInt24(const float* source, std::uint8_t* destination, int samples, std::uint32_t* ditherState) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+        case SimdLevel::Avx2:
+            floatToInt24Avx2(source, destination, samples, ditherState);
+            return;
+#endif
+        default:
+            floatToInt24Scalar(source, destination, samples, ditherState);
+            return;
+    }
+}
+
+inline void floatToInt32(const float* source, std::int32_t* destination, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+            floatToInt32Avx512(source, destination, samples);
+            return;
+        case SimdLevel::Avx2:
+            floatToInt32Avx2(source, destination, samples);
+            return;
+        case SimdLevel::Sse2:
+            floatToInt32Sse2(source, destination, samples);
+            return;
+#elif defined(EDSP_SIMD_NEON_ROUNDING)
+        case SimdLevel::Neon:
+            floatToInt32Neon(source, destination, samples);
+            return;
+#endif
+        default:
+            floatToInt32Scalar(source, destination, samples);
+            return;
+    }
+}
+
+} // namespace simd
+
+#if defined(__clang__)
+    #pragma STDC FP_CONTRACT DEFAULT
+#elif defined(__GNUC__)
+    #pragma GCC pop_options
+#endif
+
+} // namespace edsp
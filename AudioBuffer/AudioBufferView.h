@@ -0,0 +1,204 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+namespace edsp
+{
+
+// non-owning view of planar audio data, e.g. host buffers or an AudioBuffer
+// use AudioBufferView<const SampleType> for read-only access
+template <typename SampleType>
+class AudioBufferView
+{
+public:
+    AudioBufferView() = default;
+
+    AudioBufferView(SampleType* const* channelPointers, int channels, int samples, int sampleOffset = 0) noexcept
+            : mChannelPointers(channelPointers), mChannels(channels), mSamples(samples), mSampleOffset(sampleOffset)
+    {
+        assert(channelPointers != nullptr);
+        assert(channels > 0 && samples > 0);
+        assert(sampleOffset >= 0);
+    }
+
+    // a mutable view converts to a read-only view
+    template <typename OtherSampleType, typename = std::enable_if_t<std::is_same_v<const OtherSampleType, SampleType>>>
+    AudioBufferView(const AudioBufferView<OtherSampleType>& other) noexcept
+            : mChannelPointers(other.getArrayOfChannelPointers()), mChannels(other.getNumChannels()), mSamples(other.getNumSamples()), mSampleOffset(other.getSampleOffset())
+    {
+    }
+
+    // view of the channels [firstChannel, firstChannel + channels)
+    AudioBufferView getSubView(int firstChannel, int channels) const noexcept
+    {
+        assert(firstChannel >= 0 && channels > 0);
+        assert(firstChannel + channels <= mChannels);
+        return {mChannelPointers + firstChannel, channels, mSamples, mSampleOffset};
+    }
+
+    // view of the samples [startSample, startSample + samples)
+    AudioBufferView getSubBlock(int startSample, int samples) const noexcept
+    {
+        assert(startSample >= 0 && samples > 0);
+        assert(startSample + samples <= mSamples);
+        return {mChannelPointers, mChannels, samples, mSampleOffset + startSample};
+    }
+
+    const SampleType* getReadPointer(int channel) const noexcept
+    {
+        assert(channel >= 0 && channel < mChannels);
+        return mChannelPointers[channel] + mSampleOffset;
+    }
+
+    SampleType* getWritePointer(int channel) const noexcept
+    {
+        assert(channel >= 0 && channel < mChannels);
+        return mChannelPointers[channel] + mSampleOffset;
+    }
+
+    SampleType getSample(int channel, int sample) const noexcept
+    {
+        assert(channel >= 0 && channel < mChannels);
+        assert(sample >= 0 && sample < mSamples);
+        return mChannelPointers[channel][mSampleOffset + sample];
+    }
+
+    void setSample(int channel, int sample, SampleType value) const noexcept
+    {
+        assert(channel >= 0 && channel < mChannels);
+        assert(sample >= 0 && sample < mSamples);
+        mChannelPointers[channel][mSampleOffset + sample] = value;
+    }
+
+    int getNumChannels() const noexcept
+    {
+        return mChannels;
+    }
+
+    int getNumSamples() const noexcept
+    {
+        return mSamples;
+    }
+
+    // the pointers in this array are not offset by getSampleOffset()
+    SampleType* const* getArrayOfChannelPointers() const noexcept
+    {
+        return mChannelPointers;
+    }
+
+    int getSampleOffset() const noexcept
+    {
+        return mSampleOffset;
+    }
+
+private:
+    SampleType* const* mChannelPointers = nullptr;
+    int mChannels = 0;
+    int mSamples = 0;
+    int mSampleOffset = 0;
+};
+
+// non-owning view of interleaved audio data, e.g. host buffers or an AudioBufferInterleaved
+// consecutive frames are getFrameStride() samples apart, which allows views of a subset of the channels
+// use AudioBufferInterleavedView<const SampleType> for read-only access
+template <typename SampleType>
+class AudioBufferInterleavedView
+{
+public:
+    AudioBufferInterleavedView() = default;
+
+    AudioBufferInterleavedView(SampleType* data, int channels, int samples) noexcept
+            : AudioBufferInterleavedView(data, channels, samples, channels)
+    {
+    }
+
+    AudioBufferInterleavedView(SampleType* data, int channels, int samples, int frameStride) noexcept
+            : mData(data), mChannels(channels), mSamples(samples), mFrameStride(frameStride)
+    {
+        assert(data != nullptr);
+        assert(channels > 0 && samples > 0);
+        assert(frameStride >= channels);
+    }
+
+    // a mutable view converts to a read-only view
+    template <typename OtherSampleType, typename = std::enable_if_t<std::is_same_v<const OtherSampleType, SampleType>>>
+    AudioBufferInterleavedView(const AudioBufferInterleavedView<OtherSampleType>& other) noexcept
+            : mData(other.getWritePointer()), mChannels(other.getNumChannels()), mSamples(other.getNumSamples()), mFrameStride(other.getFrameStride())
+    {
+    }
+
+    // view of the channels [firstChannel, firstChannel + channels)
+    AudioBufferInterleavedView getSubView(int firstChannel, int channels) const noexcept
+    {
+        assert(firstChannel >= 0 && channels > 0);
+        assert(firstChannel + channels <= mChannels);
+        return {mData + firstChannel, channels, mSamples, mFrameStride};
+    }
+
+    // view of the samples [startSample, startSample + samples)
+    AudioBufferInterleavedView getSubBlock(int startSample, int samples) const noexcept
+    {
+        assert(startSample >= 0 && samples > 0);
+        assert(startSample + samples <= mSamples);
+        return {mData + static_cast<std::ptrdiff_t>(startSample) * mFrameStride, mChannels, samples, mFrameStride};
+    }
+
+    // pointer to the first channel of the first frame
+    const SampleType* getReadPointer() const noexcept
+    {
+        return mData;
+    }
+
+    SampleType* getWritePointer() const noexcept
+    {
+        return mData;
+    }
+
+    SampleType getSample(int channel, int sample) const noexcept
+    {
+        assert(channel >= 0 && channel < mChannels);
+        assert(sample >= 0 && sample < mSamples);
+        return mData[static_cast<std::ptrdiff_t>(sample) * mFrameStride + channel];
+    }
+
+    void setSample(int channel, int sample, SampleType value) const noexcept
+    {
+        assert(channel >= 0 && channel < mChannels);
+        assert(sample >= 0 && sample < mSamples);
+        mData[static_cast<std::ptrdiff_t>(sample) * mFrameStride + channel] = value;
+    }
+
+    int getNumChannels() const noexcept
+    {
+        return mChannels;
+    }
+
+    int getNumSamples() const noexcept
+    {
+        return mSamples;
+    }
+
+    int getFrameStride() const noexcept
+    {
+        return mFrameStride;
+    }
+
+    // true if the frames are packed without gaps
+    bool isContiguous() const noexcept
+    {
+        return mFrameStride == mChannels;
+    }
+
+private:
+    SampleType* mData = nullptr;
+    int mChannels = 0;
+    int mSamples = 0;
+    int mFrameStride = 0;
+};
+
+} // namespace edsp
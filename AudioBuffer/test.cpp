@@ -0,0 +1,1529 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#include "AudioBuffer.h"
+#include "AudioBufferConversion.h"
+#include "AudioBufferGain.h"
+#include "AudioBufferHelpers.h"
+#include "AudioBufferInterleaved.h"
+#include "AudioBufferSimd.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+static bool check(bool condition, const std::string& message)
+{
+    if (!condition)
+        std::cout << "  failed: " << message << "\n";
+    return condition;
+}
+
+// bitwise, so -0 and 0 differ and NaN equals NaN
+template <typename T>
+static bool isSame(const std::vector<T>& a, const std::vector<T>& b)
+{
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+// lengths around the vector widths of all instruction sets, the kernels are called with unaligned pointers as well
+static const int testLengths[] = {0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 47, 63, 64, 65, 100, 127, 128, 129, 1000, 1027};
+
+static std::vector<float> getRandomSamples(int samples, float range, unsigned int seed)
+{
+    std::mt19937 random{seed};
+    std::uniform_real_distribution<float> distribution{-range, range};
+    std::vector<float> result(static_cast<std::size_t>(samples));
+    for (float& sample : result)
+        sample = distribution(random);
+    return result;
+}
+
+//
+// SIMD kernels
+//
+
+// the kernels of one instruction set, nullptr where the dispatcher uses the kernel of a lower instruction set
+struct Kernels
+{
+    std::string name;
+    void (*add)(const float*, float*, int) = nullptr;
+    void (*interleaveStereo)(const float*, const float*, float*, int) = nullptr;
+    void (*deinterleaveStereo)(const float*, float*, float*, int) = nullptr;
+    void (*interleave4)(const float* const*, float*, int, int) = nullptr;
+    void (*deinterleave4)(const float*, float* const*, int, int) = nullptr;
+    void (*interleave6)(const float* const*, float*, int) = nullptr;
+    void (*deinterleave6)(const float*, float* const*, int) = nullptr;
+    void (*interleave8)(const float* const*, float*, int, int) = nullptr;
+    void (*deinterleave8)(const float*, float* const*, int, int) = nullptr;
+    void (*gain)(const float*, float*, int, float) = nullptr;
+    void (*gainAccumulate)(const float*, float*, int, float) = nullptr;
+    void (*gainRamp)(const float*, float*, int, float, float, int) = nullptr;
+    void (*gainRampAccumulate)(const float*, float*, int, float, float, int) = nullptr;
+    float (*absMax)(const float*, int) = nullptr;
+    void (*absMaxAccumulate)(const float*, float*, int) = nullptr;
+    void (*delayGainClamp)(float*, float*, const float*, int, float, float) = nullptr;
+    float (*sumOfSquares)(const float*, int) = nullptr;
+    void (*polyphaseFilter)(const float*, const float*, const int*, const int*, int, float*, int, int) = nullptr;
+    void (*int16ToFloat)(const std::int16_t*, float*, int) = nullptr;
+    void (*floatToInt16)(const float*, std::int16_t*, int, std::uint32_t*) = nullptr;
+    void (*int24ToFloat)(const std::uint8_t*, float*, int) = nullptr;
+    void (*floatToInt24)(const float*, std::uint8_t*, int, std::uint32_t*) = nullptr;
+    void (*int32ToFloat)(const std::int32_t*, float*, int) = nullptr;
+    void (*floatToInt32)(const float*, std::int32_t*, int) = nullptr;
+};
+
+static Kernels getScalarKernels()
+{
+    using namespace edsp::simd;
+    Kernels kernels;
+    kernels.name = "scalar";
+    kernels.add = addScalar;
+    kernels.interleaveStereo = interleaveStereoScalar;
+    kernels.deinterleaveStereo = deinterleaveStereoScalar;
+    kernels.interleave4 = [](const float* const* source, float* destination, int frameStride, int samples) { interleaveScalar(source, destination, 4, frameStride, samples); };
+    kernels.deinterleave4 = [](const float* source, float* const* destination, int frameStride, int samples) { deinterleaveScalar(source, destination, 4, frameStride, samples); };
+    kernels.interleave6 = [](const float* const* source, float* destination, int samples) { interleaveScalar(source, destination, 6, 6, samples); };
+    kernels.deinterleave6 = [](const float* source, float* const* destination, int samples) { deinterleaveScalar(source, destination, 6, 6, samples); };
+    kernels.interleave8 = [](const float* const* source, float* destination, int frameStride, int samples) { interleaveScalar(source, destination, 8, frameStride, samples); };
+    kernels.deinterleave8 = [](const float* source, float* const* destination, int frameStride, int samples) { deinterleaveScalar(source, destination, 8, frameStride, samples); };
+    kernels.gain = gainScalar<false>;
+    kernels.gainAccumulate = gainScalar<true>;
+    kernels.gainRamp = [](const float* source, float* destination, int samples, float startGain, float gainIncrement, int channels) { gainRampScalar<false>(source, destination, samples, startGain, gainIncrement, channels); };
+    kernels.gainRampAccumulate = [](const float* source, float* destination, int samples, float startGain, float gainIncrement, int channels) { gainRampScalar<true>(source, destination, samples, startGain, gainIncrement, channels); };
+    kernels.absMax = [](const float* source, int samples) { return absMaxScalar(source, samples); };
+    kernels.absMaxAccumulate = absMaxAccumulateScalar;
+    kernels.delayGainClamp = delayGainClampScalar;
+    kernels.sumOfSquares = sumOfSquaresScalar;
+    kernels.polyphaseFilter = polyphaseFilterScalar;
+    kernels.int16ToFloat = int16ToFloatScalar;
+    kernels.floatToInt16 = floatToInt16Scalar;
+    kernels.int24ToFloat = int24ToFloatScalar;
+    kernels.floatToInt24 = floatToInt24Scalar;
+    kernels.int32ToFloat = int32ToFloatScalar;
+    kernels.floatToInt32 = floatToInt32Scalar;
+    return kernels;
+}
+
+// the public kernels, which dispatch to the instruction set detected at runtime
+static Kernels getDispatchedKernels()
+{
+    using namespace edsp::simd;
+    Kernels kernels;
+    kernels.name = "dispatched";
+    kernels.add = add;
+    kernels.interleaveStereo = interleaveStereo;
+    kernels.deinterleaveStereo = deinterleaveStereo;
+    kernels.interleave4 = interleave4;
+    kernels.deinterleave4 = deinterleave4;
+    kernels.interleave6 = interleave6;
+    kernels.deinterleave6 = deinterleave6;
+    kernels.interleave8 = interleave8;
+    kernels.deinterleave8 = deinterleave8;
+    kernels.gain = gain<false>;
+    kernels.gainAccumulate = gain<true>;
+    kernels.gainRamp = gainRamp<false>;
+    kernels.gainRampAccumulate = gainRamp<true>;
+    kernels.absMax = absMax;
+    kernels.absMaxAccumulate = absMaxAccumulate;
+    kernels.delayGainClamp = delayGainClamp;
+    kernels.sumOfSquares = sumOfSquares;
+    kernels.polyphaseFilter = polyphaseFilter;
+    kernels.int16ToFloat = int16ToFloat;
+    kernels.floatToInt16 = floatToInt16;
+    kernels.int24ToFloat = int24ToFloat;
+    kernels.floatToInt24 = floatToInt24;
+    kernels.int32ToFloat = int32ToFloat;
+    kernels.floatToInt32 = floatToInt32;
+    return kernels;
+}
+
+// the kernels of every instruction set the CPU supports, and the dispatched ones
+static std::vector<Kernels> getTestedKernels()
+{
+    using namespace edsp::simd;
+    using edsp::SimdLevel;
+    std::vector<Kernels> result;
+    const SimdLevel supported = edsp::detectSimdLevel();
+#if defined(EDSP_SIMD_X86)
+    if (supported >= SimdLevel::Sse2)
+    {
+        Kernels kernels;
+        kernels.name = "SSE2";
+        kernels.add = addSse2;
+        kernels.interleaveStereo = interleaveStereoSse2;
+        kernels.deinterleaveStereo = deinterleaveStereoSse2;
+        kernels.interleave4 = interleave4Sse2;
+        kernels.deinterleave4 = deinterleave4Sse2;
+        kernels.interleave6 = interleave6Sse2;
+        kernels.deinterleave6 = deinterleave6Sse2;
+        kernels.interleave8 = interleave8Sse2;
+        kernels.deinterleave8 = deinterleave8Sse2;
+        kernels.gain = gainSse2<false>;
+        kernels.gainAccumulate = gainSse2<true>;
+        kernels.gainRamp = gainRampSse2<false>;
+        kernels.gainRampAccumulate = gainRampSse2<true>;
+        kernels.absMax = absMaxSse2;
+        kernels.absMaxAccumulate = absMaxAccumulateSse2;
+        kernels.delayGainClamp = delayGainClampSse2;
+        kernels.sumOfSquares = sumOfSquaresSse2;
+        kernels.polyphaseFilter = polyphaseFilterSse2;
+        kernels.int16ToFloat = int16ToFloatSse2;
+        kernels.floatToInt16 = floatToInt16Sse2;
+        kernels.int32ToFloat = int32ToFloatSse2;
+        kernels.floatToInt32 = floatToInt32Sse2;
+        result.push_back(kernels);
+    }
+    if (supported >= SimdLevel::Avx2)
+    {
+        Kernels kernels;
+        kernels.name = "AVX2";
+        kernels.add = addAvx2;
+        kernels.interleaveStereo = interleaveStereoAvx2;
+        kernels.deinterleaveStereo = deinterleaveStereoAvx2;
+        kernels.interleave8 = interleave8Avx2;
+        kernels.deinterleave8 = deinterleave8Avx2;
+        kernels.gain = gainAvx2<false>;
+        kernels.gainAccumulate = gainAvx2<true>;
+        kernels.gainRamp = gainRampAvx2<false>;
+        kernels.gainRampAccumulate = gainRampAvx2<true>;
+        kernels.absMax = absMaxAvx2;
+        kernels.absMaxAccumulate = absMaxAccumulateAvx2;
+        kernels.delayGainClamp = delayGainClampAvx2;
+        kernels.sumOfSquares = sumOfSquaresAvx2;
+        kernels.polyphaseFilter = polyphaseFilterAvx2;
+        kernels.int16ToFloat = int16ToFloatAvx2;
+        kernels.floatToInt16 = floatToInt16Avx2;
+        kernels.int24ToFloat = int24ToFloatAvx2;
+        kernels.floatToInt24 = floatToInt24Avx2;
+        kernels.int32ToFloat = int32ToFloatAvx2;
+        kernels.floatToInt32 = floatToInt32Avx2;
+        result.push_back(kernels);
+    }
+    if (supported >= SimdLevel::Avx512)
+    {
+        Kernels kernels;
+        kernels.name = "AVX-512";
+        kernels.add = addAvx512;
+        kernels.interleaveStereo = interleaveStereoAvx512;
+        kernels.deinterleaveStereo = deinterleaveStereoAvx512;
+        kernels.gain = gainAvx512<false>;
+        kernels.gainAccumulate = gainAvx512<true>;
+        kernels.gainRamp = gainRampAvx512<false>;
+        kernels.gainRampAccumulate = gainRampAvx512<true>;
+        kernels.absMax = absMaxAvx512;
+        kernels.absMaxAccumulate = absMaxAccumulateAvx512;
+        kernels.delayGainClamp = delayGainClampAvx512;
+        kernels.sumOfSquares = sumOfSquaresAvx512;
+        kernels.polyphaseFilter = polyphaseFilterAvx512;
+        kernels.int16ToFloat = int16ToFloatAvx512;
+        kernels.floatToInt16 = floatToInt16Avx512;
+        kernels.int32ToFloat = int32ToFloatAvx512;
+        kernels.floatToInt32 = floatToInt32Avx512;
+        result.push_back(kernels);
+    }
+#elif defined(EDSP_SIMD_NEON)
+    if (supported == SimdLevel::Neon)
+    {
+        Kernels kernels;
+        kernels.name = "NEON";
+        kernels.add = addNeon;
+        kernels.interleaveStereo = interleaveStereoNeon;
+        kernels.deinterleaveStereo = deinterleaveStereoNeon;
+        kernels.interleave4 = interleave4Neon;
+        kernels.deinterleave4 = deinterleave4Neon;
+        kernels.interleave8 = interleave8Neon;
+        kernels.deinterleave8 = deinterleave8Neon;
+        kernels.gain = gainNeon<false>;
+        kernels.gainAccumulate = gainNeon<true>;
+        kernels.gainRamp = gainRampNeon<false>;
+        kernels.gainRampAccumulate = gainRampNeon<true>;
+        kernels.absMax = absMaxNeon;
+        kernels.absMaxAccumulate = absMaxAccumulateNeon;
+        kernels.delayGainClamp = delayGainClampNeon;
+        kernels.sumOfSquares = sumOfSquaresNeon;
+        kernels.polyphaseFilter = polyphaseFilterNeon;
+        kernels.int16ToFloat = int16ToFloatNeon;
+        kernels.floatToInt16 = floatToInt16Neon;
+        kernels.int32ToFloat = int32ToFloatNeon;
+        kernels.floatToInt32 = floatToInt32Neon;
+        result.push_back(kernels);
+    }
+#endif
+    (void) supported;
+    result.push_back(getDispatchedKernels());
+    return result;
+}
+
+// names the kernel, the instruction set and the length in the message
+static bool checkKernel(bool same, const char* kernel, const Kernels& kernels, int samples)
+{
+    return check(same, std::string{kernel} + " (" + kernels.name + ", " + std::to_string(samples) + " samples) matches the scalar kernel");
+}
+
+static bool testSimdDispatch()
+{
+    bool passed = check(edsp::getSimdLevel() == edsp::detectSimdLevel(), "the dispatcher uses the detected instruction set");
+#if defined(EDSP_DISABLE_SIMD)
+    passed &= check(edsp::getSimdLevel() == edsp::SimdLevel::Scalar, "EDSP_DISABLE_SIMD selects the scalar kernels");
+#endif
+    std::cout << "  instruction sets:";
+    for (const Kernels& kernels : getTestedKernels())
+        std::cout << " " << kernels.name;
+    std::cout << "\n";
+    return passed;
+}
+
+// add, gain, gain ramps, peaks and the limiter output stage, the SIMD kernels must be bit-exact
+static bool testSimdArithmetic()
+{
+    const Kernels scalar = getScalarKernels();
+    bool passed = true;
+    for (const Kernels& kernels : getTestedKernels())
+    {
+        for (const int samples : testLengths)
+        {
+            for (const int offset : {0, 1})
+            {
+                const auto source = getRandomSamples(samples + offset, 2.0f, static_cast<unsigned int>(samples));
+                const auto initial = getRandomSamples(samples + offset, 1.0f, static_cast<unsigned int>(samples) + 1000);
+                const float* input = source.data() + offset;
+
+                auto run = [&](auto kernel, const Kernels& k)
+                {
+                    auto output = initial;
+                    kernel(k, input, output.data() + offset);
+                    return output;
+                };
+                auto compare = [&](const char* name, auto kernel)
+                {
+                    passed &= checkKernel(isSame(run(kernel, scalar), run(kernel, kernels)), name, kernels, samples);
+                };
+
+                if (kernels.add != nullptr)
+                    compare("add", [&](const Kernels& k, const float* in, float* out) { k.add(in, out, samples); });
+                if (kernels.gain != nullptr)
+                    compare("gain", [&](const Kernels& k, const float* in, float* out) { k.gain(in, out, samples, 0.7f); });
+                if (kernels.gainAccumulate != nullptr)
+                    compare("gain accumulate", [&](const Kernels& k, const float* in, float* out) { k.gainAccumulate(in, out, samples, -1.3f); });
+                for (const int channels : {1, 2, 3, 5, 6, 8, 11})
+                {
+                    // gain ramps over the block, the product of frame and increment is rounded before the addition
+                    if (kernels.gainRamp != nullptr)
+                        compare("gain ramp", [&](const Kernels& k, const float* in, float* out) { k.gainRamp(in, out, samples, 0.1f, 0.0123f, channels); });
+                    if (kernels.gainRampAccumulate != nullptr)
+                        compare("gain ramp accumulate", [&](const Kernels& k, const float* in, float* out) { k.gainRampAccumulate(in, out, samples, 1.0f, -0.00037f, channels); });
+                }
+                if (kernels.absMaxAccumulate != nullptr)
+                    compare("absMaxAccumulate", [&](const Kernels& k, const float* in, float* out) { k.absMaxAccumulate(in, out, samples); });
+                if (kernels.absMax != nullptr)
+                {
+                    const float reference = scalar.absMax(input, samples);
+                    const float result = kernels.absMax(input, samples);
+                    passed &= checkKernel(std::memcmp(&reference, &result, sizeof(float)) == 0, "absMax", kernels, samples);
+                }
+                if (kernels.delayGainClamp != nullptr)
+                {
+                    const auto gains = getRandomSamples(samples, 1.5f, static_cast<unsigned int>(samples) + 2000);
+                    auto runDelay = [&](const Kernels& k)
+                    {
+                        std::vector<float> buffer(input, input + samples);
+                        std::vector<float> delayLine(initial.begin() + offset, initial.end());
+                        k.delayGainClamp(buffer.data(), delayLine.data(), gains.data(), samples, 0.8f, 1.1f);
+                        buffer.insert(buffer.end(), delayLine.begin(), delayLine.end());
+                        return buffer;
+                    };
+                    passed &= checkKernel(isSame(runDelay(scalar), runDelay(kernels)), "delayGainClamp", kernels, samples);
+                }
+            }
+        }
+    }
+    return passed;
+}
+
+// all interleaving kernels, the frame stride of the 4 and 8 channel kernels can be larger than the channel count
+static bool testSimdInterleave()
+{
+    const Kernels scalar = getScalarKernels();
+    bool passed = true;
+    for (const Kernels& kernels : getTestedKernels())
+    {
+        for (const int samples : testLengths)
+        {
+            const auto planar = getRandomSamples(samples * 8 + 1, 1.0f, static_cast<unsigned int>(samples));
+            const auto interleaved = getRandomSamples(samples * 10 + 1, 1.0f, static_cast<unsigned int>(samples) + 1000);
+            const float* channels[8];
+            for (int channel = 0; channel < 8; ++channel)
+                channels[channel] = planar.data() + 1 + channel * samples;
+
+            auto interleave = [&](auto kernel, const Kernels& k)
+            {
+                std::vector<float> output(interleaved.size());
+                kernel(k, output.data() + 1);
+                return output;
+            };
+            auto deinterleave = [&](auto kernel, const Kernels& k)
+            {
+                std::vector<float> output(planar.size());
+                float* destination[8];
+                for (int channel = 0; channel < 8; ++channel)
+                    destination[channel] = output.data() + 1 + channel * samples;
+                kernel(k, interleaved.data() + 1, destination);
+                return output;
+            };
+
+            if (kernels.interleaveStereo != nullptr)
+            {
+                auto kernel = [&](const Kernels& k, float* out) { k.interleaveStereo(channels[0], channels[1], out, samples); };
+                passed &= checkKernel(isSame(interleave(kernel, scalar), interleave(kernel, kernels)), "interleaveStereo", kernels, samples);
+            }
+            if (kernels.deinterleaveStereo != nullptr)
+            {
+                auto kernel = [&](const Kernels& k, const float* in, float* const* out) { k.deinterleaveStereo(in, out[0], out[1], samples); };
+                passed &= checkKernel(isSame(deinterleave(kernel, scalar), deinterleave(kernel, kernels)), "deinterleaveStereo", kernels, samples);
+            }
+            if (kernels.interleave6 != nullptr)
+            {
+                auto kernel = [&](const Kernels& k, float* out) { k.interleave6(channels, out, samples); };
+                passed &= checkKernel(isSame(interleave(kernel, scalar), interleave(kernel, kernels)), "interleave6", kernels, samples);
+            }
+            if (kernels.deinterleave6 != nullptr)
+            {
+                auto kernel = [&](const Kernels& k, const float* in, float* const* out) { k.deinterleave6(in, out, samples); };
+                passed &= checkKernel(isSame(deinterleave(kernel, scalar), deinterleave(kernel, kernels)), "deinterleave6", kernels, samples);
+            }
+            for (const int extraStride : {0, 2})
+            {
+                if (kernels.interleave4 != nullptr)
+                {
+                    auto kernel = [&](const Kernels& k, float* out) { k.interleave4(channels, out, 4 + extraStride, samples); };
+                    passed &= checkKernel(isSame(interleave(kernel, scalar), interleave(kernel, kernels)), "interleave4", kernels, samples);
+                }
+                if (kernels.deinterleave4 != nullptr)
+                {
+                    auto kernel = [&](const Kernels& k, const float* in, float* const* out) { k.deinterleave4(in, out, 4 + extraStride, samples); };
+                    passed &= checkKernel(isSame(deinterleave(kernel, scalar), deinterleave(kernel, kernels)), "deinterleave4", kernels, samples);
+                }
+                if (kernels.interleave8 != nullptr)
+                {
+                    auto kernel = [&](const Kernels& k, float* out) { k.interleave8(channels, out, 8 + extraStride, samples); };
+                    passed &= checkKernel(isSame(interleave(kernel, scalar), interleave(kernel, kernels)), "interleave8", kernels, samples);
+                }
+                if (kernels.deinterleave8 != nullptr)
+                {
+                    auto kernel = [&](const Kernels& k, const float* in, float* const* out) { k.deinterleave8(in, out, 8 + extraStride, samples); };
+                    passed &= checkKernel(isSame(deinterleave(kernel, scalar), deinterleave(kernel, kernels)), "deinterleave8", kernels, samples);
+                }
+            }
+        }
+    }
+    return passed;
+}
+
+// integer conversions with and without dither, the input covers the clipping range, ±1, the largest values and NaN
+static bool testSimdConversion()
+{
+    const Kernels scalar = getScalarKernels();
+    bool passed = true;
+    for (const Kernels& kernels : getTestedKernels())
+    {
+        for (const int samples : testLengths)
+        {
+            auto source = getRandomSamples(samples, 1.2f, static_cast<unsigned int>(samples));
+            const float special[] = {1.0f, -1.0f, 0.0f, -0.0f, 0.99999994f, -0.99999994f, 1.0e-9f, 4.0f, std::numeric_limits<float>::quiet_NaN()};
+            for (std::size_t i = 0; i < source.size(); i += 3)
+                source[i] = special[(i / 3) % std::size(special)];
+
+            std::mt19937 random{static_cast<unsigned int>(samples)};
+            std::vector<std::int16_t> int16(static_cast<std::size_t>(samples));
+            std::vector<std::int32_t> int32(static_cast<std::size_t>(samples));
+            std::vector<std::uint8_t> int24(static_cast<std::size_t>(samples) * 3);
+            for (auto& value : int16)
+                value = static_cast<std::int16_t>(random());
+            for (auto& value : int32)
+                value = static_cast<std::int32_t>(random());
+            for (auto& value : int24)
+                value = static_cast<std::uint8_t>(random());
+            if (samples > 1)
+            {
+                int16[0] = std::numeric_limits<std::int16_t>::min();
+                int16[1] = std::numeric_limits<std::int16_t>::max();
+                int32[0] = std::numeric_limits<std::int32_t>::min();
+                int32[1] = std::numeric_limits<std::int32_t>::max();
+            }
+
+            auto toFloat = [&](auto kernel, const Kernels& k)
+            {
+                std::vector<float> output(static_cast<std::size_t>(samples));
+                kernel(k, output.data());
+                return output;
+            };
+            if (kernels.int16ToFloat != nullptr)
+            {
+                auto kernel = [&](const Kernels& k, float* out) { k.int16ToFloat(int16.data(), out, samples); };
+                passed &= checkKernel(isSame(toFloat(kernel, scalar), toFloat(kernel, kernels)), "int16ToFloat", kernels, samples);
+            }
+            if (kernels.int24ToFloat != nullptr)
+            {
+                auto kernel = [&](const Kernels& k, float* out) { k.int24ToFloat(int24.data(), out, samples); };
+                passed &= checkKernel(isSame(toFloat(kernel, scalar), toFloat(kernel, kernels)), "int24ToFloat", kernels, samples);
+            }
+            if (kernels.int32ToFloat != nullptr)
+            {
+                auto kernel = [&](const Kernels& k, float* out) { k.int32ToFloat(int32.data(), out, samples); };
+                passed &= checkKernel(isSame(toFloat(kernel, scalar), toFloat(kernel, kernels)), "int32ToFloat", kernels, samples);
+            }
+            if (kernels.floatToInt32 != nullptr)
+            {
+                auto run = [&](const Kernels& k)
+                {
+                    std::vector<std::int32_t> output(static_cast<std::size_t>(samples));
+                    k.floatToInt32(source.data(), output.data(), samples);
+                    return output;
+                };
+                passed &= checkKernel(isSame(run(scalar), run(kernels)), "floatToInt32", kernels, samples);
+            }
+
+            // the dither states have to be advanced identically as well
+            for (const bool dither : {false, true})
+            {
+                auto runDithered = [&](auto kernel, auto outputType, const Kernels& k, std::vector<std::uint32_t>& state)
+                {
+                    std::vector<decltype(outputType)> output(static_cast<std::size_t>(samples) * (sizeof(outputType) == 1 ? 3 : 1));
+                    state.assign(edsp::simd::ditherLanes, 0);
+                    for (int lane = 0; lane < edsp::simd::ditherLanes; ++lane)
+                        state[static_cast<std::size_t>(lane)] = 0x9e3779b9u * static_cast<std::uint32_t>(lane + 1);
+                    kernel(k, output.data(), dither ? state.data() : nullptr);
+                    return output;
+                };
+                std::vector<std::uint32_t> scalarState;
+                std::vector<std::uint32_t> kernelState;
+                const std::string name = dither ? " with dither" : "";
+                if (kernels.floatToInt16 != nullptr)
+                {
+                    auto kernel = [&](const Kernels& k, std::int16_t* out, std::uint32_t* state) { k.floatToInt16(source.data(), out, samples, state); };
+                    passed &= checkKernel(isSame(runDithered(kernel, std::int16_t{}, scalar, scalarState), runDithered(kernel, std::int16_t{}, kernels, kernelState)) && scalarState == kernelState,
+                                          ("floatToInt16" + name).c_str(), kernels, samples);
+                }
+                if (kernels.floatToInt24 != nullptr)
+                {
+                    auto kernel = [&](const Kernels& k, std::uint8_t* out, std::uint32_t* state) { k.floatToInt24(source.data(), out, samples, state); };
+                    passed &= checkKernel(isSame(runDithered(kernel, std::uint8_t{}, scalar, scalarState), runDithered(kernel, std::uint8_t{}, kernels, kernelState)) && scalarState == kernelState,
+                                          ("floatToInt24" + name).c_str(), kernels, samples);
+                }
+            }
+        }
+    }
+    return passed;
+}
+
+// sumOfSquares() and polyphaseFilter() add in a different order, so they are compared with a relative tolerance
+static bool testSimdSums()
+{
+    const Kernels scalar = getScalarKernels();
+    bool passed = true;
+    for (const Kernels& kernels : getTestedKernels())
+    {
+        for (const int samples : testLengths)
+        {
+            const auto source = getRandomSamples(samples + 1, 1.0f, static_cast<unsigned int>(samples));
+            const float reference = scalar.sumOfSquares(source.data() + 1, samples);
+            const float result = kernels.sumOfSquares(source.data() + 1, samples);
+            passed &= checkKernel(std::fabs(result - reference) <= 1.0e-5f * reference, "sumOfSquares", kernels, samples);
+        }
+
+        for (const int taps : {1, 3, 4, 8, 15, 16, 17, 32, 33, 64})
+        {
+            constexpr int phases = 5;
+            constexpr int samples = 67;
+            const auto coefficients = getRandomSamples(phases * taps, 1.0f, static_cast<unsigned int>(taps));
+            const auto source = getRandomSamples(samples + taps + 1, 1.0f, static_cast<unsigned int>(taps) + 1000);
+            std::vector<int> positions(samples);
+            std::vector<int> phaseIndices(samples);
+            for (int sample = 0; sample < samples; ++sample)
+            {
+                positions[static_cast<std::size_t>(sample)] = sample * 2 / 3 + 1;
+                phaseIndices[static_cast<std::size_t>(sample)] = (sample * 3) % phases;
+            }
+            auto run = [&](const Kernels& k)
+            {
+                std::vector<float> output(samples * 2);
+                k.polyphaseFilter(source.data(), coefficients.data(), positions.data(), phaseIndices.data(), taps, output.data(), 2, samples);
+                return output;
+            };
+            const auto reference = run(scalar);
+            const auto result = run(kernels);
+            float error = 0.0f;
+            for (std::size_t i = 0; i < result.size(); ++i)
+                error = std::max(error, std::fabs(result[i] - reference[i]));
+            passed &= checkKernel(error <= 1.0e-5f * static_cast<float>(taps), "polyphaseFilter", kernels, taps);
+        }
+    }
+    return passed;
+}
+
+//
+// interleaving with a compile-time channel count
+//
+
+// a unique value for every sample, exact in float
+template <typename SampleType>
+static SampleType getPlanarValue(int channel, int sample)
+{
+    return static_cast<SampleType>(channel * 100000 + sample);
+}
+
+// compares interleaveSamples<CHANNELS>(), the overload with a runtime channel count and the view overloads with a plain loop,
+// with a frame stride larger than the channel count the views use the blocked path for every channel count
+template <int CHANNELS, typename SampleType>
+static bool checkInterleaveRoundTrip()
+{
+    bool passed = true;
+    for (const int samples : testLengths)
+    {
+        if (samples == 0)
+            continue;
+
+        std::vector<std::vector<SampleType>> planar(CHANNELS, std::vector<SampleType>(static_cast<std::size_t>(samples)));
+        std::vector<SampleType> reference(static_cast<std::size_t>(samples) * CHANNELS);
+        const SampleType* source[CHANNELS];
+        for (int channel = 0; channel < CHANNELS; ++channel)
+        {
+            for (int sample = 0; sample < samples; ++sample)
+            {
+                planar[static_cast<std::size_t>(channel)][static_cast<std::size_t>(sample)] = getPlanarValue<SampleType>(channel, sample);
+                reference[static_cast<std::size_t>(sample * CHANNELS + channel)] = getPlanarValue<SampleType>(channel, sample);
+            }
+            source[channel] = planar[static_cast<std::size_t>(channel)].data();
+        }
+
+        std::vector<std::vector<SampleType>> deinterleaved(CHANNELS, std::vector<SampleType>(static_cast<std::size_t>(samples)));
+        SampleType* destination[CHANNELS];
+        for (int channel = 0; channel < CHANNELS; ++channel)
+            destination[channel] = deinterleaved[static_cast<std::size_t>(channel)].data();
+        auto clearDeinterleaved = [&]
+        {
+            for (auto& channel : deinterleaved)
+                std::fill(channel.begin(), channel.end(), SampleType{-1});
+        };
+
+        const std::string name = std::to_string(CHANNELS) + " channels, " + std::to_string(samples) + " samples";
+        std::vector<SampleType> interleaved(reference.size(), SampleType{-1});
+        edsp::interleaveSamples<CHANNELS>(source, interleaved.data(), samples);
+        passed &= check(interleaved == reference, "interleaveSamples<CHANNELS> (" + name + ")");
+        clearDeinterleaved();
+        edsp::deinterleaveSamples<CHANNELS>(interleaved.data(), destination, samples);
+        passed &= check(deinterleaved == planar, "deinterleaveSamples<CHANNELS> round trip (" + name + ")");
+
+        std::fill(interleaved.begin(), interleaved.end(), SampleType{-1});
+        edsp::interleaveSamples(source, interleaved.data(), CHANNELS, samples);
+        passed &= check(interleaved == reference, "interleaveSamples with a runtime channel count (" + name + ")");
+        clearDeinterleaved();
+        edsp::deinterleaveSamples(reference.data(), destination, CHANNELS, samples);
+        passed &= check(deinterleaved == planar, "deinterleaveSamples with a runtime channel count (" + name + ")");
+
+        // frames with 3 unused samples, which must not be written
+        constexpr int frameStride = CHANNELS + 3;
+        std::vector<SampleType> strided(static_cast<std::size_t>(samples) * frameStride, SampleType{-1});
+        const edsp::AudioBufferView<const SampleType> sourceView{source, CHANNELS, samples};
+        edsp::interleaveSamples(sourceView, edsp::AudioBufferInterleavedView<SampleType>{strided.data(), CHANNELS, samples, frameStride});
+        bool stridedMatches = true;
+        for (int sample = 0; sample < samples; ++sample)
+            for (int channel = 0; channel < frameStride; ++channel)
+                stridedMatches = stridedMatches && strided[static_cast<std::size_t>(sample * frameStride + channel)] == (channel < CHANNELS ? getPlanarValue<SampleType>(channel, sample) : SampleType{-1});
+        passed &= check(stridedMatches, "interleaveSamples with a frame stride (" + name + ")");
+        clearDeinterleaved();
+        edsp::deinterleaveSamples(edsp::AudioBufferInterleavedView<const SampleType>{strided.data(), CHANNELS, samples, frameStride}, edsp::AudioBufferView<SampleType>{destination, CHANNELS, samples});
+        passed &= check(deinterleaved == planar, "deinterleaveSamples with a frame stride (" + name + ")");
+
+        std::fill(interleaved.begin(), interleaved.end(), SampleType{-1});
+        edsp::interleaveSamples(sourceView, edsp::AudioBufferInterleavedView<SampleType>{interleaved.data(), CHANNELS, samples});
+        passed &= check(interleaved == reference, "interleaveSamples with views (" + name + ")");
+    }
+    return passed;
+}
+
+template <typename SampleType, int... CHANNELS>
+static bool checkInterleaveRoundTrips(std::integer_sequence<int, CHANNELS...>)
+{
+    return (checkInterleaveRoundTrip<CHANNELS + 1, SampleType>() & ...);
+}
+
+// 1 to 12 channels, float uses the SIMD kernels for 2, 4, 6 and 8 channels, double is always unrolled
+static bool testInterleaveRoundTrip()
+{
+    return checkInterleaveRoundTrips<float>(std::make_integer_sequence<int, 12>{}) & checkInterleaveRoundTrips<double>(std::make_integer_sequence<int, 12>{});
+}
+
+//
+// AudioBuffer
+//
+
+static bool isAligned(const void* pointer)
+{
+    return reinterpret_cast<std::uintptr_t>(pointer) % 64 == 0;
+}
+
+// every channel starts at a 64 byte boundary, the stride is padded to whole cache lines and never a multiple of 4 KiB,
+// and the channels do not overlap
+template <typename SampleType, int MAX_CHANNELS>
+static bool checkLayout(const edsp::AudioBuffer<SampleType, MAX_CHANNELS>& buffer, const std::string& name)
+{
+    const int stride = buffer.getChannelStride();
+    const auto strideBytes = static_cast<std::size_t>(stride) * sizeof(SampleType);
+    bool passed = check(stride >= buffer.getSampleCapacity() && strideBytes % 64 == 0, "the channel stride is padded to whole cache lines (" + name + ")");
+    passed &= check(strideBytes % 4096 != 0, "the channel stride is not a multiple of 4 KiB (" + name + ")");
+    passed &= check(strideBytes < static_cast<std::size_t>(buffer.getSampleCapacity()) * sizeof(SampleType) + 128, "the padding is at most two cache lines (" + name + ")");
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        passed &= check(isAligned(buffer.getReadPointer(channel)), "channel " + std::to_string(channel) + " is aligned (" + name + ")");
+        passed &= check(buffer.getReadPointer(channel) == buffer.getReadPointer(0) + static_cast<std::ptrdiff_t>(channel) * stride, "channel " + std::to_string(channel) + " is one stride after the previous one (" + name + ")");
+        passed &= check(buffer.getReadView().getReadPointer(channel) == buffer.getReadPointer(channel), "the view points to channel " + std::to_string(channel) + " (" + name + ")");
+    }
+    return passed;
+}
+
+template <typename SampleType, int MAX_CHANNELS>
+static void fillBuffer(edsp::AudioBuffer<SampleType, MAX_CHANNELS>& buffer)
+{
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+            buffer.setSample(channel, sample, getPlanarValue<SampleType>(channel, sample));
+}
+
+template <typename SampleType, int MAX_CHANNELS>
+static bool isFilled(const edsp::AudioBuffer<SampleType, MAX_CHANNELS>& buffer)
+{
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+            if (buffer.getSample(channel, sample) != getPlanarValue<SampleType>(channel, sample))
+                return false;
+    return true;
+}
+
+template <typename SampleType>
+static bool checkAlignmentAndStride(const char* typeName)
+{
+    bool passed = true;
+    // 1024 float or 512 double samples are exactly 4 KiB and get one cache line of padding
+    for (const int samples : {1, 15, 16, 17, 100, 512, 1000, 1024, 2048, 4097})
+    {
+        for (const int channels : {1, 3, 8})
+        {
+            edsp::AudioBuffer<SampleType, 8> buffer{channels, samples};
+            const std::string name = std::string{typeName} + ", " + std::to_string(channels) + " channels, " + std::to_string(samples) + " samples";
+            passed &= check(buffer.getNumChannels() == channels && buffer.getNumSamples() == samples, "size (" + name + ")");
+            passed &= checkLayout(buffer, name);
+
+            // writing all samples of all channels must not overwrite another channel
+            fillBuffer(buffer);
+            passed &= check(isFilled(buffer), "channels do not overlap (" + name + ")");
+        }
+    }
+    return passed;
+}
+
+static bool testAlignmentAndStride()
+{
+    return checkAlignmentAndStride<float>("float") & checkAlignmentAndStride<double>("double") & checkAlignmentAndStride<std::int16_t>("int16");
+}
+
+static bool testResize()
+{
+    edsp::AudioBuffer<float, 8> buffer{2, 100};
+    fillBuffer(buffer);
+    const float* data = buffer.getReadPointer(0);
+    const int stride = buffer.getChannelStride();
+
+    // shrinking keeps the memory, the stride and the samples
+    buffer.setSize(1, 50);
+    bool passed = check(buffer.getNumChannels() == 1 && buffer.getNumSamples() == 50, "size after shrinking");
+    passed &= check(buffer.getReadPointer(0) == data && buffer.getChannelStride() == stride, "shrinking does not reallocate");
+    passed &= check(buffer.getChannelCapacity() == 2 && buffer.getSampleCapacity() == 100, "capacity after shrinking");
+    passed &= check(isFilled(buffer), "shrinking keeps the samples");
+
+    buffer.setSize(2, 100);
+    passed &= check(buffer.getReadPointer(0) == data && isFilled(buffer), "growing within the capacity keeps the memory and the samples");
+
+    // more samples than the capacity, the channel capacity is kept
+    buffer.setSize(1, 1000);
+    passed &= check(buffer.getNumChannels() == 1 && buffer.getNumSamples() == 1000, "size after growing");
+    passed &= check(buffer.getChannelCapacity() == 2 && buffer.getSampleCapacity() == 1000, "growing the samples keeps the channel capacity");
+    passed &= checkLayout(buffer, "more samples");
+
+    // more channels than the capacity, the sample capacity is kept
+    buffer.setSize(5, 10);
+    passed &= check(buffer.getChannelCapacity() == 5 && buffer.getSampleCapacity() == 1000, "growing the channels keeps the sample capacity");
+    passed &= checkLayout(buffer, "more channels");
+    fillBuffer(buffer);
+    passed &= check(isFilled(buffer), "samples after growing");
+
+    // reserve() allocates once, the following sizes fit
+    edsp::AudioBuffer<float, 8> reserved;
+    reserved.reserve(8, 4096);
+    passed &= check(reserved.getNumChannels() == 0 && reserved.getNumSamples() == 0, "reserve() does not change the size");
+    reserved.setSize(3, 1);
+    data = reserved.getReadPointer(0);
+    for (const int samples : {4096, 17, 1000, 1})
+    {
+        reserved.setSize(8, samples);
+        passed &= check(reserved.getReadPointer(0) == data && reserved.getChannelStride() == 4096 + 16, "setSize() within the reserved capacity keeps the memory");
+    }
+    passed &= checkLayout(reserved, "reserved");
+
+    // the moved-to buffer takes the memory, the moved-from buffer is empty
+    edsp::AudioBuffer<float, 8> moved{std::move(buffer)};
+    passed &= check(moved.getNumChannels() == 5 && moved.getNumSamples() == 10 && isFilled(moved), "moved buffer");
+    passed &= check(buffer.getNumChannels() == 0 && buffer.getChannelCapacity() == 0 && buffer.getSampleCapacity() == 0, "moved-from buffer is empty");
+    buffer.setSize(2, 20);
+    passed &= checkLayout(buffer, "moved-from buffer after setSize()");
+    moved = std::move(reserved);
+    passed &= check(moved.getReadPointer(0) == data && moved.getNumChannels() == 8, "move assignment");
+    return passed;
+}
+
+// counts the allocations and the allocated bytes, the memory comes from new/delete
+class CountingMemoryResource : public std::pmr::memory_resource
+{
+public:
+    int allocations = 0;
+    int deallocations = 0;
+    std::size_t allocatedBytes = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        ++allocations;
+        allocatedBytes += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override
+    {
+        ++deallocations;
+        allocatedBytes -= bytes;
+        std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+// all allocations go through the supplied resource, the default resource throws if it is used
+static bool testMemoryResource()
+{
+    CountingMemoryResource resource;
+    std::pmr::memory_resource* defaultResource = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+    bool passed = true;
+    {
+        edsp::AudioBuffer<float, 8> buffer{&resource};
+        passed &= check(resource.allocations == 0 && buffer.getMemoryResource() == &resource, "the constructor with a resource does not allocate");
+
+        buffer.reserve(8, 2048);
+        passed &= check(resource.allocations == 1 && resource.allocatedBytes >= 8 * 2048 * sizeof(float), "reserve() allocates once");
+        for (const int channels : {1, 8, 3})
+            for (const int samples : {2048, 1, 100, 2047})
+                buffer.setSize(channels, samples);
+        passed &= check(resource.allocations == 1, "setSize() within the capacity does not allocate");
+
+        buffer.setSize(8, 2049);
+        passed &= check(resource.allocations == 2 && resource.deallocations == 1, "growing beyond the capacity allocates and releases the old memory");
+
+        edsp::AudioBuffer<float, 8> moved{std::move(buffer)};
+        passed &= check(resource.allocations == 2 && moved.getMemoryResource() == &resource, "moving does not allocate");
+
+        edsp::AudioBufferInterleaved<float> interleaved{2, 512, &resource};
+        passed &= check(resource.allocations == 3, "the interleaved buffer allocates from the resource");
+        for (const int channels : {1, 2, 4})
+            interleaved.setSize(channels, 1024 / channels);
+        passed &= check(resource.allocations == 3 && interleaved.getCapacity() == 1024, "setSize() of the interleaved buffer within the capacity does not allocate");
+    }
+    passed &= check(resource.deallocations == resource.allocations && resource.allocatedBytes == 0, "the destructors release everything");
+    std::pmr::set_default_resource(defaultResource);
+    return passed;
+}
+
+//
+// views
+//
+
+// a mutable view converts to a read-only view, but not the other way around
+static_assert(std::is_convertible_v<edsp::AudioBufferView<float>, edsp::AudioBufferView<const float>>);
+static_assert(!std::is_convertible_v<edsp::AudioBufferView<const float>, edsp::AudioBufferView<float>>);
+static_assert(!std::is_convertible_v<edsp::AudioBufferView<double>, edsp::AudioBufferView<const float>>);
+static_assert(std::is_convertible_v<edsp::AudioBufferInterleavedView<float>, edsp::AudioBufferInterleavedView<const float>>);
+static_assert(!std::is_convertible_v<edsp::AudioBufferInterleavedView<const float>, edsp::AudioBufferInterleavedView<float>>);
+
+static bool testPlanarView()
+{
+    edsp::AudioBuffer<float, 4> buffer{4, 100};
+    fillBuffer(buffer);
+    const edsp::AudioBufferView<float> view = buffer.getWriteView();
+    bool passed = check(view.getNumChannels() == 4 && view.getNumSamples() == 100 && view.getSampleOffset() == 0, "size of the view of a buffer");
+
+    // channels [1, 3) and samples [10, 40)
+    const auto subView = view.getSubView(1, 2).getSubBlock(10, 30);
+    passed &= check(subView.getNumChannels() == 2 && subView.getNumSamples() == 30 && subView.getSampleOffset() == 10, "size and offset of a sub view");
+    passed &= check(subView.getReadPointer(0) == buffer.getReadPointer(1) + 10 && subView.getWritePointer(1) == buffer.getWritePointer(2) + 10, "pointers of a sub view");
+    passed &= check(subView.getArrayOfChannelPointers() == buffer.getArrayOfWritePointers() + 1, "the channel pointers are not offset");
+    passed &= check(subView.getSample(1, 5) == getPlanarValue<float>(2, 15), "sample of a sub view");
+
+    // the offsets add up
+    const auto nested = subView.getSubBlock(5, 20).getSubView(1, 1);
+    passed &= check(nested.getSampleOffset() == 15 && nested.getNumSamples() == 20 && nested.getReadPointer(0) == buffer.getReadPointer(2) + 15, "offsets of nested sub views add up");
+
+    // writes through a view change the buffer and are visible in the other views
+    nested.setSample(0, 0, -1.0f);
+    passed &= check(buffer.getSample(2, 15) == -1.0f && subView.getSample(1, 5) == -1.0f && view.getSample(2, 15) == -1.0f, "the views alias the buffer");
+    buffer.setSample(1, 10, -2.0f);
+    passed &= check(subView.getSample(0, 0) == -2.0f, "the view sees writes to the buffer");
+
+    // the read-only view points to the same samples
+    const edsp::AudioBufferView<const float> readOnly = subView;
+    passed &= check(readOnly.getNumChannels() == 2 && readOnly.getNumSamples() == 30 && readOnly.getSampleOffset() == 10, "size and offset of a read-only view");
+    passed &= check(readOnly.getReadPointer(0) == subView.getReadPointer(0) && readOnly.getReadPointer(1) == subView.getReadPointer(1), "a read-only view aliases the mutable view");
+    passed &= check(buffer.getReadView().getSubBlock(10, 30).getSubView(1, 2).getReadPointer(1) == readOnly.getReadPointer(1), "read view of the buffer");
+
+    // only the samples of the sub view are cleared
+    edsp::clearBuffer(nested);
+    bool cleared = true;
+    for (int channel = 0; channel < 4; ++channel)
+        for (int sample = 0; sample < 100; ++sample)
+        {
+            const bool inside = channel == 2 && sample >= 15 && sample < 35;
+            const float expected = inside ? 0.0f : (channel == 1 && sample == 10 ? -2.0f : getPlanarValue<float>(channel, sample));
+            cleared = cleared && buffer.getSample(channel, sample) == expected;
+        }
+    passed &= check(cleared, "clearing a sub view only changes its samples");
+
+    // host channel pointers with a sample offset
+    float left[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    float right[8] = {10, 11, 12, 13, 14, 15, 16, 17};
+    float* channels[] = {left, right};
+    const edsp::AudioBufferView<float> hostView{channels, 2, 5, 3};
+    passed &= check(hostView.getSample(0, 0) == 3.0f && hostView.getSample(1, 4) == 17.0f && hostView.getReadPointer(1) == right + 3, "view with a sample offset");
+    return passed;
+}
+
+static bool testInterleavedView()
+{
+    edsp::AudioBufferInterleaved<float> buffer{4, 100};
+    for (int channel = 0; channel < 4; ++channel)
+        for (int sample = 0; sample < 100; ++sample)
+            buffer.setSample(channel, sample, getPlanarValue<float>(channel, sample));
+    const edsp::AudioBufferInterleavedView<float> view = buffer.getWriteView();
+    bool passed = check(view.getNumChannels() == 4 && view.getNumSamples() == 100 && view.getFrameStride() == 4 && view.isContiguous(), "size of the view of a buffer");
+
+    // channels [1, 3) and samples [10, 40), the frame stride stays 4
+    const auto subView = view.getSubView(1, 2).getSubBlock(10, 30);
+    passed &= check(subView.getNumChannels() == 2 && subView.getNumSamples() == 30 && subView.getFrameStride() == 4 && !subView.isContiguous(), "size and stride of a sub view");
+    passed &= check(subView.getReadPointer() == buffer.getReadPointer() + 10 * 4 + 1, "pointer of a sub view");
+    passed &= check(subView.getSample(1, 5) == getPlanarValue<float>(2, 15), "sample of a sub view");
+    passed &= check(view.getSubBlock(10, 30).isContiguous(), "a sub block of all channels is contiguous");
+
+    const auto nested = subView.getSubBlock(5, 20).getSubView(1, 1);
+    passed &= check(nested.getReadPointer() == buffer.getReadPointer() + 15 * 4 + 2 && nested.getNumSamples() == 20, "offsets of nested sub views add up");
+
+    nested.setSample(0, 0, -1.0f);
+    passed &= check(buffer.getSample(2, 15) == -1.0f && subView.getSample(1, 5) == -1.0f && view.getSample(2, 15) == -1.0f, "the views alias the buffer");
+
+    const edsp::AudioBufferInterleavedView<const float> readOnly = subView;
+    passed &= check(readOnly.getReadPointer() == subView.getReadPointer() && readOnly.getFrameStride() == 4 && readOnly.getNumSamples() == 30, "a read-only view aliases the mutable view");
+
+    // only the samples of the sub view are cleared, the other channels of its frames are kept
+    edsp::clearBuffer(nested);
+    bool cleared = true;
+    for (int channel = 0; channel < 4; ++channel)
+        for (int sample = 0; sample < 100; ++sample)
+        {
+            const bool inside = channel == 2 && sample >= 15 && sample < 35;
+            cleared = cleared && buffer.getSample(channel, sample) == (inside ? 0.0f : getPlanarValue<float>(channel, sample));
+        }
+    passed &= check(cleared, "clearing a sub view only changes its samples");
+
+    // deinterleaving a sub view of the interleaved buffer into a sub view of a planar buffer
+    edsp::AudioBuffer<float, 4> planar{4, 100};
+    edsp::clearBuffer(planar.getWriteView());
+    edsp::deinterleaveSamples(view.getSubView(0, 2).getSubBlock(50, 50), planar.getWriteView().getSubView(2, 2).getSubBlock(0, 50));
+    bool copied = true;
+    for (int sample = 0; sample < 100; ++sample)
+        copied = copied && planar.getSample(2, sample) == (sample < 50 ? getPlanarValue<float>(0, sample + 50) : 0.0f)
+                 && planar.getSample(3, sample) == (sample < 50 ? getPlanarValue<float>(1, sample + 50) : 0.0f) && planar.getSample(0, sample) == 0.0f;
+    passed &= check(copied, "deinterleaving between sub views");
+    return passed;
+}
+
+//
+// gain, mix, pan and level measurement
+//
+
+// planar and interleaved copies of the same random samples, the frames of the strided copy have 2 unused samples
+template <typename SampleType>
+struct TestBuffers
+{
+    TestBuffers(int numChannels, int numSamples, unsigned int seed)
+            : channels(numChannels), samples(numSamples), planar(static_cast<std::size_t>(numChannels)), pointers(static_cast<std::size_t>(numChannels)),
+              interleaved(static_cast<std::size_t>(numChannels * numSamples)), strided(static_cast<std::size_t>((numChannels + 2) * numSamples))
+    {
+        const auto random = getRandomSamples(channels * samples, 1.0f, seed);
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            planar[static_cast<std::size_t>(channel)].resize(static_cast<std::size_t>(samples));
+            pointers[static_cast<std::size_t>(channel)] = planar[static_cast<std::size_t>(channel)].data();
+            for (int sample = 0; sample < samples; ++sample)
+            {
+                const auto value = static_cast<SampleType>(random[static_cast<std::size_t>(sample * channels + channel)]);
+                planar[static_cast<std::size_t>(channel)][static_cast<std::size_t>(sample)] = value;
+                interleaved[static_cast<std::size_t>(sample * channels + channel)] = value;
+                strided[static_cast<std::size_t>(sample * (channels + 2) + channel)] = value;
+            }
+        }
+    }
+
+    edsp::AudioBufferView<SampleType> getPlanarView()
+    {
+        return {pointers.data(), channels, samples};
+    }
+
+    edsp::AudioBufferInterleavedView<SampleType> getInterleavedView()
+    {
+        return {interleaved.data(), channels, samples};
+    }
+
+    edsp::AudioBufferInterleavedView<SampleType> getStridedView()
+    {
+        return {strided.data(), channels, samples, channels + 2};
+    }
+
+    int channels;
+    int samples;
+    std::vector<std::vector<SampleType>> planar;
+    std::vector<SampleType*> pointers;
+    std::vector<SampleType> interleaved;
+    std::vector<SampleType> strided;
+};
+
+// the three copies of the destination match the reference
+template <typename SampleType>
+static bool isClose(TestBuffers<SampleType>& buffers, const std::vector<std::vector<double>>& reference)
+{
+    const double tolerance = std::is_same_v<SampleType, float> ? 1.0e-6 : 1.0e-12;
+    bool close = true;
+    for (int channel = 0; channel < buffers.channels; ++channel)
+    {
+        for (int sample = 0; sample < buffers.samples; ++sample)
+        {
+            const double expected = reference[static_cast<std::size_t>(channel)][static_cast<std::size_t>(sample)];
+            for (const SampleType value : {buffers.getPlanarView().getSample(channel, sample), buffers.getInterleavedView().getSample(channel, sample), buffers.getStridedView().getSample(channel, sample)})
+                close = close && std::fabs(static_cast<double>(value) - expected) <= tolerance * (1.0 + std::fabs(expected));
+        }
+    }
+    return close;
+}
+
+// runs process(source, destination) on the planar, interleaved and strided views and compares them with
+// reference(channel, sample, sourceValue, destinationValue)
+template <typename SampleType, typename Process, typename Reference>
+static bool checkGainFunction(const std::string& name, int sourceChannels, int destinationChannels, Process process, Reference reference)
+{
+    bool passed = true;
+    for (const int samples : {1, 3, 17, 64, 1027})
+    {
+        TestBuffers<SampleType> source{sourceChannels, samples, static_cast<unsigned int>(samples)};
+        TestBuffers<SampleType> destination{destinationChannels, samples, static_cast<unsigned int>(samples) + 1000};
+
+        std::vector<std::vector<double>> expected(static_cast<std::size_t>(destinationChannels), std::vector<double>(static_cast<std::size_t>(samples)));
+        for (int channel = 0; channel < destinationChannels; ++channel)
+            for (int sample = 0; sample < samples; ++sample)
+                expected[static_cast<std::size_t>(channel)][static_cast<std::size_t>(sample)] =
+                        reference(channel, sample, samples, source.planar[static_cast<std::size_t>(std::min(channel, sourceChannels - 1))][static_cast<std::size_t>(sample)],
+                                  destination.planar[static_cast<std::size_t>(channel)][static_cast<std::size_t>(sample)]);
+
+        process(edsp::AudioBufferView<const SampleType>{source.getPlanarView()}, destination.getPlanarView());
+        process(edsp::AudioBufferInterleavedView<const SampleType>{source.getInterleavedView()}, destination.getInterleavedView());
+        process(edsp::AudioBufferInterleavedView<const SampleType>{source.getStridedView()}, destination.getStridedView());
+        passed &= check(isClose(destination, expected), name + " (" + std::to_string(destinationChannels) + " channels, " + std::to_string(samples) + " samples)");
+    }
+    return passed;
+}
+
+// the gain of a ramp is computed in SampleType like in AudioBufferGain.h, startGain + n * (endGain - startGain) / samples
+template <typename SampleType>
+static double getRampGain(SampleType startGain, SampleType endGain, int sample, int samples)
+{
+    return static_cast<double>(startGain + static_cast<SampleType>(sample) * ((endGain - startGain) / static_cast<SampleType>(samples)));
+}
+
+template <typename SampleType>
+static bool checkGain(const char* typeName)
+{
+    const std::string type = std::string{" ("} + typeName + ")";
+    const auto startGain = static_cast<SampleType>(0.25);
+    const auto endGain = static_cast<SampleType>(1.5);
+    const auto gain = static_cast<SampleType>(0.7);
+    bool passed = true;
+    for (const int channels : {1, 2, 3, 8})
+    {
+        passed &= checkGainFunction<SampleType>("applyGain" + type, channels, channels,
+                                                [&](auto, auto destination) { edsp::applyGain(destination, gain); },
+                                                [&](int, int, int, double, double value) { return value * static_cast<double>(gain); });
+        passed &= checkGainFunction<SampleType>("applyGainRamp" + type, channels, channels,
+                                                [&](auto, auto destination) { edsp::applyGainRamp(destination, startGain, endGain); },
+                                                [&](int, int sample, int samples, double, double value) { return value * getRampGain(startGain, endGain, sample, samples); });
+        passed &= checkGainFunction<SampleType>("copyBufferWithGain" + type, channels, channels,
+                                                [&](auto source, auto destination) { edsp::copyBufferWithGain(source, destination, gain); },
+                                                [&](int, int, int, double value, double) { return value * static_cast<double>(gain); });
+        passed &= checkGainFunction<SampleType>("copyBufferWithGainRamp" + type, channels, channels,
+                                                [&](auto source, auto destination) { edsp::copyBufferWithGainRamp(source, destination, startGain, endGain); },
+                                                [&](int, int sample, int samples, double value, double) { return value * getRampGain(startGain, endGain, sample, samples); });
+        passed &= checkGainFunction<SampleType>("addBufferWithGain" + type, channels, channels,
+                                                [&](auto source, auto destination) { edsp::addBufferWithGain(source, destination, gain); },
+                                                [&](int, int, int, double value, double previous) { return previous + value * static_cast<double>(gain); });
+        passed &= checkGainFunction<SampleType>("addBufferWithGainRamp" + type, channels, channels,
+                                                [&](auto source, auto destination) { edsp::addBufferWithGainRamp(source, destination, endGain, startGain); },
+                                                [&](int, int sample, int samples, double value, double previous) { return previous + value * getRampGain(endGain, startGain, sample, samples); });
+    }
+
+    // consecutive ramps continue seamlessly, the end gain is reached one frame after the buffer
+    std::vector<SampleType> ones(8, SampleType{1});
+    edsp::applyGainRamp(ones.data(), 1, 4, SampleType{0}, SampleType{1});
+    edsp::applyGainRamp(ones.data() + 4, 1, 4, SampleType{1}, SampleType{0});
+    const std::vector<SampleType> expected = {0, 0.25, 0.5, 0.75, 1, 0.75, 0.5, 0.25};
+    passed &= check(ones == expected, "consecutive ramps" + type);
+    return passed;
+}
+
+static bool testGain()
+{
+    return checkGain<float>("float") & checkGain<double>("double");
+}
+
+template <typename SampleType>
+static bool checkPan(const char* typeName)
+{
+    const std::string type = std::string{" ("} + typeName + ")";
+    bool passed = true;
+
+    // constant power: -3 dB in the center, the squared gains add up to 1
+    for (const double pan : {-1.0, -0.5, 0.0, 0.3, 1.0})
+    {
+        SampleType left, right;
+        edsp::getPanGains(static_cast<SampleType>(pan), left, right);
+        const double angle = (pan + 1.0) * std::atan(1.0);
+        passed &= check(std::fabs(static_cast<double>(left) - std::cos(angle)) < 1.0e-6 && std::fabs(static_cast<double>(right) - std::sin(angle)) < 1.0e-6, "pan gains" + type);
+        passed &= check(std::fabs(static_cast<double>(left * left + right * right) - 1.0) < 1.0e-6, "constant power" + type);
+    }
+    SampleType left, right;
+    edsp::getPanGains(SampleType{-1}, left, right);
+    passed &= check(left == SampleType{1} && std::fabs(static_cast<double>(right)) < 1.0e-7, "hard left" + type);
+
+    for (const auto& [startPan, endPan] : {std::pair{-0.5, 0.8}, std::pair{0.0, 0.0}, std::pair{1.0, -1.0}})
+    {
+        SampleType startLeft, startRight, endLeft, endRight;
+        edsp::getPanGains(static_cast<SampleType>(startPan), startLeft, startRight);
+        edsp::getPanGains(static_cast<SampleType>(endPan), endLeft, endRight);
+        passed &= checkGainFunction<SampleType>("addBufferWithPan" + type, 1, 2,
+                                                [&](auto source, auto destination) { edsp::addBufferWithPan(source, destination, static_cast<SampleType>(startPan), static_cast<SampleType>(endPan)); },
+                                                [&](int channel, int sample, int samples, double value, double previous)
+                                                { return previous + value * (channel == 0 ? getRampGain(startLeft, endLeft, sample, samples) : getRampGain(startRight, endRight, sample, samples)); });
+    }
+    return passed;
+}
+
+static bool testPan()
+{
+    return checkPan<float>("float") & checkPan<double>("double");
+}
+
+template <typename SampleType>
+static bool checkPeakAndRms(const char* typeName)
+{
+    const std::string type = std::string{" ("} + typeName + ")";
+    bool passed = true;
+    for (const int channels : {1, 2, 3, 8})
+    {
+        for (const int samples : {1, 3, 17, 64, 1027})
+        {
+            TestBuffers<SampleType> buffers{channels, samples, static_cast<unsigned int>(channels * samples)};
+            // the peak is negative and in the middle of the last channel
+            buffers.getPlanarView().setSample(channels - 1, samples / 2, SampleType{-1.5});
+            buffers.getInterleavedView().setSample(channels - 1, samples / 2, SampleType{-1.5});
+            buffers.getStridedView().setSample(channels - 1, samples / 2, SampleType{-1.5});
+
+            double sumOfSquares = 0.0;
+            for (const auto& channel : buffers.planar)
+                for (const SampleType value : channel)
+                    sumOfSquares += static_cast<double>(value) * static_cast<double>(value);
+            const double rms = std::sqrt(sumOfSquares / static_cast<double>(channels * samples));
+
+            const std::string name = " (" + std::to_string(channels) + " channels, " + std::to_string(samples) + " samples)" + type;
+            passed &= check(edsp::getPeak(edsp::AudioBufferView<const SampleType>{buffers.getPlanarView()}) == SampleType{1.5}, "planar peak" + name);
+            passed &= check(edsp::getPeak(edsp::AudioBufferInterleavedView<const SampleType>{buffers.getInterleavedView()}) == SampleType{1.5}, "interleaved peak" + name);
+            passed &= check(edsp::getPeak(edsp::AudioBufferInterleavedView<const SampleType>{buffers.getStridedView()}) == SampleType{1.5}, "strided peak" + name);
+            passed &= check(edsp::getPeak(const_cast<const SampleType**>(buffers.pointers.data()), channels, samples) == SampleType{1.5}, "peak of channel pointers" + name);
+
+            for (const SampleType value : {edsp::getRms(edsp::AudioBufferView<const SampleType>{buffers.getPlanarView()}),
+                                           edsp::getRms(edsp::AudioBufferInterleavedView<const SampleType>{buffers.getInterleavedView()}),
+                                           edsp::getRms(edsp::AudioBufferInterleavedView<const SampleType>{buffers.getStridedView()}),
+                                           edsp::getRms(static_cast<const SampleType*>(buffers.interleaved.data()), channels, samples)})
+                passed &= check(std::fabs(static_cast<double>(value) - rms) <= 1.0e-6 * rms, "rms" + name);
+        }
+    }
+    return passed;
+}
+
+// planar and interleaved buffers give the same RMS for long buffers, the float sums of the SIMD kernel are added in double
+static bool testLongRms()
+{
+    constexpr int channels = 2;
+    constexpr int samples = 1 << 22;
+    TestBuffers<float> buffers{channels, samples, 1};
+    double sumOfSquares = 0.0;
+    for (const float value : buffers.interleaved)
+        sumOfSquares += static_cast<double>(value) * static_cast<double>(value);
+    const double rms = std::sqrt(sumOfSquares / static_cast<double>(channels * samples));
+
+    const float planarRms = edsp::getRms(edsp::AudioBufferView<const float>{buffers.getPlanarView()});
+    const float interleavedRms = edsp::getRms(edsp::AudioBufferInterleavedView<const float>{buffers.getInterleavedView()});
+    bool passed = check(std::fabs(static_cast<double>(planarRms) - rms) <= 1.0e-6 * rms, "planar rms of a long buffer");
+    passed &= check(std::fabs(static_cast<double>(interleavedRms) - rms) <= 1.0e-6 * rms, "interleaved rms of a long buffer");
+    passed &= check(planarRms == interleavedRms, "planar and interleaved rms of a long buffer are the same");
+    return passed;
+}
+
+static bool testPeakAndRms()
+{
+    return checkPeakAndRms<float>("float") & checkPeakAndRms<double>("double") & testLongRms();
+}
+
+//
+// integer conversion
+//
+
+static std::int32_t getInt24(const edsp::PackedInt24& sample)
+{
+    const std::uint32_t value = static_cast<std::uint32_t>(sample.bytes[0]) << 8 | static_cast<std::uint32_t>(sample.bytes[1]) << 16 | static_cast<std::uint32_t>(sample.bytes[2]) << 24;
+    return static_cast<std::int32_t>(value) >> 8;
+}
+
+static edsp::PackedInt24 makeInt24(std::int32_t value)
+{
+    const auto bits = static_cast<std::uint32_t>(value);
+    return {{static_cast<std::uint8_t>(bits), static_cast<std::uint8_t>(bits >> 8), static_cast<std::uint8_t>(bits >> 16)}};
+}
+
+// the integer value and the full scale of each format, the largest int32 result is the largest float below 2^31
+template <typename IntegerType>
+struct IntegerFormat;
+
+template <>
+struct IntegerFormat<std::int16_t>
+{
+    static constexpr double scale = 32768.0;
+    static constexpr double maximum = 32767.0;
+    static std::int32_t get(std::int16_t sample) { return sample; }
+    static std::int16_t make(std::int32_t value) { return static_cast<std::int16_t>(value); }
+};
+
+template <>
+struct IntegerFormat<edsp::PackedInt24>
+{
+    static constexpr double scale = 8388608.0;
+    static constexpr double maximum = 8388607.0;
+    static std::int32_t get(edsp::PackedInt24 sample) { return getInt24(sample); }
+    static edsp::PackedInt24 make(std::int32_t value) { return makeInt24(value); }
+};
+
+template <>
+struct IntegerFormat<std::int32_t>
+{
+    static constexpr double scale = 2147483648.0;
+    static constexpr double maximum = 2147483520.0;
+    static std::int32_t get(std::int32_t sample) { return sample; }
+    static std::int32_t make(std::int32_t value) { return value; }
+};
+
+// clamped and rounded to the nearest integer, ties to even like the current rounding mode
+template <typename IntegerType>
+static std::int32_t getExpectedInteger(float value)
+{
+    using Format = IntegerFormat<IntegerType>;
+    const double scaled = static_cast<double>(value) * Format::scale;
+    if (std::isnan(value))
+        return static_cast<std::int32_t>(-Format::scale);
+    return static_cast<std::int32_t>(std::nearbyint(std::clamp(scaled, -Format::scale, Format::maximum)));
+}
+
+template <typename IntegerType>
+static bool checkSaturation(const char* typeName)
+{
+    using Format = IntegerFormat<IntegerType>;
+    const std::string type = std::string{" ("} + typeName + ")";
+    const float input[] = {1.0f, -1.0f, 1.5f, -1.5f, 100.0f, -100.0f, std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), 0.99999994f, -0.99999994f, 0.0f};
+    constexpr int samples = static_cast<int>(std::size(input));
+    IntegerType output[samples];
+    edsp::convertSamples(input, output, samples);
+
+    bool passed = true;
+    for (int i = 0; i < samples; ++i)
+        passed &= check(Format::get(output[i]) == getExpectedInteger<IntegerType>(input[i]), "conversion of " + std::to_string(input[i]) + type);
+    passed &= check(Format::get(output[0]) == static_cast<std::int32_t>(Format::maximum) && Format::get(output[4]) == static_cast<std::int32_t>(Format::maximum)
+                            && Format::get(output[6]) == static_cast<std::int32_t>(Format::maximum),
+                    "1 and above saturate at the maximum" + type);
+    passed &= check(Format::get(output[1]) == static_cast<std::int32_t>(-Format::scale) && Format::get(output[5]) == static_cast<std::int32_t>(-Format::scale)
+                            && Format::get(output[7]) == static_cast<std::int32_t>(-Format::scale),
+                    "-1 and below saturate at the minimum" + type);
+
+    // the dither must not wrap around at full scale either
+    edsp::TpdfDither dither{7};
+    std::vector<float> fullScale(1000);
+    for (std::size_t i = 0; i < fullScale.size(); ++i)
+        fullScale[i] = i % 2 == 0 ? 1.0f : -1.0f;
+    std::vector<IntegerType> dithered(fullScale.size());
+    edsp::convertSamples(fullScale.data(), dithered.data(), static_cast<int>(fullScale.size()), &dither);
+    bool saturated = true;
+    for (std::size_t i = 0; i < dithered.size(); ++i)
+        saturated = saturated && (i % 2 == 0 ? Format::get(dithered[i]) >= static_cast<std::int32_t>(Format::maximum) - 1 : Format::get(dithered[i]) <= static_cast<std::int32_t>(-Format::scale) + 1);
+    passed &= check(saturated, "dithered full scale samples saturate" + type);
+    return passed;
+}
+
+static bool testSaturation()
+{
+    return checkSaturation<std::int16_t>("int16") & checkSaturation<edsp::PackedInt24>("int24") & checkSaturation<std::int32_t>("int32");
+}
+
+// integer -> float -> integer and float -> integer -> float
+template <typename IntegerType>
+static bool checkRoundTrip(const char* typeName, std::int32_t maximumIntegerError)
+{
+    using Format = IntegerFormat<IntegerType>;
+    const std::string type = std::string{" ("} + typeName + ")";
+    bool passed = true;
+
+    // all 16 bit values, random 24 and 32 bit values and the extremes
+    std::mt19937 random{1};
+    std::vector<IntegerType> integers;
+    for (std::int32_t value = -32768; value < 32768; ++value)
+        integers.push_back(Format::make(static_cast<std::int32_t>(static_cast<double>(value) * Format::scale / 32768.0) + static_cast<std::int32_t>(random() % static_cast<std::uint32_t>(Format::scale / 32768.0))));
+    integers.push_back(Format::make(static_cast<std::int32_t>(-Format::scale)));
+    integers.push_back(Format::make(static_cast<std::int32_t>(Format::scale - 1.0)));
+    const int samples = static_cast<int>(integers.size());
+
+    std::vector<float> floats(integers.size());
+    edsp::convertSamples(integers.data(), floats.data(), samples);
+    bool inRange = true;
+    bool exactFloat = true;
+    for (std::size_t i = 0; i < integers.size(); ++i)
+    {
+        inRange = inRange && floats[i] >= -1.0f && floats[i] <= 1.0f;
+        exactFloat = exactFloat && std::fabs(static_cast<double>(floats[i]) - static_cast<double>(Format::get(integers[i])) / Format::scale) <= 0.5 * std::pow(2.0, -24.0);
+    }
+    passed &= check(inRange, "integer samples are converted to [-1, 1]" + type);
+    passed &= check(exactFloat, "integer to float conversion is exact up to float rounding" + type);
+
+    std::vector<IntegerType> roundTrip(integers.size());
+    edsp::convertSamples(floats.data(), roundTrip.data(), samples);
+    std::int32_t maximumError = 0;
+    for (std::size_t i = 0; i < integers.size(); ++i)
+        maximumError = std::max(maximumError, std::abs(Format::get(roundTrip[i]) - Format::get(integers[i])));
+    passed &= check(maximumError <= maximumIntegerError, "integer round trip error " + std::to_string(maximumError) + " LSB" + type);
+
+    // float -> integer -> float is off by at most half an LSB, and by at most 1.5 LSB with dither
+    const auto source = getRandomSamples(100000, 1.0f, 2);
+    for (const bool dither : {false, true})
+    {
+        edsp::TpdfDither tpdf{3};
+        std::vector<IntegerType> quantized(source.size());
+        edsp::convertSamples(source.data(), quantized.data(), static_cast<int>(source.size()), dither ? &tpdf : nullptr);
+        std::vector<float> restored(source.size());
+        edsp::convertSamples(quantized.data(), restored.data(), static_cast<int>(source.size()));
+        double error = 0.0;
+        for (std::size_t i = 0; i < source.size(); ++i)
+            error = std::max(error, std::fabs(static_cast<double>(restored[i]) - static_cast<double>(source[i])) * Format::scale);
+        // float can not represent 32 bit samples exactly, the error is relative to the float resolution then
+        const double bound = std::is_same_v<IntegerType, std::int32_t> ? 128.0 : (dither ? 1.5 : 0.5);
+        passed &= check(error <= bound, "float round trip error of " + std::to_string(error) + " LSB" + (dither ? " with dither" : "") + type);
+    }
+    return passed;
+}
+
+static bool testRoundTrip()
+{
+    // float has 24 significant bits, so 32 bit samples are rounded to a multiple of up to 128
+    return checkRoundTrip<std::int16_t>("int16", 0) & checkRoundTrip<edsp::PackedInt24>("int24", 0) & checkRoundTrip<std::int32_t>("int32", 128);
+}
+
+// the quantization error with TPDF dither has no offset and a power of 1/4 LSB^2 (1/12 of the rounding and 1/6 of the dither),
+// the dither stays within +-1 LSB and only depends on the seed
+// the samples stay below -40 dBFS, so the scaled 24 bit samples still have enough fractional bits in float
+template <typename IntegerType>
+static bool checkDither(const char* typeName)
+{
+    using Format = IntegerFormat<IntegerType>;
+    const std::string type = std::string{" ("} + typeName + ")";
+    const auto source = getRandomSamples(1 << 20, 0.01f, 4);
+    const int samples = static_cast<int>(source.size());
+
+    auto convert = [&](edsp::TpdfDither* dither)
+    {
+        std::vector<IntegerType> output(source.size());
+        edsp::convertSamples(source.data(), output.data(), samples, dither);
+        return output;
+    };
+    edsp::TpdfDither dither{42};
+    const auto dithered = convert(&dither);
+
+    double sum = 0.0;
+    double sumOfSquares = 0.0;
+    double maximum = 0.0;
+    for (std::size_t i = 0; i < source.size(); ++i)
+    {
+        const double error = static_cast<double>(Format::get(dithered[i])) - static_cast<double>(source[i]) * Format::scale;
+        sum += error;
+        sumOfSquares += error * error;
+        maximum = std::max(maximum, std::fabs(error));
+    }
+    const double mean = sum / static_cast<double>(samples);
+    const double power = sumOfSquares / static_cast<double>(samples);
+    bool passed = check(std::fabs(mean) < 0.005, "dither has no offset, mean error " + std::to_string(mean) + type);
+    passed &= check(std::fabs(power - 0.25) < 0.005, "error power with dither is 1/4 LSB^2, measured " + std::to_string(power) + type);
+    passed &= check(maximum < 1.5, "dither stays within 1 LSB" + type);
+
+    // without dither the error power is 1/12 LSB^2
+    const auto undithered = convert(nullptr);
+    double unditheredPower = 0.0;
+    for (std::size_t i = 0; i < source.size(); ++i)
+    {
+        const double error = static_cast<double>(Format::get(undithered[i])) - static_cast<double>(source[i]) * Format::scale;
+        unditheredPower += error * error;
+    }
+    unditheredPower /= static_cast<double>(samples);
+    passed &= check(std::fabs(unditheredPower - 1.0 / 12.0) < 0.005, "error power without dither is 1/12 LSB^2, measured " + std::to_string(unditheredPower) + type);
+
+    // the same seed gives the same noise, also after reset(), another seed gives different noise
+    edsp::TpdfDither sameSeed{42};
+    const auto repeated = convert(&sameSeed);
+    edsp::TpdfDither otherSeed{43};
+    const auto other = convert(&otherSeed);
+    dither.reset(42);
+    const auto afterReset = convert(&dither);
+    auto isSameOutput = [](const std::vector<IntegerType>& a, const std::vector<IntegerType>& b)
+    {
+        return std::memcmp(a.data(), b.data(), a.size() * sizeof(IntegerType)) == 0;
+    };
+    passed &= check(isSameOutput(dithered, repeated), "the same seed gives the same output" + type);
+    passed &= check(isSameOutput(dithered, afterReset), "reset() restarts the noise" + type);
+    passed &= check(!isSameOutput(dithered, other), "another seed gives another output" + type);
+
+    // the noise continues across calls instead of repeating
+    const auto secondCall = convert(&sameSeed);
+    passed &= check(!isSameOutput(repeated, secondCall), "the noise continues in the next call" + type);
+    return passed;
+}
+
+static bool testDither()
+{
+    return checkDither<std::int16_t>("int16") & checkDither<edsp::PackedInt24>("int24");
+}
+
+// every length and the planar and strided overloads, compared with a reference rounding per sample
+template <typename IntegerType>
+static bool checkConversionTails(const char* typeName)
+{
+    using Format = IntegerFormat<IntegerType>;
+    const std::string type = std::string{" ("} + typeName + ")";
+    bool passed = true;
+    for (const int samples : testLengths)
+    {
+        if (samples == 0)
+            continue;
+
+        const auto source = getRandomSamples(samples, 1.1f, static_cast<unsigned int>(samples));
+        std::vector<IntegerType> integers(source.size());
+        edsp::convertSamples(source.data(), integers.data(), samples);
+        bool matches = true;
+        for (int i = 0; i < samples; ++i)
+            matches = matches && Format::get(integers[static_cast<std::size_t>(i)]) == getExpectedInteger<IntegerType>(source[static_cast<std::size_t>(i)]);
+        passed &= check(matches, "float to integer with " + std::to_string(samples) + " samples" + type);
+
+        std::vector<float> floats(source.size(), -2.0f);
+        edsp::convertSamples(integers.data(), floats.data(), samples);
+        matches = true;
+        for (int i = 0; i < samples; ++i)
+            matches = matches && floats[static_cast<std::size_t>(i)] == static_cast<float>(static_cast<double>(Format::get(integers[static_cast<std::size_t>(i)])) / Format::scale);
+        passed &= check(matches, "integer to float with " + std::to_string(samples) + " samples" + type);
+
+        // planar to interleaved frames with 2 unused samples, which must not be written, and back
+        for (const int channels : {1, 3, 7})
+        {
+            TestBuffers<float> planar{channels, samples, static_cast<unsigned int>(samples * channels)};
+            const int frameStride = channels + 2;
+            std::vector<IntegerType> interleaved(static_cast<std::size_t>(samples * frameStride), Format::make(12345));
+            const edsp::AudioBufferInterleavedView<IntegerType> interleavedView{interleaved.data(), channels, samples, frameStride};
+            edsp::convertSamples(edsp::AudioBufferView<const float>{planar.getPlanarView()}, interleavedView);
+
+            bool planarMatches = true;
+            for (int sample = 0; sample < samples; ++sample)
+                for (int channel = 0; channel < frameStride; ++channel)
+                {
+                    const auto value = Format::get(interleaved[static_cast<std::size_t>(sample * frameStride + channel)]);
+                    planarMatches = planarMatches && value == (channel < channels ? getExpectedInteger<IntegerType>(planar.getPlanarView().getSample(channel, sample)) : 12345);
+                }
+            passed &= check(planarMatches, "planar float to strided integer with " + std::to_string(channels) + " channels and " + std::to_string(samples) + " samples" + type);
+
+            TestBuffers<float> restored{channels, samples, 0};
+            edsp::convertSamples(edsp::AudioBufferInterleavedView<const IntegerType>{interleavedView}, restored.getPlanarView());
+            bool restoredMatches = true;
+            for (int sample = 0; sample < samples; ++sample)
+                for (int channel = 0; channel < channels; ++channel)
+                    restoredMatches = restoredMatches && restored.getPlanarView().getSample(channel, sample) == static_cast<float>(static_cast<double>(Format::get(interleavedView.getSample(channel, sample))) / Format::scale);
+            passed &= check(restoredMatches, "strided integer to planar float with " + std::to_string(channels) + " channels and " + std::to_string(samples) + " samples" + type);
+        }
+    }
+    return passed;
+}
+
+static bool testConversionTails()
+{
+    return checkConversionTails<std::int16_t>("int16") & checkConversionTails<edsp::PackedInt24>("int24") & checkConversionTails<std::int32_t>("int32");
+}
+
+int main()
+{
+    bool passed = true;
+    for (const auto& [name, test] : {std::pair{"SIMD dispatch", testSimdDispatch},
+                                     std::pair{"SIMD arithmetic", testSimdArithmetic},
+                                     std::pair{"SIMD interleave", testSimdInterleave},
+                                     std::pair{"SIMD conversion", testSimdConversion},
+                                     std::pair{"SIMD sums", testSimdSums},
+                                     std::pair{"interleave round trip", testInterleaveRoundTrip},
+                                     std::pair{"alignment and stride", testAlignmentAndStride},
+                                     std::pair{"resize", testResize},
+                                     std::pair{"memory resource", testMemoryResource},
+                                     std::pair{"planar view", testPlanarView},
+                                     std::pair{"interleaved view", testInterleavedView},
+                                     std::pair{"gain", testGain},
+                                     std::pair{"pan", testPan},
+                                     std::pair{"peak and rms", testPeakAndRms},
+                                     std::pair{"saturation", testSaturation},
+                                     std::pair{"conversion round trip", testRoundTrip},
+                                     std::pair{"dither", testDither},
+                                     std::pair{"conversion tails", testConversionTails}})
+    {
+        const bool testPassed = test();
+        std::cout << name << (testPassed ? " passed.\n" : " failed!\n");
+        passed &= testPassed;
+    }
+    return passed ? 0 : 1;
+}
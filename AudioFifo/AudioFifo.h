@@ -0,0 +1,440 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "../AudioBuffer/AudioBuffer.h"
+#include "../AudioBuffer/AudioBufferInterleaved.h"
+#include "../AudioBuffer/AudioBufferView.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+
+namespace edsp
+{
+
+// the samples of a FIFO that can be accessed at once
+// second continues at the beginning of the storage if the region wraps around, otherwise it is empty (0 samples)
+template <typename ViewType>
+struct AudioFifoRegions
+{
+    ViewType first;
+    ViewType second;
+
+    int getNumSamples() const noexcept
+    {
+        return first.getNumSamples() + second.getNumSamples();
+    }
+};
+
+namespace detail
+{
+
+// read and write positions of a single-producer/single-consumer ring buffer with a power of two capacity
+// the positions increase monotonically and are masked to access the storage, so a full FIFO is not mistaken for an empty one
+// each side keeps a copy of the other side's position and only reloads it if the copy says there is not enough space
+class FifoPositions
+{
+public:
+    FifoPositions() = default;
+
+    // not thread-safe, the producer and the consumer must not access either FIFO
+    FifoPositions(const FifoPositions& other) noexcept
+    {
+        *this = other;
+    }
+
+    FifoPositions& operator=(const FifoPositions& other) noexcept
+    {
+        mCapacity = other.mCapacity;
+        mMask = other.mMask;
+        mWritePosition.store(other.mWritePosition.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        mCachedReadPosition = other.mCachedReadPosition;
+        mReadPosition.store(other.mReadPosition.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        mCachedWritePosition = other.mCachedWritePosition;
+        return *this;
+    }
+
+    static int roundUpToPowerOfTwo(int value) noexcept
+    {
+        assert(value > 0 && value <= (1 << 30));
+        int result = 1;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+
+    // not thread-safe, the producer and the consumer must not access the FIFO
+    void setCapacity(int capacity) noexcept
+    {
+        assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+        mCapacity = static_cast<std::size_t>(capacity);
+        mMask = mCapacity - 1;
+        reset();
+    }
+
+    // not thread-safe, the producer and the consumer must not access the FIFO
+    void reset() noexcept
+    {
+        mWritePosition.store(0, std::memory_order_relaxed);
+        mCachedReadPosition = 0;
+        mReadPosition.store(0, std::memory_order_relaxed);
+        mCachedWritePosition = 0;
+    }
+
+    int getCapacity() const noexcept
+    {
+        return static_cast<int>(mCapacity);
+    }
+
+    // can be called from any thread, the result may be outdated when it is used
+    int getNumReady() const noexcept
+    {
+        // the read position is loaded first so it can't be ahead of the write position
+        // both sides may have moved on in between, which is why the result is limited to the capacity
+        const std::size_t readPosition = mReadPosition.load(std::memory_order_acquire);
+        const std::size_t writePosition = mWritePosition.load(std::memory_order_acquire);
+        return static_cast<int>(std::min(writePosition - readPosition, mCapacity));
+    }
+
+    int getFreeSpace() const noexcept
+    {
+        return getCapacity() - getNumReady();
+    }
+
+    // producer: returns how many of the requested samples can be written, start is the masked write position
+    int prepareWrite(int samples, std::size_t& start) noexcept
+    {
+        const std::size_t writePosition = mWritePosition.load(std::memory_order_relaxed);
+        std::size_t freeSpace = mCapacity - (writePosition - mCachedReadPosition);
+        if (freeSpace < static_cast<std::size_t>(samples))
+        {
+            mCachedReadPosition = mReadPosition.load(std::memory_order_acquire);
+            freeSpace = mCapacity - (writePosition - mCachedReadPosition);
+        }
+
+        start = writePosition & mMask;
+        return static_cast<int>(std::min(freeSpace, static_cast<std::size_t>(samples)));
+    }
+
+    // producer: publishes the written samples to the consumer
+    void finishWrite(int samples) noexcept
+    {
+        const std::size_t writePosition = mWritePosition.load(std::memory_order_relaxed);
+        assert(samples >= 0 && writePosition + static_cast<std::size_t>(samples) - mCachedReadPosition <= mCapacity);
+        mWritePosition.store(writePosition + static_cast<std::size_t>(samples), std::memory_order_release);
+    }
+
+    // consumer: returns how many of the requested samples can be read, start is the masked read position
+    int prepareRead(int samples, std::size_t& start) noexcept
+    {
+        const std::size_t readPosition = mReadPosition.load(std::memory_order_relaxed);
+        std::size_t ready = mCachedWritePosition - readPosition;
+        if (ready < static_cast<std::size_t>(samples))
+        {
+            mCachedWritePosition = mWritePosition.load(std::memory_order_acquire);
+            ready = mCachedWritePosition - readPosition;
+        }
+
+        start = readPosition & mMask;
+        return static_cast<int>(std::min(ready, static_cast<std::size_t>(samples)));
+    }
+
+    // consumer: hands the read samples back to the producer
+    void finishRead(int samples) noexcept
+    {
+        const std::size_t readPosition = mReadPosition.load(std::memory_order_relaxed);
+        assert(samples >= 0 && readPosition + static_cast<std::size_t>(samples) <= mCachedWritePosition);
+        mReadPosition.store(readPosition + static_cast<std::size_t>(samples), std::memory_order_release);
+    }
+
+private:
+    std::size_t mCapacity = 0;
+    std::size_t mMask = 0;
+
+    // the producer and the consumer write to different cache lines
+    alignas(64) std::atomic<std::size_t> mWritePosition{0};
+    std::size_t mCachedReadPosition = 0;
+    alignas(64) std::atomic<std::size_t> mReadPosition{0};
+    std::size_t mCachedWritePosition = 0;
+};
+
+} // namespace detail
+
+// wait-free single-producer/single-consumer FIFO for planar audio
+// the capacity in samples per channel is rounded up to a power of two
+// the write functions must only be called from one thread and the read functions only from one other thread
+template <typename SampleType, int MAX_CHANNELS>
+class AudioFifo
+{
+public:
+    using WriteRegions = AudioFifoRegions<AudioBufferView<SampleType>>;
+    using ReadRegions = AudioFifoRegions<AudioBufferView<const SampleType>>;
+
+    AudioFifo() = default;
+
+    AudioFifo(int channels, int capacity)
+    {
+        configure(channels, capacity);
+    }
+
+    // allocates memory and empties the FIFO, call e.g. at application start
+    void configure(int channels, int capacity)
+    {
+        assert(channels > 0 && capacity > 0);
+        const int roundedCapacity = detail::FifoPositions::roundUpToPowerOfTwo(capacity);
+        mBuffer.setSize(channels, roundedCapacity);
+        mPositions.setCapacity(roundedCapacity);
+    }
+
+    // empties the FIFO, not thread-safe
+    void reset() noexcept
+    {
+        mPositions.reset();
+    }
+
+    int getNumChannels() const noexcept
+    {
+        return mBuffer.getNumChannels();
+    }
+
+    int getCapacity() const noexcept
+    {
+        return mPositions.getCapacity();
+    }
+
+    // number of samples that can be read, callable from any thread
+    int getNumReady() const noexcept
+    {
+        return mPositions.getNumReady();
+    }
+
+    // number of samples that can be written, callable from any thread
+    int getFreeSpace() const noexcept
+    {
+        return mPositions.getFreeSpace();
+    }
+
+    // producer: up to samples of free space that can be filled in place, call finishWrite() afterwards
+    WriteRegions getWriteRegions(int samples) noexcept
+    {
+        assert(samples >= 0);
+        std::size_t start = 0;
+        const int available = mPositions.prepareWrite(samples, start);
+        return makeRegions<SampleType>(mBuffer.getWriteView(), start, available);
+    }
+
+    void finishWrite(int samples) noexcept
+    {
+        mPositions.finishWrite(samples);
+    }
+
+    // consumer: up to samples of ready samples that can be read in place, call finishRead() afterwards
+    ReadRegions getReadRegions(int samples) noexcept
+    {
+        assert(samples >= 0);
+        std::size_t start = 0;
+        const int available = mPositions.prepareRead(samples, start);
+        return makeRegions<const SampleType>(mBuffer.getReadView(), start, available);
+    }
+
+    void finishRead(int samples) noexcept
+    {
+        mPositions.finishRead(samples);
+    }
+
+    // producer: copies as many samples as possible and returns their number
+    int write(AudioBufferView<const SampleType> source) noexcept
+    {
+        assert(source.getNumChannels() == getNumChannels());
+        const WriteRegions regions = getWriteRegions(source.getNumSamples());
+        copyRegion(source, regions.first, 0, 0);
+        copyRegion(source, regions.second, regions.first.getNumSamples(), 0);
+        finishWrite(regions.getNumSamples());
+        return regions.getNumSamples();
+    }
+
+    // consumer: copies as many samples as possible and returns their number
+    int read(AudioBufferView<SampleType> destination) noexcept
+    {
+        assert(destination.getNumChannels() == getNumChannels());
+        const ReadRegions regions = getReadRegions(destination.getNumSamples());
+        copyRegion(regions.first, destination, 0, 0);
+        copyRegion(regions.second, destination, 0, regions.first.getNumSamples());
+        finishRead(regions.getNumSamples());
+        return regions.getNumSamples();
+    }
+
+private:
+    template <typename ViewSampleType>
+    AudioFifoRegions<AudioBufferView<ViewSampleType>> makeRegions(AudioBufferView<ViewSampleType> buffer, std::size_t start, int samples) const noexcept
+    {
+        AudioFifoRegions<AudioBufferView<ViewSampleType>> regions;
+        const int firstSamples = std::min(samples, getCapacity() - static_cast<int>(start));
+        if (firstSamples > 0)
+            regions.first = buffer.getSubBlock(static_cast<int>(start), firstSamples);
+        if (samples > firstSamples)
+            regions.second = buffer.getSubBlock(0, samples - firstSamples);
+        return regions;
+    }
+
+    // copies source[sourceOffset, ...) to destination[destinationOffset, ...), the smaller view limits the samples
+    template <typename SourceSampleType>
+    static void copyRegion(AudioBufferView<SourceSampleType> source, AudioBufferView<SampleType> destination, int sourceOffset, int destinationOffset) noexcept
+    {
+        const int samples = std::min(source.getNumSamples() - sourceOffset, destination.getNumSamples() - destinationOffset);
+        if (samples <= 0)
+            return;
+
+        for (int channel = 0; channel < destination.getNumChannels(); ++channel)
+            std::copy_n(source.getReadPointer(channel) + sourceOffset, samples, destination.getWritePointer(channel) + destinationOffset);
+    }
+
+    AudioBuffer<SampleType, MAX_CHANNELS> mBuffer;
+    detail::FifoPositions mPositions;
+};
+
+// wait-free single-producer/single-consumer FIFO for interleaved audio
+// the capacity in frames is rounded up to a power of two
+// the write functions must only be called from one thread and the read functions only from one other thread
+template <typename SampleType>
+class AudioFifoInterleaved
+{
+public:
+    using WriteRegions = AudioFifoRegions<AudioBufferInterleavedView<SampleType>>;
+    using ReadRegions = AudioFifoRegions<AudioBufferInterleavedView<const SampleType>>;
+
+    AudioFifoInterleaved() = default;
+
+    AudioFifoInterleaved(int channels, int capacity)
+    {
+        configure(channels, capacity);
+    }
+
+    // allocates memory and empties the FIFO, call e.g. at application start
+    void configure(int channels, int capacity)
+    {
+        assert(channels > 0 && capacity > 0);
+        const int roundedCapacity = detail::FifoPositions::roundUpToPowerOfTwo(capacity);
+        mBuffer.setSize(channels, roundedCapacity);
+        mPositions.setCapacity(roundedCapacity);
+    }
+
+    // empties the FIFO, not thread-safe
+    void reset() noexcept
+    {
+        mPositions.reset();
+    }
+
+    int getNumChannels() const noexcept
+    {
+        return mBuffer.getNumChannels();
+    }
+
+    int getCapacity() const noexcept
+    {
+        return mPositions.getCapacity();
+    }
+
+    // number of frames that can be read, callable from any thread
+    int getNumReady() const noexcept
+    {
+        return mPositions.getNumReady();
+    }
+
+    // number of frames that can be written, callable from any thread
+    int getFreeSpace() const noexcept
+    {
+        return mPositions.getFreeSpace();
+    }
+
+    // producer: up to samples frames of free space that can be filled in place, call finishWrite() afterwards
+    WriteRegions getWriteRegions(int samples) noexcept
+    {
+        assert(samples >= 0);
+        std::size_t start = 0;
+        const int available = mPositions.prepareWrite(samples, start);
+        return makeRegions<SampleType>(mBuffer.getWriteView(), start, available);
+    }
+
+    void finishWrite(int samples) noexcept
+    {
+        mPositions.finishWrite(samples);
+    }
+
+    // consumer: up to samples ready frames that can be read in place, call finishRead() afterwards
+    ReadRegions getReadRegions(int samples) noexcept
+    {
+        assert(samples >= 0);
+        std::size_t start = 0;
+        const int available = mPositions.prepareRead(samples, start);
+        return makeRegions<const SampleType>(mBuffer.getReadView(), start, available);
+    }
+
+    void finishRead(int samples) noexcept
+    {
+        mPositions.finishRead(samples);
+    }
+
+    // producer: copies as many frames as possible and returns their number
+    int write(AudioBufferInterleavedView<const SampleType> source) noexcept
+    {
+        assert(source.getNumChannels() == getNumChannels());
+        const WriteRegions regions = getWriteRegions(source.getNumSamples());
+        copyRegion(source, regions.first, 0, 0);
+        copyRegion(source, regions.second, regions.first.getNumSamples(), 0);
+        finishWrite(regions.getNumSamples());
+        return regions.getNumSamples();
+    }
+
+    // consumer: copies as many frames as possible and returns their number
+    int read(AudioBufferInterleavedView<SampleType> destination) noexcept
+    {
+        assert(destination.getNumChannels() == getNumChannels());
+        const ReadRegions regions = getReadRegions(destination.getNumSamples());
+        copyRegion(regions.first, destination, 0, 0);
+        copyRegion(regions.second, destination, 0, regions.first.getNumSamples());
+        finishRead(regions.getNumSamples());
+        return regions.getNumSamples();
+    }
+
+private:
+    template <typename ViewSampleType>
+    AudioFifoRegions<AudioBufferInterleavedView<ViewSampleType>> makeRegions(AudioBufferInterleavedView<ViewSampleType> buffer, std::size_t start, int samples) const noexcept
+    {
+        AudioFifoRegions<AudioBufferInterleavedView<ViewSampleType>> regions;
+        const int firstSamples = std::min(samples, getCapacity() - static_cast<int>(start));
+        if (firstSamples > 0)
+            regions.first = buffer.getSubBlock(static_cast<int>(start), firstSamples);
+        if (samples > firstSamples)
+            regions.second = buffer.getSubBlock(0, samples - firstSamples);
+        return regions;
+    }
+
+    // copies source[sourceOffset, ...) to destination[destinationOffset, ...), the smaller view limits the frames
+    template <typename SourceSampleType>
+    static void copyRegion(AudioBufferInterleavedView<SourceSampleType> source, AudioBufferInterleavedView<SampleType> destination, int sourceOffset, int destinationOffset) noexcept
+    {
+        const int samples = std::min(source.getNumSamples() - sourceOffset, destination.getNumSamples() - destinationOffset);
+        if (samples <= 0)
+            return;
+
+        const int channels = destination.getNumChannels();
+        if (source.isContiguous() && destination.isContiguous())
+        {
+            std::copy_n(source.getReadPointer() + static_cast<std::ptrdiff_t>(sourceOffset) * channels, static_cast<std::ptrdiff_t>(samples) * channels,
+                        destination.getWritePointer() + static_cast<std::ptrdiff_t>(destinationOffset) * channels);
+            return;
+        }
+
+        for (int sample = 0; sample < samples; ++sample)
+            std::copy_n(source.getReadPointer() + static_cast<std::ptrdiff_t>(sourceOffset + sample) * source.getFrameStride(), channels,
+                        destination.getWritePointer() + static_cast<std::ptrdiff_t>(destinationOffset + sample) * destination.getFrameStride());
+    }
+
+    AudioBufferInterleaved<SampleType> mBuffer;
+    detail::FifoPositions mPositions;
+};
+
+} // namespace edsp
@@ -0,0 +1,215 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#include "AudioFifo.h"
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+// the value of a sample encodes its position in the stream and its channel, so the order can be verified
+static float getTestValue(std::int64_t sample, int channel)
+{
+    return static_cast<float>((sample % 1000000) * 8 + channel);
+}
+
+static bool check(bool condition, const char* message)
+{
+    if (!condition)
+        std::cout << "  failed: " << message << "\n";
+    return condition;
+}
+
+// capacity 8: 6 written, 5 read, then the next 6 samples wrap around (2 at the end and 4 at the beginning of the storage)
+static bool testPlanarWraparound()
+{
+    constexpr int channels = 2;
+    edsp::AudioFifo<float, channels> fifo{channels, 6};
+    bool passed = check(fifo.getCapacity() == 8, "capacity is rounded up to a power of two");
+
+    std::int64_t writePosition = 0;
+    std::int64_t readPosition = 0;
+    auto writeRegion = [&](edsp::AudioBufferView<float> region)
+    {
+        for (int sample = 0; sample < region.getNumSamples(); ++sample, ++writePosition)
+            for (int channel = 0; channel < channels; ++channel)
+                region.setSample(channel, sample, getTestValue(writePosition, channel));
+    };
+    auto readRegion = [&](edsp::AudioBufferView<const float> region)
+    {
+        bool inOrder = true;
+        for (int sample = 0; sample < region.getNumSamples(); ++sample, ++readPosition)
+            for (int channel = 0; channel < channels; ++channel)
+                inOrder = inOrder && region.getSample(channel, sample) == getTestValue(readPosition, channel);
+        return inOrder;
+    };
+
+    auto writeRegions = fifo.getWriteRegions(6);
+    passed &= check(writeRegions.first.getNumSamples() == 6 && writeRegions.second.getNumSamples() == 0, "first write is not split");
+    writeRegion(writeRegions.first);
+    fifo.finishWrite(6);
+    passed &= check(fifo.getNumReady() == 6 && fifo.getFreeSpace() == 2, "ready and free space after the first write");
+
+    // only part of the regions is committed
+    auto readRegions = fifo.getReadRegions(5);
+    passed &= check(readRegions.getNumSamples() == 5 && readRegions.second.getNumSamples() == 0, "first read is not split");
+    passed &= check(readRegion(readRegions.first.getSubBlock(0, 3)), "first read");
+    fifo.finishRead(3);
+    readRegions = fifo.getReadRegions(2);
+    passed &= check(readRegion(readRegions.first), "second read");
+    fifo.finishRead(2);
+    passed &= check(fifo.getNumReady() == 1 && fifo.getFreeSpace() == 7, "ready and free space after reading");
+
+    // more than the free space is requested
+    writeRegions = fifo.getWriteRegions(10);
+    passed &= check(writeRegions.first.getNumSamples() == 2 && writeRegions.second.getNumSamples() == 5, "write wraps around");
+    passed &= check(writeRegions.first.getSampleOffset() == 6 && writeRegions.second.getSampleOffset() == 0, "second write region starts at the beginning of the storage");
+    writeRegion(writeRegions.first);
+    writeRegion(writeRegions.second.getSubBlock(0, 4));
+    fifo.finishWrite(6);
+    passed &= check(fifo.getNumReady() == 7 && fifo.getFreeSpace() == 1, "ready and free space after wrapping around");
+
+    readRegions = fifo.getReadRegions(fifo.getNumReady());
+    passed &= check(readRegions.first.getNumSamples() == 3 && readRegions.second.getNumSamples() == 4, "read wraps around");
+    passed &= check(readRegion(readRegions.first) && readRegion(readRegions.second), "wrapped read");
+    fifo.finishRead(readRegions.getNumSamples());
+    passed &= check(fifo.getNumReady() == 0 && fifo.getFreeSpace() == 8, "empty after reading everything");
+    passed &= check(fifo.getReadRegions(1).getNumSamples() == 0, "nothing can be read from an empty FIFO");
+
+    // fill completely, a full FIFO must not look empty
+    edsp::AudioBuffer<float, channels> source{channels, 8};
+    writeRegion(source.getWriteView());
+    passed &= check(fifo.write(source.getReadView()) == 8, "write fills the FIFO");
+    passed &= check(fifo.getNumReady() == 8 && fifo.getFreeSpace() == 0 && fifo.getWriteRegions(1).getNumSamples() == 0, "full FIFO");
+
+    edsp::AudioBuffer<float, channels> destination{channels, 8};
+    passed &= check(fifo.read(destination.getWriteView()) == 8 && readRegion(destination.getReadView()), "read empties the FIFO in order");
+    return passed;
+}
+
+static bool testInterleavedWraparound()
+{
+    constexpr int channels = 3;
+    edsp::AudioFifoInterleaved<float> fifo{channels, 8};
+
+    std::int64_t writePosition = 0;
+    std::int64_t readPosition = 0;
+    std::vector<float> source(static_cast<std::size_t>(8 * channels));
+    std::vector<float> destination(static_cast<std::size_t>(8 * channels));
+    auto write = [&](int samples)
+    {
+        for (int sample = 0; sample < samples; ++sample)
+            for (int channel = 0; channel < channels; ++channel)
+                source[static_cast<std::size_t>(sample * channels + channel)] = getTestValue(writePosition + sample, channel);
+        const int written = fifo.write(edsp::AudioBufferInterleavedView<const float>{source.data(), channels, samples});
+        writePosition += written;
+        return written;
+    };
+    auto read = [&](int samples)
+    {
+        const int readSamples = fifo.read(edsp::AudioBufferInterleavedView<float>{destination.data(), channels, samples});
+        bool inOrder = true;
+        for (int sample = 0; sample < readSamples; ++sample, ++readPosition)
+            for (int channel = 0; channel < channels; ++channel)
+                inOrder = inOrder && destination[static_cast<std::size_t>(sample * channels + channel)] == getTestValue(readPosition, channel);
+        return inOrder ? readSamples : -1;
+    };
+
+    bool passed = check(write(5) == 5 && read(4) == 4, "write and read before wrapping around");
+    passed &= check(write(8) == 7, "write is limited to the free space");
+
+    const auto regions = fifo.getReadRegions(8);
+    passed &= check(regions.first.getNumSamples() == 4 && regions.second.getNumSamples() == 4, "read regions are split at the end of the storage");
+    passed &= check(regions.first.getFrameStride() == channels && regions.second.getReadPointer() + 4 * channels == regions.first.getReadPointer(), "read regions point into the storage");
+
+    passed &= check(read(6) == 6 && read(8) == 2 && read(8) == 0, "wrapped reads in order");
+    passed &= check(fifo.getNumReady() == 0 && fifo.getFreeSpace() == 8, "empty after reading everything");
+    return passed;
+}
+
+// the producer writes and the consumer reads blocks of random sizes, every sample has to arrive once and in order
+static bool testProducerConsumer()
+{
+    constexpr int channels = 2;
+    constexpr std::int64_t totalSamples = 2000000;
+    edsp::AudioFifo<float, channels> planarFifo{channels, 256};
+    edsp::AudioFifoInterleaved<float> interleavedFifo{channels, 256};
+
+    // the producer writes with write() into the planar FIFO and in place into the interleaved FIFO
+    std::thread producer([&]
+                         {
+                             std::minstd_rand random{1};
+                             edsp::AudioBuffer<float, channels> block{channels, 300};
+                             std::int64_t planarPosition = 0;
+                             std::int64_t interleavedPosition = 0;
+                             while (planarPosition < totalSamples || interleavedPosition < totalSamples)
+                             {
+                                 const int samples = static_cast<int>(random() % 300) + 1;
+
+                                 const int planarSamples = static_cast<int>(std::min<std::int64_t>(samples, totalSamples - planarPosition));
+                                 if (planarSamples > 0)
+                                 {
+                                     for (int sample = 0; sample < planarSamples; ++sample)
+                                         for (int channel = 0; channel < channels; ++channel)
+                                             block.getWriteView().setSample(channel, sample, getTestValue(planarPosition + sample, channel));
+                                     planarPosition += planarFifo.write(block.getReadView().getSubBlock(0, planarSamples));
+                                 }
+
+                                 const auto regions = interleavedFifo.getWriteRegions(static_cast<int>(std::min<std::int64_t>(samples, totalSamples - interleavedPosition)));
+                                 for (const auto& region : {regions.first, regions.second})
+                                     for (int sample = 0; sample < region.getNumSamples(); ++sample, ++interleavedPosition)
+                                         for (int channel = 0; channel < channels; ++channel)
+                                             region.setSample(channel, sample, getTestValue(interleavedPosition, channel));
+                                 interleavedFifo.finishWrite(regions.getNumSamples());
+
+                                 if (samples % 7 == 0)
+                                     std::this_thread::yield();
+                             } });
+
+    // the consumer reads with read() from the planar FIFO and in place from the interleaved FIFO
+    std::minstd_rand random{2};
+    edsp::AudioBuffer<float, channels> block{channels, 300};
+    std::int64_t planarPosition = 0;
+    std::int64_t interleavedPosition = 0;
+    std::int64_t errors = 0;
+    while (planarPosition < totalSamples || interleavedPosition < totalSamples)
+    {
+        const int samples = static_cast<int>(random() % 300) + 1;
+
+        const int planarSamples = planarFifo.read(block.getWriteView().getSubBlock(0, samples));
+        for (int sample = 0; sample < planarSamples; ++sample, ++planarPosition)
+            for (int channel = 0; channel < channels; ++channel)
+                errors += block.getSample(channel, sample) != getTestValue(planarPosition, channel) ? 1 : 0;
+
+        const auto regions = interleavedFifo.getReadRegions(samples);
+        for (const auto& region : {regions.first, regions.second})
+            for (int sample = 0; sample < region.getNumSamples(); ++sample, ++interleavedPosition)
+                for (int channel = 0; channel < channels; ++channel)
+                    errors += region.getSample(channel, sample) != getTestValue(interleavedPosition, channel) ? 1 : 0;
+        interleavedFifo.finishRead(regions.getNumSamples());
+
+        if (samples % 5 == 0)
+            std::this_thread::yield();
+    }
+    producer.join();
+
+    bool passed = check(errors == 0, "samples arrive in order");
+    passed &= check(planarPosition == totalSamples && interleavedPosition == totalSamples, "all samples arrive");
+    passed &= check(planarFifo.getNumReady() == 0 && interleavedFifo.getNumReady() == 0, "nothing is left");
+    return passed;
+}
+
+int main()
+{
+    bool passed = true;
+    for (const auto& [name, test] : {std::pair{"planar wraparound", testPlanarWraparound},
+                                     std::pair{"interleaved wraparound", testInterleavedWraparound},
+                                     std::pair{"producer/consumer", testProducerConsumer}})
+    {
+        const bool testPassed = test();
+        std::cout << name << (testPassed ? " passed.\n" : " failed!\n");
+        passed &= testPassed;
+    }
+    return passed ? 0 : 1;
+}
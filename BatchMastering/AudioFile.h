@@ -0,0 +1,407 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+// streaming reader and writer for WAV files and headerless raw files with interleaved PCM samples
+// only one block of samples is held in memory, so files of any length can be processed
+// the samples are little endian, like in every WAV file, the conversion assumes a little endian machine
+
+#include "../AudioBuffer/AudioBufferConversion.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace edsp
+{
+
+enum class AudioFileSampleFormat
+{
+    Int16,
+    Int24,
+    Int32,
+    Float32
+};
+
+struct AudioFileFormat
+{
+    int channels = 0;
+    double sampleRate = 0.0;
+    AudioFileSampleFormat sampleFormat = AudioFileSampleFormat::Float32;
+};
+
+inline int getBytesPerSample(AudioFileSampleFormat sampleFormat) noexcept
+{
+    switch (sampleFormat)
+    {
+    case AudioFileSampleFormat::Int16:
+        return 2;
+    case AudioFileSampleFormat::Int24:
+        return 3;
+    case AudioFileSampleFormat::Int32:
+    case AudioFileSampleFormat::Float32:
+        return 4;
+    }
+    return 4;
+}
+
+class AudioFileException : public std::exception
+{
+public:
+    explicit AudioFileException(const std::string& message)
+            : mMessage(message)
+    {
+    }
+
+    const char* what() const noexcept override
+    {
+        return mMessage.c_str();
+    }
+
+private:
+    std::string mMessage;
+};
+
+namespace detail
+{
+
+constexpr std::uint16_t wavFormatPcm = 1;
+constexpr std::uint16_t wavFormatFloat = 3;
+constexpr std::uint16_t wavFormatExtensible = 0xfffe;
+
+// the sub format GUID of the extensible format after its first two bytes, which contain the format
+constexpr std::uint8_t wavSubFormatGuid[14] = {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71};
+
+template <typename IntegerType>
+inline IntegerType readLittleEndian(const std::uint8_t* bytes) noexcept
+{
+    IntegerType value = 0;
+    for (std::size_t byte = 0; byte < sizeof(IntegerType); ++byte)
+        value |= static_cast<IntegerType>(static_cast<IntegerType>(bytes[byte]) << (8 * byte));
+    return value;
+}
+
+template <typename IntegerType>
+inline void writeLittleEndian(std::ostream& stream, IntegerType value)
+{
+    for (std::size_t byte = 0; byte < sizeof(IntegerType); ++byte)
+        stream.put(static_cast<char>((value >> (8 * byte)) & 0xff));
+}
+
+} // namespace detail
+
+class AudioFileReader
+{
+public:
+    // reads the header, the samples are read block by block with read()
+    void openWav(const std::string& fileName)
+    {
+        open(fileName);
+
+        std::uint8_t riffHeader[12];
+        if (!readBytes(riffHeader, sizeof(riffHeader)) || std::memcmp(riffHeader, "RIFF", 4) != 0 || std::memcmp(riffHeader + 8, "WAVE", 4) != 0)
+            throw(AudioFileException(fileName + " is not a WAV file"));
+
+        bool hasFormat = false;
+        while (true)
+        {
+            std::uint8_t chunkHeader[8];
+            if (!readBytes(chunkHeader, sizeof(chunkHeader)))
+                throw(AudioFileException(fileName + " has no data chunk"));
+
+            const auto chunkSize = detail::readLittleEndian<std::uint32_t>(chunkHeader + 4);
+            if (std::memcmp(chunkHeader, "fmt ", 4) == 0)
+            {
+                std::vector<std::uint8_t> chunk(chunkSize);
+                if (chunkSize < 16 || !readBytes(chunk.data(), chunk.size()))
+                    throw(AudioFileException(fileName + " has an invalid format chunk"));
+                mFormat = parseFormatChunk(chunk, fileName);
+                hasFormat = true;
+                skipPadByte(chunkSize);
+            }
+            else if (std::memcmp(chunkHeader, "data", 4) == 0)
+            {
+                if (!hasFormat)
+                    throw(AudioFileException(fileName + " has no format chunk before the data chunk"));
+
+                // some writers that stream to a pipe leave the size at 0 or 0xffffffff, then the data ends with the file
+                const std::int64_t fileFrames = (getFileSize() - static_cast<std::int64_t>(mFile.tellg())) / getFrameSize();
+                const std::int64_t chunkFrames = static_cast<std::int64_t>(chunkSize) / getFrameSize();
+                mRemainingFrames = chunkSize == 0 || chunkSize == std::numeric_limits<std::uint32_t>::max() ? fileFrames : std::min(chunkFrames, fileFrames);
+                return;
+            }
+            else
+            {
+                mFile.seekg(static_cast<std::streamoff>(chunkSize), std::ios::cur);
+                skipPadByte(chunkSize);
+            }
+        }
+    }
+
+    // raw files have no header, so the format has to be known
+    void openRaw(const std::string& fileName, const AudioFileFormat& format)
+    {
+        if (format.channels <= 0 || format.sampleRate <= 0.0)
+            throw(AudioFileException("the channels and the sample rate of the raw file " + fileName + " are missing"));
+
+        open(fileName);
+        mFormat = format;
+        mRemainingFrames = getFileSize() / getFrameSize();
+    }
+
+    const AudioFileFormat& getFormat() const noexcept
+    {
+        return mFormat;
+    }
+
+    std::int64_t getRemainingFrames() const noexcept
+    {
+        return mRemainingFrames;
+    }
+
+    // reads up to frames interleaved frames and converts them to float, returns the number of frames read, 0 at the end of the file
+    int read(float* destination, int frames)
+    {
+        frames = static_cast<int>(std::min(static_cast<std::int64_t>(frames), mRemainingFrames));
+        if (frames <= 0)
+            return 0;
+
+        const int samples = frames * mFormat.channels;
+        const std::size_t bytes = static_cast<std::size_t>(frames) * static_cast<std::size_t>(getFrameSize());
+        if (mFormat.sampleFormat == AudioFileSampleFormat::Float32)
+        {
+            if (!readBytes(destination, bytes))
+                throw(AudioFileException("reading failed"));
+        }
+        else
+        {
+            mBytes.resize(std::max(mBytes.size(), bytes));
+            if (!readBytes(mBytes.data(), bytes))
+                throw(AudioFileException("reading failed"));
+
+            if (mFormat.sampleFormat == AudioFileSampleFormat::Int16)
+                convertSamples(reinterpret_cast<const std::int16_t*>(mBytes.data()), destination, samples);
+            else if (mFormat.sampleFormat == AudioFileSampleFormat::Int24)
+                convertSamples(reinterpret_cast<const PackedInt24*>(mBytes.data()), destination, samples);
+            else
+                convertSamples(reinterpret_cast<const std::int32_t*>(mBytes.data()), destination, samples);
+        }
+
+        mRemainingFrames -= frames;
+        return frames;
+    }
+
+private:
+    void open(const std::string& fileName)
+    {
+        mFile.close();
+        mFile.clear();
+        mFile.open(fileName, std::ios::binary);
+        if (!mFile.is_open())
+            throw(AudioFileException("could not open " + fileName));
+        mFileName = fileName;
+        mRemainingFrames = 0;
+    }
+
+    AudioFileFormat parseFormatChunk(const std::vector<std::uint8_t>& chunk, const std::string& fileName) const
+    {
+        auto formatTag = detail::readLittleEndian<std::uint16_t>(chunk.data());
+        const auto channels = detail::readLittleEndian<std::uint16_t>(chunk.data() + 2);
+        const auto sampleRate = detail::readLittleEndian<std::uint32_t>(chunk.data() + 4);
+        const auto bitsPerSample = detail::readLittleEndian<std::uint16_t>(chunk.data() + 14);
+
+        // the extensible format stores the actual format in the first two bytes of the sub format GUID
+        if (formatTag == detail::wavFormatExtensible && chunk.size() >= 26)
+            formatTag = detail::readLittleEndian<std::uint16_t>(chunk.data() + 24);
+
+        AudioFileFormat format;
+        format.channels = channels;
+        format.sampleRate = sampleRate;
+        if (formatTag == detail::wavFormatPcm && bitsPerSample == 16)
+            format.sampleFormat = AudioFileSampleFormat::Int16;
+        else if (formatTag == detail::wavFormatPcm && bitsPerSample == 24)
+            format.sampleFormat = AudioFileSampleFormat::Int24;
+        else if (formatTag == detail::wavFormatPcm && bitsPerSample == 32)
+            format.sampleFormat = AudioFileSampleFormat::Int32;
+        else if (formatTag == detail::wavFormatFloat && bitsPerSample == 32)
+            format.sampleFormat = AudioFileSampleFormat::Float32;
+        else
+            throw(AudioFileException(fileName + " has an unsupported sample format (16, 24 or 32 bit integer or 32 bit float)"));
+
+        if (format.channels <= 0 || format.sampleRate <= 0.0)
+            throw(AudioFileException(fileName + " has no channels or no sample rate"));
+
+        return format;
+    }
+
+    // chunks are padded to an even size, the pad byte is not part of the chunk size
+    void skipPadByte(std::uint32_t chunkSize)
+    {
+        if ((chunkSize & 1) != 0)
+            mFile.seekg(1, std::ios::cur);
+    }
+
+    bool readBytes(void* destination, std::size_t bytes)
+    {
+        mFile.read(static_cast<char*>(destination), static_cast<std::streamsize>(bytes));
+        return static_cast<std::size_t>(mFile.gcount()) == bytes;
+    }
+
+    std::int64_t getFileSize()
+    {
+        const std::streampos position = mFile.tellg();
+        mFile.seekg(0, std::ios::end);
+        const std::streampos size = mFile.tellg();
+        mFile.seekg(position);
+        return static_cast<std::int64_t>(size);
+    }
+
+    int getFrameSize() const noexcept
+    {
+        return mFormat.channels * getBytesPerSample(mFormat.sampleFormat);
+    }
+
+    std::ifstream mFile;
+    std::string mFileName;
+    AudioFileFormat mFormat;
+    std::int64_t mRemainingFrames = 0;
+    std::vector<std::uint8_t> mBytes;
+};
+
+class AudioFileWriter
+{
+public:
+    AudioFileWriter() = default;
+
+    ~AudioFileWriter()
+    {
+        try
+        {
+            close();
+        }
+        catch (const AudioFileException&)
+        {
+        }
+    }
+
+    AudioFileWriter(const AudioFileWriter&) = delete;
+    AudioFileWriter& operator=(const AudioFileWriter&) = delete;
+
+    // writes a WAV header, its sizes are filled in by close()
+    // more than 2 channels or more than 16 bits per sample are written in the extensible format, like the WAV specification requires
+    // the speaker positions are only set for mono and stereo files
+    // 16 and 24 bit samples are dithered, every file should get its own ditherSeed
+    void openWav(const std::string& fileName, const AudioFileFormat& format, std::uint32_t ditherSeed = 1)
+    {
+        close();
+
+        mFile.open(fileName, std::ios::binary | std::ios::trunc);
+        if (!mFile.is_open())
+            throw(AudioFileException("could not create " + fileName));
+        mFileName = fileName;
+        mFormat = format;
+        mDataBytes = 0;
+        mDither.reset(ditherSeed);
+
+        const auto bytesPerSample = static_cast<std::uint16_t>(getBytesPerSample(format.sampleFormat));
+        const auto blockAlign = static_cast<std::uint16_t>(format.channels * bytesPerSample);
+        const auto sampleRate = static_cast<std::uint32_t>(format.sampleRate + 0.5);
+        const std::uint16_t formatTag = format.sampleFormat == AudioFileSampleFormat::Float32 ? detail::wavFormatFloat : detail::wavFormatPcm;
+        const bool extensible = format.channels > 2 || bytesPerSample > 2;
+
+        mFile.write("RIFF", 4);
+        detail::writeLittleEndian<std::uint32_t>(mFile, 0);
+        mFile.write("WAVEfmt ", 8);
+        detail::writeLittleEndian<std::uint32_t>(mFile, extensible ? 40 : 16);
+        detail::writeLittleEndian<std::uint16_t>(mFile, extensible ? detail::wavFormatExtensible : formatTag);
+        detail::writeLittleEndian<std::uint16_t>(mFile, static_cast<std::uint16_t>(format.channels));
+        detail::writeLittleEndian<std::uint32_t>(mFile, sampleRate);
+        detail::writeLittleEndian<std::uint32_t>(mFile, sampleRate * blockAlign);
+        detail::writeLittleEndian<std::uint16_t>(mFile, blockAlign);
+        detail::writeLittleEndian<std::uint16_t>(mFile, static_cast<std::uint16_t>(8 * bytesPerSample));
+        if (extensible)
+        {
+            // extension size, valid bits per sample, speaker positions (front center or front left and right) and sub format
+            const std::uint32_t channelMask = format.channels == 1 ? 0x4 : (format.channels == 2 ? 0x3 : 0);
+            detail::writeLittleEndian<std::uint16_t>(mFile, 22);
+            detail::writeLittleEndian<std::uint16_t>(mFile, static_cast<std::uint16_t>(8 * bytesPerSample));
+            detail::writeLittleEndian<std::uint32_t>(mFile, channelMask);
+            detail::writeLittleEndian<std::uint16_t>(mFile, formatTag);
+            mFile.write(reinterpret_cast<const char*>(detail::wavSubFormatGuid), sizeof(detail::wavSubFormatGuid));
+        }
+        mFile.write("data", 4);
+        mDataSizePosition = static_cast<std::uint64_t>(mFile.tellp());
+        detail::writeLittleEndian<std::uint32_t>(mFile, 0);
+
+        if (!mFile.good())
+            throw(AudioFileException("writing " + fileName + " failed"));
+    }
+
+    // converts and writes interleaved frames
+    void write(const float* source, int frames)
+    {
+        if (frames <= 0)
+            return;
+
+        const int samples = frames * mFormat.channels;
+        const std::size_t bytes = static_cast<std::size_t>(samples) * static_cast<std::size_t>(getBytesPerSample(mFormat.sampleFormat));
+        if (mFormat.sampleFormat == AudioFileSampleFormat::Float32)
+        {
+            mFile.write(reinterpret_cast<const char*>(source), static_cast<std::streamsize>(bytes));
+        }
+        else
+        {
+            mBytes.resize(std::max(mBytes.size(), bytes));
+            if (mFormat.sampleFormat == AudioFileSampleFormat::Int16)
+                convertSamples(source, reinterpret_cast<std::int16_t*>(mBytes.data()), samples, &mDither);
+            else if (mFormat.sampleFormat == AudioFileSampleFormat::Int24)
+                convertSamples(source, reinterpret_cast<PackedInt24*>(mBytes.data()), samples, &mDither);
+            else
+                convertSamples(source, reinterpret_cast<std::int32_t*>(mBytes.data()), samples);
+            mFile.write(reinterpret_cast<const char*>(mBytes.data()), static_cast<std::streamsize>(bytes));
+        }
+
+        if (!mFile.good())
+            throw(AudioFileException("writing " + mFileName + " failed"));
+        mDataBytes += static_cast<std::uint64_t>(bytes);
+    }
+
+    // pads the data chunk and fills in the sizes of the header, larger files than 4 GB get the maximum size like most writers do
+    void close()
+    {
+        if (!mFile.is_open())
+            return;
+
+        if (mDataBytes & 1)
+            mFile.put(0);
+
+        // the RIFF chunk contains everything after its size
+        constexpr std::uint64_t maxSize = std::numeric_limits<std::uint32_t>::max();
+        const std::uint64_t riffSize = mDataSizePosition - 4 + mDataBytes + (mDataBytes & 1);
+        mFile.seekp(4);
+        detail::writeLittleEndian<std::uint32_t>(mFile, static_cast<std::uint32_t>(std::min(riffSize, maxSize)));
+        mFile.seekp(static_cast<std::streamoff>(mDataSizePosition));
+        detail::writeLittleEndian<std::uint32_t>(mFile, static_cast<std::uint32_t>(std::min(mDataBytes, maxSize)));
+
+        const bool good = mFile.good();
+        mFile.close();
+        if (!good)
+            throw(AudioFileException("writing " + mFileName + " failed"));
+    }
+
+private:
+    std::ofstream mFile;
+    std::string mFileName;
+    AudioFileFormat mFormat;
+    std::uint64_t mDataSizePosition = 0;
+    std::uint64_t mDataBytes = 0;
+    TpdfDither mDither;
+    std::vector<std::uint8_t> mBytes;
+};
+
+} // namespace edsp
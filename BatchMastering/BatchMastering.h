@@ -0,0 +1,312 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+// offline mastering of many files: every file is streamed block by block through a Resampler and a LookAheadLimiter
+// the files are processed in parallel on a ThreadPool, the memory per file only depends on the block size
+
+#include "../LookAheadLimiter/LookAheadLimiter.h"
+#include "../Resampler/Resampler.h"
+#include "../ThreadPool/ThreadPool.h"
+#include "AudioFile.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace edsp
+{
+
+struct MasteringSettings
+{
+    double outputSampleRate = 0.0;                            // 0 keeps the sample rate of the input
+    ResamplerQuality resamplerQuality = ResamplerQuality::Best;
+    std::optional<AudioFileSampleFormat> outputSampleFormat;  // the sample format of the input if not set
+    float attackMs = 5.0f;
+    float releaseMs = 50.0f;
+    float thresholdInDb = -1.0f;
+    float makeupGainInDb = 0.0f;
+    PeakDetection peakDetection = PeakDetection::SamplePeak;
+    int blockSize = 65536;                                    // frames per block
+    bool rawInput = false;                                    // headerless input files with rawFormat instead of WAV files
+    AudioFileFormat rawFormat;
+};
+
+struct MasteringJob
+{
+    std::string inputFile;
+    std::string outputFile;
+};
+
+struct MasteringResult
+{
+    std::string inputFile;
+    std::string outputFile;
+    std::string error;             // empty on success
+    std::int64_t inputFrames = 0;
+    std::int64_t outputFrames = 0;
+    double audioSeconds = 0.0;     // duration of the input
+    double processingSeconds = 0.0;
+    GainReductionStatistics gainReduction;
+
+    bool succeeded() const noexcept
+    {
+        return error.empty();
+    }
+
+    // seconds of audio processed per second
+    double getRealtimeFactor() const noexcept
+    {
+        return processingSeconds > 0.0 ? audioSeconds / processingSeconds : 0.0;
+    }
+};
+
+namespace detail
+{
+
+// resamples and limits interleaved blocks and passes the result to the writer
+// the latency of the limiter is removed, so the output is aligned with the input
+class MasteringChain
+{
+public:
+    MasteringChain(const AudioFileFormat& inputFormat, double outputSampleRate, const MasteringSettings& settings, AudioFileWriter& writer)
+            : mChannels(inputFormat.channels),
+              mBlockSize(settings.blockSize),
+              mWriter(writer),
+              mOutput(static_cast<std::size_t>(inputFormat.channels) * static_cast<std::size_t>(settings.blockSize))
+    {
+        if (outputSampleRate != inputFormat.sampleRate)
+            mResampler.emplace(mChannels, inputFormat.sampleRate, outputSampleRate, settings.resamplerQuality);
+
+        mLimiter.configure(settings.attackMs, settings.releaseMs, settings.thresholdInDb, settings.makeupGainInDb, mChannels, outputSampleRate, settings.peakDetection);
+        mLimiter.setStatisticsEnabled(true);
+        mLatencyToSkip = mLimiter.getLatencyInSamples();
+    }
+
+    // the buffer is used as scratch memory
+    void process(float* buffer, int frames)
+    {
+        if (!mResampler)
+        {
+            limitAndWrite(buffer, frames);
+            return;
+        }
+
+        while (frames > 0)
+        {
+            const ResamplerProgress progress = mResampler->process(buffer, frames, mOutput.data(), mBlockSize, false);
+            if (progress.inputSamplesUsed == 0 && progress.outputSamplesGenerated == 0)
+                throw(AudioFileException("resampling failed"));
+
+            buffer += static_cast<std::ptrdiff_t>(progress.inputSamplesUsed) * mChannels;
+            frames -= progress.inputSamplesUsed;
+            limitAndWrite(mOutput.data(), progress.outputSamplesGenerated);
+        }
+    }
+
+    // flushes the resampler and the delay line of the limiter
+    void finish()
+    {
+        if (mResampler)
+        {
+            while (true)
+            {
+                const ResamplerProgress progress = mResampler->process(nullptr, 0, mOutput.data(), mBlockSize, true);
+                if (progress.outputSamplesGenerated == 0)
+                    break;
+                limitAndWrite(mOutput.data(), progress.outputSamplesGenerated);
+            }
+        }
+
+        for (int remaining = mLimiter.getLatencyInSamples(); remaining > 0;)
+        {
+            const int frames = std::min(remaining, mBlockSize);
+            std::fill(mOutput.begin(), mOutput.begin() + static_cast<std::ptrdiff_t>(frames) * mChannels, 0.0f);
+            limitAndWrite(mOutput.data(), frames);
+            remaining -= frames;
+        }
+    }
+
+    std::int64_t getOutputFrames() const noexcept
+    {
+        return mOutputFrames;
+    }
+
+    const GainReductionStatistics& getGainReduction() const noexcept
+    {
+        return mGainReduction;
+    }
+
+private:
+    void limitAndWrite(float* buffer, int frames)
+    {
+        if (frames <= 0)
+            return;
+
+        mLimiter.process(buffer, frames);
+
+        GainReductionStatistics statistics;
+        if (mLimiter.pollStatistics(statistics))
+            mGainReduction.merge(statistics);
+
+        // the first frames only contain the delay line of the limiter
+        const int skipped = std::min(frames, mLatencyToSkip);
+        mLatencyToSkip -= skipped;
+        mWriter.write(buffer + static_cast<std::ptrdiff_t>(skipped) * mChannels, frames - skipped);
+        mOutputFrames += frames - skipped;
+    }
+
+    int mChannels;
+    int mBlockSize;
+    AudioFileWriter& mWriter;
+    std::vector<float> mOutput;
+    std::optional<Resampler> mResampler;
+    BasicLookAheadLimiter<float> mLimiter;
+    int mLatencyToSkip = 0;
+    std::int64_t mOutputFrames = 0;
+    GainReductionStatistics mGainReduction;
+};
+
+} // namespace detail
+
+// masters one file on the calling thread, errors are reported in the result
+inline MasteringResult masterFile(const MasteringJob& job, const MasteringSettings& settings, std::uint32_t ditherSeed = 1)
+{
+    MasteringResult result;
+    result.inputFile = job.inputFile;
+    result.outputFile = job.outputFile;
+
+    const auto start = std::chrono::steady_clock::now();
+    bool outputCreated = false;
+    try
+    {
+        AudioFileReader reader;
+        if (settings.rawInput)
+            reader.openRaw(job.inputFile, settings.rawFormat);
+        else
+            reader.openWav(job.inputFile);
+
+        const AudioFileFormat& inputFormat = reader.getFormat();
+        AudioFileFormat outputFormat = inputFormat;
+        if (settings.outputSampleRate > 0.0)
+            outputFormat.sampleRate = settings.outputSampleRate;
+        if (settings.outputSampleFormat)
+            outputFormat.sampleFormat = *settings.outputSampleFormat;
+
+        AudioFileWriter writer;
+        writer.openWav(job.outputFile, outputFormat, ditherSeed);
+        outputCreated = true;
+
+        detail::MasteringChain chain(inputFormat, outputFormat.sampleRate, settings, writer);
+        std::vector<float> input(static_cast<std::size_t>(inputFormat.channels) * static_cast<std::size_t>(settings.blockSize));
+        for (int frames = reader.read(input.data(), settings.blockSize); frames > 0; frames = reader.read(input.data(), settings.blockSize))
+        {
+            chain.process(input.data(), frames);
+            result.inputFrames += frames;
+        }
+        chain.finish();
+        writer.close();
+
+        result.outputFrames = chain.getOutputFrames();
+        result.audioSeconds = static_cast<double>(result.inputFrames) / inputFormat.sampleRate;
+        result.gainReduction = chain.getGainReduction();
+    }
+    catch (const std::exception& e)
+    {
+        result.error = e.what();
+    }
+
+    // a truncated file must not look like a finished one
+    if (!result.succeeded() && outputCreated)
+        std::remove(job.outputFile.c_str());
+
+    result.processingSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+namespace detail
+{
+
+// shared by masterFiles() and its worker tasks, a task that starts after masterFiles() returned only accesses this state
+struct MasteringBatch
+{
+    // takes the next file until none is left
+    void processJobs()
+    {
+        for (std::size_t job = nextJob++; job < jobs->size(); job = nextJob++)
+            (*results)[job] = masterFile((*jobs)[job], *settings, static_cast<std::uint32_t>(job + 1));
+    }
+
+    // only joins while masterFiles() is running, masterFiles() waits for it from then on
+    void runTask()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!batchOpen)
+                return;
+            ++runningTasks;
+        }
+
+        processJobs();
+
+        // notified while locked, so masterFiles() can not return in between
+        std::lock_guard<std::mutex> lock(mutex);
+        --runningTasks;
+        taskFinished.notify_one();
+    }
+
+    const std::vector<MasteringJob>* jobs = nullptr;
+    const MasteringSettings* settings = nullptr;
+    std::vector<MasteringResult>* results = nullptr;
+    std::atomic<std::size_t> nextJob{0};
+
+    std::mutex mutex;
+    std::condition_variable taskFinished;
+    bool batchOpen = true;
+    int runningTasks = 0;
+};
+
+} // namespace detail
+
+// masters all files with up to workers files in parallel and returns when all files are done
+// the calling thread and up to workers - 1 tasks of the ThreadPool take the next file until none is left,
+// so the queue of the ThreadPool only holds one task per worker and the files are processed even if no task gets to run
+// the calling thread only waits for tasks that are still processing a file
+template <int MAX_QUEUE_SIZE>
+inline std::vector<MasteringResult> masterFiles(ThreadPool<MAX_QUEUE_SIZE>& threadPool, const std::vector<MasteringJob>& jobs, const MasteringSettings& settings, int workers)
+{
+    std::vector<MasteringResult> results(jobs.size());
+    auto batch = std::make_shared<detail::MasteringBatch>();
+    batch->jobs = &jobs;
+    batch->settings = &settings;
+    batch->results = &results;
+
+    workers = std::max(1, std::min(workers, static_cast<int>(jobs.size())));
+    for (int i = 1; i < workers; ++i)
+    {
+        if (!threadPool.enqueue([batch]
+                                { batch->runTask(); }))
+            break;
+    }
+
+    batch->processJobs();
+
+    // tasks that have not started yet return without accessing the jobs
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->batchOpen = false;
+    batch->taskFinished.wait(lock, [&batch]
+                             { return batch->runningTasks == 0; });
+    return results;
+}
+
+} // namespace edsp
@@ -0,0 +1,182 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#include "BatchMastering.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct Settings
+{
+    edsp::MasteringSettings mastering;
+    std::string outputDirectory;
+    int jobs = std::thread::hardware_concurrency() > 0 ? static_cast<int>(std::thread::hardware_concurrency()) : 1;
+    std::vector<std::string> inputFiles;
+};
+
+void printUsage()
+{
+    std::cout << "usage: batchMastering [options] <input files>\n"
+              << "  --output-dir <directory>   directory of the output files, default next to the input files\n"
+              << "  --rate <Hz>                output sample rate, default the sample rate of the input\n"
+              << "  --quality <name>           resampler quality: fast, medium or best, default best\n"
+              << "  --format <name>            output sample format: 16, 24, 32 or float, default the format of the input\n"
+              << "  --attack <ms>              limiter attack/lookahead, default 5\n"
+              << "  --release <ms>             limiter release, default 50\n"
+              << "  --threshold <dB>           limiter threshold, default -1\n"
+              << "  --makeup <dB>              makeup gain, default 0\n"
+              << "  --true-peak                limit the true peaks instead of the sample peaks\n"
+              << "  --block <frames>           frames per block, determines the memory per file, default 65536\n"
+              << "  --jobs <n>                 files processed in parallel, default the number of hardware threads\n"
+              << "  --raw <name>               the input files are headerless with the sample format 16, 24, 32 or float\n"
+              << "  --channels <channels>      channels of the raw input files\n"
+              << "  --input-rate <Hz>          sample rate of the raw input files\n"
+              << "the output files are WAV files named <input name>_mastered.wav\n";
+}
+
+bool parseSampleFormat(const std::string& name, edsp::AudioFileSampleFormat& sampleFormat)
+{
+    if (name == "16")
+        sampleFormat = edsp::AudioFileSampleFormat::Int16;
+    else if (name == "24")
+        sampleFormat = edsp::AudioFileSampleFormat::Int24;
+    else if (name == "32")
+        sampleFormat = edsp::AudioFileSampleFormat::Int32;
+    else if (name == "float")
+        sampleFormat = edsp::AudioFileSampleFormat::Float32;
+    else
+        return false;
+    return true;
+}
+
+bool parseQuality(const std::string& name, edsp::ResamplerQuality& quality)
+{
+    if (name == "fast")
+        quality = edsp::ResamplerQuality::Fast;
+    else if (name == "medium")
+        quality = edsp::ResamplerQuality::Medium;
+    else if (name == "best")
+        quality = edsp::ResamplerQuality::Best;
+    else
+        return false;
+    return true;
+}
+
+bool parseArguments(int argc, char** argv, Settings& settings)
+{
+    edsp::MasteringSettings& mastering = settings.mastering;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (argument == "--output-dir" && hasValue)
+            settings.outputDirectory = argv[++i];
+        else if (argument == "--rate" && hasValue)
+            mastering.outputSampleRate = std::atof(argv[++i]);
+        else if (argument == "--quality" && hasValue)
+        {
+            if (!parseQuality(argv[++i], mastering.resamplerQuality))
+                return false;
+        }
+        else if (argument == "--format" && hasValue)
+        {
+            edsp::AudioFileSampleFormat sampleFormat;
+            if (!parseSampleFormat(argv[++i], sampleFormat))
+                return false;
+            mastering.outputSampleFormat = sampleFormat;
+        }
+        else if (argument == "--attack" && hasValue)
+            mastering.attackMs = static_cast<float>(std::atof(argv[++i]));
+        else if (argument == "--release" && hasValue)
+            mastering.releaseMs = static_cast<float>(std::atof(argv[++i]));
+        else if (argument == "--threshold" && hasValue)
+            mastering.thresholdInDb = static_cast<float>(std::atof(argv[++i]));
+        else if (argument == "--makeup" && hasValue)
+            mastering.makeupGainInDb = static_cast<float>(std::atof(argv[++i]));
+        else if (argument == "--true-peak")
+            mastering.peakDetection = edsp::PeakDetection::TruePeak;
+        else if (argument == "--block" && hasValue)
+            mastering.blockSize = std::atoi(argv[++i]);
+        else if (argument == "--jobs" && hasValue)
+            settings.jobs = std::atoi(argv[++i]);
+        else if (argument == "--raw" && hasValue)
+        {
+            mastering.rawInput = true;
+            if (!parseSampleFormat(argv[++i], mastering.rawFormat.sampleFormat))
+                return false;
+        }
+        else if (argument == "--channels" && hasValue)
+            mastering.rawFormat.channels = std::atoi(argv[++i]);
+        else if (argument == "--input-rate" && hasValue)
+            mastering.rawFormat.sampleRate = std::atof(argv[++i]);
+        else if (argument.rfind("--", 0) == 0)
+            return false;
+        else
+            settings.inputFiles.push_back(argument);
+    }
+
+    return !settings.inputFiles.empty() && mastering.outputSampleRate >= 0.0 && mastering.attackMs > 0.0f && mastering.releaseMs > 0.0f && mastering.blockSize > 0 && settings.jobs > 0;
+}
+
+std::string getOutputFile(const std::string& inputFile, const std::string& outputDirectory)
+{
+    const std::filesystem::path input(inputFile);
+    const std::filesystem::path directory = outputDirectory.empty() ? input.parent_path() : std::filesystem::path(outputDirectory);
+    return (directory / (input.stem().string() + "_mastered.wav")).string();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Settings settings;
+    if (!parseArguments(argc, argv, settings))
+    {
+        printUsage();
+        return argc == 2 && std::string(argv[1]) == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (!settings.outputDirectory.empty())
+        std::filesystem::create_directories(settings.outputDirectory);
+
+    std::vector<edsp::MasteringJob> jobs;
+    for (const std::string& inputFile : settings.inputFiles)
+        jobs.push_back({inputFile, getOutputFile(inputFile, settings.outputDirectory)});
+
+    const auto start = std::chrono::steady_clock::now();
+    edsp::ThreadPool<256> threadPool;
+    const std::vector<edsp::MasteringResult> results = edsp::masterFiles(threadPool, jobs, settings.mastering, settings.jobs);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int failed = 0;
+    double audioSeconds = 0.0;
+    std::cout << std::fixed << std::setprecision(2);
+    for (const edsp::MasteringResult& result : results)
+    {
+        if (!result.succeeded())
+        {
+            std::cout << result.inputFile << ": " << result.error << "\n";
+            ++failed;
+            continue;
+        }
+
+        audioSeconds += result.audioSeconds;
+        std::cout << result.inputFile << " -> " << result.outputFile << ": " << result.audioSeconds << " s audio in " << result.processingSeconds << " s ("
+                  << result.getRealtimeFactor() << "x realtime), max gain reduction " << -20.0f * std::log10(result.gainReduction.minGain) << " dB, clamped samples "
+                  << result.gainReduction.clampedSamples << "\n";
+    }
+
+    std::cout << "files: " << results.size() - static_cast<std::size_t>(failed) << " of " << results.size() << ", " << audioSeconds << " s audio in " << seconds << " s ("
+              << (seconds > 0.0 ? audioSeconds / seconds : 0.0) << "x realtime)\n";
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
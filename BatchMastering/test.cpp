@@ -0,0 +1,293 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#include "AudioFile.h"
+#include "BatchMastering.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+static bool check(bool condition, const std::string& message)
+{
+    if (!condition)
+        std::cout << "  failed: " << message << "\n";
+    return condition;
+}
+
+static std::string getTestFile(const std::string& name)
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "edspBatchMasteringTest";
+    std::filesystem::create_directories(directory);
+    return (directory / name).string();
+}
+
+static std::vector<std::uint8_t> readFile(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+static std::vector<float> createNoise(int channels, int frames, unsigned int seed)
+{
+    std::mt19937 random{seed};
+    std::uniform_real_distribution<float> distribution{-1.0f, 1.0f};
+    std::vector<float> noise(static_cast<std::size_t>(channels) * static_cast<std::size_t>(frames));
+    for (float& sample : noise)
+        sample = distribution(random);
+    return noise;
+}
+
+// reads the whole file in blocks of an odd number of frames
+static std::vector<float> readWav(const std::string& fileName, edsp::AudioFileFormat& format)
+{
+    edsp::AudioFileReader reader;
+    reader.openWav(fileName);
+    format = reader.getFormat();
+    std::vector<float> samples;
+    std::vector<float> block(static_cast<std::size_t>(format.channels) * 37);
+    for (int frames = reader.read(block.data(), 37); frames > 0; frames = reader.read(block.data(), 37))
+        samples.insert(samples.end(), block.begin(), block.begin() + static_cast<std::ptrdiff_t>(frames) * format.channels);
+    return samples;
+}
+
+// odd frame counts, so 24 bit mono files need a pad byte after the data
+static bool testWavRoundTrip()
+{
+    using edsp::AudioFileSampleFormat;
+    bool passed = true;
+    for (const auto& [sampleFormat, name] : {std::pair{AudioFileSampleFormat::Int16, "16 bit"}, std::pair{AudioFileSampleFormat::Int24, "24 bit"},
+                                             std::pair{AudioFileSampleFormat::Int32, "32 bit"}, std::pair{AudioFileSampleFormat::Float32, "float"}})
+    {
+        for (const int channels : {1, 2, 3, 6})
+        {
+            constexpr int frames = 1001;
+            const std::string description = std::string{name} + ", " + std::to_string(channels) + " channels";
+            const std::string fileName = getTestFile("roundTrip.wav");
+            const std::vector<float> samples = createNoise(channels, frames, static_cast<unsigned int>(channels));
+
+            const edsp::AudioFileFormat format{channels, 44100.0, sampleFormat};
+            {
+                edsp::AudioFileWriter writer;
+                writer.openWav(fileName, format);
+                writer.write(samples.data(), 500);
+                writer.write(samples.data() + 500 * channels, frames - 500);
+                writer.close();
+            }
+
+            // the sizes in the header
+            const std::vector<std::uint8_t> bytes = readFile(fileName);
+            const int bytesPerSample = edsp::getBytesPerSample(sampleFormat);
+            const bool extensible = channels > 2 || bytesPerSample > 2;
+            const std::size_t headerSize = extensible ? 68 : 44;
+            const std::size_t dataBytes = static_cast<std::size_t>(frames * channels * bytesPerSample);
+            passed &= check(bytes.size() == headerSize + dataBytes + (dataBytes & 1), "file size (" + description + ")");
+            passed &= check(bytes.size() >= headerSize && edsp::detail::readLittleEndian<std::uint32_t>(bytes.data() + 4) == bytes.size() - 8, "RIFF size (" + description + ")");
+            passed &= check(bytes.size() >= headerSize && edsp::detail::readLittleEndian<std::uint32_t>(bytes.data() + headerSize - 4) == dataBytes, "data size (" + description + ")");
+
+            // WAVE_FORMAT_EXTENSIBLE for more than 2 channels or more than 16 bits
+            const std::uint16_t formatTag = sampleFormat == AudioFileSampleFormat::Float32 ? 3 : 1;
+            passed &= check(edsp::detail::readLittleEndian<std::uint32_t>(bytes.data() + 16) == (extensible ? 40u : 16u), "format chunk size (" + description + ")");
+            passed &= check(edsp::detail::readLittleEndian<std::uint16_t>(bytes.data() + 20) == (extensible ? 0xfffe : formatTag), "format tag (" + description + ")");
+            if (extensible)
+            {
+                passed &= check(edsp::detail::readLittleEndian<std::uint16_t>(bytes.data() + 36) == 22, "extension size (" + description + ")");
+                passed &= check(edsp::detail::readLittleEndian<std::uint16_t>(bytes.data() + 38) == 8 * bytesPerSample, "valid bits (" + description + ")");
+                passed &= check(edsp::detail::readLittleEndian<std::uint16_t>(bytes.data() + 44) == formatTag, "sub format (" + description + ")");
+            }
+
+            edsp::AudioFileFormat readFormat;
+            const std::vector<float> readSamples = readWav(fileName, readFormat);
+            passed &= check(readFormat.channels == channels && readFormat.sampleRate == 44100.0 && readFormat.sampleFormat == sampleFormat, "format (" + description + ")");
+            passed &= check(readSamples.size() == samples.size(), "frames (" + description + ")");
+
+            // 16 and 24 bit samples are dithered, float can not hold 32 bit samples exactly
+            const double lsb = sampleFormat == AudioFileSampleFormat::Int16 ? 1.0 / 32768.0 : (sampleFormat == AudioFileSampleFormat::Int24 ? 1.0 / 8388608.0 : 0.0);
+            const double tolerance = sampleFormat == AudioFileSampleFormat::Float32 ? 0.0 : (lsb > 0.0 ? 1.5 * lsb : 1.0e-7);
+            double error = 0.0;
+            for (std::size_t i = 0; i < std::min(samples.size(), readSamples.size()); ++i)
+                error = std::max(error, std::fabs(static_cast<double>(readSamples[i]) - static_cast<double>(samples[i])));
+            passed &= check(error <= tolerance, "samples (" + description + "), error " + std::to_string(error));
+        }
+    }
+    return passed;
+}
+
+// a format chunk and an unknown chunk of odd size are followed by a pad byte, which is not part of the chunk size
+static bool testOddChunkSizes()
+{
+    std::vector<std::uint8_t> bytes;
+    auto put16 = [&](std::uint16_t value)
+    {
+        bytes.push_back(static_cast<std::uint8_t>(value));
+        bytes.push_back(static_cast<std::uint8_t>(value >> 8));
+    };
+    auto put32 = [&](std::uint32_t value)
+    {
+        put16(static_cast<std::uint16_t>(value));
+        put16(static_cast<std::uint16_t>(value >> 16));
+    };
+    auto putId = [&](const char* id)
+    {
+        bytes.insert(bytes.end(), id, id + 4);
+    };
+
+    putId("RIFF");
+    put32(0);
+    putId("WAVE");
+
+    // 16 bit stereo with cbSize 0 and one extra byte, so the chunk has 19 bytes and a pad byte
+    putId("fmt ");
+    put32(19);
+    put16(1);
+    put16(2);
+    put32(48000);
+    put32(48000 * 4);
+    put16(4);
+    put16(16);
+    put16(0);
+    bytes.push_back(0x55);
+    bytes.push_back(0);
+
+    putId("LIST");
+    put32(3);
+    bytes.insert(bytes.end(), {'a', 'b', 'c', 0});
+
+    putId("data");
+    put32(5 * 4);
+    for (int frame = 0; frame < 5; ++frame)
+    {
+        put16(static_cast<std::uint16_t>(frame * 1000));
+        put16(static_cast<std::uint16_t>(-frame * 1000));
+    }
+    const auto riffSize = static_cast<std::uint32_t>(bytes.size() - 8);
+    for (int byte = 0; byte < 4; ++byte)
+        bytes[static_cast<std::size_t>(4 + byte)] = static_cast<std::uint8_t>(riffSize >> (8 * byte));
+
+    const std::string fileName = getTestFile("oddChunks.wav");
+    {
+        std::ofstream file(fileName, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    bool passed = true;
+    try
+    {
+        edsp::AudioFileFormat format;
+        const std::vector<float> samples = readWav(fileName, format);
+        passed &= check(format.channels == 2 && format.sampleRate == 48000.0 && format.sampleFormat == edsp::AudioFileSampleFormat::Int16, "format after an odd format chunk");
+        bool samplesMatch = samples.size() == 10;
+        for (std::size_t frame = 0; frame < 5 && samplesMatch; ++frame)
+            samplesMatch = samples[2 * frame] == static_cast<float>(frame) * 1000.0f / 32768.0f && samples[2 * frame + 1] == -static_cast<float>(frame) * 1000.0f / 32768.0f;
+        passed &= check(samplesMatch, "samples after odd chunks");
+    }
+    catch (const edsp::AudioFileException& e)
+    {
+        passed &= check(false, std::string{"reading odd chunks: "} + e.what());
+    }
+
+    // the exception has a message and is caught as a std::exception
+    try
+    {
+        edsp::AudioFileReader reader;
+        reader.openWav(getTestFile("missing.wav"));
+        passed &= check(false, "opening a missing file throws");
+    }
+    catch (const std::exception& e)
+    {
+        passed &= check(std::string{e.what()}.find("missing.wav") != std::string::npos, "the exception names the file");
+    }
+    return passed;
+}
+
+// every thread of the ThreadPool is blocked, so the calling thread has to master all files itself
+static bool testBusyThreadPool()
+{
+    constexpr int files = 3;
+    const int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    std::vector<edsp::MasteringJob> jobs;
+    for (int file = 0; file < files; ++file)
+    {
+        const std::string inputFile = getTestFile("input" + std::to_string(file) + ".wav");
+        const std::vector<float> samples = createNoise(2, 4800, static_cast<unsigned int>(file));
+        edsp::AudioFileWriter writer;
+        writer.openWav(inputFile, {2, 48000.0, edsp::AudioFileSampleFormat::Float32});
+        writer.write(samples.data(), 4800);
+        writer.close();
+        jobs.push_back({inputFile, getTestFile("output" + std::to_string(file) + ".wav")});
+    }
+
+    edsp::MasteringSettings settings;
+    settings.thresholdInDb = -6.0f;
+    settings.outputSampleFormat = edsp::AudioFileSampleFormat::Int24;
+
+    edsp::ThreadPool<64> threadPool;
+    std::mutex mutex;
+    std::condition_variable released;
+    bool release = false;
+    std::atomic<int> busyThreads{0};
+    for (int thread = 0; thread < threads; ++thread)
+    {
+        threadPool.enqueue([&]
+                           {
+                               ++busyThreads;
+                               std::unique_lock<std::mutex> lock(mutex);
+                               released.wait_for(lock, std::chrono::seconds(2), [&]
+                                                 { return release; }); });
+    }
+    while (busyThreads < threads)
+        std::this_thread::yield();
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<edsp::MasteringResult> results = edsp::masterFiles(threadPool, jobs, settings, 4);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        release = true;
+    }
+    released.notify_all();
+
+    bool passed = check(seconds < 1.0, "masterFiles() returns while the ThreadPool is busy, took " + std::to_string(seconds) + " s");
+    passed &= check(results.size() == jobs.size(), "one result per file");
+    for (int file = 0; file < static_cast<int>(results.size()); ++file)
+    {
+        const edsp::MasteringResult& result = results[static_cast<std::size_t>(file)];
+        passed &= check(result.succeeded() && result.inputFrames == 4800 && result.outputFrames == 4800, "file " + std::to_string(file) + " is mastered " + result.error);
+
+        // the same output as on the calling thread, the dither seed only depends on the position of the file
+        const std::vector<std::uint8_t> output = readFile(result.outputFile);
+        const edsp::MasteringJob expectedJob{result.inputFile, getTestFile("expected.wav")};
+        edsp::masterFile(expectedJob, settings, static_cast<std::uint32_t>(file + 1));
+        passed &= check(!output.empty() && output == readFile(expectedJob.outputFile), "file " + std::to_string(file) + " matches masterFile()");
+    }
+
+    // the blocked tasks return before the ThreadPool is destroyed
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    return passed;
+}
+
+int main()
+{
+    bool passed = true;
+    for (const auto& [name, test] : {std::pair{"WAV round trip", testWavRoundTrip},
+                                     std::pair{"odd chunk sizes", testOddChunkSizes},
+                                     std::pair{"busy ThreadPool", testBusyThreadPool}})
+    {
+        const bool testPassed = test();
+        std::cout << name << (testPassed ? " passed.\n" : " failed!\n");
+        passed &= testPassed;
+    }
+    std::filesystem::remove_all(std::filesystem::temp_directory_path() / "edspBatchMasteringTest");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace edsp
+{
+
+// prevents the compiler from optimizing away a computation whose result is otherwise unused
+template <typename T>
+inline void doNotOptimize(const T& value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct BenchmarkOptions
+{
+    int repetitions = 15;            // the median of the repetitions is reported
+    double repetitionSeconds = 0.02; // minimum duration of one repetition
+    double warmUpSeconds = 0.01;     // caches, branch predictors and CPU clock settle down
+};
+
+struct BenchmarkResult
+{
+    std::string name;       // e.g. "LookAheadLimiter::process"
+    std::string parameters; // e.g. "channels=2 block=512"
+    std::string unit;       // what is counted, e.g. "sample" or "operation"
+    double nsPerUnitMedian = 0.0;
+    double nsPerUnitMin = 0.0;
+    double nsPerUnitMax = 0.0;
+    double unitsPerSecond = 0.0; // based on the median
+    std::int64_t unitsPerRepetition = 0;
+    int repetitions = 0;
+};
+
+// measures function(), which processes unitsPerCall units (e.g. samples) per call
+// the number of calls per repetition is calibrated so a repetition takes at least options.repetitionSeconds
+template <typename Function>
+inline BenchmarkResult runBenchmark(const std::string& name, const std::string& parameters, const std::string& unit, std::int64_t unitsPerCall, Function&& function, const BenchmarkOptions& options = {})
+{
+    using Clock = std::chrono::steady_clock;
+    auto secondsSince = [](Clock::time_point start)
+    { return std::chrono::duration<double>(Clock::now() - start).count(); };
+
+    // warm up and calibrate
+    std::int64_t callsPerRepetition = 1;
+    const Clock::time_point warmUpStart = Clock::now();
+    while (true)
+    {
+        const Clock::time_point start = Clock::now();
+        for (std::int64_t call = 0; call < callsPerRepetition; ++call)
+            function();
+        const double seconds = secondsSince(start);
+
+        if (seconds >= options.repetitionSeconds && secondsSince(warmUpStart) >= options.warmUpSeconds)
+            break;
+        if (seconds < options.repetitionSeconds)
+            callsPerRepetition *= 2;
+    }
+
+    std::vector<double> nsPerUnit;
+    nsPerUnit.reserve(static_cast<std::size_t>(options.repetitions));
+    for (int repetition = 0; repetition < options.repetitions; ++repetition)
+    {
+        const Clock::time_point start = Clock::now();
+        for (std::int64_t call = 0; call < callsPerRepetition; ++call)
+            function();
+        nsPerUnit.push_back(secondsSince(start) * 1e9 / static_cast<double>(callsPerRepetition * unitsPerCall));
+    }
+    std::sort(nsPerUnit.begin(), nsPerUnit.end());
+
+    BenchmarkResult result;
+    result.name = name;
+    result.parameters = parameters;
+    result.unit = unit;
+    result.nsPerUnitMedian = nsPerUnit[nsPerUnit.size() / 2];
+    result.nsPerUnitMin = nsPerUnit.front();
+    result.nsPerUnitMax = nsPerUnit.back();
+    result.unitsPerSecond = result.nsPerUnitMedian > 0.0 ? 1e9 / result.nsPerUnitMedian : 0.0;
+    result.unitsPerRepetition = callsPerRepetition * unitsPerCall;
+    result.repetitions = options.repetitions;
+    return result;
+}
+
+// measures function() like runBenchmark(), setup() is called before every call, e.g. to refresh a buffer that function() processes in place
+// setup() is measured on its own as well and its median is subtracted, so the result only contains function()
+template <typename Setup, typename Function>
+inline BenchmarkResult runBenchmarkWithSetup(const std::string& name, const std::string& parameters, const std::string& unit, std::int64_t unitsPerCall, Setup&& setup, Function&& function, const BenchmarkOptions& options = {})
+{
+    const BenchmarkResult setupResult = runBenchmark(name, parameters, unit, unitsPerCall, setup, options);
+    BenchmarkResult result = runBenchmark(name, parameters, unit, unitsPerCall, [&]
+                                          {
+                                              setup();
+                                              function(); },
+                                          options);
+
+    result.nsPerUnitMedian = std::max(0.0, result.nsPerUnitMedian - setupResult.nsPerUnitMedian);
+    result.nsPerUnitMin = std::max(0.0, result.nsPerUnitMin - setupResult.nsPerUnitMedian);
+    result.nsPerUnitMax = std::max(0.0, result.nsPerUnitMax - setupResult.nsPerUnitMedian);
+    result.unitsPerSecond = result.nsPerUnitMedian > 0.0 ? 1e9 / result.nsPerUnitMedian : 0.0;
+    return result;
+}
+
+inline std::string escapeJson(const std::string& text)
+{
+    std::string result;
+    result.reserve(text.size());
+    for (const char character : text)
+    {
+        if (character == '"' || character == '\\')
+            result += '\\';
+        result += character;
+    }
+    return result;
+}
+
+// one JSON object with a "context" object (e.g. compiler, instruction set) and a "results" array
+inline void writeBenchmarkResultsAsJson(std::ostream& stream, const std::vector<std::pair<std::string, std::string>>& context, const std::vector<BenchmarkResult>& results)
+{
+    stream << "{\n  \"context\": {";
+    for (std::size_t i = 0; i < context.size(); ++i)
+        stream << (i > 0 ? ", " : "") << "\"" << escapeJson(context[i].first) << "\": \"" << escapeJson(context[i].second) << "\"";
+    stream << "},\n  \"results\": [\n";
+
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchmarkResult& result = results[i];
+        stream << "    {\"name\": \"" << escapeJson(result.name) << "\", \"parameters\": \"" << escapeJson(result.parameters) << "\", \"unit\": \"" << escapeJson(result.unit) << "\", "
+               << "\"ns_per_unit\": " << result.nsPerUnitMedian << ", \"ns_per_unit_min\": " << result.nsPerUnitMin << ", \"ns_per_unit_max\": " << result.nsPerUnitMax << ", "
+               << "\"units_per_second\": " << result.unitsPerSecond << ", \"units_per_repetition\": " << result.unitsPerRepetition << ", \"repetitions\": " << result.repetitions << "}"
+               << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    stream << "  ]\n}\n";
+}
+
+} // namespace edsp
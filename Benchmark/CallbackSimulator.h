@@ -0,0 +1,196 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "../SpinLock/SpinLock.h"
+#include "../ThreadPool/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace edsp
+{
+
+struct CallbackSimulatorOptions
+{
+    int blockSize = 256;       // samples per callback
+    double sampleRate = 48000.0;
+    double seconds = 10.0;     // simulated duration
+    bool realTime = true;      // wait for the next period like an audio device, otherwise run the callbacks back to back
+    int threadPoolTasks = 0;   // tasks per callback that keep the ThreadPool busy, e.g. disk streaming or analysis
+    double threadPoolTaskMicroseconds = 200.0;
+    int spinLockThreads = 0;   // threads that contend for a SpinLock that the callback also has to acquire
+    double spinLockHoldMicroseconds = 2.0;
+};
+
+struct CallbackStatistics
+{
+    std::int64_t callbacks = 0;
+    std::int64_t xruns = 0;    // callbacks that finished after their deadline
+    double deadlineUs = 0.0;   // one block at the sample rate
+    double meanUs = 0.0;
+    double p50Us = 0.0;
+    double p90Us = 0.0;
+    double p99Us = 0.0;
+    double p999Us = 0.0;
+    double worstUs = 0.0;
+    double worstLatenessUs = 0.0; // how late the worst callback finished, 0 if there was no xrun
+};
+
+namespace detail
+{
+
+inline void spinFor(std::chrono::steady_clock::duration duration) noexcept
+{
+    const auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end)
+    {
+    }
+}
+
+// background threads that compete with the callback thread for CPU time, caches and locks
+class BackgroundLoad
+{
+public:
+    explicit BackgroundLoad(const CallbackSimulatorOptions& options)
+            : mTaskDuration(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::micro>(options.threadPoolTaskMicroseconds))),
+              mTasksPerCallback(options.threadPoolTasks),
+              mHoldDuration(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::micro>(options.spinLockHoldMicroseconds)))
+    {
+        // the pool starts one thread per core, which would compete with the callback even without tasks
+        if (mTasksPerCallback > 0)
+            mThreadPool.emplace();
+
+        for (int thread = 0; thread < options.spinLockThreads; ++thread)
+        {
+            mSpinLockThreads.emplace_back([this]
+                                          {
+                                              while (!mStop.load(std::memory_order_relaxed))
+                                              {
+                                                  {
+                                                      std::lock_guard<SpinLock> lock(mSpinLock);
+                                                      spinFor(mHoldDuration);
+                                                  }
+                                                  std::this_thread::yield();
+                                              } });
+        }
+    }
+
+    ~BackgroundLoad()
+    {
+        mStop = true;
+        for (auto& thread : mSpinLockThreads)
+            thread.join();
+    }
+
+    BackgroundLoad(const BackgroundLoad&) = delete;
+    BackgroundLoad& operator=(const BackgroundLoad&) = delete;
+
+    // called on the callback thread before the processor, so the enqueue and lock costs count towards the deadline
+    void beginCallback() noexcept
+    {
+        for (int task = 0; task < mTasksPerCallback; ++task)
+            mThreadPool->enqueue(&spinFor, mTaskDuration); // a full queue drops the task like a real-time producer would
+
+        if (!mSpinLockThreads.empty())
+        {
+            std::lock_guard<SpinLock> lock(mSpinLock);
+            ++mSharedValue;
+        }
+    }
+
+private:
+    std::chrono::steady_clock::duration mTaskDuration;
+    int mTasksPerCallback;
+    std::chrono::steady_clock::duration mHoldDuration;
+    std::optional<ThreadPool<256>> mThreadPool;
+    SpinLock mSpinLock;
+    std::int64_t mSharedValue = 0;
+    std::atomic<bool> mStop = false;
+    std::vector<std::thread> mSpinLockThreads;
+};
+
+} // namespace detail
+
+// calls process() like an audio device calls its callback: once per block, each call has to finish within one block duration
+// reports the tail of the callback time distribution, which is what causes dropouts, instead of just the average
+template <typename Function>
+inline CallbackStatistics runCallbackSimulation(Function&& process, const CallbackSimulatorOptions& options = {})
+{
+    using Clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.blockSize / options.sampleRate));
+    const auto callbacks = static_cast<std::int64_t>(options.seconds * options.sampleRate / options.blockSize);
+
+    std::vector<double> durationsUs;
+    durationsUs.reserve(static_cast<std::size_t>(std::max<std::int64_t>(callbacks, 1)));
+
+    CallbackStatistics statistics;
+    statistics.deadlineUs = std::chrono::duration<double, std::micro>(period).count();
+
+    detail::BackgroundLoad backgroundLoad{options};
+    Clock::time_point wakeUp = Clock::now();
+    for (std::int64_t callback = 0; callback < callbacks; ++callback)
+    {
+        if (options.realTime)
+            std::this_thread::sleep_until(wakeUp);
+
+        const Clock::time_point start = Clock::now();
+        backgroundLoad.beginCallback();
+        process();
+        const Clock::time_point end = Clock::now();
+
+        const double durationUs = std::chrono::duration<double, std::micro>(end - start).count();
+        durationsUs.push_back(durationUs);
+
+        // in real-time mode a callback also misses its deadline if it was woken up too late
+        const Clock::time_point deadline = (options.realTime ? wakeUp : start) + period;
+        const double latenessUs = std::chrono::duration<double, std::micro>(end - deadline).count();
+        if (latenessUs > 0.0)
+        {
+            ++statistics.xruns;
+            statistics.worstLatenessUs = std::max(statistics.worstLatenessUs, latenessUs);
+        }
+
+        // after an xrun the device continues with the next period instead of catching up
+        wakeUp = std::max(deadline, end);
+    }
+
+    if (durationsUs.empty())
+        return statistics;
+
+    std::sort(durationsUs.begin(), durationsUs.end());
+    auto percentile = [&durationsUs](double fraction)
+    { return durationsUs[std::min(durationsUs.size() - 1, static_cast<std::size_t>(fraction * static_cast<double>(durationsUs.size())))]; };
+
+    statistics.callbacks = static_cast<std::int64_t>(durationsUs.size());
+    double sum = 0.0;
+    for (const double durationUs : durationsUs)
+        sum += durationUs;
+    statistics.meanUs = sum / static_cast<double>(durationsUs.size());
+    statistics.p50Us = percentile(0.5);
+    statistics.p90Us = percentile(0.9);
+    statistics.p99Us = percentile(0.99);
+    statistics.p999Us = percentile(0.999);
+    statistics.worstUs = durationsUs.back();
+    return statistics;
+}
+
+inline void writeCallbackStatisticsAsJson(std::ostream& stream, const CallbackSimulatorOptions& options, const CallbackStatistics& statistics)
+{
+    stream << "{\n  \"options\": {\"block_size\": " << options.blockSize << ", \"sample_rate\": " << options.sampleRate << ", \"seconds\": " << options.seconds
+           << ", \"real_time\": " << (options.realTime ? "true" : "false") << ", \"thread_pool_tasks\": " << options.threadPoolTasks
+           << ", \"thread_pool_task_us\": " << options.threadPoolTaskMicroseconds << ", \"spin_lock_threads\": " << options.spinLockThreads
+           << ", \"spin_lock_hold_us\": " << options.spinLockHoldMicroseconds << "},\n"
+           << "  \"statistics\": {\"callbacks\": " << statistics.callbacks << ", \"xruns\": " << statistics.xruns << ", \"deadline_us\": " << statistics.deadlineUs
+           << ", \"mean_us\": " << statistics.meanUs << ", \"p50_us\": " << statistics.p50Us << ", \"p90_us\": " << statistics.p90Us << ", \"p99_us\": " << statistics.p99Us
+           << ", \"p999_us\": " << statistics.p999Us << ", \"worst_us\": " << statistics.worstUs << ", \"worst_lateness_us\": " << statistics.worstLatenessUs << "}\n}\n";
+}
+
+} // namespace edsp
@@ -0,0 +1,693 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#include "../AudioBuffer/AudioBuffer.h"
+#include "../AudioBuffer/AudioBufferConversion.h"
+#include "../AudioBuffer/AudioBufferGain.h"
+#include "../AudioBuffer/AudioBufferHelpers.h"
+#include "../AudioBuffer/AudioBufferInterleaved.h"
+#include "../LookAheadLimiter/LookAheadLimiter.h"
+#include "../LookAheadLimiter/LookAheadLimiterBank.h"
+#include "../LookAheadLimiter/LookAheadLimiterReference.h"
+#include "../MidiFileParser/MidiFileParser.h"
+#include "../Resampler/AsyncResampler.h"
+#include "../Resampler/MultichannelResampler.h"
+#include "../Resampler/Resampler.h"
+#include "../Resampler/StreamingResampler.h"
+#include "../SpinLock/SpinLock.h"
+#include "../ThreadPool/ThreadPool.h"
+#include "Benchmark.h"
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct Settings
+{
+    std::string filter;   // only run benchmarks whose name contains this text
+    std::string jsonPath; // write the results to this file
+    edsp::BenchmarkOptions options;
+};
+
+class BenchmarkRunner
+{
+public:
+    explicit BenchmarkRunner(const Settings& settings)
+            : mSettings(settings)
+    {
+    }
+
+    bool isEnabled(const std::string& name) const
+    {
+        return mSettings.filter.empty() || name.find(mSettings.filter) != std::string::npos;
+    }
+
+    template <typename Function>
+    void run(const std::string& name, const std::string& parameters, const std::string& unit, std::int64_t unitsPerCall, Function&& function)
+    {
+        if (!isEnabled(name))
+            return;
+
+        report(edsp::runBenchmark(name, parameters, unit, unitsPerCall, function, mSettings.options));
+    }
+
+    // setup() refreshes the input before every call, its time is not reported, see edsp::runBenchmarkWithSetup()
+    template <typename Setup, typename Function>
+    void runWithSetup(const std::string& name, const std::string& parameters, const std::string& unit, std::int64_t unitsPerCall, Setup&& setup, Function&& function)
+    {
+        if (!isEnabled(name))
+            return;
+
+        report(edsp::runBenchmarkWithSetup(name, parameters, unit, unitsPerCall, setup, function, mSettings.options));
+    }
+
+    const std::vector<edsp::BenchmarkResult>& getResults() const noexcept
+    {
+        return mResults;
+    }
+
+private:
+    void report(const edsp::BenchmarkResult& result)
+    {
+        std::cout << std::left << std::setw(36) << result.name << std::setw(44) << result.parameters << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(12) << result.nsPerUnitMedian << " ns/" << std::left << std::setw(10) << result.unit << std::right
+                  << std::setprecision(0) << std::setw(16) << result.unitsPerSecond << " " << result.unit << "s/s\n";
+        mResults.push_back(result);
+    }
+
+    const Settings& mSettings;
+    std::vector<edsp::BenchmarkResult> mResults;
+};
+
+std::string makeParameters(std::initializer_list<std::pair<const char*, double>> parameters)
+{
+    std::string result;
+    for (const auto& parameter : parameters)
+    {
+        if (!result.empty())
+            result += ' ';
+        std::ostringstream value;
+        value << parameter.second;
+        result += std::string(parameter.first) + "=" + value.str();
+    }
+    return result;
+}
+
+std::string getSimdLevelName()
+{
+    switch (edsp::getSimdLevel())
+    {
+        case edsp::SimdLevel::Sse2:
+            return "SSE2";
+        case edsp::SimdLevel::Avx2:
+            return "AVX2";
+        case edsp::SimdLevel::Avx512:
+            return "AVX-512";
+        case edsp::SimdLevel::Neon:
+            return "NEON";
+        default:
+            return "scalar";
+    }
+}
+
+std::string getCompilerName()
+{
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_VER);
+#else
+    return "unknown";
+#endif
+}
+
+void fillWithNoise(float* buffer, std::size_t samples, float amplitude)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(-amplitude, amplitude);
+    for (std::size_t i = 0; i < samples; ++i)
+        buffer[i] = distribution(generator);
+}
+
+//
+// AudioBuffer helpers, gain and conversion functions
+//
+
+void benchmarkAudioBufferHelpers(BenchmarkRunner& runner)
+{
+    constexpr int samples = 512;
+    for (const int channels : {2, 8, 13})
+    {
+        edsp::AudioBuffer<float, 16> planar(channels, samples);
+        edsp::AudioBuffer<float, 16> planar2(channels, samples);
+        edsp::AudioBufferInterleaved<float> interleaved(channels, samples);
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            fillWithNoise(planar.getWritePointer(channel), samples, 1.0f);
+            fillWithNoise(planar2.getWritePointer(channel), samples, 1.0f);
+        }
+        fillWithNoise(interleaved.getWritePointer(), static_cast<std::size_t>(channels) * samples, 1.0f);
+
+        const std::string parameters = makeParameters({{"channels", channels}, {"block", samples}});
+        const std::int64_t units = static_cast<std::int64_t>(channels) * samples;
+
+        runner.run("AudioBufferHelpers::clearBuffer", parameters, "sample", units, [&]
+                   {
+                       edsp::clearBuffer(planar2.getWriteView());
+                       edsp::doNotOptimize(planar2.getReadPointer(0)[0]); });
+        runner.run("AudioBufferHelpers::addBuffer", parameters, "sample", units, [&]
+                   {
+                       edsp::addBuffer(planar.getReadView(), planar2.getWriteView());
+                       edsp::doNotOptimize(planar2.getReadPointer(0)[0]); });
+        runner.run("AudioBufferHelpers::interleaveSamples", parameters, "sample", units, [&]
+                   {
+                       edsp::interleaveSamples(planar.getReadView(), interleaved.getWriteView());
+                       edsp::doNotOptimize(interleaved.getWritePointer()[0]); });
+        runner.run("AudioBufferHelpers::deinterleaveSamples", parameters, "sample", units, [&]
+                   {
+                       edsp::deinterleaveSamples(interleaved.getReadView(), planar2.getWriteView());
+                       edsp::doNotOptimize(planar2.getReadPointer(0)[0]); });
+        runner.run("AudioBufferGain::addBufferWithGainRamp", parameters, "sample", units, [&]
+                   {
+                       edsp::addBufferWithGainRamp(planar.getReadView(), planar2.getWriteView(), 0.5f, 0.25f);
+                       edsp::doNotOptimize(planar2.getReadPointer(0)[0]); });
+        runner.run("AudioBufferGain::applyGainRamp", "interleaved " + parameters, "sample", units, [&]
+                   {
+                       edsp::applyGainRamp(interleaved.getWriteView(), 1.0f, 0.999f);
+                       edsp::doNotOptimize(interleaved.getWritePointer()[0]); });
+        runner.run("AudioBufferGain::getPeak", parameters, "sample", units, [&]
+                   { edsp::doNotOptimize(edsp::getPeak(planar.getReadView())); });
+
+        std::vector<std::int16_t> int16Samples(static_cast<std::size_t>(units));
+        std::vector<edsp::PackedInt24> int24Samples(static_cast<std::size_t>(units));
+        edsp::TpdfDither dither;
+        runner.run("AudioBufferConversion::int16ToPlanarFloat", parameters, "sample", units, [&]
+                   {
+                       edsp::convertSamples(edsp::AudioBufferInterleavedView<const std::int16_t>{int16Samples.data(), channels, samples}, planar2.getWriteView());
+                       edsp::doNotOptimize(planar2.getReadPointer(0)[0]); });
+        runner.run("AudioBufferConversion::planarFloatToInt16", "dither " + parameters, "sample", units, [&]
+                   {
+                       edsp::convertSamples(planar.getReadView(), edsp::AudioBufferInterleavedView<std::int16_t>{int16Samples.data(), channels, samples}, &dither);
+                       edsp::doNotOptimize(int16Samples[0]); });
+        runner.run("AudioBufferConversion::planarFloatToInt24", "dither " + parameters, "sample", units, [&]
+                   {
+                       edsp::convertSamples(planar.getReadView(), edsp::AudioBufferInterleavedView<edsp::PackedInt24>{int24Samples.data(), channels, samples}, &dither);
+                       edsp::doNotOptimize(int24Samples[0]); });
+    }
+}
+
+//
+// LookAheadLimiter
+//
+
+void benchmarkLookAheadLimiter(BenchmarkRunner& runner)
+{
+    constexpr double sampleRate = 48000.0;
+    for (const float attackMs : {1.0f, 5.0f, 20.0f})
+    {
+        for (const int channels : {1, 2, 8})
+        {
+            for (const int samples : {32, 256, 1024})
+            {
+                edsp::LookAheadLimiter limiter;
+                limiter.configure(attackMs, 50.0f, -3.0f, 0.0f, channels, sampleRate);
+
+                // the input peaks above the threshold, so the gain computation is exercised
+                std::vector<float> input(static_cast<std::size_t>(channels) * samples);
+                fillWithNoise(input.data(), input.size(), 1.5f);
+                std::vector<float> buffer(input.size());
+
+                const std::string parameters = makeParameters({{"attackMs", attackMs}, {"channels", channels}, {"block", samples}});
+                runner.runWithSetup("LookAheadLimiter::process", "interleaved " + parameters, "sample", static_cast<std::int64_t>(channels) * samples, [&]
+                                    { std::copy(input.begin(), input.end(), buffer.begin()); },
+                                    [&]
+                                    {
+                                        limiter.process(buffer.data(), samples);
+                                        edsp::doNotOptimize(buffer[0]); });
+
+                // the per-sample implementation LookAheadLimiter is derived from, for the speedup of the block processing
+                edsp::LookAheadLimiterReference reference;
+                reference.configure(attackMs, 50.0f, -3.0f, 0.0f, channels, sampleRate);
+                runner.runWithSetup("LookAheadLimiter::process", "per-sample " + parameters, "sample", static_cast<std::int64_t>(channels) * samples, [&]
+                                    { std::copy(input.begin(), input.end(), buffer.begin()); },
+                                    [&]
+                                    {
+                                        reference.process(buffer.data(), samples);
+                                        edsp::doNotOptimize(buffer[0]); });
+
+                edsp::LookAheadLimiter truePeakLimiter;
+                truePeakLimiter.configure(attackMs, 50.0f, -3.0f, 0.0f, channels, sampleRate, edsp::PeakDetection::TruePeak);
+                runner.runWithSetup("LookAheadLimiter::process", "interleaved true peak " + parameters, "sample", static_cast<std::int64_t>(channels) * samples, [&]
+                                    { std::copy(input.begin(), input.end(), buffer.begin()); },
+                                    [&]
+                                    {
+                                        truePeakLimiter.process(buffer.data(), samples);
+                                        edsp::doNotOptimize(buffer[0]); });
+
+                // the input stays below the threshold, so the envelope is skipped
+                std::vector<float> quietInput(input.size());
+                fillWithNoise(quietInput.data(), quietInput.size(), 0.5f);
+                limiter.reset();
+                runner.runWithSetup("LookAheadLimiter::process", "interleaved below threshold " + parameters, "sample", static_cast<std::int64_t>(channels) * samples, [&]
+                                    { std::copy(quietInput.begin(), quietInput.end(), buffer.begin()); },
+                                    [&]
+                                    {
+                                        limiter.process(buffer.data(), samples);
+                                        edsp::doNotOptimize(buffer[0]); });
+
+                edsp::AudioBuffer<float, 16> planarInput(channels, samples);
+                edsp::AudioBuffer<float, 16> planarBuffer(channels, samples);
+                edsp::deinterleaveSamples(edsp::AudioBufferInterleavedView<const float>{input.data(), channels, samples}, planarInput.getWriteView());
+                limiter.reset();
+                runner.runWithSetup("LookAheadLimiter::process", "planar " + parameters, "sample", static_cast<std::int64_t>(channels) * samples, [&]
+                                    { edsp::copyBufferWithGain(planarInput.getReadView(), planarBuffer.getWriteView(), 1.0f); },
+                                    [&]
+                                    {
+                                        limiter.process(planarBuffer.getWriteView());
+                                        edsp::doNotOptimize(planarBuffer.getReadPointer(0)[0]); });
+
+                std::vector<double> doubleInput(input.begin(), input.end());
+                std::vector<double> doubleBuffer(input.size());
+                edsp::BasicLookAheadLimiter<double> doubleLimiter;
+                doubleLimiter.configure(attackMs, 50.0f, -3.0f, 0.0f, channels, sampleRate);
+                runner.runWithSetup("LookAheadLimiter::process", "interleaved double " + parameters, "sample", static_cast<std::int64_t>(channels) * samples, [&]
+                                    { std::copy(doubleInput.begin(), doubleInput.end(), doubleBuffer.begin()); },
+                                    [&]
+                                    {
+                                        doubleLimiter.process(doubleBuffer.data(), samples);
+                                        edsp::doNotOptimize(doubleBuffer[0]); });
+            }
+        }
+
+        // the channel count as template argument
+        for (const int samples : {32, 256, 1024})
+        {
+            constexpr int channels = 2;
+            edsp::BasicLookAheadLimiter<float, channels> limiter;
+            limiter.configure(attackMs, 50.0f, -3.0f, 0.0f, channels, sampleRate);
+
+            std::vector<float> input(static_cast<std::size_t>(channels) * samples);
+            fillWithNoise(input.data(), input.size(), 1.5f);
+            std::vector<float> buffer(input.size());
+
+            const std::string parameters = makeParameters({{"attackMs", attackMs}, {"channels", channels}, {"block", samples}});
+            runner.runWithSetup("LookAheadLimiter::process", "interleaved fixed channels " + parameters, "sample", static_cast<std::int64_t>(channels) * samples, [&]
+                                { std::copy(input.begin(), input.end(), buffer.begin()); },
+                                [&]
+                                {
+                                    limiter.process(buffer.data(), samples);
+                                    edsp::doNotOptimize(buffer[0]); });
+        }
+    }
+}
+
+// one LookAheadLimiter per stream compared with a LookAheadLimiterBank for all streams
+void benchmarkLookAheadLimiterBank(BenchmarkRunner& runner)
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int channels = 2;
+    constexpr int samples = 256;
+    for (const int limiters : {16, 64, 256})
+    {
+        std::vector<float> input(static_cast<std::size_t>(limiters) * channels * samples);
+        fillWithNoise(input.data(), input.size(), 1.5f);
+        std::vector<float> buffer(input.size());
+        std::vector<float*> buffers(static_cast<std::size_t>(limiters));
+        for (int limiter = 0; limiter < limiters; ++limiter)
+            buffers[static_cast<std::size_t>(limiter)] = buffer.data() + static_cast<std::size_t>(limiter) * channels * samples;
+
+        // every limiter has different parameters
+        std::vector<edsp::LookAheadLimiter> separateLimiters(static_cast<std::size_t>(limiters));
+        edsp::LookAheadLimiterBank bank;
+        bank.configure(limiters, channels, sampleRate);
+        for (int limiter = 0; limiter < limiters; ++limiter)
+        {
+            const float attackMs = 1.0f + static_cast<float>(limiter % 10);
+            const float releaseMs = 20.0f + static_cast<float>(limiter % 7) * 10.0f;
+            const float thresholdInDb = -1.0f - static_cast<float>(limiter % 5);
+            separateLimiters[static_cast<std::size_t>(limiter)].configure(attackMs, releaseMs, thresholdInDb, 0.0f, channels, sampleRate);
+            bank.configureLimiter(limiter, attackMs, releaseMs, thresholdInDb, 0.0f);
+        }
+
+        const std::string parameters = makeParameters({{"limiters", limiters}, {"channels", channels}, {"block", samples}});
+        const std::int64_t totalSamples = static_cast<std::int64_t>(limiters) * channels * samples;
+        runner.runWithSetup("LookAheadLimiterBank::process", "separate " + parameters, "sample", totalSamples, [&]
+                            { std::copy(input.begin(), input.end(), buffer.begin()); },
+                            [&]
+                            {
+                                for (int limiter = 0; limiter < limiters; ++limiter)
+                                    separateLimiters[static_cast<std::size_t>(limiter)].process(buffers[static_cast<std::size_t>(limiter)], samples);
+                                edsp::doNotOptimize(buffer[0]); });
+
+        runner.runWithSetup("LookAheadLimiterBank::process", "bank " + parameters, "sample", totalSamples, [&]
+                            { std::copy(input.begin(), input.end(), buffer.begin()); },
+                            [&]
+                            {
+                                bank.process(buffers.data(), samples);
+                                edsp::doNotOptimize(buffer[0]); });
+    }
+}
+
+//
+// Resampler
+//
+
+void benchmarkResampler(BenchmarkRunner& runner)
+{
+    constexpr int channels = 2;
+    constexpr int outputSamples = 512;
+    const std::pair<double, double> sampleRates[] = {{44100.0, 48000.0}, {48000.0, 44100.0}, {48000.0, 96000.0}, {96000.0, 48000.0}};
+
+    for (const auto& [inputRate, outputRate] : sampleRates)
+    {
+        const int inputSamples = static_cast<int>(std::ceil(outputSamples * inputRate / outputRate));
+        std::vector<float> input(static_cast<std::size_t>(channels) * inputSamples);
+        std::vector<float> output(static_cast<std::size_t>(channels) * outputSamples);
+        fillWithNoise(input.data(), input.size(), 1.0f);
+
+        edsp::Resampler resampler{channels};
+        runner.run("Resampler::process", makeParameters({{"inputRate", inputRate}, {"outputRate", outputRate}, {"channels", channels}, {"block", outputSamples}}), "sample",
+                   static_cast<std::int64_t>(channels) * outputSamples, [&]
+                   {
+                       resampler.process(input.data(), output.data(), inputSamples, outputSamples);
+                       edsp::doNotOptimize(output[0]); });
+
+        // the fixed ratio uses the polyphase filter instead of libsamplerate
+        const std::pair<edsp::ResamplerQuality, const char*> qualities[] = {{edsp::ResamplerQuality::Fast, "fast"}, {edsp::ResamplerQuality::Medium, "medium"}, {edsp::ResamplerQuality::Best, "best"}};
+        for (const auto& [quality, qualityName] : qualities)
+        {
+            edsp::Resampler polyphaseResampler{channels, inputRate, outputRate, quality};
+            runner.run("Resampler::process", std::string("polyphase ") + qualityName + " " + makeParameters({{"inputRate", inputRate}, {"outputRate", outputRate}, {"channels", channels}, {"block", outputSamples}}), "sample",
+                       static_cast<std::int64_t>(channels) * outputSamples, [&]
+                       {
+                           polyphaseResampler.process(input.data(), output.data(), inputSamples, outputSamples);
+                           edsp::doNotOptimize(output[0]); });
+        }
+
+        // 16 bit samples, converted inside the resampler
+        std::vector<std::int16_t> integerInput(input.size());
+        std::vector<std::int16_t> integerOutput(output.size());
+        edsp::convertSamples(input.data(), integerInput.data(), static_cast<int>(input.size()));
+        edsp::Resampler integerResampler{channels, inputRate, outputRate};
+        runner.run("Resampler::process", "int16 " + makeParameters({{"inputRate", inputRate}, {"outputRate", outputRate}, {"channels", channels}, {"block", outputSamples}}), "sample",
+                   static_cast<std::int64_t>(channels) * outputSamples, [&]
+                   {
+                       integerResampler.process(integerInput.data(), inputSamples, integerOutput.data(), outputSamples, false);
+                       edsp::doNotOptimize(integerOutput[0]); });
+
+        // the ratio is corrected on every call
+        edsp::AsyncResampler asyncResampler{channels, inputRate, outputRate, outputSamples, 2 * inputSamples};
+        runner.run("AsyncResampler::pull", makeParameters({{"inputRate", inputRate}, {"outputRate", outputRate}, {"channels", channels}, {"block", outputSamples}}), "sample",
+                   static_cast<std::int64_t>(channels) * outputSamples, [&]
+                   {
+                       asyncResampler.push(input.data(), inputSamples);
+                       asyncResampler.pull(output.data(), outputSamples);
+                       edsp::doNotOptimize(output[0]); });
+
+        // includes copying the input through the FIFO
+        edsp::StreamingResampler streamingResampler{channels, inputRate, outputRate, outputSamples};
+        runner.run("StreamingResampler::pull", makeParameters({{"inputRate", inputRate}, {"outputRate", outputRate}, {"channels", channels}, {"block", outputSamples}}), "sample",
+                   static_cast<std::int64_t>(channels) * outputSamples, [&]
+                   {
+                       streamingResampler.push(input.data(), std::min(streamingResampler.getRequiredInputSamples(outputSamples), inputSamples));
+                       streamingResampler.pull(output.data(), outputSamples);
+                       edsp::doNotOptimize(output[0]); });
+    }
+}
+
+void benchmarkMultichannelResampler(BenchmarkRunner& runner)
+{
+    if (!runner.isEnabled("MultichannelResampler::process"))
+        return;
+
+    constexpr int channels = 32;
+    constexpr int outputSamples = 512;
+    constexpr double inputRate = 44100.0;
+    constexpr double outputRate = 48000.0;
+    const int inputSamples = static_cast<int>(std::ceil(outputSamples * inputRate / outputRate));
+
+    edsp::AudioBuffer<float, channels> input(channels, inputSamples);
+    edsp::AudioBuffer<float, channels> output(channels, outputSamples);
+    for (int channel = 0; channel < channels; ++channel)
+        fillWithNoise(input.getWritePointer(channel), static_cast<std::size_t>(inputSamples), 1.0f);
+
+    edsp::ThreadPool<64> threadPool;
+    edsp::MultichannelResampler resampler{channels, inputRate, outputRate};
+    const std::string parameters = makeParameters({{"inputRate", inputRate}, {"outputRate", outputRate}, {"channels", channels}, {"block", outputSamples}});
+
+    // the same input is used again, the resampler keeps the history of the previous block
+    runner.run("MultichannelResampler::process", "calling thread " + parameters, "sample", static_cast<std::int64_t>(channels) * outputSamples, [&]
+               {
+                   resampler.process(input.getReadView(), output.getWriteView(), false);
+                   edsp::doNotOptimize(output.getWritePointer(0)[0]); });
+
+    runner.run("MultichannelResampler::process", "thread pool " + parameters, "sample", static_cast<std::int64_t>(channels) * outputSamples, [&]
+               {
+                   resampler.process(threadPool, input.getReadView(), output.getWriteView(), false);
+                   edsp::doNotOptimize(output.getWritePointer(0)[0]); });
+}
+
+//
+// ThreadPool
+//
+
+void benchmarkThreadPool(BenchmarkRunner& runner)
+{
+    if (!runner.isEnabled("ThreadPool::enqueue"))
+        return;
+
+    edsp::ThreadPool<1024> threadPool;
+    std::atomic<int> counter{0};
+
+    // time from enqueue() until the task has been executed by a worker thread
+    runner.run("ThreadPool::enqueue", "round trip", "operation", 1, [&]
+               {
+                   const int expected = counter.load(std::memory_order_relaxed) + 1;
+                   while (!threadPool.enqueue([&counter]
+                                              { counter.fetch_add(1, std::memory_order_release); }))
+                       std::this_thread::yield();
+                   while (counter.load(std::memory_order_acquire) != expected)
+                       std::this_thread::yield(); });
+
+    // cost of enqueue() on the calling thread, e.g. the audio thread
+    constexpr int tasks = 64;
+    runner.run("ThreadPool::enqueue", makeParameters({{"burst", tasks}}), "operation", tasks, [&]
+               {
+                   const int expected = counter.load(std::memory_order_relaxed) + tasks;
+                   for (int task = 0; task < tasks; ++task)
+                       while (!threadPool.enqueue([&counter]
+                                                  { counter.fetch_add(1, std::memory_order_release); }))
+                           std::this_thread::yield();
+                   while (counter.load(std::memory_order_acquire) != expected)
+                       std::this_thread::yield(); });
+}
+
+//
+// SpinLock
+//
+
+void benchmarkSpinLock(BenchmarkRunner& runner)
+{
+    if (!runner.isEnabled("SpinLock::lock"))
+        return;
+
+    for (const int contendingThreads : {0, 1, 3})
+    {
+        edsp::SpinLock spinLock;
+        std::atomic<bool> stop{false};
+        std::int64_t sharedValue = 0;
+
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread < contendingThreads; ++thread)
+        {
+            threads.emplace_back([&]
+                                 {
+                                     while (!stop.load(std::memory_order_relaxed))
+                                     {
+                                         std::lock_guard<edsp::SpinLock> lock(spinLock);
+                                         ++sharedValue;
+                                     } });
+        }
+
+        // lock and unlock on the measured thread while the other threads do the same
+        constexpr int locks = 100;
+        runner.run("SpinLock::lock", makeParameters({{"contendingThreads", contendingThreads}}), "operation", locks, [&]
+                   {
+                       for (int i = 0; i < locks; ++i)
+                       {
+                           std::lock_guard<edsp::SpinLock> lock(spinLock);
+                           ++sharedValue;
+                       } });
+
+        stop = true;
+        for (auto& thread : threads)
+            thread.join();
+        edsp::doNotOptimize(sharedValue);
+    }
+}
+
+//
+// MidiFileParser
+//
+
+void writeBigEndian(std::ofstream& file, std::uint32_t value, int bytes)
+{
+    for (int byte = bytes - 1; byte >= 0; --byte)
+        file.put(static_cast<char>((value >> (8 * byte)) & 0xffu));
+}
+
+void writeVariableLength(std::vector<char>& data, std::uint32_t value)
+{
+    char bytes[4];
+    int count = 0;
+    do
+    {
+        bytes[count++] = static_cast<char>(value & 0x7fu);
+        value >>= 7;
+    } while (value > 0);
+
+    while (count > 0)
+    {
+        --count;
+        data.push_back(static_cast<char>(bytes[count] | (count > 0 ? 0x80 : 0x00)));
+    }
+}
+
+// type 1 file with note on/off pairs, running status, controllers and pitch bends
+void writeSyntheticMidiFile(const std::string& fileName, int tracks, int notesPerTrack)
+{
+    std::ofstream file(fileName, std::ios::binary);
+    file.write("MThd", 4);
+    writeBigEndian(file, 6, 4);
+    writeBigEndian(file, 1, 2);
+    writeBigEndian(file, static_cast<std::uint32_t>(tracks), 2);
+    writeBigEndian(file, 480, 2);
+
+    std::mt19937 generator(7);
+    for (int track = 0; track < tracks; ++track)
+    {
+        std::vector<char> data;
+        const auto channel = static_cast<char>(track % 16);
+        for (int note = 0; note < notesPerTrack; ++note)
+        {
+            const auto key = static_cast<char>(36 + generator() % 48);
+            writeVariableLength(data, generator() % 240);
+            data.insert(data.end(), {static_cast<char>(0x90 | channel), key, 100});
+            writeVariableLength(data, 1 + generator() % 960);
+            data.insert(data.end(), {key, 0}); // running status, note on with velocity 0
+
+            if (note % 8 == 0)
+            {
+                writeVariableLength(data, 0);
+                data.insert(data.end(), {static_cast<char>(0xb0 | channel), 7, static_cast<char>(generator() % 128)});
+                writeVariableLength(data, 0);
+                data.insert(data.end(), {static_cast<char>(0xe0 | channel), 0, static_cast<char>(generator() % 128)});
+            }
+        }
+        writeVariableLength(data, 0);
+        data.insert(data.end(), {static_cast<char>(0xff), 0x2f, 0x00}); // end of track
+
+        file.write("MTrk", 4);
+        writeBigEndian(file, static_cast<std::uint32_t>(data.size()), 4);
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+}
+
+void benchmarkMidiFileParser(BenchmarkRunner& runner)
+{
+    if (!runner.isEnabled("MidiFileParser::parse"))
+        return;
+
+    for (const int notesPerTrack : {1000, 20000})
+    {
+        constexpr int tracks = 16;
+        const std::string fileName = (std::filesystem::temp_directory_path() / "edsp_benchmark.mid").string();
+        writeSyntheticMidiFile(fileName, tracks, notesPerTrack);
+
+        edsp::MidiFileParser parser;
+        const std::int64_t events = static_cast<std::int64_t>(tracks) * notesPerTrack * 2;
+        runner.run("MidiFileParser::parse", makeParameters({{"tracks", tracks}, {"notesPerTrack", notesPerTrack}}), "event", events, [&]
+                   {
+                       parser.parse(fileName);
+                       edsp::doNotOptimize(parser.midiEvents.size()); });
+
+        std::filesystem::remove(fileName);
+    }
+}
+
+void printUsage()
+{
+    std::cout << "usage: benchmark [--filter <text>] [--json <file>] [--quick]\n"
+              << "  --filter <text>  only run benchmarks whose name contains text, e.g. LookAheadLimiter\n"
+              << "  --json <file>    write the results as JSON, e.g. to compare releases\n"
+              << "  --quick          fewer and shorter repetitions\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Settings settings;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--filter" && i + 1 < argc)
+            settings.filter = argv[++i];
+        else if (argument == "--json" && i + 1 < argc)
+            settings.jsonPath = argv[++i];
+        else if (argument == "--quick")
+        {
+            settings.options.repetitions = 5;
+            settings.options.repetitionSeconds = 0.005;
+        }
+        else
+        {
+            printUsage();
+            return argument == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    std::cout << "instruction set: " << getSimdLevelName() << ", compiler: " << getCompilerName() << "\n\n";
+
+    BenchmarkRunner runner{settings};
+    benchmarkAudioBufferHelpers(runner);
+    benchmarkLookAheadLimiter(runner);
+    benchmarkLookAheadLimiterBank(runner);
+    benchmarkResampler(runner);
+    benchmarkMultichannelResampler(runner);
+    benchmarkThreadPool(runner);
+    benchmarkSpinLock(runner);
+    benchmarkMidiFileParser(runner);
+
+    if (!settings.jsonPath.empty())
+    {
+        std::ofstream file(settings.jsonPath);
+        if (!file.is_open())
+        {
+            std::cerr << "could not open " << settings.jsonPath << "\n";
+            return EXIT_FAILURE;
+        }
+
+        const std::vector<std::pair<std::string, std::string>> context = {
+            {"instruction_set", getSimdLevelName()},
+            {"compiler", getCompilerName()},
+            {"hardware_threads", std::to_string(std::thread::hardware_concurrency())}};
+        edsp::writeBenchmarkResultsAsJson(file, context, runner.getResults());
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,198 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#include "../AudioBuffer/AudioBuffer.h"
+#include "../AudioBuffer/AudioBufferGain.h"
+#include "../AudioBuffer/AudioBufferHelpers.h"
+#include "../AudioBuffer/AudioBufferInterleaved.h"
+#include "../LookAheadLimiter/LookAheadLimiter.h"
+#include "../Resampler/StreamingResampler.h"
+#include "Benchmark.h"
+#include "CallbackSimulator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// the planar buffers of the chain have a fixed maximum channel count
+constexpr int maxChannels = 16;
+
+struct Settings
+{
+    std::string processor = "limiter";
+    int channels = 2;
+    std::string jsonPath;
+    edsp::CallbackSimulatorOptions options;
+};
+
+void fillWithNoise(float* buffer, std::size_t samples, float amplitude)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(-amplitude, amplitude);
+    for (std::size_t i = 0; i < samples; ++i)
+        buffer[i] = distribution(generator);
+}
+
+void printUsage()
+{
+    std::cout << "usage: callbackSimulator [options]\n"
+              << "  --processor <name>         limiter, resampler or chain (deinterleave, gain ramp, mix, interleave, limiter), default limiter\n"
+              << "  --block <samples>          samples per callback, default 256\n"
+              << "  --rate <Hz>                sample rate, default 48000\n"
+              << "  --channels <channels>      1 to 16, default 2\n"
+              << "  --seconds <seconds>        simulated duration, default 10\n"
+              << "  --free-running             run the callbacks back to back instead of waiting for the next period\n"
+              << "  --thread-pool-tasks <n>    ThreadPool tasks enqueued per callback, default 0\n"
+              << "  --thread-pool-task-us <us> duration of one ThreadPool task, default 200\n"
+              << "  --spin-lock-threads <n>    threads contending for a SpinLock the callback acquires, default 0\n"
+              << "  --spin-lock-hold-us <us>   how long a contending thread holds the SpinLock, default 2\n"
+              << "  --json <file>              write the options and statistics as JSON\n";
+}
+
+bool parseArguments(int argc, char** argv, Settings& settings)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (argument == "--processor" && hasValue)
+            settings.processor = argv[++i];
+        else if (argument == "--block" && hasValue)
+            settings.options.blockSize = std::atoi(argv[++i]);
+        else if (argument == "--rate" && hasValue)
+            settings.options.sampleRate = std::atof(argv[++i]);
+        else if (argument == "--channels" && hasValue)
+            settings.channels = std::atoi(argv[++i]);
+        else if (argument == "--seconds" && hasValue)
+            settings.options.seconds = std::atof(argv[++i]);
+        else if (argument == "--free-running")
+            settings.options.realTime = false;
+        else if (argument == "--thread-pool-tasks" && hasValue)
+            settings.options.threadPoolTasks = std::atoi(argv[++i]);
+        else if (argument == "--thread-pool-task-us" && hasValue)
+            settings.options.threadPoolTaskMicroseconds = std::atof(argv[++i]);
+        else if (argument == "--spin-lock-threads" && hasValue)
+            settings.options.spinLockThreads = std::atoi(argv[++i]);
+        else if (argument == "--spin-lock-hold-us" && hasValue)
+            settings.options.spinLockHoldMicroseconds = std::atof(argv[++i]);
+        else if (argument == "--json" && hasValue)
+            settings.jsonPath = argv[++i];
+        else
+            return false;
+    }
+
+    if (settings.channels > maxChannels)
+    {
+        std::cerr << "at most " << maxChannels << " channels are supported\n";
+        return false;
+    }
+
+    return settings.options.blockSize > 0 && settings.options.sampleRate > 0.0 && settings.channels > 0 && settings.options.seconds > 0.0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Settings settings;
+    if (!parseArguments(argc, argv, settings))
+    {
+        printUsage();
+        return argc == 2 && std::string(argv[1]) == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    const int channels = settings.channels;
+    const int samples = settings.options.blockSize;
+    const double sampleRate = settings.options.sampleRate;
+
+    // all memory is allocated up front, the callbacks must not allocate
+    edsp::AudioBufferInterleaved<float> input(channels, samples);
+    edsp::AudioBufferInterleaved<float> output(channels, samples);
+    edsp::AudioBuffer<float, maxChannels> planar(channels, samples);
+    edsp::AudioBuffer<float, maxChannels> planarMix(channels, samples);
+    fillWithNoise(input.getWritePointer(), static_cast<std::size_t>(channels) * samples, 1.5f);
+
+    edsp::LookAheadLimiter limiter;
+    limiter.configure(5.0f, 50.0f, -3.0f, 0.0f, channels, sampleRate);
+
+    // converts from 44.1 kHz to the device sample rate, so the input block size varies like with a real clock ratio
+    constexpr double sourceRate = 44100.0;
+    const int maxResamplerInputSamples = static_cast<int>(std::ceil(samples * sourceRate / sampleRate)) + 1;
+    std::vector<float> resamplerInput(static_cast<std::size_t>(channels) * maxResamplerInputSamples);
+    fillWithNoise(resamplerInput.data(), resamplerInput.size(), 1.0f);
+    edsp::StreamingResampler resampler{channels, sourceRate, sampleRate, samples};
+
+    std::function<void()> process;
+    if (settings.processor == "limiter")
+    {
+        process = [&]
+        {
+            edsp::copyBufferWithGain(input.getReadView(), output.getWriteView(), 1.0f);
+            limiter.process(output.getWriteView());
+            edsp::doNotOptimize(output.getWritePointer()[0]);
+        };
+    }
+    else if (settings.processor == "resampler")
+    {
+        process = [&]
+        {
+            // the callback is asked for the input that is missing for the block
+            resampler.pull(output.getWritePointer(), samples, [&](edsp::AudioBufferInterleavedView<float> destination)
+                           {
+                               const int inputSamples = std::min(destination.getNumSamples(), maxResamplerInputSamples);
+                               std::copy_n(resamplerInput.data(), static_cast<std::ptrdiff_t>(inputSamples) * channels, destination.getWritePointer());
+                               return inputSamples; });
+            edsp::doNotOptimize(output.getWritePointer()[0]);
+        };
+    }
+    else if (settings.processor == "chain")
+    {
+        process = [&]
+        {
+            edsp::deinterleaveSamples(input.getReadView(), planar.getWriteView());
+            edsp::applyGainRamp(planar.getWriteView(), 0.5f, 0.6f);
+            edsp::copyBufferWithGain(planar.getReadView(), planarMix.getWriteView(), 0.8f);
+            edsp::addBufferWithGainRamp(planar.getReadView(), planarMix.getWriteView(), 0.3f, 0.2f);
+            edsp::interleaveSamples(planarMix.getReadView(), output.getWriteView());
+            limiter.process(output.getWriteView());
+            edsp::doNotOptimize(output.getWritePointer()[0]);
+        };
+    }
+    else
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    const edsp::CallbackStatistics statistics = edsp::runCallbackSimulation(process, settings.options);
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "processor: " << settings.processor << ", channels: " << channels << ", block: " << samples << ", sample rate: " << sampleRate
+              << (settings.options.realTime ? "" : ", free running") << "\n"
+              << "callbacks: " << statistics.callbacks << ", deadline: " << statistics.deadlineUs << " us\n"
+              << "mean: " << statistics.meanUs << " us, p50: " << statistics.p50Us << " us, p90: " << statistics.p90Us << " us, p99: " << statistics.p99Us
+              << " us, p99.9: " << statistics.p999Us << " us, worst: " << statistics.worstUs << " us\n"
+              << "xruns: " << statistics.xruns << ", worst lateness: " << statistics.worstLatenessUs << " us\n";
+
+    if (!settings.jsonPath.empty())
+    {
+        std::ofstream file(settings.jsonPath);
+        if (!file.is_open())
+        {
+            std::cerr << "could not open " << settings.jsonPath << "\n";
+            return EXIT_FAILURE;
+        }
+        edsp::writeCallbackStatisticsAsJson(file, settings.options, statistics);
+    }
+
+    return EXIT_SUCCESS;
+}
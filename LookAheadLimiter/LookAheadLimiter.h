@@ -3,152 +3,1228 @@
 
 #pragma once
 
+#include "../AudioBuffer/AudioBufferHelpers.h"
+#include "../AudioBuffer/AudioBufferSimd.h"
+#include "../AudioBuffer/AudioBufferView.h"
+#include "../AudioFifo/AudioFifo.h"
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <type_traits>
 #include <vector>
 
 namespace edsp
 {
 
-class LookAheadLimiter
+namespace detail
+{
+
+// an atomic that can be copied and moved, so the limiter keeps the copy and move operations of the baseline
+// copying is not thread-safe, no other thread may write the source or the destination at the same time
+template <typename T>
+class CopyableAtomic : public std::atomic<T>
+{
+public:
+    CopyableAtomic() noexcept = default;
+
+    constexpr CopyableAtomic(T value) noexcept
+            : std::atomic<T>(value)
+    {
+    }
+
+    CopyableAtomic(const CopyableAtomic& other) noexcept
+            : std::atomic<T>(other.load(std::memory_order_relaxed))
+    {
+    }
+
+    CopyableAtomic& operator=(const CopyableAtomic& other) noexcept
+    {
+        this->store(other.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+};
+
+// maximum of the last windowSize values with O(1) cost per value (van Herk/Gil-Werman)
+// the values are split into blocks of windowSize, so the window covers the end of the previous block and the beginning of the current block
+// the maximum is the suffix maximum of the previous block combined with the running prefix maximum of the current block
+// all values must be >= 0
+class SlidingMaximum
+{
+public:
+    // allocates the memory for windows of up to maxWindowSize values, resize() does not allocate afterwards
+    void reserve(std::size_t maxWindowSize)
+    {
+        mValues.reserve(maxWindowSize + 1);
+    }
+
+    void resize(std::size_t windowSize)
+    {
+        mValues.resize(windowSize + 1); // the last element terminates the suffix maximum and stays 0
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        std::fill(mValues.begin(), mValues.end(), 0.0f);
+        mPrefixMaximum = 0.0f;
+    }
+
+    // position is the index of input[0] within the current block (0 ... windowSize - 1), it advances by one per value
+    // output[i] is the maximum of the last windowSize values up to input[i]
+    void process(const float* input, float* output, int samples, std::size_t position) noexcept
+    {
+        const std::size_t windowSize = mValues.size() - 1;
+        assert(position < windowSize);
+
+        while (samples > 0)
+        {
+            const int segmentSamples = static_cast<int>(std::min(static_cast<std::size_t>(samples), windowSize - position));
+
+            mPrefixMaximum = processSegment(input, output, segmentSamples, position, position == 0 ? 0.0f : mPrefixMaximum);
+
+            // the block is complete, turn it into the suffix maximum for the next block
+            position += static_cast<std::size_t>(segmentSamples);
+            if (position == windowSize)
+            {
+                computeSuffixMaximum(mValues.data(), windowSize);
+                position = 0;
+            }
+
+            input += segmentSamples;
+            output += segmentSamples;
+            samples -= segmentSamples;
+        }
+    }
+
+private:
+    // stores the input at position, output[i] is the maximum of the suffix maximum of the previous block and the prefix maximum of the current block
+    // groups of 4 values are scanned independently, so only one maximum per group depends on the previous group
+    float processSegment(const float* input, float* output, int samples, std::size_t position, float prefixMaximum) noexcept
+    {
+        // values[i + 1 ...] still holds the suffix maximum of the previous block, it is read before values[i] is overwritten
+        float* values = mValues.data() + position;
+
+        int i = 0;
+        for (; i + 4 <= samples; i += 4)
+        {
+            const float suffix0 = values[i + 1];
+            const float suffix1 = values[i + 2];
+            const float suffix2 = values[i + 3];
+            const float suffix3 = values[i + 4];
+            const float prefix0 = input[i];
+            const float prefix1 = std::max(prefix0, input[i + 1]);
+            const float prefix2 = std::max(prefix1, input[i + 2]);
+            const float prefix3 = std::max(prefix2, input[i + 3]);
+            std::copy(input + i, input + i + 4, values + i);
+            output[i] = std::max(suffix0, std::max(prefixMaximum, prefix0));
+            output[i + 1] = std::max(suffix1, std::max(prefixMaximum, prefix1));
+            output[i + 2] = std::max(suffix2, std::max(prefixMaximum, prefix2));
+            output[i + 3] = std::max(suffix3, std::max(prefixMaximum, prefix3));
+            prefixMaximum = std::max(prefixMaximum, prefix3);
+        }
+        for (; i < samples; ++i)
+        {
+            const float suffix = values[i + 1];
+            values[i] = input[i];
+            prefixMaximum = std::max(prefixMaximum, input[i]);
+            output[i] = std::max(suffix, prefixMaximum);
+        }
+        return prefixMaximum;
+    }
+
+    // values[i] = maximum of values[i ... size - 1], in groups of 4 like accumulatePrefixMaximum()
+    static void computeSuffixMaximum(float* values, std::size_t size) noexcept
+    {
+        float suffixMaximum = 0.0f;
+        std::size_t i = size;
+        for (; i >= 4; i -= 4)
+        {
+            const float suffix3 = values[i - 1];
+            const float suffix2 = std::max(suffix3, values[i - 2]);
+            const float suffix1 = std::max(suffix2, values[i - 3]);
+            const float suffix0 = std::max(suffix1, values[i - 4]);
+            values[i - 1] = std::max(suffixMaximum, suffix3);
+            values[i - 2] = std::max(suffixMaximum, suffix2);
+            values[i - 3] = std::max(suffixMaximum, suffix1);
+            values[i - 4] = std::max(suffixMaximum, suffix0);
+            suffixMaximum = values[i - 4];
+        }
+        for (; i > 0; --i)
+        {
+            suffixMaximum = std::max(suffixMaximum, values[i - 1]);
+            values[i - 1] = suffixMaximum;
+        }
+    }
+
+    std::vector<float> mValues;
+    float mPrefixMaximum = 0.0f;
+};
+
+// 4x oversampling FIR of ITU-R BS.1770-4 Annex 2 for true-peak detection, split into 4 phases of 12 taps
+constexpr int truePeakPhases = 4;
+constexpr int truePeakTaps = 12;
+constexpr float truePeakCoefficients[truePeakPhases][truePeakTaps] = {
+    {0.0017089843750f, 0.0109863281250f, -0.0196533203125f, 0.0332031250000f, -0.0594482421875f, 0.1373291015625f, 0.9721679687500f, -0.1022949218750f, 0.0476074218750f, -0.0266113281250f, 0.0148925781250f, -0.0083007812500f},
+    {-0.0291748046875f, 0.0292968750000f, -0.0517578125000f, 0.0891113281250f, -0.1665039062500f, 0.4650878906250f, 0.7797851562500f, -0.2003173828125f, 0.1015625000000f, -0.0582275390625f, 0.0330810546875f, -0.0189208984375f},
+    {-0.0189208984375f, 0.0330810546875f, -0.0582275390625f, 0.1015625000000f, -0.2003173828125f, 0.7797851562500f, 0.4650878906250f, -0.1665039062500f, 0.0891113281250f, -0.0517578125000f, 0.0292968750000f, -0.0291748046875f},
+    {-0.0083007812500f, 0.0148925781250f, -0.0266113281250f, 0.0476074218750f, -0.1022949218750f, 0.9721679687500f, 0.1373291015625f, -0.0594482421875f, 0.0332031250000f, -0.0196533203125f, 0.0109863281250f, 0.0017089843750f}};
+
+// the oversampled values at input sample n lie between the samples n - 6 and n - 5
+constexpr int truePeakLatency = 6;
+
+//
+// true-peak kernels, maxima[i] = max(maxima[i], |y0[i]|, ..., |y3[i]|) with the phases yk[i] = sum of truePeakCoefficients[k][tap] * source[i - tap]
+// source[-1] ... source[-11] have to be valid, every kernel sums the taps in the same order and returns exactly the same result,
+// except for compilers that contract multiply-add into FMA instructions
+//
+
+inline void truePeakAccumulateScalar(const float* source, float* maxima, int samples) noexcept
+{
+    for (int i = 0; i < samples; ++i)
+    {
+        float sum0 = truePeakCoefficients[0][0] * source[i];
+        float sum1 = truePeakCoefficients[1][0] * source[i];
+        float sum2 = truePeakCoefficients[2][0] * source[i];
+        float sum3 = truePeakCoefficients[3][0] * source[i];
+        for (int tap = 1; tap < truePeakTaps; ++tap)
+        {
+            const float input = source[i - tap];
+            sum0 = sum0 + truePeakCoefficients[0][tap] * input;
+            sum1 = sum1 + truePeakCoefficients[1][tap] * input;
+            sum2 = sum2 + truePeakCoefficients[2][tap] * input;
+            sum3 = sum3 + truePeakCoefficients[3][tap] * input;
+        }
+        maxima[i] = std::max(std::max(std::max(maxima[i], std::fabs(sum0)), std::max(std::fabs(sum1), std::fabs(sum2))), std::fabs(sum3));
+    }
+}
+
+#if defined(EDSP_SIMD_X86)
+
+// the 4 phases are independent, so their sums overlap
+EDSP_SIMD_TARGET("sse2") inline void truePeakAccumulateSse2(const float* source, float* maxima, int samples) noexcept
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        __m128 input = _mm_loadu_ps(source + i);
+        __m128 sum0 = _mm_mul_ps(_mm_set1_ps(truePeakCoefficients[0][0]), input);
+        __m128 sum1 = _mm_mul_ps(_mm_set1_ps(truePeakCoefficients[1][0]), input);
+        __m128 sum2 = _mm_mul_ps(_mm_set1_ps(truePeakCoefficients[2][0]), input);
+        __m128 sum3 = _mm_mul_ps(_mm_set1_ps(truePeakCoefficients[3][0]), input);
+        for (int tap = 1; tap < truePeakTaps; ++tap)
+        {
+            input = _mm_loadu_ps(source + i - tap);
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_set1_ps(truePeakCoefficients[0][tap]), input));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_set1_ps(truePeakCoefficients[1][tap]), input));
+            sum2 = _mm_add_ps(sum2, _mm_mul_ps(_mm_set1_ps(truePeakCoefficients[2][tap]), input));
+            sum3 = _mm_add_ps(sum3, _mm_mul_ps(_mm_set1_ps(truePeakCoefficients[3][tap]), input));
+        }
+        const __m128 peak01 = _mm_max_ps(_mm_andnot_ps(signMask, sum0), _mm_andnot_ps(signMask, sum1));
+        const __m128 peak23 = _mm_max_ps(_mm_andnot_ps(signMask, sum2), _mm_andnot_ps(signMask, sum3));
+        _mm_storeu_ps(maxima + i, _mm_max_ps(_mm_loadu_ps(maxima + i), _mm_max_ps(peak01, peak23)));
+    }
+    truePeakAccumulateScalar(source + i, maxima + i, samples - i);
+}
+
+EDSP_SIMD_TARGET("avx2") inline void truePeakAccumulateAvx2(const float* source, float* maxima, int samples) noexcept
+{
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+    {
+        __m256 input = _mm256_loadu_ps(source + i);
+        __m256 sum0 = _mm256_mul_ps(_mm256_set1_ps(truePeakCoefficients[0][0]), input);
+        __m256 sum1 = _mm256_mul_ps(_mm256_set1_ps(truePeakCoefficients[1][0]), input);
+        __m256 sum2 = _mm256_mul_ps(_mm256_set1_ps(truePeakCoefficients[2][0]), input);
+        __m256 sum3 = _mm256_mul_ps(_mm256_set1_ps(truePeakCoefficients[3][0]), input);
+        for (int tap = 1; tap < truePeakTaps; ++tap)
+        {
+            input = _mm256_loadu_ps(source + i - tap);
+            sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_set1_ps(truePeakCoefficients[0][tap]), input));
+            sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_set1_ps(truePeakCoefficients[1][tap]), input));
+            sum2 = _mm256_add_ps(sum2, _mm256_mul_ps(_mm256_set1_ps(truePeakCoefficients[2][tap]), input));
+            sum3 = _mm256_add_ps(sum3, _mm256_mul_ps(_mm256_set1_ps(truePeakCoefficients[3][tap]), input));
+        }
+        const __m256 peak01 = _mm256_max_ps(_mm256_andnot_ps(signMask, sum0), _mm256_andnot_ps(signMask, sum1));
+        const __m256 peak23 = _mm256_max_ps(_mm256_andnot_ps(signMask, sum2), _mm256_andnot_ps(signMask, sum3));
+        _mm256_storeu_ps(maxima + i, _mm256_max_ps(_mm256_loadu_ps(maxima + i), _mm256_max_ps(peak01, peak23)));
+    }
+    truePeakAccumulateScalar(source + i, maxima + i, samples - i);
+}
+
+EDSP_SIMD_AVX512_BEGIN
+
+EDSP_SIMD_TARGET("avx512f") inline void truePeakAccumulateAvx512(const float* source, float* maxima, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 16 <= samples; i += 16)
+    {
+        __m512 input = _mm512_loadu_ps(source + i);
+        __m512 sum0 = _mm512_mul_ps(_mm512_set1_ps(truePeakCoefficients[0][0]), input);
+        __m512 sum1 = _mm512_mul_ps(_mm512_set1_ps(truePeakCoefficients[1][0]), input);
+        __m512 sum2 = _mm512_mul_ps(_mm512_set1_ps(truePeakCoefficients[2][0]), input);
+        __m512 sum3 = _mm512_mul_ps(_mm512_set1_ps(truePeakCoefficients[3][0]), input);
+        for (int tap = 1; tap < truePeakTaps; ++tap)
+        {
+            input = _mm512_loadu_ps(source + i - tap);
+            sum0 = _mm512_add_ps(sum0, _mm512_mul_ps(_mm512_set1_ps(truePeakCoefficients[0][tap]), input));
+            sum1 = _mm512_add_ps(sum1, _mm512_mul_ps(_mm512_set1_ps(truePeakCoefficients[1][tap]), input));
+            sum2 = _mm512_add_ps(sum2, _mm512_mul_ps(_mm512_set1_ps(truePeakCoefficients[2][tap]), input));
+            sum3 = _mm512_add_ps(sum3, _mm512_mul_ps(_mm512_set1_ps(truePeakCoefficients[3][tap]), input));
+        }
+        const __m512 peak01 = _mm512_max_ps(_mm512_abs_ps(sum0), _mm512_abs_ps(sum1));
+        const __m512 peak23 = _mm512_max_ps(_mm512_abs_ps(sum2), _mm512_abs_ps(sum3));
+        _mm512_storeu_ps(maxima + i, _mm512_max_ps(_mm512_loadu_ps(maxima + i), _mm512_max_ps(peak01, peak23)));
+    }
+    truePeakAccumulateScalar(source + i, maxima + i, samples - i);
+}
+
+EDSP_SIMD_AVX512_END
+
+#elif defined(EDSP_SIMD_NEON)
+
+inline void truePeakAccumulateNeon(const float* source, float* maxima, int samples) noexcept
+{
+    int i = 0;
+    for (; i + 4 <= samples; i += 4)
+    {
+        float32x4_t input = vld1q_f32(source + i);
+        float32x4_t sum0 = vmulq_f32(vdupq_n_f32(truePeakCoefficients[0][0]), input);
+        float32x4_t sum1 = vmulq_f32(vdupq_n_f32(truePeakCoefficients[1][0]), input);
+        float32x4_t sum2 = vmulq_f32(vdupq_n_f32(truePeakCoefficients[2][0]), input);
+        float32x4_t sum3 = vmulq_f32(vdupq_n_f32(truePeakCoefficients[3][0]), input);
+        for (int tap = 1; tap < truePeakTaps; ++tap)
+        {
+            input = vld1q_f32(source + i - tap);
+            sum0 = vaddq_f32(sum0, vmulq_f32(vdupq_n_f32(truePeakCoefficients[0][tap]), input));
+            sum1 = vaddq_f32(sum1, vmulq_f32(vdupq_n_f32(truePeakCoefficients[1][tap]), input));
+            sum2 = vaddq_f32(sum2, vmulq_f32(vdupq_n_f32(truePeakCoefficients[2][tap]), input));
+            sum3 = vaddq_f32(sum3, vmulq_f32(vdupq_n_f32(truePeakCoefficients[3][tap]), input));
+        }
+        const float32x4_t peak01 = vmaxq_f32(vabsq_f32(sum0), vabsq_f32(sum1));
+        const float32x4_t peak23 = vmaxq_f32(vabsq_f32(sum2), vabsq_f32(sum3));
+        vst1q_f32(maxima + i, vmaxq_f32(vld1q_f32(maxima + i), vmaxq_f32(peak01, peak23)));
+    }
+    truePeakAccumulateScalar(source + i, maxima + i, samples - i);
+}
+
+#endif
+
+inline void truePeakAccumulate(const float* source, float* maxima, int samples) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+            truePeakAccumulateAvx512(source, maxima, samples);
+            return;
+        case SimdLevel::Avx2:
+            truePeakAccumulateAvx2(source, maxima, samples);
+            return;
+        case SimdLevel::Sse2:
+            truePeakAccumulateSse2(source, maxima, samples);
+            return;
+#elif defined(EDSP_SIMD_NEON)
+        case SimdLevel::Neon:
+            truePeakAccumulateNeon(source, maxima, samples);
+            return;
+#endif
+        default:
+            truePeakAccumulateScalar(source, maxima, samples);
+            return;
+    }
+}
+
+// the input of the true-peak FIR of each channel: the last truePeakTaps - 1 samples of the previous block followed by the current block
+class TruePeakHistory
+{
+public:
+    static constexpr int historySize = truePeakTaps - 1;
+
+    void resize(int channels, int blockSize)
+    {
+        mLineSize = static_cast<std::size_t>(historySize + blockSize);
+        mLines.resize(static_cast<std::size_t>(channels) * mLineSize);
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        std::fill(mLines.begin(), mLines.end(), 0.0f);
+    }
+
+    // maxima[i] = max(maxima[i], true peak at source[i]), double samples are converted to float for the detection
+    template <typename SampleType>
+    void accumulate(int channel, const SampleType* source, float* maxima, int samples) noexcept
+    {
+        float* line = mLines.data() + static_cast<std::size_t>(channel) * mLineSize;
+        std::transform(source, source + samples, line + historySize, [](SampleType sample)
+                       { return static_cast<float>(sample); });
+        truePeakAccumulate(line + historySize, maxima, samples);
+
+        // keep the last samples for the next block
+        std::copy(line + samples, line + samples + historySize, line);
+    }
+
+private:
+    std::size_t mLineSize = 0;
+    std::vector<float> mLines;
+};
+
+// coefficients of the gain envelope, the recurrence is rearranged so only one multiply-add and one maximum depend on the previous frame, see README.md
+struct EnvelopeCoefficients
+{
+    static constexpr float overshootScale = 1.11111111f;
+    static constexpr float overshootStateScale = static_cast<float>(0.1 * static_cast<double>(overshootScale));
+
+    EnvelopeCoefficients() = default;
+
+    EnvelopeCoefficients(float attackMs, float releaseMs, double sampleRate) noexcept
+    {
+        setAttackConst(computeTimeConst(attackMs, sampleRate));
+        setReleaseConst(computeTimeConst(releaseMs, sampleRate));
+    }
+
+    // coefficient of the one-pole smoother for the given attack or release time
+    static float computeTimeConst(float timeMs, double sampleRate) noexcept
+    {
+        return std::pow(0.1f, 1.0f / (timeMs * static_cast<float>(sampleRate) / 1000.0f + 1.0f));
+    }
+
+    // the setters only derive the other coefficients with a few multiplications, so the audio thread can call them
+    void setAttackConst(float value) noexcept
+    {
+        attackConst = value;
+
+        const double attack = attackConst;
+        attackComplement = 1.0f - attackConst;
+        attackOvershootConst = static_cast<float>(attack - (1.0 - attack) * 0.1 * static_cast<double>(overshootScale));
+        attackOvershootComplement = static_cast<float>((1.0 - attack) * static_cast<double>(overshootScale));
+    }
+
+    void setReleaseConst(float value) noexcept
+    {
+        releaseConst = value;
+        releaseComplement = 1.0f - releaseConst;
+
+        // the release only approaches 1 and gets stuck once its step (1 - R) * (1 - s) is below half a rounding step (2^-25),
+        // i.e. about 2^-25 / (1 - R) below 1, e.g. 3e-5 for 50 ms at 48 kHz, so it is set to 1 at twice this distance (at least 1e-6, -120 dB)
+        releasedGain = 1.0f - std::max(1.0e-6f, 0.5f * std::numeric_limits<float>::epsilon() / releaseComplement);
+    }
+
+    // one frame of the envelope, returns the smoothed gain
+    float process(float currentGain, float& fadedGain, float& smoothedState) const noexcept
+    {
+        if (currentGain >= smoothedState)
+        {
+            // release phase: R * (s - c) + c
+            fadedGain = currentGain;
+            smoothedState = releaseConst * smoothedState + releaseComplement * currentGain;
+        }
+        else
+        {
+            // avoid overshoot: the faded gain is min(f, (c - 0.1 * s) * 1.11111111)
+            const float overshootGain = overshootScale * currentGain - overshootStateScale * smoothedState;
+
+            // attack phase: A * (s - f) + f, with the overshoot gain inserted for f if it is the new faded gain
+            const float attackState = overshootGain < fadedGain ? attackOvershootConst * smoothedState + attackOvershootComplement * currentGain
+                                                                : attackConst * smoothedState + attackComplement * fadedGain;
+            fadedGain = std::min(fadedGain, overshootGain);
+
+            if (fadedGain < smoothedState)
+                smoothedState = std::max(currentGain, attackState);
+            else
+                smoothedState = releaseConst * smoothedState + releaseComplement * fadedGain; // only due to rounding
+        }
+        return smoothedState;
+    }
+
+    float attackConst = 0.0f;
+    float releaseConst = 0.0f;
+    float attackComplement = 0.0f;
+    float releaseComplement = 0.0f;
+    float attackOvershootConst = 0.0f;
+    float attackOvershootComplement = 0.0f;
+    float releasedGain = 1.0f; // above this gain the release is set to 1
+};
+
+// maxima[i] = max(maxima[i], |source[i]|)
+template <typename SampleType>
+inline void absMaxAccumulate(const SampleType* source, float* maxima, int samples) noexcept
+{
+    if constexpr (std::is_same_v<SampleType, float>)
+    {
+        simd::absMaxAccumulate(source, maxima, samples);
+        return;
+    }
+
+    for (int i = 0; i < samples; ++i)
+        maxima[i] = std::max(maxima[i], static_cast<float>(std::abs(source[i])));
+}
+
+template <typename SampleType>
+inline void delayGainClamp(SampleType* buffer, SampleType* delayLine, const float* gains, int samples, float limit, float makeupGain) noexcept
+{
+    if constexpr (std::is_same_v<SampleType, float>)
+    {
+        simd::delayGainClamp(buffer, delayLine, gains, samples, limit, makeupGain);
+        return;
+    }
+
+    const SampleType clampLimit = limit;
+    for (int i = 0; i < samples; ++i)
+    {
+        const SampleType delayedSample = delayLine[i];
+        delayLine[i] = buffer[i];
+        buffer[i] = std::clamp(delayedSample * static_cast<SampleType>(gains[i]), -clampLimit, clampLimit) * static_cast<SampleType>(makeupGain);
+    }
+}
+
+// number of values for which predicate(value) is true
+// the lanes are independent, so the compiler can vectorize the loop
+template <typename SampleType, typename Predicate>
+inline int countValues(const SampleType* values, int samples, Predicate predicate) noexcept
+{
+    constexpr int lanes = 8;
+    std::array<std::int32_t, lanes> counts{};
+    int i = 0;
+    for (; i + lanes <= samples; i += lanes)
+        for (int lane = 0; lane < lanes; ++lane)
+            counts[static_cast<std::size_t>(lane)] += predicate(values[i + lane]) ? 1 : 0;
+    for (; i < samples; ++i)
+        counts[0] += predicate(values[i]) ? 1 : 0;
+    return std::accumulate(counts.begin(), counts.end(), 0);
+}
+
+// the clamp outputs exactly limit * makeupGain, so the samples at this level were clamped
+template <typename SampleType>
+inline int countClampedSamples(const SampleType* buffer, int samples, SampleType level) noexcept
+{
+    return countValues(buffer, samples, [level](SampleType sample)
+                       { return std::abs(sample) >= level; });
+}
+
+// the gain of sample i is startGain + i * gainIncrement
+template <typename SampleType>
+inline void applyGainRamp(SampleType* buffer, int samples, float startGain, float gainIncrement) noexcept
+{
+    if constexpr (std::is_same_v<SampleType, float>)
+    {
+        simd::gainRamp<false>(buffer, buffer, samples, startGain, gainIncrement, 1);
+        return;
+    }
+
+    for (int i = 0; i < samples; ++i)
+        buffer[i] *= static_cast<SampleType>(startGain + static_cast<float>(i) * gainIncrement);
+}
+
+// delays the block with a ring buffer of delayLineSize samples that currently starts at delayLineIndex, then applies gain, clamp and makeup gain
+template <typename SampleType>
+inline void delayAndApplyGains(SampleType* buffer, SampleType* delayLine, std::size_t delayLineSize, std::size_t delayLineIndex, const float* gains, int samples, float threshold, float makeupGain) noexcept
+{
+    // the delay line might wrap around within the block
+    const int firstSegmentSamples = static_cast<int>(std::min(static_cast<std::size_t>(samples), delayLineSize - delayLineIndex));
+    delayGainClamp(buffer, delayLine + delayLineIndex, gains, firstSegmentSamples, threshold, makeupGain);
+    for (int sample = firstSegmentSamples; sample < samples; sample += static_cast<int>(delayLineSize))
+    {
+        const int segmentSamples = static_cast<int>(std::min(static_cast<std::size_t>(samples - sample), delayLineSize));
+        delayGainClamp(buffer + sample, delayLine, gains + sample, segmentSamples, threshold, makeupGain);
+    }
+}
+
+} // namespace detail
+
+// how hard a limiter works, accumulated over all process() calls since the last poll
+struct GainReductionStatistics
+{
+    static constexpr int histogramBuckets = 8;
+
+    // lower edges of the histogram buckets in dB of gain reduction
+    static constexpr std::array<float, histogramBuckets> histogramEdgesInDb{0.0f, 0.5f, 1.0f, 2.0f, 3.0f, 6.0f, 10.0f, 20.0f};
+
+    std::int64_t frames = 0;          // frames processed since the last poll
+    float minGain = 1.0f;             // lowest gain of the envelope, without makeup gain
+    float averageGain = 1.0f;         // average gain of the envelope, without makeup gain
+    std::int64_t clampedSamples = 0;  // samples of all channels that exceeded the threshold after the gain and were clamped
+    std::array<std::int64_t, histogramBuckets> histogram{}; // frames per gain reduction range
+
+    void merge(const GainReductionStatistics& other) noexcept
+    {
+        const std::int64_t totalFrames = frames + other.frames;
+        if (totalFrames > 0)
+            averageGain = static_cast<float>((static_cast<double>(averageGain) * static_cast<double>(frames) + static_cast<double>(other.averageGain) * static_cast<double>(other.frames)) / static_cast<double>(totalFrames));
+        frames = totalFrames;
+        minGain = std::min(minGain, other.minGain);
+        clampedSamples += other.clampedSamples;
+        for (std::size_t bucket = 0; bucket < histogram.size(); ++bucket)
+            histogram[bucket] += other.histogram[bucket];
+    }
+};
+
+enum class PeakDetection
+{
+    SamplePeak, // maximum absolute sample value
+    TruePeak    // maximum of the 4x oversampled signal like a true-peak meter (ITU-R BS.1770), adds 6 samples of latency
+};
+
+// SampleType is float or double, the audio is delayed and limited with this type, the gain is computed with float
+// CHANNELS > 0 fixes the number of channels at compile time, so the loops over the channels are unrolled, 0 means it is set by prepare()
+template <typename SampleType, int CHANNELS = 0>
+class BasicLookAheadLimiter
 {
 public:
-    LookAheadLimiter() = default;
+    static_assert(std::is_same_v<SampleType, float> || std::is_same_v<SampleType, double>, "SampleType must be float or double");
+    static_assert(CHANNELS >= 0, "CHANNELS must not be negative");
 
-    // configure the limiter
+    BasicLookAheadLimiter()
+    {
+        mStatisticsPositions.setCapacity(statisticsQueueSize);
+    }
+
+    // allocates all buffers for lookahead times up to maxAttackMs and up to maxChannels channels, call it before the audio thread starts
+    // the latency is the maximum lookahead, so it does not change when the attack time is changed later
+    // the limiter starts with maxAttackMs, 50 ms release, 0 dBFS threshold and no makeup gain
+    void prepare(float maxAttackMs,    // maximum attack/lookahead time in milliseconds
+                 int maxChannels,      // maximum number of channels
+                 double sampleRate,    // sample rate in Hz
+                 PeakDetection peakDetection = PeakDetection::SamplePeak)
+    {
+        assert(maxAttackMs > 0.0f);
+        assert(maxChannels > 0);
+        assert(CHANNELS == 0 || maxChannels == CHANNELS);
+        assert(sampleRate > 0.0);
+
+        mSampleRate = sampleRate;
+        mMaxAttackMs = maxAttackMs;
+        mMaxAttackInSamples = getAttackInSamples(maxAttackMs, sampleRate);
+        mChannels = maxChannels;
+        mPeakDetection = peakDetection;
+        mSmoothingSamples = std::max(1.0f, parameterSmoothingMs * static_cast<float>(sampleRate) / 1000.0f);
+
+        // only the sidechain is oversampled, the audio is delayed by the latency of the FIR
+        mDelayInSamples = mMaxAttackInSamples + (mPeakDetection == PeakDetection::TruePeak ? static_cast<std::size_t>(detail::truePeakLatency) : 0);
+
+        mSlidingMaximum.reserve(mMaxAttackInSamples);
+        mPeakHistory.resize(mMaxAttackInSamples + blockSize);
+        mThresholdHistory.resize(mDelayInSamples + blockSize);
+        mDelayBuffer.resize(mDelayInSamples * static_cast<std::size_t>(mChannels));
+        if (mPeakDetection == PeakDetection::TruePeak)
+            mTruePeakHistory.resize(mChannels, blockSize);
+
+        mScratchBuffer.resize(static_cast<std::size_t>(blockSize) * static_cast<std::size_t>(mChannels));
+        mScratchPointers.resize(static_cast<std::size_t>(mChannels));
+
+        mAttackMs = 0.0f; // the attack coefficient is computed again for the new sample rate
+        mAttackInSamples = mMaxAttackInSamples;
+        mSlidingMaximum.resize(mAttackInSamples);
+        setAttack(maxAttackMs);
+        setRelease(50.0f);
+        setThreshold(0.0f);
+        setMakeupGain(0.0f);
+        updateParameters(false);
+        reset();
+    }
+
+    // configure the limiter, prepares it for exactly this attack time and number of channels
     void configure(float attackMs,       // attack/lookahead time in milliseconds
                    float releaseMs,      // release time in milliseconds
                    float thresholdInDb,  // limiting threshold in dBFS
                    float makeupGainInDb, // makeup gain in dB
                    int channels,         // number of channels
-                   double sampleRate)    // sample rate in Hz
+                   double sampleRate,    // sample rate in Hz
+                   PeakDetection peakDetection = PeakDetection::SamplePeak)
+    {
+        assert(releaseMs > 0.0f);
+
+        prepare(attackMs, channels, sampleRate, peakDetection);
+        setRelease(releaseMs);
+        setThreshold(thresholdInDb);
+        setMakeupGain(makeupGainInDb);
+        updateParameters(false);
+    }
+
+    // the setters can be called from any thread after prepare(), also while the audio thread is processing
+    // they neither lock nor allocate, the audio thread applies the new values at the beginning of its next block
+    // threshold and makeup gain are smoothed over parameterSmoothingMs, attack and release continue from the current gain
+
+    // attack/lookahead time in milliseconds, at most the maxAttackMs of prepare()
+    void setAttack(float attackMs) noexcept
     {
         assert(attackMs > 0.0f);
+        // the coefficient and the lookahead are both derived from the time on the audio thread, so they always belong together
+        mPendingAttackMs.store(std::min(attackMs, mMaxAttackMs), std::memory_order_relaxed);
+        mParametersChanged.store(true, std::memory_order_release);
+    }
+
+    // release time in milliseconds
+    void setRelease(float releaseMs) noexcept
+    {
         assert(releaseMs > 0.0f);
-        assert(channels > 0);
-        assert(sampleRate > 0.0);
+        mPendingReleaseConst.store(detail::EnvelopeCoefficients::computeTimeConst(releaseMs, mSampleRate), std::memory_order_relaxed);
+        mParametersChanged.store(true, std::memory_order_release);
+    }
 
-        mAttackInSamples = static_cast<std::size_t>(std::ceil(attackMs * static_cast<float>(sampleRate) / 1000.0f));
-        mThreshold = std::pow(10.0f, thresholdInDb / 20.0f);
-        mMakeupGain = std::pow(10.0f, makeupGainInDb / 20.0f);
-        mChannels = channels;
+    // limiting threshold in dBFS
+    void setThreshold(float thresholdInDb) noexcept
+    {
+        mPendingThreshold.store(std::pow(10.0f, thresholdInDb / 20.0f), std::memory_order_relaxed);
+        mParametersChanged.store(true, std::memory_order_release);
+    }
 
-        mAttackConst = std::pow(0.1f, 1.0f / (attackMs * static_cast<float>(sampleRate) / 1000.0f + 1.0f));
-        mReleaseConst = std::pow(0.1f, 1.0f / (releaseMs * static_cast<float>(sampleRate) / 1000.0f + 1.0f));
+    // makeup gain in dB
+    void setMakeupGain(float makeupGainInDb) noexcept
+    {
+        mPendingMakeupGain.store(std::pow(10.0f, makeupGainInDb / 20.0f), std::memory_order_relaxed);
+        mParametersChanged.store(true, std::memory_order_release);
+    }
 
-        mMaxBuffer.resize(mAttackInSamples);
-        mDelayBuffer.resize(mAttackInSamples * static_cast<std::size_t>(mChannels));
+    // gain reduction statistics are only gathered while enabled, can be called from any thread
+    void setStatisticsEnabled(bool enabled) noexcept
+    {
+        mStatisticsEnabled.store(enabled, std::memory_order_relaxed);
+    }
 
-        reset();
+    // merges the statistics of all process() calls since the last poll, returns false if nothing was processed since then
+    // while the queue is full, the audio thread keeps accumulating and queues the frames with its first process() call after the poll
+    // wait-free, the audio thread queues one record per process() call, so the monitoring thread never touches its cache lines per sample
+    // must only be called from one thread at a time
+    bool pollStatistics(GainReductionStatistics& statistics) noexcept
+    {
+        std::size_t start = 0;
+        const int records = mStatisticsPositions.prepareRead(statisticsQueueSize, start);
+        if (records == 0)
+            return false;
+
+        statistics = {};
+        for (int record = 0; record < records; ++record)
+            statistics.merge(mStatisticsQueue[(start + static_cast<std::size_t>(record)) % statisticsQueueSize]);
+        mStatisticsPositions.finishRead(records);
+        return true;
     }
 
-    // process audio data
-    void process(float* buffer, int samples)
+    // process interleaved audio data
+    void process(SampleType* buffer, int samples)
     {
-        assert(mAttackInSamples > 0); // configure must be called beforehand
+        processInterleaved(buffer, mChannels, mChannels, samples);
+    }
 
-        for (int sample = 0; sample < samples; ++sample)
+    // process interleaved audio data, e.g. host memory or a subset of the channels of a wider buffer
+    // the buffer can have fewer channels than prepared, unless CHANNELS is set
+    void process(AudioBufferInterleavedView<SampleType> buffer)
+    {
+        assert(buffer.getNumChannels() <= mChannels);
+        assert(CHANNELS == 0 || buffer.getNumChannels() == CHANNELS);
+        processInterleaved(buffer.getWritePointer(), buffer.getNumChannels(), buffer.getFrameStride(), buffer.getNumSamples());
+    }
+
+    // process planar audio data
+    void process(SampleType** channels, int samples)
+    {
+        processPlanar(AudioBufferView<SampleType>{channels, mChannels, samples});
+    }
+
+    // process planar audio data, e.g. an AudioBuffer or a subset of its channels
+    // the buffer can have fewer channels than prepared, unless CHANNELS is set
+    void process(AudioBufferView<SampleType> buffer)
+    {
+        assert(buffer.getNumChannels() <= mChannels);
+        assert(CHANNELS == 0 || buffer.getNumChannels() == CHANNELS);
+        processPlanar(buffer);
+    }
+
+    // the delay of the audio in samples
+    int getLatencyInSamples() const noexcept
+    {
+        return static_cast<int>(mDelayInSamples);
+    }
+
+    // resets the internal state, pending parameter changes are applied without smoothing
+    void reset() noexcept
+    {
+        updateParameters(false);
+        mThreshold = mThresholdTarget;
+        mMakeupGain = mMakeupGainTarget;
+
+        mBufferIndex = 0;
+        mDelayIndex = 0;
+        mPeakHistoryIndex = 0;
+        mThresholdHistoryIndex = 0;
+        mThresholdHistoryFrames = 0;
+
+        mSlidingMaximum.reset();
+        mTruePeakHistory.reset();
+
+        std::fill(mPeakHistory.begin(), mPeakHistory.end(), peakFloor);
+        std::fill(mDelayBuffer.begin(), mDelayBuffer.end(), 0.0f);
+
+        mFadedGain = 1.0f;
+        mSmoothedState = 1.0f;
+
+        // the history only holds silence
+        mQuietWindow = true;
+        mQuietWindowPeak = peakFloor;
+
+        mStatistics = {};
+        mStatisticsGainSum = 0.0;
+    }
+
+    // duration of the threshold and makeup gain ramps after a change
+    static constexpr float parameterSmoothingMs = 20.0f;
+
+private:
+    // audio is processed in blocks of up to blockSize frames
+    static constexpr int blockSize = 256;
+
+    // records of process() calls that the monitoring thread has not polled yet
+    static constexpr int statisticsQueueSize = 64;
+
+    // the peaks are at least the smallest normal float instead of the threshold, so the peaks in the history stay valid when the threshold changes
+    // threshold / peak is > 1 below the threshold and then limited to 1, exactly like with the threshold as lower bound
+    static constexpr float peakFloor = std::numeric_limits<float>::min();
+
+    // gain of the lower edges of the histogram buckets, 10^(-dB / 20)
+    static constexpr std::array<float, GainReductionStatistics::histogramBuckets> histogramEdges{1.0f, 0.94406088f, 0.89125094f, 0.79432823f, 0.70794578f, 0.50118723f, 0.31622777f, 0.1f};
+
+    static_assert(std::atomic<float>::is_always_lock_free && std::atomic<bool>::is_always_lock_free);
+
+    static std::size_t getAttackInSamples(float attackMs, double sampleRate) noexcept
+    {
+        return std::max(std::size_t{1}, static_cast<std::size_t>(std::ceil(attackMs * static_cast<float>(sampleRate) / 1000.0f)));
+    }
+
+    // moves value by samples * increment towards target without passing it
+    static float advanceTowards(float value, float target, float increment, int samples) noexcept
+    {
+        if (value == target)
+            return value;
+        const float next = value + increment * static_cast<float>(samples);
+        return increment > 0.0f ? std::min(next, target) : std::max(next, target);
+    }
+
+    // copies the pending parameters written by the setters, runs on the audio thread at block boundaries
+    void updateParameters(bool smooth) noexcept
+    {
+        // the exchange is only done after a change, so the cache line is not written every block
+        if (!mParametersChanged.load(std::memory_order_relaxed) || !mParametersChanged.exchange(false, std::memory_order_acquire))
+            return;
+
+        mEnvelope.setReleaseConst(mPendingReleaseConst.load(std::memory_order_relaxed));
+
+        const float attackMs = mPendingAttackMs.load(std::memory_order_relaxed);
+        if (attackMs != mAttackMs)
         {
-            // store the maximum absolute sample value of all channels if the absolute value is greater than mThreshold
-            mMaxBuffer[mBufferIndex] = mThreshold;
-            for (int channel = 0; channel < mChannels; ++channel)
-                mMaxBuffer[mBufferIndex] = std::max(mMaxBuffer[mBufferIndex], std::fabs(buffer[sample * mChannels + channel]));
+            mAttackMs = attackMs;
+            mEnvelope.setAttackConst(detail::EnvelopeCoefficients::computeTimeConst(attackMs, mSampleRate));
 
-            // get the maximum absolute sample value within mMaxBuffer
-            if (mMaxBufferCurrentMaxIndex == mBufferIndex)
-            {
-                // there hasn't been a maximum or the last maximum just left the buffer
-                const auto maxElementIterator = std::max_element(mMaxBuffer.begin(), mMaxBuffer.end());
-                mMaxBufferCurrentMaxValue = *maxElementIterator;
-                mMaxBufferCurrentMaxIndex = static_cast<std::size_t>(std::distance(mMaxBuffer.begin(), maxElementIterator));
-            }
-            else
+            const std::size_t attackInSamples = std::min(getAttackInSamples(attackMs, mSampleRate), mMaxAttackInSamples);
+            if (attackInSamples != mAttackInSamples)
+                changeAttack(attackInSamples);
+        }
+
+        mThresholdTarget = mPendingThreshold.load(std::memory_order_relaxed);
+        mMakeupGainTarget = mPendingMakeupGain.load(std::memory_order_relaxed);
+        if (!smooth)
+        {
+            mThreshold = mThresholdTarget;
+            mMakeupGain = mMakeupGainTarget;
+        }
+        mThresholdIncrement = (mThresholdTarget - mThreshold) / mSmoothingSamples;
+        mMakeupGainIncrement = (mMakeupGainTarget - mMakeupGain) / mSmoothingSamples;
+    }
+
+    // changes the window of the sliding maximum within the reserved memory
+    // the new window is filled with the last peaks from the history, so neither peaks within the lookahead nor the envelope state are lost
+    void changeAttack(std::size_t attackInSamples) noexcept
+    {
+        mAttackInSamples = attackInSamples;
+        mSlidingMaximum.resize(mAttackInSamples);
+        mQuietWindow = false;
+
+        // the window ends getPeakDelay() frames before the newest peak
+        const std::size_t historySize = mPeakHistory.size();
+        primeSlidingMaximum((mPeakHistoryIndex + historySize - getPeakDelay()) % historySize);
+    }
+
+    // feeds the mAttackInSamples peaks before endIndex from the peak history into the sliding maximum, uses mGains and mMaxima as scratch
+    void primeSlidingMaximum(std::size_t endIndex) noexcept
+    {
+        mSlidingMaximum.reset();
+
+        const std::size_t historySize = mPeakHistory.size();
+        std::size_t readIndex = (endIndex + historySize - mAttackInSamples) % historySize;
+        for (std::size_t primed = 0; primed < mAttackInSamples;)
+        {
+            const int samples = static_cast<int>(std::min(mAttackInSamples - primed, static_cast<std::size_t>(blockSize)));
+            readHistory(mPeakHistory, readIndex, mGains.data(), samples);
+            mSlidingMaximum.process(mGains.data(), mMaxima.data(), samples, primed % mAttackInSamples);
+            readIndex = (readIndex + static_cast<std::size_t>(samples)) % historySize;
+            primed += static_cast<std::size_t>(samples);
+        }
+        mBufferIndex = 0;
+    }
+
+    // a lookahead shorter than the latency delays the peaks, so the window still ends at the frame that leaves the delay line
+    std::size_t getPeakDelay() const noexcept
+    {
+        return mMaxAttackInSamples - mAttackInSamples;
+    }
+
+    // the histories are ring buffers of one value per frame, they hold the last maximum delay + blockSize frames
+    static void writeHistory(std::vector<float>& history, std::size_t& writeIndex, const float* values, int samples) noexcept
+    {
+        const std::size_t firstSegmentSamples = std::min(static_cast<std::size_t>(samples), history.size() - writeIndex);
+        std::copy(values, values + firstSegmentSamples, history.data() + writeIndex);
+        std::copy(values + firstSegmentSamples, values + samples, history.data());
+        writeIndex = (writeIndex + static_cast<std::size_t>(samples)) % history.size();
+    }
+
+    static void readHistory(const std::vector<float>& history, std::size_t readIndex, float* values, int samples) noexcept
+    {
+        const std::size_t firstSegmentSamples = std::min(static_cast<std::size_t>(samples), history.size() - readIndex);
+        std::copy(history.data() + readIndex, history.data() + readIndex + firstSegmentSamples, values);
+        std::copy(history.data(), history.data() + (static_cast<std::size_t>(samples) - firstSegmentSamples), values + firstSegmentSamples);
+    }
+
+    // while the threshold changes, the clamp uses the highest threshold that was active while the frames leaving the delay line were analyzed
+    // so a lower threshold is reached by the envelope within the lookahead instead of clipping the frames that are already delayed
+    float getClampThreshold(float threshold, int samples) noexcept
+    {
+        if (threshold == mThreshold && mThresholdHistoryFrames == 0)
+            return threshold;
+
+        // the history is only kept up to date during and shortly after a change
+        if (mThresholdHistoryFrames == 0)
+            std::fill(mThresholdHistory.begin(), mThresholdHistory.end(), threshold);
+
+        const std::size_t readIndex = (mThresholdHistoryIndex + mThresholdHistory.size() - mDelayInSamples) % mThresholdHistory.size();
+        std::fill(mMaxima.begin(), mMaxima.begin() + samples, threshold);
+        writeHistory(mThresholdHistory, mThresholdHistoryIndex, mMaxima.data(), samples);
+        readHistory(mThresholdHistory, readIndex, mMaxima.data(), samples);
+
+        // frames with another threshold stay in the delay line for mDelayInSamples frames
+        const std::size_t frames = static_cast<std::size_t>(samples);
+        mThresholdHistoryFrames = threshold != mThreshold ? mDelayInSamples : mThresholdHistoryFrames - std::min(mThresholdHistoryFrames, frames);
+
+        return std::max(threshold, *std::max_element(mMaxima.begin(), mMaxima.begin() + samples));
+    }
+
+    void advanceBufferIndex(std::size_t samples) noexcept
+    {
+        mBufferIndex = (mBufferIndex + samples) % mAttackInSamples;
+    }
+
+    SampleType* getDelayLine(int channel) noexcept
+    {
+        return mDelayBuffer.data() + static_cast<std::size_t>(channel) * mDelayInSamples;
+    }
+
+    // consecutive frames are frameStride samples apart
+    void processInterleaved(SampleType* buffer, int channels, int frameStride, int samples)
+    {
+        assert(mMaxAttackInSamples > 0); // prepare or configure must be called beforehand
+
+        mGatherStatistics = mStatisticsEnabled.load(std::memory_order_relaxed);
+
+        // set per call instead of in prepare(), so a copy of the limiter does not point into the scratch buffer of the original
+        for (int channel = 0; channel < mChannels; ++channel)
+            mScratchPointers[static_cast<std::size_t>(channel)] = mScratchBuffer.data() + static_cast<std::size_t>(channel) * blockSize;
+
+        // every block is deinterleaved, processed and interleaved again, which is cheaper than processing the frames one by one
+        const AudioBufferInterleavedView<SampleType> interleavedBuffer{buffer, channels, samples, frameStride};
+        for (int blockStart = 0; blockStart < samples; blockStart += blockSize)
+        {
+            const int blockSamples = std::min(blockSize, samples - blockStart);
+            const AudioBufferInterleavedView<SampleType> interleavedBlock = interleavedBuffer.getSubBlock(blockStart, blockSamples);
+            const AudioBufferView<SampleType> planarBlock{mScratchPointers.data(), channels, blockSamples};
+
+            // without a runtime switch over the channel count
+            if constexpr (CHANNELS > 0)
             {
-                // there is a valid maximum, we just need to check if the new value is bigger than the current maximum
-                if (mMaxBuffer[mBufferIndex] >= mMaxBufferCurrentMaxValue)
+                if (interleavedBlock.isContiguous())
                 {
-                    mMaxBufferCurrentMaxValue = mMaxBuffer[mBufferIndex];
-                    mMaxBufferCurrentMaxIndex = mBufferIndex;
+                    const SampleType* source[CHANNELS];
+                    std::copy(mScratchPointers.begin(), mScratchPointers.begin() + CHANNELS, source);
+
+                    deinterleaveSamples<CHANNELS>(interleavedBlock.getReadPointer(), mScratchPointers.data(), blockSamples);
+                    processBlock(planarBlock);
+                    interleaveSamples<CHANNELS>(source, interleavedBlock.getWritePointer(), blockSamples);
+                    continue;
                 }
             }
 
-            const float currentGain = std::min(1.0f, mThreshold / mMaxBufferCurrentMaxValue);
+            deinterleaveSamples(AudioBufferInterleavedView<const SampleType>{interleavedBlock}, planarBlock);
+            processBlock(planarBlock);
+            interleaveSamples(AudioBufferView<const SampleType>{planarBlock}, interleavedBlock);
+        }
+
+        if (mGatherStatistics)
+            publishStatistics();
+    }
+
+    void processPlanar(AudioBufferView<SampleType> buffer)
+    {
+        assert(mMaxAttackInSamples > 0); // prepare or configure must be called beforehand
+
+        mGatherStatistics = mStatisticsEnabled.load(std::memory_order_relaxed);
+
+        for (int blockStart = 0; blockStart < buffer.getNumSamples(); blockStart += blockSize)
+            processBlock(buffer.getSubBlock(blockStart, std::min(blockSize, buffer.getNumSamples() - blockStart)));
+
+        if (mGatherStatistics)
+            publishStatistics();
+    }
 
-            // avoid overshoot
-            if (currentGain < mSmoothedState)
-                mFadedGain = std::min(mFadedGain, (currentGain - 0.1f * mSmoothedState) * 1.11111111f);
+    // 1. maximum absolute (true-)peak value of all channels per frame (vectorized)
+    // 2. gain per frame (sequential)
+    // 3. delay, gain, clamp and makeup gain per channel (vectorized)
+    void processBlock(AudioBufferView<SampleType> block) noexcept
+    {
+        const int samples = block.getNumSamples();
+        const int channels = CHANNELS > 0 ? CHANNELS : block.getNumChannels();
+        assert(samples <= blockSize);
+
+        updateParameters(true);
+
+        // the threshold is constant within a block, the envelope smoothes its steps
+        const float threshold = mThreshold;
+        mThreshold = advanceTowards(mThreshold, mThresholdTarget, mThresholdIncrement, samples);
+
+        std::fill(mGains.begin(), mGains.begin() + samples, peakFloor);
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            if (mPeakDetection == PeakDetection::TruePeak)
+                mTruePeakHistory.accumulate(channel, block.getReadPointer(channel), mGains.data(), samples);
             else
-                mFadedGain = currentGain;
+                detail::absMaxAccumulate(block.getReadPointer(channel), mGains.data(), samples);
+        }
 
-            if (mFadedGain < mSmoothedState)
+        computeGains(samples, threshold);
+        const float clampThreshold = getClampThreshold(threshold, samples);
+        if (mGatherStatistics)
+            accumulateGainStatistics(samples);
+
+        // the makeup gain ramps linearly within the block while it is smoothed
+        const float makeupGain = mMakeupGain;
+        mMakeupGain = advanceTowards(mMakeupGain, mMakeupGainTarget, mMakeupGainIncrement, samples);
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            SampleType* buffer = block.getWritePointer(channel);
+            if (makeupGain == mMakeupGain)
             {
-                // attack phase
-                mSmoothedState = std::max(currentGain, mAttackConst * (mSmoothedState - mFadedGain) + mFadedGain);
+                detail::delayAndApplyGains(buffer, getDelayLine(channel), mDelayInSamples, mDelayIndex, mGains.data(), samples, clampThreshold, makeupGain);
+                if (mGatherStatistics)
+                    mStatistics.clampedSamples += detail::countClampedSamples(buffer, samples, static_cast<SampleType>(clampThreshold) * static_cast<SampleType>(makeupGain));
             }
             else
             {
-                // release phase
-                mSmoothedState = mReleaseConst * (mSmoothedState - mFadedGain) + mFadedGain;
+                detail::delayAndApplyGains(buffer, getDelayLine(channel), mDelayInSamples, mDelayIndex, mGains.data(), samples, clampThreshold, 1.0f);
+                if (mGatherStatistics)
+                    mStatistics.clampedSamples += detail::countClampedSamples(buffer, samples, static_cast<SampleType>(clampThreshold));
+                detail::applyGainRamp(buffer, samples, makeupGain, (mMakeupGain - makeupGain) / static_cast<float>(samples));
             }
+        }
+        mDelayIndex = (mDelayIndex + static_cast<std::size_t>(samples)) % mDelayInSamples;
+    }
 
-            for (int channel = 0; channel < mChannels; ++channel)
-            {
-                // fill delay buffer
-                const std::size_t currentDelayBufferIndex = mBufferIndex * static_cast<std::size_t>(mChannels) + static_cast<std::size_t>(channel);
-                float sampleValue = mDelayBuffer[currentDelayBufferIndex];
-                mDelayBuffer[currentDelayBufferIndex] = buffer[sample * mChannels + channel];
+    // minimum, sum and histogram of the gains in mGains
+    void accumulateGainStatistics(int samples) noexcept
+    {
+        // independent partial results, so the loop does not wait for the previous frame
+        constexpr int lanes = 8;
+        std::array<float, lanes> minima;
+        std::array<float, lanes> sums{};
+        minima.fill(1.0f);
 
-                // apply gain reduction
-                sampleValue *= mSmoothedState;
-                sampleValue = std::clamp(sampleValue, -mThreshold, mThreshold);
+        int sample = 0;
+        for (; sample + lanes <= samples; sample += lanes)
+        {
+            for (int lane = 0; lane < lanes; ++lane)
+            {
+                const float gain = mGains[static_cast<std::size_t>(sample + lane)];
+                minima[static_cast<std::size_t>(lane)] = std::min(minima[static_cast<std::size_t>(lane)], gain);
+                sums[static_cast<std::size_t>(lane)] += gain;
+            }
+        }
+        for (; sample < samples; ++sample)
+        {
+            minima[0] = std::min(minima[0], mGains[static_cast<std::size_t>(sample)]);
+            sums[0] += mGains[static_cast<std::size_t>(sample)];
+        }
 
-                // apply makeup gain
-                sampleValue *= mMakeupGain;
+        const float minGain = *std::min_element(minima.begin(), minima.end());
+        mStatistics.minGain = std::min(mStatistics.minGain, minGain);
+        mStatisticsGainSum += static_cast<double>(std::accumulate(sums.begin(), sums.end(), 0.0f));
+        mStatistics.frames += samples;
 
-                buffer[sample * mChannels + channel] = sampleValue;
-            }
+        // usually the whole block is in the first bucket
+        if (minGain > histogramEdges[1])
+        {
+            mStatistics.histogram[0] += samples;
+            return;
+        }
 
-            ++mBufferIndex;
-            if (mBufferIndex >= mAttackInSamples)
-                mBufferIndex = 0;
+        // frames with at least the gain reduction of each edge, no frame reaches the edges below minGain
+        std::array<std::int32_t, GainReductionStatistics::histogramBuckets> counts{};
+        counts[0] = samples;
+        for (std::size_t edge = 1; edge < counts.size() && histogramEdges[edge] >= minGain; ++edge)
+        {
+            const float edgeGain = histogramEdges[edge];
+            counts[edge] = detail::countValues(mGains.data(), samples, [edgeGain](float gain)
+                                               { return gain <= edgeGain; });
         }
+
+        for (std::size_t bucket = 0; bucket + 1 < counts.size(); ++bucket)
+            mStatistics.histogram[bucket] += counts[bucket] - counts[bucket + 1];
+        mStatistics.histogram.back() += counts.back();
     }
 
-    // resets the internal state
-    void reset() noexcept
+    // queues the accumulated statistics for the monitoring thread, they keep accumulating while the queue is full
+    void publishStatistics() noexcept
     {
-        mBufferIndex = 0;
+        std::size_t start = 0;
+        if (mStatistics.frames == 0 || mStatisticsPositions.prepareWrite(1, start) == 0)
+            return;
 
-        std::fill(mMaxBuffer.begin(), mMaxBuffer.end(), 0.0f);
-        mMaxBufferCurrentMaxValue = 0.0f;
-        mMaxBufferCurrentMaxIndex = 0;
+        mStatistics.averageGain = static_cast<float>(mStatisticsGainSum / static_cast<double>(mStatistics.frames));
+        mStatisticsQueue[start] = mStatistics;
+        mStatisticsPositions.finishWrite(1);
 
-        std::fill(mDelayBuffer.begin(), mDelayBuffer.end(), 0.0f);
+        mStatistics = {};
+        mStatisticsGainSum = 0.0;
+    }
 
-        mFadedGain = 1.0f;
-        mSmoothedState = 1.0f;
+    // replaces the peaks in mGains with the smoothed gains
+    void computeGains(int samples, float threshold) noexcept
+    {
+        // a shorter lookahead than prepared reads the peaks delayed from the history
+        const std::size_t peakDelay = getPeakDelay();
+        const std::size_t readIndex = (mPeakHistoryIndex + mPeakHistory.size() - peakDelay) % mPeakHistory.size();
+        writeHistory(mPeakHistory, mPeakHistoryIndex, mGains.data(), samples);
+        if (peakDelay > 0)
+            readHistory(mPeakHistory, readIndex, mGains.data(), samples);
+
+        // all peaks within the window are known to be below the threshold and the envelope has released
+        // as long as the new peaks stay below the threshold too, every gain is 1 and the sliding maximum is not needed
+        if (mQuietWindow)
+        {
+            const float windowPeak = std::max(mQuietWindowPeak, simd::absMax(mGains.data(), samples));
+            if (windowPeak <= threshold)
+            {
+                mQuietWindowPeak = windowPeak;
+                std::fill(mGains.begin(), mGains.begin() + samples, 1.0f);
+                return;
+            }
+
+            // restore the window from the history and continue with the full path
+            mQuietWindow = false;
+            primeSlidingMaximum(readIndex);
+            readHistory(mPeakHistory, readIndex, mGains.data(), samples);
+        }
+
+        // maximum within the last mAttackInSamples samples
+        mSlidingMaximum.process(mGains.data(), mMaxima.data(), samples, mBufferIndex);
+        advanceBufferIndex(static_cast<std::size_t>(samples));
+
+        // the window fell below the threshold after the envelope has released, every gain is 1 from here on
+        // the release only approaches 1, so it is snapped to 1 once it is close enough
+        if (mSmoothedState >= mEnvelope.releasedGain)
+        {
+            const float windowPeak = simd::absMax(mMaxima.data(), samples);
+            if (windowPeak <= threshold)
+            {
+                std::fill(mGains.begin(), mGains.begin() + samples, 1.0f);
+                mFadedGain = 1.0f;
+                mSmoothedState = 1.0f;
+                mQuietWindow = true;
+                mQuietWindowPeak = windowPeak;
+                return;
+            }
+        }
+
+        // the state is kept in registers during the loop
+        float fadedGain = mFadedGain;
+        float smoothedState = mSmoothedState;
+
+        for (int sample = 0; sample < samples; ++sample)
+        {
+            // does not depend on the previous frame and overlaps with the recurrence
+            const float currentGain = std::min(1.0f, threshold / mMaxima[static_cast<std::size_t>(sample)]);
+            mGains[static_cast<std::size_t>(sample)] = mEnvelope.process(currentGain, fadedGain, smoothedState);
+        }
+
+        mFadedGain = fadedGain;
+        mSmoothedState = smoothedState;
     }
 
-private:
+    double mSampleRate = 0.0;
+    float mMaxAttackMs = 0.0f;
+    std::size_t mMaxAttackInSamples = 0;
+    float mAttackMs = 0.0f;
     std::size_t mAttackInSamples = 0;
-    float mAttackConst = 0.0f;
-    float mReleaseConst = 0.0f;
+    std::size_t mDelayInSamples = 0;
+    detail::EnvelopeCoefficients mEnvelope;
+    int mChannels = 0;
+    PeakDetection mPeakDetection = PeakDetection::SamplePeak;
+
+    // current values and linear ramps towards the targets
     float mThreshold = 0.0f;
+    float mThresholdTarget = 0.0f;
+    float mThresholdIncrement = 0.0f;
     float mMakeupGain = 0.0f;
-    int mChannels = 0;
+    float mMakeupGainTarget = 0.0f;
+    float mMakeupGainIncrement = 0.0f;
+    float mSmoothingSamples = 1.0f;
 
-    std::size_t mBufferIndex = 0;
+    // written by the setters, read by the audio thread
+    detail::CopyableAtomic<float> mPendingAttackMs{0.0f};
+    detail::CopyableAtomic<float> mPendingReleaseConst{0.0f};
+    detail::CopyableAtomic<float> mPendingThreshold{1.0f};
+    detail::CopyableAtomic<float> mPendingMakeupGain{1.0f};
+    detail::CopyableAtomic<bool> mParametersChanged{false};
 
-    std::vector<float> mMaxBuffer;
-    float mMaxBufferCurrentMaxValue = 0.0f;
-    std::size_t mMaxBufferCurrentMaxIndex = 0;
+    std::size_t mBufferIndex = 0;      // position within the sliding maximum
+    std::size_t mDelayIndex = 0;       // position within the delay line
+    std::size_t mPeakHistoryIndex = 0; // position within the peak history
+    std::size_t mThresholdHistoryIndex = 0;
+    std::size_t mThresholdHistoryFrames = 0; // frames until the delay line only contains frames analyzed with the current threshold
 
-    std::vector<float> mDelayBuffer;
+    detail::SlidingMaximum mSlidingMaximum;
+    detail::TruePeakHistory mTruePeakHistory;
+
+    std::vector<float> mPeakHistory;      // peaks of the last mMaxAttackInSamples + blockSize frames
+    std::vector<float> mThresholdHistory; // thresholds of the last mDelayInSamples + blockSize frames
+    std::vector<SampleType> mDelayBuffer; // planar, mDelayInSamples per channel
+    std::array<float, blockSize> mGains{};
+    std::array<float, blockSize> mMaxima{};
+
+    // planar copy of one block of interleaved audio data
+    std::vector<SampleType> mScratchBuffer;
+    std::vector<SampleType*> mScratchPointers;
 
     float mFadedGain = 1.0f;
     float mSmoothedState = 1.0f;
+
+    // the sliding maximum is skipped while the window is known to be below the threshold, mQuietWindowPeak is an upper bound of its peaks
+    bool mQuietWindow = false;
+    float mQuietWindowPeak = 0.0f;
+
+    // accumulated by the audio thread until the monitoring thread has read them
+    detail::CopyableAtomic<bool> mStatisticsEnabled{false};
+    bool mGatherStatistics = false;
+    GainReductionStatistics mStatistics;
+    double mStatisticsGainSum = 0.0;
+    detail::FifoPositions mStatisticsPositions;
+    std::array<GainReductionStatistics, statisticsQueueSize> mStatisticsQueue{};
 };
 
+// the original float limiter with the number of channels set by prepare() or configure()
+using LookAheadLimiter = BasicLookAheadLimiter<float>;
+
 } // namespace edsp
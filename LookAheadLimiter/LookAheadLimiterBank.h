@@ -0,0 +1,613 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "../AudioBuffer/AudioBufferHelpers.h"
+#include "../AudioBuffer/AudioBufferSimd.h"
+#include "../AudioBuffer/AudioBufferView.h"
+#include "LookAheadLimiter.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace edsp
+{
+
+namespace detail
+{
+
+// threshold, envelope coefficients and envelope state of all limiters of a bank, one lane per limiter (structure of arrays)
+// unused lanes have a threshold of 1 and release towards a gain of 1, so they stay there
+struct EnvelopeLanes
+{
+    // lanes are processed in groups of 16, the number of lanes is a multiple of it
+    static constexpr std::size_t laneGroupSize = 16;
+
+    void resize(std::size_t limiters)
+    {
+        const std::size_t lanes = (limiters + laneGroupSize - 1) / laneGroupSize * laneGroupSize;
+        for (std::vector<float>* values : {&attackConst, &attackComplement, &attackOvershootConst, &attackOvershootComplement, &releaseConst})
+            values->assign(lanes, 0.0f);
+        threshold.assign(lanes, 1.0f);
+        releaseComplement.assign(lanes, 1.0f);
+        fadedGain.assign(lanes, 1.0f);
+        smoothedState.assign(lanes, 1.0f);
+    }
+
+    std::size_t size() const noexcept
+    {
+        return smoothedState.size();
+    }
+
+    void setCoefficients(std::size_t lane, const EnvelopeCoefficients& coefficients) noexcept
+    {
+        attackConst[lane] = coefficients.attackConst;
+        releaseConst[lane] = coefficients.releaseConst;
+        attackComplement[lane] = coefficients.attackComplement;
+        releaseComplement[lane] = coefficients.releaseComplement;
+        attackOvershootConst[lane] = coefficients.attackOvershootConst;
+        attackOvershootComplement[lane] = coefficients.attackOvershootComplement;
+    }
+
+    void reset(std::size_t lane) noexcept
+    {
+        fadedGain[lane] = 1.0f;
+        smoothedState[lane] = 1.0f;
+    }
+
+    std::vector<float> threshold;
+    std::vector<float> attackConst;
+    std::vector<float> releaseConst;
+    std::vector<float> attackComplement;
+    std::vector<float> releaseComplement;
+    std::vector<float> attackOvershootConst;
+    std::vector<float> attackOvershootComplement;
+    std::vector<float> fadedGain;
+    std::vector<float> smoothedState;
+};
+
+//
+// envelope kernels, gains holds frames rows of 16 peaks per group of 16 lanes, they are replaced with the smoothed gains
+// the peaks are the sliding maxima and at least the threshold, the current gain is min(1, threshold / peak) like in LookAheadLimiter
+// the branches of EnvelopeCoefficients::process() are replaced with selects, so every kernel returns exactly the same result
+// as LookAheadLimiter, unless the whole program is compiled with FMA contraction (e.g. -march=native without -ffp-contract=off)
+//
+
+// index of the peak or gain of a lane and frame within gains
+inline std::size_t getEnvelopeIndex(std::size_t lane, int frame, int frames) noexcept
+{
+    constexpr std::size_t groupSize = EnvelopeLanes::laneGroupSize;
+    return (lane / groupSize) * groupSize * static_cast<std::size_t>(frames) + static_cast<std::size_t>(frame) * groupSize + lane % groupSize;
+}
+
+inline void computeEnvelopesScalar(EnvelopeLanes& lanes, float* gains, int frames) noexcept
+{
+    const std::size_t laneCount = lanes.size();
+    for (std::size_t lane = 0; lane < laneCount; ++lane)
+    {
+        EnvelopeCoefficients coefficients;
+        coefficients.attackConst = lanes.attackConst[lane];
+        coefficients.releaseConst = lanes.releaseConst[lane];
+        coefficients.attackComplement = lanes.attackComplement[lane];
+        coefficients.releaseComplement = lanes.releaseComplement[lane];
+        coefficients.attackOvershootConst = lanes.attackOvershootConst[lane];
+        coefficients.attackOvershootComplement = lanes.attackOvershootComplement[lane];
+
+        const float threshold = lanes.threshold[lane];
+        float fadedGain = lanes.fadedGain[lane];
+        float smoothedState = lanes.smoothedState[lane];
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            float& gain = gains[getEnvelopeIndex(lane, frame, frames)];
+            gain = coefficients.process(std::min(1.0f, threshold / gain), fadedGain, smoothedState);
+        }
+        lanes.fadedGain[lane] = fadedGain;
+        lanes.smoothedState[lane] = smoothedState;
+    }
+}
+
+#if defined(EDSP_SIMD_X86)
+
+EDSP_SIMD_TARGET("sse2") inline __m128 selectSse2(__m128 mask, __m128 a, __m128 b) noexcept
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// one frame of 4 lanes
+EDSP_SIMD_TARGET("sse2") inline void envelopeStepSse2(const EnvelopeLanes& lanes, std::size_t lane, float* gains, __m128& fadedGain, __m128& smoothedState) noexcept
+{
+    const __m128 currentGain = _mm_min_ps(_mm_div_ps(_mm_loadu_ps(lanes.threshold.data() + lane), _mm_loadu_ps(gains)), _mm_set1_ps(1.0f));
+    const __m128 release = _mm_cmpge_ps(currentGain, smoothedState);
+
+    const __m128 overshootGain = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(EnvelopeCoefficients::overshootScale), currentGain),
+                                            _mm_mul_ps(_mm_set1_ps(EnvelopeCoefficients::overshootStateScale), smoothedState));
+    const __m128 overshootAttackState = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(lanes.attackOvershootConst.data() + lane), smoothedState),
+                                                   _mm_mul_ps(_mm_loadu_ps(lanes.attackOvershootComplement.data() + lane), currentGain));
+    const __m128 attackState = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(lanes.attackConst.data() + lane), smoothedState),
+                                          _mm_mul_ps(_mm_loadu_ps(lanes.attackComplement.data() + lane), fadedGain));
+    const __m128 attackSmoothedState = _mm_max_ps(selectSse2(_mm_cmplt_ps(overshootGain, fadedGain), overshootAttackState, attackState), currentGain);
+    const __m128 attackFadedGain = _mm_min_ps(overshootGain, fadedGain);
+
+    // the release formula is also used in the attack phase if the faded gain is not below the state
+    fadedGain = selectSse2(release, currentGain, attackFadedGain);
+    const __m128 releaseSmoothedState = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(lanes.releaseConst.data() + lane), smoothedState),
+                                                   _mm_mul_ps(_mm_loadu_ps(lanes.releaseComplement.data() + lane), fadedGain));
+    smoothedState = selectSse2(_mm_or_ps(release, _mm_cmpge_ps(attackFadedGain, smoothedState)), releaseSmoothedState, attackSmoothedState);
+    _mm_storeu_ps(gains, smoothedState);
+}
+
+EDSP_SIMD_TARGET("sse2") inline void computeEnvelopesSse2(EnvelopeLanes& lanes, float* gains, int frames) noexcept
+{
+    const std::size_t laneCount = lanes.size();
+    for (std::size_t lane = 0; lane < laneCount; lane += EnvelopeLanes::laneGroupSize)
+    {
+        // 4 independent recurrences hide the latency of each other
+        __m128 fadedGain[4];
+        __m128 smoothedState[4];
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            fadedGain[i] = _mm_loadu_ps(lanes.fadedGain.data() + lane + 4 * i);
+            smoothedState[i] = _mm_loadu_ps(lanes.smoothedState.data() + lane + 4 * i);
+        }
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            float* frameGains = gains + getEnvelopeIndex(lane, frame, frames);
+            for (std::size_t i = 0; i < 4; ++i)
+                envelopeStepSse2(lanes, lane + 4 * i, frameGains + 4 * i, fadedGain[i], smoothedState[i]);
+        }
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            _mm_storeu_ps(lanes.fadedGain.data() + lane + 4 * i, fadedGain[i]);
+            _mm_storeu_ps(lanes.smoothedState.data() + lane + 4 * i, smoothedState[i]);
+        }
+    }
+}
+
+// one frame of 8 lanes
+EDSP_SIMD_TARGET("avx2") inline void envelopeStepAvx2(const EnvelopeLanes& lanes, std::size_t lane, float* gains, __m256& fadedGain, __m256& smoothedState) noexcept
+{
+    const __m256 currentGain = _mm256_min_ps(_mm256_div_ps(_mm256_loadu_ps(lanes.threshold.data() + lane), _mm256_loadu_ps(gains)), _mm256_set1_ps(1.0f));
+    const __m256 release = _mm256_cmp_ps(currentGain, smoothedState, _CMP_GE_OQ);
+
+    const __m256 overshootGain = _mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(EnvelopeCoefficients::overshootScale), currentGain),
+                                               _mm256_mul_ps(_mm256_set1_ps(EnvelopeCoefficients::overshootStateScale), smoothedState));
+    const __m256 overshootAttackState = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(lanes.attackOvershootConst.data() + lane), smoothedState),
+                                                      _mm256_mul_ps(_mm256_loadu_ps(lanes.attackOvershootComplement.data() + lane), currentGain));
+    const __m256 attackState = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(lanes.attackConst.data() + lane), smoothedState),
+                                             _mm256_mul_ps(_mm256_loadu_ps(lanes.attackComplement.data() + lane), fadedGain));
+    const __m256 attackSmoothedState = _mm256_max_ps(_mm256_blendv_ps(attackState, overshootAttackState, _mm256_cmp_ps(overshootGain, fadedGain, _CMP_LT_OQ)), currentGain);
+    const __m256 attackFadedGain = _mm256_min_ps(overshootGain, fadedGain);
+
+    // the release formula is also used in the attack phase if the faded gain is not below the state
+    fadedGain = _mm256_blendv_ps(attackFadedGain, currentGain, release);
+    const __m256 releaseSmoothedState = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(lanes.releaseConst.data() + lane), smoothedState),
+                                                      _mm256_mul_ps(_mm256_loadu_ps(lanes.releaseComplement.data() + lane), fadedGain));
+    smoothedState = _mm256_blendv_ps(attackSmoothedState, releaseSmoothedState, _mm256_or_ps(release, _mm256_cmp_ps(attackFadedGain, smoothedState, _CMP_GE_OQ)));
+    _mm256_storeu_ps(gains, smoothedState);
+}
+
+EDSP_SIMD_TARGET("avx2") inline void computeEnvelopesAvx2(EnvelopeLanes& lanes, float* gains, int frames) noexcept
+{
+    const std::size_t laneCount = lanes.size();
+    for (std::size_t lane = 0; lane < laneCount; lane += EnvelopeLanes::laneGroupSize)
+    {
+        __m256 fadedGain0 = _mm256_loadu_ps(lanes.fadedGain.data() + lane);
+        __m256 fadedGain1 = _mm256_loadu_ps(lanes.fadedGain.data() + lane + 8);
+        __m256 smoothedState0 = _mm256_loadu_ps(lanes.smoothedState.data() + lane);
+        __m256 smoothedState1 = _mm256_loadu_ps(lanes.smoothedState.data() + lane + 8);
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            float* frameGains = gains + getEnvelopeIndex(lane, frame, frames);
+            envelopeStepAvx2(lanes, lane, frameGains, fadedGain0, smoothedState0);
+            envelopeStepAvx2(lanes, lane + 8, frameGains + 8, fadedGain1, smoothedState1);
+        }
+        _mm256_storeu_ps(lanes.fadedGain.data() + lane, fadedGain0);
+        _mm256_storeu_ps(lanes.fadedGain.data() + lane + 8, fadedGain1);
+        _mm256_storeu_ps(lanes.smoothedState.data() + lane, smoothedState0);
+        _mm256_storeu_ps(lanes.smoothedState.data() + lane + 8, smoothedState1);
+    }
+}
+
+EDSP_SIMD_AVX512_BEGIN
+
+// the avx512f target also enables FMA, the embedded rounding (the default round to nearest) keeps the compiler from contracting a * b + c * d
+constexpr int envelopeRoundingAvx512 = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+
+EDSP_SIMD_TARGET("avx512f") inline __m512 multiplyAddAvx512(__m512 a, __m512 b, __m512 c, __m512 d) noexcept
+{
+    return _mm512_add_round_ps(_mm512_mul_round_ps(a, b, envelopeRoundingAvx512), _mm512_mul_round_ps(c, d, envelopeRoundingAvx512), envelopeRoundingAvx512);
+}
+
+EDSP_SIMD_TARGET("avx512f") inline __m512 multiplySubtractAvx512(__m512 a, __m512 b, __m512 c, __m512 d) noexcept
+{
+    return _mm512_sub_round_ps(_mm512_mul_round_ps(a, b, envelopeRoundingAvx512), _mm512_mul_round_ps(c, d, envelopeRoundingAvx512), envelopeRoundingAvx512);
+}
+
+// one frame of 16 lanes
+EDSP_SIMD_TARGET("avx512f") inline void envelopeStepAvx512(const EnvelopeLanes& lanes, std::size_t lane, float* gains, __m512& fadedGain, __m512& smoothedState) noexcept
+{
+    const __m512 currentGain = _mm512_min_ps(_mm512_div_ps(_mm512_loadu_ps(lanes.threshold.data() + lane), _mm512_loadu_ps(gains)), _mm512_set1_ps(1.0f));
+    const __mmask16 release = _mm512_cmp_ps_mask(currentGain, smoothedState, _CMP_GE_OQ);
+
+    const __m512 overshootGain = multiplySubtractAvx512(_mm512_set1_ps(EnvelopeCoefficients::overshootScale), currentGain,
+                                                        _mm512_set1_ps(EnvelopeCoefficients::overshootStateScale), smoothedState);
+    const __m512 overshootAttackState = multiplyAddAvx512(_mm512_loadu_ps(lanes.attackOvershootConst.data() + lane), smoothedState,
+                                                          _mm512_loadu_ps(lanes.attackOvershootComplement.data() + lane), currentGain);
+    const __m512 attackState = multiplyAddAvx512(_mm512_loadu_ps(lanes.attackConst.data() + lane), smoothedState,
+                                                 _mm512_loadu_ps(lanes.attackComplement.data() + lane), fadedGain);
+    const __m512 attackSmoothedState = _mm512_max_ps(_mm512_mask_blend_ps(_mm512_cmp_ps_mask(overshootGain, fadedGain, _CMP_LT_OQ), attackState, overshootAttackState), currentGain);
+    const __m512 attackFadedGain = _mm512_min_ps(overshootGain, fadedGain);
+
+    // the release formula is also used in the attack phase if the faded gain is not below the state
+    fadedGain = _mm512_mask_blend_ps(release, attackFadedGain, currentGain);
+    const __m512 releaseSmoothedState = multiplyAddAvx512(_mm512_loadu_ps(lanes.releaseConst.data() + lane), smoothedState,
+                                                          _mm512_loadu_ps(lanes.releaseComplement.data() + lane), fadedGain);
+    const __mmask16 useRelease = static_cast<__mmask16>(release | _mm512_cmp_ps_mask(attackFadedGain, smoothedState, _CMP_GE_OQ));
+    smoothedState = _mm512_mask_blend_ps(useRelease, attackSmoothedState, releaseSmoothedState);
+    _mm512_storeu_ps(gains, smoothedState);
+}
+
+EDSP_SIMD_TARGET("avx512f") inline void computeEnvelopesAvx512(EnvelopeLanes& lanes, float* gains, int frames) noexcept
+{
+    const std::size_t laneCount = lanes.size();
+    std::size_t lane = 0;
+
+    // two groups at once, so two independent recurrences hide the latency of each other
+    for (; lane + 2 * EnvelopeLanes::laneGroupSize <= laneCount; lane += 2 * EnvelopeLanes::laneGroupSize)
+    {
+        const std::size_t nextLane = lane + EnvelopeLanes::laneGroupSize;
+        __m512 fadedGain0 = _mm512_loadu_ps(lanes.fadedGain.data() + lane);
+        __m512 fadedGain1 = _mm512_loadu_ps(lanes.fadedGain.data() + nextLane);
+        __m512 smoothedState0 = _mm512_loadu_ps(lanes.smoothedState.data() + lane);
+        __m512 smoothedState1 = _mm512_loadu_ps(lanes.smoothedState.data() + nextLane);
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            envelopeStepAvx512(lanes, lane, gains + getEnvelopeIndex(lane, frame, frames), fadedGain0, smoothedState0);
+            envelopeStepAvx512(lanes, nextLane, gains + getEnvelopeIndex(nextLane, frame, frames), fadedGain1, smoothedState1);
+        }
+        _mm512_storeu_ps(lanes.fadedGain.data() + lane, fadedGain0);
+        _mm512_storeu_ps(lanes.fadedGain.data() + nextLane, fadedGain1);
+        _mm512_storeu_ps(lanes.smoothedState.data() + lane, smoothedState0);
+        _mm512_storeu_ps(lanes.smoothedState.data() + nextLane, smoothedState1);
+    }
+
+    if (lane < laneCount)
+    {
+        __m512 fadedGain = _mm512_loadu_ps(lanes.fadedGain.data() + lane);
+        __m512 smoothedState = _mm512_loadu_ps(lanes.smoothedState.data() + lane);
+        for (int frame = 0; frame < frames; ++frame)
+            envelopeStepAvx512(lanes, lane, gains + getEnvelopeIndex(lane, frame, frames), fadedGain, smoothedState);
+        _mm512_storeu_ps(lanes.fadedGain.data() + lane, fadedGain);
+        _mm512_storeu_ps(lanes.smoothedState.data() + lane, smoothedState);
+    }
+}
+
+EDSP_SIMD_AVX512_END
+
+#elif defined(EDSP_SIMD_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+    #define EDSP_SIMD_NEON_DIVISION 1
+
+// one frame of 4 lanes, division (vdivq) requires AArch64
+inline void envelopeStepNeon(const EnvelopeLanes& lanes, std::size_t lane, float* gains, float32x4_t& fadedGain, float32x4_t& smoothedState) noexcept
+{
+    const float32x4_t currentGain = vminq_f32(vdivq_f32(vld1q_f32(lanes.threshold.data() + lane), vld1q_f32(gains)), vdupq_n_f32(1.0f));
+    const uint32x4_t release = vcgeq_f32(currentGain, smoothedState);
+
+    const float32x4_t overshootGain = vsubq_f32(vmulq_f32(vdupq_n_f32(EnvelopeCoefficients::overshootScale), currentGain),
+                                                vmulq_f32(vdupq_n_f32(EnvelopeCoefficients::overshootStateScale), smoothedState));
+    const float32x4_t overshootAttackState = vaddq_f32(vmulq_f32(vld1q_f32(lanes.attackOvershootConst.data() + lane), smoothedState),
+                                                       vmulq_f32(vld1q_f32(lanes.attackOvershootComplement.data() + lane), currentGain));
+    const float32x4_t attackState = vaddq_f32(vmulq_f32(vld1q_f32(lanes.attackConst.data() + lane), smoothedState),
+                                              vmulq_f32(vld1q_f32(lanes.attackComplement.data() + lane), fadedGain));
+    const float32x4_t attackSmoothedState = vmaxq_f32(vbslq_f32(vcltq_f32(overshootGain, fadedGain), overshootAttackState, attackState), currentGain);
+    const float32x4_t attackFadedGain = vminq_f32(overshootGain, fadedGain);
+
+    // the release formula is also used in the attack phase if the faded gain is not below the state
+    fadedGain = vbslq_f32(release, currentGain, attackFadedGain);
+    const float32x4_t releaseSmoothedState = vaddq_f32(vmulq_f32(vld1q_f32(lanes.releaseConst.data() + lane), smoothedState),
+                                                       vmulq_f32(vld1q_f32(lanes.releaseComplement.data() + lane), fadedGain));
+    smoothedState = vbslq_f32(vorrq_u32(release, vcgeq_f32(attackFadedGain, smoothedState)), releaseSmoothedState, attackSmoothedState);
+    vst1q_f32(gains, smoothedState);
+}
+
+inline void computeEnvelopesNeon(EnvelopeLanes& lanes, float* gains, int frames) noexcept
+{
+    const std::size_t laneCount = lanes.size();
+    for (std::size_t lane = 0; lane < laneCount; lane += EnvelopeLanes::laneGroupSize)
+    {
+        // 4 independent recurrences hide the latency of each other
+        float32x4_t fadedGain[4];
+        float32x4_t smoothedState[4];
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            fadedGain[i] = vld1q_f32(lanes.fadedGain.data() + lane + 4 * i);
+            smoothedState[i] = vld1q_f32(lanes.smoothedState.data() + lane + 4 * i);
+        }
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            float* frameGains = gains + getEnvelopeIndex(lane, frame, frames);
+            for (std::size_t i = 0; i < 4; ++i)
+                envelopeStepNeon(lanes, lane + 4 * i, frameGains + 4 * i, fadedGain[i], smoothedState[i]);
+        }
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            vst1q_f32(lanes.fadedGain.data() + lane + 4 * i, fadedGain[i]);
+            vst1q_f32(lanes.smoothedState.data() + lane + 4 * i, smoothedState[i]);
+        }
+    }
+}
+
+#endif
+
+inline void computeEnvelopes(EnvelopeLanes& lanes, float* gains, int frames) noexcept
+{
+    switch (getSimdLevel())
+    {
+#if defined(EDSP_SIMD_X86)
+        case SimdLevel::Avx512:
+            computeEnvelopesAvx512(lanes, gains, frames);
+            return;
+        case SimdLevel::Avx2:
+            computeEnvelopesAvx2(lanes, gains, frames);
+            return;
+        case SimdLevel::Sse2:
+            computeEnvelopesSse2(lanes, gains, frames);
+            return;
+#elif defined(EDSP_SIMD_NEON_DIVISION)
+        case SimdLevel::Neon:
+            computeEnvelopesNeon(lanes, gains, frames);
+            return;
+#endif
+        default:
+            computeEnvelopesScalar(lanes, gains, frames);
+            return;
+    }
+}
+
+} // namespace detail
+
+// many independent limiters, e.g. one per stream on a server
+// the peak detection and the gain stage of every limiter are vectorized over time like in LookAheadLimiter,
+// the envelope recurrence, which is sequential within a limiter, is computed for 16 limiters at once in SIMD lanes
+// each limiter works like a LookAheadLimiter configured with configure(), but only with sample-peak detection,
+// without the setters for changes while processing, without statistics and without skipping the envelope of quiet blocks
+class LookAheadLimiterBank
+{
+public:
+    LookAheadLimiterBank() = default;
+
+    // allocate the limiters, all of them process the same number of channels at the same sample rate
+    // every limiter has to be configured with configureLimiter() afterwards
+    void configure(int limiters,      // number of limiters
+                   int channels,      // number of channels per limiter
+                   double sampleRate) // sample rate in Hz
+    {
+        assert(limiters > 0);
+        assert(channels > 0);
+        assert(sampleRate > 0.0);
+
+        mChannels = channels;
+        mSampleRate = sampleRate;
+        mLimiters.clear();
+        mLimiters.resize(static_cast<std::size_t>(limiters));
+        mEnvelopes.resize(mLimiters.size());
+
+        // unused lanes need valid peaks
+        mGains.assign(static_cast<std::size_t>(blockSize) * mEnvelopes.size(), 1.0f);
+
+        const std::size_t scratchChannels = mLimiters.size() * static_cast<std::size_t>(mChannels);
+        mScratchBuffer.resize(static_cast<std::size_t>(blockSize) * scratchChannels);
+        mScratchPointers.resize(scratchChannels);
+        for (std::size_t channel = 0; channel < scratchChannels; ++channel)
+            mScratchPointers[channel] = mScratchBuffer.data() + channel * blockSize;
+    }
+
+    // configure one limiter, the parameters are independent of the other limiters
+    void configureLimiter(int limiter,          // index of the limiter
+                          float attackMs,       // attack/lookahead time in milliseconds
+                          float releaseMs,      // release time in milliseconds
+                          float thresholdInDb,  // limiting threshold in dBFS
+                          float makeupGainInDb) // makeup gain in dB
+    {
+        assert(limiter >= 0 && limiter < getNumLimiters());
+        assert(attackMs > 0.0f);
+        assert(releaseMs > 0.0f);
+
+        Limiter& state = mLimiters[static_cast<std::size_t>(limiter)];
+        state.attackInSamples = static_cast<std::size_t>(std::ceil(attackMs * static_cast<float>(mSampleRate) / 1000.0f));
+        state.threshold = std::pow(10.0f, thresholdInDb / 20.0f);
+        state.makeupGain = std::pow(10.0f, makeupGainInDb / 20.0f);
+        state.slidingMaximum.resize(state.attackInSamples);
+        state.delayBuffer.resize(state.attackInSamples * static_cast<std::size_t>(mChannels));
+
+        mEnvelopes.threshold[static_cast<std::size_t>(limiter)] = state.threshold;
+        const detail::EnvelopeCoefficients coefficients{attackMs, releaseMs, mSampleRate};
+        state.releasedGain = coefficients.releasedGain;
+        mEnvelopes.setCoefficients(static_cast<std::size_t>(limiter), coefficients);
+
+        reset(limiter);
+    }
+
+    int getNumLimiters() const noexcept
+    {
+        return static_cast<int>(mLimiters.size());
+    }
+
+    // process interleaved audio data, buffers[limiter] holds samples frames for each limiter
+    void process(float* const* buffers, int samples)
+    {
+        processInterleaved([buffers, samples, this](int limiter)
+                           { return AudioBufferInterleavedView<float>{buffers[limiter], mChannels, samples}; },
+                           samples);
+    }
+
+    // process interleaved audio data, one view with the same number of samples for each limiter
+    void process(const AudioBufferInterleavedView<float>* buffers)
+    {
+        processInterleaved([buffers](int limiter)
+                           { return buffers[limiter]; },
+                           buffers[0].getNumSamples());
+    }
+
+    // process planar audio data, one view with the same number of samples for each limiter
+    void process(const AudioBufferView<float>* buffers)
+    {
+        assert(mChannels > 0); // configure must be called beforehand
+
+        const int samples = buffers[0].getNumSamples();
+        for (int blockStart = 0; blockStart < samples; blockStart += blockSize)
+        {
+            const int blockSamples = std::min(blockSize, samples - blockStart);
+            for (int limiter = 0; limiter < getNumLimiters(); ++limiter)
+            {
+                assert(buffers[limiter].getNumChannels() == mChannels && buffers[limiter].getNumSamples() == samples);
+                computePeaks(limiter, buffers[limiter].getSubBlock(blockStart, blockSamples));
+            }
+
+            detail::computeEnvelopes(mEnvelopes, mGains.data(), blockSamples);
+
+            for (int limiter = 0; limiter < getNumLimiters(); ++limiter)
+                applyGains(limiter, buffers[limiter].getSubBlock(blockStart, blockSamples));
+        }
+    }
+
+    // resets the internal state of all limiters
+    void reset() noexcept
+    {
+        for (int limiter = 0; limiter < getNumLimiters(); ++limiter)
+            reset(limiter);
+    }
+
+    // resets the internal state of one limiter, e.g. when a new stream starts
+    void reset(int limiter) noexcept
+    {
+        Limiter& state = mLimiters[static_cast<std::size_t>(limiter)];
+        state.bufferIndex = 0;
+        state.slidingMaximum.reset();
+        std::fill(state.delayBuffer.begin(), state.delayBuffer.end(), 0.0f);
+
+        mEnvelopes.reset(static_cast<std::size_t>(limiter));
+    }
+
+private:
+    // audio is processed in blocks of up to blockSize frames
+    static constexpr int blockSize = 256;
+
+    // everything except the envelope, which is stored in mEnvelopes
+    struct Limiter
+    {
+        std::size_t attackInSamples = 0;
+        float threshold = 0.0f;
+        float makeupGain = 0.0f;
+        std::size_t bufferIndex = 0;
+        float releasedGain = 1.0f; // above this gain the release is set to 1 like in LookAheadLimiter
+        bool released = false;     // the envelope has released and the window of the current block stays below the threshold
+        detail::SlidingMaximum slidingMaximum;
+        std::vector<float> delayBuffer; // planar, attackInSamples per channel
+    };
+
+    template <typename GetBuffer>
+    void processInterleaved(GetBuffer getBuffer, int samples)
+    {
+        assert(mChannels > 0); // configure must be called beforehand
+
+        for (int blockStart = 0; blockStart < samples; blockStart += blockSize)
+        {
+            const int blockSamples = std::min(blockSize, samples - blockStart);
+            for (int limiter = 0; limiter < getNumLimiters(); ++limiter)
+            {
+                const AudioBufferInterleavedView<float> buffer = getBuffer(limiter);
+                assert(buffer.getNumChannels() == mChannels && buffer.getNumSamples() == samples);
+                const AudioBufferView<float> planarBlock = getScratchBlock(limiter, blockSamples);
+                deinterleaveSamples(AudioBufferInterleavedView<const float>{buffer.getSubBlock(blockStart, blockSamples)}, planarBlock);
+                computePeaks(limiter, planarBlock);
+            }
+
+            detail::computeEnvelopes(mEnvelopes, mGains.data(), blockSamples);
+
+            for (int limiter = 0; limiter < getNumLimiters(); ++limiter)
+            {
+                const AudioBufferView<float> planarBlock = getScratchBlock(limiter, blockSamples);
+                applyGains(limiter, planarBlock);
+                interleaveSamples(AudioBufferView<const float>{planarBlock}, getBuffer(limiter).getSubBlock(blockStart, blockSamples));
+            }
+        }
+    }
+
+    // planar copy of one block of interleaved audio data of a limiter
+    AudioBufferView<float> getScratchBlock(int limiter, int samples) noexcept
+    {
+        return AudioBufferView<float>{mScratchPointers.data() + static_cast<std::size_t>(limiter) * static_cast<std::size_t>(mChannels), mChannels, samples};
+    }
+
+    // maximum absolute sample value of all channels within the lookahead, stored in the lane of the limiter in mGains
+    void computePeaks(int limiter, AudioBufferView<const float> block) noexcept
+    {
+        Limiter& state = mLimiters[static_cast<std::size_t>(limiter)];
+        assert(state.attackInSamples > 0); // configureLimiter must be called beforehand
+        const int samples = block.getNumSamples();
+
+        // the peaks are at least the threshold
+        std::fill(mPeaks.begin(), mPeaks.begin() + samples, state.threshold);
+        for (int channel = 0; channel < mChannels; ++channel)
+            simd::absMaxAccumulate(block.getReadPointer(channel), mPeaks.data(), samples);
+
+        state.slidingMaximum.process(mPeaks.data(), mMaxima.data(), samples, state.bufferIndex);
+
+        // the release only approaches 1, it is set to 1 like in LookAheadLimiter
+        state.released = mEnvelopes.smoothedState[static_cast<std::size_t>(limiter)] >= state.releasedGain
+                         && simd::absMax(mMaxima.data(), samples) <= state.threshold;
+
+        for (int sample = 0; sample < samples; ++sample)
+            mGains[detail::getEnvelopeIndex(static_cast<std::size_t>(limiter), sample, samples)] = mMaxima[static_cast<std::size_t>(sample)];
+    }
+
+    // delay, gain, clamp and makeup gain of one limiter
+    void applyGains(int limiter, AudioBufferView<float> block) noexcept
+    {
+        Limiter& state = mLimiters[static_cast<std::size_t>(limiter)];
+        const int samples = block.getNumSamples();
+
+        if (state.released)
+        {
+            std::fill(mPeaks.begin(), mPeaks.begin() + samples, 1.0f);
+            mEnvelopes.reset(static_cast<std::size_t>(limiter));
+        }
+        else
+        {
+            for (int sample = 0; sample < samples; ++sample)
+                mPeaks[static_cast<std::size_t>(sample)] = mGains[detail::getEnvelopeIndex(static_cast<std::size_t>(limiter), sample, samples)];
+        }
+
+        for (int channel = 0; channel < mChannels; ++channel)
+        {
+            float* delayLine = state.delayBuffer.data() + static_cast<std::size_t>(channel) * state.attackInSamples;
+            detail::delayAndApplyGains(block.getWritePointer(channel), delayLine, state.attackInSamples, state.bufferIndex, mPeaks.data(), samples, state.threshold, state.makeupGain);
+        }
+
+        state.bufferIndex = (state.bufferIndex + static_cast<std::size_t>(samples)) % state.attackInSamples;
+    }
+
+    int mChannels = 0;
+    double mSampleRate = 0.0;
+
+    std::vector<Limiter> mLimiters;
+    detail::EnvelopeLanes mEnvelopes;
+
+    // peaks and then gains of all lanes for one block, see detail::getEnvelopeIndex()
+    std::vector<float> mGains;
+
+    // one block of a single limiter, mPeaks also holds its gains in applyGains()
+    std::array<float, blockSize> mPeaks{};
+    std::array<float, blockSize> mMaxima{};
+
+    // planar copy of one block of interleaved audio data per limiter
+    std::vector<float> mScratchBuffer;
+    std::vector<float*> mScratchPointers;
+};
+
+} // namespace edsp
@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace edsp
+{
+
+// the per-sample implementation of https://github.com/tcarpent/PeakLimiter that LookAheadLimiter is derived from, interleaved float
+// audio with sample-peak detection only, test.cpp compares the output with it and the benchmark the processing time
+class LookAheadLimiterReference
+{
+public:
+    void configure(float attackMs, float releaseMs, float thresholdInDb, float makeupGainInDb, int channels, double sampleRate)
+    {
+        mAttackInSamples = static_cast<std::size_t>(std::ceil(attackMs * static_cast<float>(sampleRate) / 1000.0f));
+        mThreshold = std::pow(10.0f, thresholdInDb / 20.0f);
+        mMakeupGain = std::pow(10.0f, makeupGainInDb / 20.0f);
+        mChannels = channels;
+
+        mAttackConst = std::pow(0.1f, 1.0f / (attackMs * static_cast<float>(sampleRate) / 1000.0f + 1.0f));
+        mReleaseConst = std::pow(0.1f, 1.0f / (releaseMs * static_cast<float>(sampleRate) / 1000.0f + 1.0f));
+
+        mMaxBuffer.assign(mAttackInSamples, 0.0f);
+        mDelayBuffer.assign(mAttackInSamples * static_cast<std::size_t>(mChannels), 0.0f);
+    }
+
+    void process(float* buffer, int samples)
+    {
+        for (int sample = 0; sample < samples; ++sample)
+        {
+            mMaxBuffer[mBufferIndex] = mThreshold;
+            for (int channel = 0; channel < mChannels; ++channel)
+                mMaxBuffer[mBufferIndex] = std::max(mMaxBuffer[mBufferIndex], std::fabs(buffer[sample * mChannels + channel]));
+
+            if (mMaxBufferCurrentMaxIndex == mBufferIndex)
+            {
+                const auto maxElementIterator = std::max_element(mMaxBuffer.begin(), mMaxBuffer.end());
+                mMaxBufferCurrentMaxValue = *maxElementIterator;
+                mMaxBufferCurrentMaxIndex = static_cast<std::size_t>(std::distance(mMaxBuffer.begin(), maxElementIterator));
+            }
+            else if (mMaxBuffer[mBufferIndex] >= mMaxBufferCurrentMaxValue)
+            {
+                mMaxBufferCurrentMaxValue = mMaxBuffer[mBufferIndex];
+                mMaxBufferCurrentMaxIndex = mBufferIndex;
+            }
+
+            const float currentGain = std::min(1.0f, mThreshold / mMaxBufferCurrentMaxValue);
+            if (currentGain < mSmoothedState)
+                mFadedGain = std::min(mFadedGain, (currentGain - 0.1f * mSmoothedState) * 1.11111111f);
+            else
+                mFadedGain = currentGain;
+
+            if (mFadedGain < mSmoothedState)
+                mSmoothedState = std::max(currentGain, mAttackConst * (mSmoothedState - mFadedGain) + mFadedGain);
+            else
+                mSmoothedState = mReleaseConst * (mSmoothedState - mFadedGain) + mFadedGain;
+
+            for (int channel = 0; channel < mChannels; ++channel)
+            {
+                const std::size_t delayBufferIndex = mBufferIndex * static_cast<std::size_t>(mChannels) + static_cast<std::size_t>(channel);
+                const float sampleValue = mDelayBuffer[delayBufferIndex];
+                mDelayBuffer[delayBufferIndex] = buffer[sample * mChannels + channel];
+                buffer[sample * mChannels + channel] = std::clamp(sampleValue * mSmoothedState, -mThreshold, mThreshold) * mMakeupGain;
+            }
+
+            mBufferIndex = (mBufferIndex + 1) % mAttackInSamples;
+        }
+    }
+
+private:
+    std::size_t mAttackInSamples = 0;
+    float mAttackConst = 0.0f;
+    float mReleaseConst = 0.0f;
+    float mThreshold = 0.0f;
+    float mMakeupGain = 0.0f;
+    int mChannels = 0;
+
+    std::size_t mBufferIndex = 0;
+    std::vector<float> mMaxBuffer;
+    float mMaxBufferCurrentMaxValue = 0.0f;
+    std::size_t mMaxBufferCurrentMaxIndex = 0;
+    std::vector<float> mDelayBuffer;
+
+    float mFadedGain = 1.0f;
+    float mSmoothedState = 1.0f;
+};
+
+} // namespace edsp
@@ -1,15 +1,42 @@
 // SPDX-FileCopyrightText: 2023 Christian Voigt
 // SPDX-License-Identifier: MIT
 
+#include "../AudioBuffer/AudioBuffer.h"
 #include "../AudioBuffer/AudioBufferHelpers.h"
 #include "../AudioBuffer/AudioBufferInterleaved.h"
 #include "LookAheadLimiter.h"
+#include "LookAheadLimiterBank.h"
+#include "LookAheadLimiterReference.h"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <random>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// the bank and every envelope kernel compute exactly the same as LookAheadLimiter, unless the compiler contracts multiply-add into FMA instructions
+// (e.g. -march=native), then they round differently like the per-sample reference
+#if defined(__FMA__)
+static constexpr double bankTolerance = 6e-5;
+#else
+static constexpr double bankTolerance = 0.0;
+#endif
+
+static bool check(bool condition, const std::string& message)
+{
+    if (!condition)
+        std::cout << "  failed: " << message << "\n";
+    return condition;
+}
 
 static void fillBufferWithSineWaveAndPeak(float* buffer, int channels, int samples)
 {
@@ -20,13 +47,124 @@ static void fillBufferWithSineWaveAndPeak(float* buffer, int channels, int sampl
     {
         for (int channel = 0; channel < 2; ++channel)
         {
-            buffer[sample * channels + channel] = peakAmplitude * std::sinf(angularFrequency * sample / samples);
+            buffer[sample * channels + channel] = peakAmplitude * std::sin(angularFrequency * sample / samples);
             if (sample == samples / 2)
                 buffer[sample * channels + channel] = 1.0f; // one additional peak at 0 dBFS
         }
     }
 }
 
+// dense material, the limiter works on every frame
+static std::vector<float> createNoise(int channels, int samples, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> distribution(-1.5f, 1.5f);
+    std::vector<float> buffer(static_cast<std::size_t>(channels) * static_cast<std::size_t>(samples));
+    for (float& sample : buffer)
+        sample = distribution(generator);
+    return buffer;
+}
+
+// decaying noise bursts of random length and level between quiet passages, the envelope attacks, releases and rests
+static std::vector<float> createBursts(int channels, int samples, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> length(50, 4000);
+    std::uniform_real_distribution<float> level(0.3f, 2.0f);
+    std::vector<float> buffer(static_cast<std::size_t>(channels) * static_cast<std::size_t>(samples));
+
+    int sample = 0;
+    while (sample < samples)
+    {
+        const int burstEnd = std::min(samples, sample + length(generator));
+        const float decay = std::exp(-5.0f / static_cast<float>(burstEnd - sample));
+        float amplitude = level(generator);
+        for (; sample < burstEnd; ++sample, amplitude *= decay)
+            for (int channel = 0; channel < channels; ++channel)
+                buffer[static_cast<std::size_t>(sample * channels + channel)] = amplitude * noise(generator);
+
+        const int quietEnd = std::min(samples, sample + length(generator));
+        for (; sample < quietEnd; ++sample)
+            for (int channel = 0; channel < channels; ++channel)
+                buffer[static_cast<std::size_t>(sample * channels + channel)] = 0.01f * noise(generator);
+    }
+    return buffer;
+}
+
+// noise just below the threshold with short peaks above it, the limiter keeps entering and leaving the quiet-window path
+static std::vector<float> createPeaksAboveQuietNoise(int channels, int samples, float threshold, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> noise(-0.95f, 0.95f);
+    std::uniform_int_distribution<int> distance(100, 30000);
+    std::uniform_int_distribution<int> length(1, 20);
+    std::uniform_int_distribution<int> channel(0, channels - 1);
+    std::uniform_real_distribution<float> level(1.001f, 1.2f);
+    std::vector<float> buffer(static_cast<std::size_t>(channels) * static_cast<std::size_t>(samples));
+    for (float& sample : buffer)
+        sample = threshold * noise(generator);
+
+    for (int sample = distance(generator); sample < samples; sample += distance(generator))
+    {
+        const int peakChannel = channel(generator);
+        const float peakLevel = threshold * level(generator);
+        for (int peakEnd = std::min(samples, sample + length(generator)); sample < peakEnd; ++sample)
+            buffer[static_cast<std::size_t>(sample * channels + peakChannel)] = sample % 2 == 0 ? peakLevel : -peakLevel;
+    }
+    return buffer;
+}
+
+// sines close to a quarter of the sample rate, the peaks between their samples are up to 3 dB above the sample peaks
+static std::vector<float> createIntersamplePeaks(int channels, int samples, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> noise(-0.1f, 0.1f);
+    const float pi = static_cast<float>(M_PI);
+    std::vector<float> buffer(static_cast<std::size_t>(channels) * static_cast<std::size_t>(samples));
+    for (int sample = 0; sample < samples; ++sample)
+    {
+        const float amplitude = 0.75f + 0.75f * std::sin(0.0003f * static_cast<float>(sample));
+        const float frequency = (sample / 24000) % 2 == 0 ? 0.25f : 0.23f;
+        const float value = amplitude * std::sin(2.0f * pi * frequency * static_cast<float>(sample) + 0.25f * pi);
+        for (int channel = 0; channel < channels; ++channel)
+            buffer[static_cast<std::size_t>(sample * channels + channel)] = value + (channel > 0 ? noise(generator) : 0.0f);
+    }
+    return buffer;
+}
+
+// maximum of the 4x oversampled signal of all channels, measured like the limiter does
+static float getTruePeak(const std::vector<float>& buffer, int channels, int samples)
+{
+    constexpr int history = edsp::detail::truePeakTaps - 1;
+    std::vector<float> line(static_cast<std::size_t>(history + samples), 0.0f);
+    std::vector<float> maxima(static_cast<std::size_t>(samples), 0.0f);
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        for (int sample = 0; sample < samples; ++sample)
+            line[static_cast<std::size_t>(history + sample)] = buffer[static_cast<std::size_t>(sample * channels + channel)];
+        edsp::detail::truePeakAccumulateScalar(line.data() + history, maxima.data(), samples);
+    }
+    return *std::max_element(maxima.begin(), maxima.end());
+}
+
+// calls process() with blocks of blockSize frames, the last block can be shorter
+template <typename Limiter, typename SampleType>
+static void processInBlocks(Limiter& limiter, SampleType* buffer, int channels, int samples, int blockSize)
+{
+    for (int blockStart = 0; blockStart < samples; blockStart += blockSize)
+        limiter.process(edsp::AudioBufferInterleavedView<SampleType>{buffer + static_cast<std::ptrdiff_t>(blockStart) * channels, channels, std::min(blockSize, samples - blockStart)});
+}
+
+template <typename SampleType>
+static double getMaxDifference(const std::vector<SampleType>& a, const std::vector<SampleType>& b)
+{
+    double maxDifference = 0.0;
+    for (std::size_t i = 0; i < a.size(); ++i)
+        maxDifference = std::max(maxDifference, std::abs(static_cast<double>(a[i]) - static_cast<double>(b[i])));
+    return maxDifference;
+}
+
 static void writeBufferToFile(const float* buffer, int channels, int samples, const std::string& filePath)
 {
     std::ofstream outFile(filePath);
@@ -45,26 +183,29 @@ static void writeBufferToFile(const float* buffer, int channels, int samples, co
     outFile.close();
 }
 
-static bool compareFiles(const std::string& file1, const std::string& file2)
+// the files hold comma separated values with 5 decimals, which may differ by up to tolerance
+static bool compareFiles(const std::string& file1, const std::string& file2, double tolerance)
 {
-    std::ifstream f1(file1, std::ifstream::binary | std::ifstream::ate);
-    std::ifstream f2(file2, std::ifstream::binary | std::ifstream::ate);
+    std::ifstream f1(file1);
+    std::ifstream f2(file2);
 
     if (f1.fail() || f2.fail())
         return false; // file problem
 
-    if (f1.tellg() != f2.tellg())
-        return false; // size mismatch
-
-    // seek back to beginning and use std::equal to compare contents
-    f1.seekg(0, std::ifstream::beg);
-    f2.seekg(0, std::ifstream::beg);
-    return std::equal(std::istreambuf_iterator<char>(f1.rdbuf()),
-                      std::istreambuf_iterator<char>(),
-                      std::istreambuf_iterator<char>(f2.rdbuf()));
+    double value1 = 0.0;
+    double value2 = 0.0;
+    char separator = 0;
+    while (f1 >> value1 >> separator)
+    {
+        if (!(f2 >> value2 >> separator) || std::abs(value1 - value2) > tolerance)
+            return false;
+    }
+    return f1.eof() && !(f2 >> value2); // same number of values
 }
 
-int main()
+// run from this directory, the output is written to testOutputNew.txt and compared with testOutput.txt
+// the last digit can differ by the deviation from the per-sample reference and with the std::sin() and std::pow() of the platform
+static bool testOutputUnchanged()
 {
     constexpr int channels = 2;
     constexpr int samples = 2048;
@@ -83,10 +224,775 @@ int main()
     limiter.process(bufferPtr, samples);
 
     writeBufferToFile(bufferPtr, channels, samples, outputFile);
-    if (compareFiles(comparisonFile, outputFile))
-        std::cout << "Output hasn't changed.\n";
-    else
-        std::cout << "Output has changed!\n";
+    return check(compareFiles(comparisonFile, outputFile, 6e-5 + 1e-5), "output has changed");
+}
+
+// the block processing rounds differently than the per-sample reference, but must not deviate by more than 6e-5
+// for every channel count, split of the stream into process() calls and kind of material
+// planar audio gives exactly the same output as interleaved audio, as views and as channel pointers, for any block size
+static bool testPlanarMatchesInterleaved()
+{
+    constexpr int samples = 12000;
+    constexpr double sampleRate = 48000.0;
 
-    return 0;
+    bool passed = true;
+    for (const int channels : {1, 2, 3})
+    {
+        const std::vector<float> input = createBursts(channels, samples, 19);
+        for (const edsp::PeakDetection peakDetection : {edsp::PeakDetection::SamplePeak, edsp::PeakDetection::TruePeak})
+        {
+            for (const int blockSize : {1, 7, 256, 257, 1001})
+            {
+                const std::string configuration = std::to_string(channels) + " channels, " + (peakDetection == edsp::PeakDetection::TruePeak ? "true peak" : "sample peak") + ", blocks of " + std::to_string(blockSize) + ": ";
+                auto configure = [&](edsp::LookAheadLimiter& limiter)
+                { limiter.configure(2.0f, 20.0f, -3.0f, 1.0f, channels, sampleRate, peakDetection); };
+
+                edsp::LookAheadLimiter interleavedLimiter;
+                configure(interleavedLimiter);
+                std::vector<float> expected = input;
+                for (int blockStart = 0; blockStart < samples; blockStart += blockSize)
+                    interleavedLimiter.process(expected.data() + static_cast<std::ptrdiff_t>(blockStart) * channels, std::min(blockSize, samples - blockStart));
+
+                edsp::AudioBuffer<float, 3> viewOutput(channels, samples);
+                edsp::deinterleaveSamples(edsp::AudioBufferInterleavedView<const float>{input.data(), channels, samples}, viewOutput.getWriteView());
+                edsp::LookAheadLimiter viewLimiter;
+                configure(viewLimiter);
+                for (int blockStart = 0; blockStart < samples; blockStart += blockSize)
+                    viewLimiter.process(viewOutput.getWriteView().getSubBlock(blockStart, std::min(blockSize, samples - blockStart)));
+
+                edsp::AudioBuffer<float, 3> pointerOutput(channels, samples);
+                edsp::deinterleaveSamples(edsp::AudioBufferInterleavedView<const float>{input.data(), channels, samples}, pointerOutput.getWriteView());
+                edsp::LookAheadLimiter pointerLimiter;
+                configure(pointerLimiter);
+                for (int blockStart = 0; blockStart < samples; blockStart += blockSize)
+                {
+                    float* channelPointers[3];
+                    for (int channel = 0; channel < channels; ++channel)
+                        channelPointers[channel] = pointerOutput.getWritePointer(channel) + blockStart;
+                    pointerLimiter.process(channelPointers, std::min(blockSize, samples - blockStart));
+                }
+
+                for (const auto& [name, output] : {std::pair{"view", &viewOutput}, std::pair{"channel pointers", &pointerOutput}})
+                {
+                    std::vector<float> interleavedOutput(input.size());
+                    edsp::interleaveSamples(output->getReadView(), edsp::AudioBufferInterleavedView<float>{interleavedOutput.data(), channels, samples});
+                    passed &= check(interleavedOutput == expected, configuration + name + " gives the same output as interleaved audio");
+                }
+            }
+        }
+    }
+    return passed;
+}
+
+static bool testMatchesReference()
+{
+    constexpr int samples = 48000;
+    constexpr double sampleRate = 48000.0;
+    constexpr double tolerance = 6e-5;
+
+    bool passed = true;
+    for (const int channels : {1, 2, 3})
+    {
+        for (const auto& [material, input] : {std::pair{"noise", createNoise(channels, samples, 1)}, std::pair{"bursts", createBursts(channels, samples, 2)}})
+        {
+            edsp::LookAheadLimiterReference reference;
+            reference.configure(3.0f, 30.0f, -6.0f, 3.0f, channels, sampleRate);
+            std::vector<float> expected = input;
+            reference.process(expected.data(), samples);
+
+            for (const int blockSize : {1, 64, 300})
+            {
+                edsp::LookAheadLimiter limiter;
+                limiter.configure(3.0f, 30.0f, -6.0f, 3.0f, channels, sampleRate);
+                std::vector<float> output = input;
+                processInBlocks(limiter, output.data(), channels, samples, blockSize);
+
+                const double maxDifference = getMaxDifference(output, expected);
+                passed &= check(maxDifference <= tolerance, std::string(material) + ", " + std::to_string(channels) + " channels, blocks of " + std::to_string(blockSize) + ": deviation " + std::to_string(maxDifference));
+            }
+        }
+    }
+    return passed;
+}
+
+// with true-peak detection the oversampled output stays at the threshold, with sample-peak detection only the samples do
+// the gain changes within the length of the FIR, so the true peak can exceed the threshold by a few thousandths of a dB
+static bool testTruePeak()
+{
+    constexpr int channels = 2;
+    constexpr int samples = 96000;
+    constexpr double sampleRate = 48000.0;
+    constexpr float thresholdInDb = -3.0f;
+    const std::vector<float> input = createIntersamplePeaks(channels, samples, 3);
+
+    bool passed = true;
+    for (const int blockSize : {1, 64, 300})
+    {
+        edsp::LookAheadLimiter samplePeakLimiter;
+        edsp::LookAheadLimiter truePeakLimiter;
+        samplePeakLimiter.configure(1.5f, 50.0f, thresholdInDb, 0.0f, channels, sampleRate);
+        truePeakLimiter.configure(1.5f, 50.0f, thresholdInDb, 0.0f, channels, sampleRate, edsp::PeakDetection::TruePeak);
+
+        std::vector<float> samplePeakOutput = input;
+        std::vector<float> truePeakOutput = input;
+        processInBlocks(samplePeakLimiter, samplePeakOutput.data(), channels, samples, blockSize);
+        processInBlocks(truePeakLimiter, truePeakOutput.data(), channels, samples, blockSize);
+
+        const float samplePeakLimiterInDb = 20.0f * std::log10(getTruePeak(samplePeakOutput, channels, samples));
+        const float truePeakLimiterInDb = 20.0f * std::log10(getTruePeak(truePeakOutput, channels, samples));
+        const std::string blocks = "blocks of " + std::to_string(blockSize) + ": ";
+        passed &= check(samplePeakLimiterInDb > thresholdInDb + 1.0f, blocks + "the material has peaks between the samples, " + std::to_string(samplePeakLimiterInDb) + " dB");
+        passed &= check(truePeakLimiterInDb <= thresholdInDb + 0.01f, blocks + "true peak of the output " + std::to_string(truePeakLimiterInDb) + " dB");
+    }
+
+    // the FIR delays the detection by 6 samples, the audio is delayed by the same amount
+    edsp::LookAheadLimiter limiter;
+    limiter.configure(1.5f, 50.0f, thresholdInDb, 0.0f, 1, sampleRate, edsp::PeakDetection::TruePeak);
+    passed &= check(limiter.getLatencyInSamples() == 72 + edsp::detail::truePeakLatency, "latency of the lookahead and the FIR");
+
+    std::vector<float> impulse(200, 0.0f);
+    impulse[10] = 0.5f;
+    limiter.process(impulse.data(), static_cast<int>(impulse.size()));
+    passed &= check(impulse[static_cast<std::size_t>(10 + limiter.getLatencyInSamples())] == 0.5f, "an impulse below the threshold is delayed by the latency");
+    return passed;
+}
+
+// a limiter prepared for a longer lookahead delays the audio by the prepared lookahead, otherwise it limits like a configured one
+// the envelope skips blocks at other positions of the stream, which only changes the gain by up to the distance at which the release is set to 1
+static bool testPreparedMatchesConfigured()
+{
+    constexpr int channels = 2;
+    constexpr int samples = 48000;
+    constexpr double sampleRate = 48000.0;
+    const std::vector<float> input = createBursts(channels, samples, 4);
+
+    edsp::LookAheadLimiter configured;
+    configured.configure(3.0f, 30.0f, -6.0f, 3.0f, channels, sampleRate);
+    std::vector<float> expected = input;
+    processInBlocks(configured, expected.data(), channels, samples, 300);
+
+    edsp::LookAheadLimiter prepared;
+    prepared.prepare(10.0f, channels, sampleRate);
+    prepared.setAttack(3.0f);
+    prepared.setRelease(30.0f);
+    prepared.setThreshold(-6.0f);
+    prepared.setMakeupGain(3.0f);
+    prepared.reset(); // applies the parameters without smoothing
+    std::vector<float> output = input;
+    processInBlocks(prepared, output.data(), channels, samples, 300);
+
+    const int shift = prepared.getLatencyInSamples() - configured.getLatencyInSamples();
+    bool passed = check(prepared.getLatencyInSamples() == 480 && shift == 336, "the latency is the prepared lookahead");
+
+    const std::vector<float> shiftedOutput(output.begin() + shift * channels, output.end());
+    const std::vector<float> truncatedExpected(expected.begin(), expected.end() - shift * channels);
+    const double maxDifference = getMaxDifference(shiftedOutput, truncatedExpected);
+    passed &= check(maxDifference <= 1e-5, "deviation " + std::to_string(maxDifference));
+    return passed;
+}
+
+static float getPeak(const std::vector<float>& buffer, int channels, int startSample, int endSample)
+{
+    float peak = 0.0f;
+    for (int i = startSample * channels; i < endSample * channels; ++i)
+        peak = std::max(peak, std::abs(buffer[static_cast<std::size_t>(i)]));
+    return peak;
+}
+
+// the setters are called between process() calls, the changes are applied at the next block
+static bool testParameterChanges()
+{
+    constexpr int channels = 2;
+    constexpr int samples = 96000;
+    constexpr int changeSample = 48000;
+    constexpr int makeupGainChangeSample = 72000;
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 64;
+    const std::vector<float> input = createNoise(channels, samples, 5);
+
+    auto prepare = [](edsp::LookAheadLimiter& limiter, float attackMs)
+    {
+        limiter.prepare(10.0f, channels, sampleRate);
+        limiter.setAttack(attackMs);
+        limiter.setRelease(30.0f);
+        limiter.setThreshold(-3.0f);
+        limiter.reset();
+    };
+
+    // the frames of the block after a change, the ramp of 20 ms and the latency
+    constexpr int settlingSamples = blockSize + 960 + 480;
+
+    // threshold, then makeup gain: the output reaches the new level after the ramp, while the threshold goes down the clamp keeps the old level
+    edsp::LookAheadLimiter limiter;
+    prepare(limiter, 5.0f);
+    std::vector<float> output = input;
+    processInBlocks(limiter, output.data(), channels, changeSample, blockSize);
+    limiter.setThreshold(-9.0f);
+    processInBlocks(limiter, output.data() + changeSample * channels, channels, makeupGainChangeSample - changeSample, blockSize);
+    limiter.setMakeupGain(4.0f);
+    processInBlocks(limiter, output.data() + makeupGainChangeSample * channels, channels, samples - makeupGainChangeSample, blockSize);
+
+    auto checkLevel = [&](int startSample, int endSample, float levelInDb, const std::string& message)
+    {
+        const float level = std::pow(10.0f, levelInDb / 20.0f);
+        const float peak = getPeak(output, channels, startSample, endSample);
+        return check(peak <= level * 1.000001f && peak >= level * 0.99f, message + " " + std::to_string(peak));
+    };
+    bool passed = checkLevel(0, changeSample, -3.0f, "peak before the threshold change");
+    passed &= checkLevel(changeSample, changeSample + settlingSamples, -3.0f, "peak during the threshold change");
+    passed &= checkLevel(changeSample + settlingSamples, makeupGainChangeSample, -9.0f, "peak after the threshold change");
+    passed &= checkLevel(makeupGainChangeSample + settlingSamples, samples, -5.0f, "peak after the makeup gain change");
+
+    // attack: a shorter lookahead takes effect without a reset, the limiter then works like one that had it from the start
+    edsp::LookAheadLimiter changedLimiter;
+    edsp::LookAheadLimiter constantLimiter;
+    prepare(changedLimiter, 8.0f);
+    prepare(constantLimiter, 2.0f);
+    std::vector<float> changedOutput = input;
+    std::vector<float> constantOutput = input;
+    processInBlocks(changedLimiter, changedOutput.data(), channels, changeSample, blockSize);
+    changedLimiter.setAttack(2.0f);
+    processInBlocks(changedLimiter, changedOutput.data() + changeSample * channels, channels, samples - changeSample, blockSize);
+    processInBlocks(constantLimiter, constantOutput.data(), channels, samples, blockSize);
+
+    passed &= check(changedLimiter.getLatencyInSamples() == constantLimiter.getLatencyInSamples(), "the latency does not change with the attack");
+    passed &= check(getPeak(changedOutput, channels, 0, samples) <= std::pow(10.0f, -3.0f / 20.0f) * 1.000001f, "peak while the attack changes");
+    const std::vector<float> changedTail(changedOutput.begin() + (changeSample + 24000) * channels, changedOutput.end());
+    const std::vector<float> constantTail(constantOutput.begin() + (changeSample + 24000) * channels, constantOutput.end());
+    const double maxDifference = getMaxDifference(changedTail, constantTail);
+    passed &= check(maxDifference <= 1e-5, "deviation after the attack change " + std::to_string(maxDifference));
+    return passed;
+}
+
+// another thread keeps changing every parameter while the audio thread processes, the output stays finite and within the highest level
+static bool testConcurrentParameterChanges()
+{
+    constexpr int channels = 2;
+    constexpr int samples = 480000;
+    constexpr double sampleRate = 48000.0;
+    std::vector<float> buffer = createBursts(channels, samples, 6);
+
+    edsp::LookAheadLimiter limiter;
+    limiter.prepare(10.0f, channels, sampleRate);
+    limiter.setThreshold(-1.0f);
+    limiter.reset();
+
+    std::atomic<bool> done = false;
+    std::thread controller([&]
+                           {
+                               std::minstd_rand random{8};
+                               while (!done.load(std::memory_order_relaxed))
+                               {
+                                   limiter.setAttack(0.1f + static_cast<float>(random() % 120) * 0.1f);
+                                   limiter.setRelease(1.0f + static_cast<float>(random() % 200));
+                                   limiter.setThreshold(-1.0f - static_cast<float>(random() % 20));
+                                   limiter.setMakeupGain(static_cast<float>(random() % 3));
+                                   std::this_thread::yield();
+                               } });
+
+    std::minstd_rand random{9};
+    for (int blockStart = 0; blockStart < samples;)
+    {
+        const int blockSamples = std::min(static_cast<int>(random() % 300) + 1, samples - blockStart);
+        limiter.process(buffer.data() + static_cast<std::ptrdiff_t>(blockStart) * channels, blockSamples);
+        blockStart += blockSamples;
+    }
+    done = true;
+    controller.join();
+
+    // -1 dB threshold and 2 dB makeup gain
+    const float highestLevel = std::pow(10.0f, 1.0f / 20.0f);
+    const bool finite = std::all_of(buffer.begin(), buffer.end(), [](float sample)
+                                    { return std::isfinite(sample); });
+    return check(finite, "output is finite") && check(getPeak(buffer, channels, 0, samples) <= highestLevel * 1.000001f, "peak within the highest level");
+}
+
+// a fixed channel count computes exactly the same as the runtime channel count, with contiguous frames and with a subset of the channels
+// double audio uses the same float envelope, so it only deviates by the rounding of the float output
+static bool testSampleTypesAndChannels()
+{
+    constexpr int channels = 2;
+    constexpr int samples = 48000;
+    constexpr double sampleRate = 48000.0;
+
+    bool passed = true;
+    for (const auto& [material, input] : {std::pair{"noise", createNoise(channels, samples, 10)}, std::pair{"bursts", createBursts(channels, samples, 11)}})
+    {
+        edsp::LookAheadLimiter limiter;
+        limiter.configure(3.0f, 30.0f, -6.0f, 3.0f, channels, sampleRate);
+        std::vector<float> expected = input;
+        processInBlocks(limiter, expected.data(), channels, samples, 300);
+
+        edsp::BasicLookAheadLimiter<float, channels> fixedLimiter;
+        fixedLimiter.configure(3.0f, 30.0f, -6.0f, 3.0f, channels, sampleRate);
+        std::vector<float> output = input;
+        processInBlocks(fixedLimiter, output.data(), channels, samples, 300);
+        passed &= check(getMaxDifference(output, expected) == 0.0, std::string(material) + ": fixed channel count");
+
+        // the first two channels of three, so the frames are not contiguous
+        std::vector<float> wideBuffer(static_cast<std::size_t>(samples) * 3, 0.5f);
+        for (int sample = 0; sample < samples; ++sample)
+            std::copy_n(input.begin() + sample * channels, channels, wideBuffer.begin() + sample * 3);
+        fixedLimiter.reset();
+        const edsp::AudioBufferInterleavedView<float> subView = edsp::AudioBufferInterleavedView<float>{wideBuffer.data(), 3, samples}.getSubView(0, channels);
+        for (int blockStart = 0; blockStart < samples; blockStart += 300)
+            fixedLimiter.process(subView.getSubBlock(blockStart, std::min(300, samples - blockStart)));
+        for (int sample = 0; sample < samples; ++sample)
+            std::copy_n(wideBuffer.begin() + sample * 3, channels, output.begin() + sample * channels);
+        passed &= check(getMaxDifference(output, expected) == 0.0, std::string(material) + ": fixed channel count, subset of the channels");
+        passed &= check(wideBuffer[2] == 0.5f && wideBuffer.back() == 0.5f, std::string(material) + ": the other channel is not touched");
+
+        edsp::BasicLookAheadLimiter<double> doubleLimiter;
+        doubleLimiter.configure(3.0f, 30.0f, -6.0f, 3.0f, channels, sampleRate);
+        std::vector<double> doubleOutput(input.begin(), input.end());
+        processInBlocks(doubleLimiter, doubleOutput.data(), channels, samples, 300);
+        const std::vector<double> expectedAsDouble(expected.begin(), expected.end());
+        const double maxDifference = getMaxDifference(doubleOutput, expectedAsDouble);
+        passed &= check(maxDifference <= 1e-6, std::string(material) + ": double deviation " + std::to_string(maxDifference));
+    }
+    return passed;
+}
+
+// the second channel is a constant power of two below the threshold, it does not change the gains and its output is the gain times the constant without rounding
+// so the statistics can be compared exactly with the gains of the frames after the latency
+static bool testStatistics()
+{
+    constexpr int samples = 48000;
+    constexpr double sampleRate = 48000.0;
+    constexpr float probe = 1.0f / 1024.0f;
+    const float threshold = std::pow(10.0f, -6.0f / 20.0f);
+    const std::vector<float> material = createBursts(1, samples, 12);
+
+    std::vector<float> buffer(static_cast<std::size_t>(samples) * 2, probe);
+    for (int sample = 0; sample < samples; ++sample)
+        buffer[static_cast<std::size_t>(sample) * 2] = material[static_cast<std::size_t>(sample)];
+
+    edsp::LookAheadLimiter limiter;
+    limiter.configure(3.0f, 30.0f, -6.0f, 0.0f, 2, sampleRate);
+    edsp::GainReductionStatistics statistics;
+    bool passed = check(!limiter.pollStatistics(statistics), "nothing to poll while disabled");
+
+    limiter.setStatisticsEnabled(true);
+    passed &= check(!limiter.pollStatistics(statistics), "nothing to poll before processing");
+
+    // the frames within the latency leave the delay line as silence, they are polled separately
+    const int latency = limiter.getLatencyInSamples();
+    limiter.process(buffer.data(), latency);
+    passed &= check(limiter.pollStatistics(statistics) && statistics.frames == latency, "frames within the latency");
+
+    // more process() calls than the queue holds, the audio thread keeps accumulating while it is full
+    // and queues the accumulated frames with the first call after the poll, here the last 100 frames
+    std::minstd_rand random{13};
+    int calls = 0;
+    for (int blockStart = latency; blockStart < samples - 100; ++calls)
+    {
+        const int blockSamples = std::min(static_cast<int>(random() % 300) + 1, samples - 100 - blockStart);
+        limiter.process(buffer.data() + static_cast<std::ptrdiff_t>(blockStart) * 2, blockSamples);
+        blockStart += blockSamples;
+    }
+    passed &= check(calls > 64, "the queue was full");
+    passed &= check(limiter.pollStatistics(statistics), "statistics while processing");
+    passed &= check(statistics.frames < samples - 100 - latency, "the frames after the queue was full are not queued yet");
+
+    edsp::GainReductionStatistics lastStatistics;
+    limiter.process(buffer.data() + static_cast<std::ptrdiff_t>(samples - 100) * 2, 100);
+    passed &= check(limiter.pollStatistics(lastStatistics), "statistics after processing");
+    passed &= check(!limiter.pollStatistics(lastStatistics), "nothing to poll twice");
+    statistics.merge(lastStatistics);
+
+    edsp::GainReductionStatistics expected;
+    double gainSum = 0.0;
+    for (int sample = latency; sample < samples; ++sample)
+    {
+        const float gain = buffer[static_cast<std::size_t>(sample) * 2 + 1] / probe;
+        expected.frames += 1;
+        expected.minGain = std::min(expected.minGain, gain);
+        gainSum += static_cast<double>(gain);
+
+        std::size_t bucket = 0;
+        while (bucket + 1 < expected.histogram.size() && gain <= std::pow(10.0f, -edsp::GainReductionStatistics::histogramEdgesInDb[bucket + 1] / 20.0f))
+            ++bucket;
+        expected.histogram[bucket] += 1;
+
+        if (std::abs(buffer[static_cast<std::size_t>(sample) * 2]) >= threshold)
+            expected.clampedSamples += 1;
+    }
+    expected.averageGain = static_cast<float>(gainSum / static_cast<double>(expected.frames));
+
+    std::int64_t histogramFrames = 0;
+    for (const std::int64_t frames : statistics.histogram)
+        histogramFrames += frames;
+
+    passed &= check(statistics.frames == expected.frames, "frames " + std::to_string(statistics.frames));
+    passed &= check(histogramFrames == statistics.frames, "the histogram holds every frame");
+    passed &= check(expected.minGain < 0.5f && statistics.minGain == expected.minGain, "minimum gain " + std::to_string(statistics.minGain));
+    passed &= check(std::abs(statistics.averageGain - expected.averageGain) <= 1e-5f, "average gain " + std::to_string(statistics.averageGain));
+    passed &= check(statistics.histogram == expected.histogram, "histogram");
+    passed &= check(expected.clampedSamples > 0 && statistics.clampedSamples == expected.clampedSamples, "clamped samples " + std::to_string(statistics.clampedSamples));
+
+    // disabled again, the audio thread stops queueing
+    limiter.setStatisticsEnabled(false);
+    limiter.process(buffer.data(), samples);
+    passed &= check(!limiter.pollStatistics(statistics), "nothing to poll after disabling");
+    return passed;
+}
+
+// a monitoring thread polls while the audio thread processes, every frame is counted exactly once
+// frames accumulated while the queue was full are queued by the next process() call, here the last frame
+static bool testConcurrentStatistics()
+{
+    constexpr int channels = 2;
+    constexpr int samples = 480000;
+    constexpr double sampleRate = 48000.0;
+    std::vector<float> buffer = createBursts(channels, samples, 14);
+
+    edsp::LookAheadLimiter limiter;
+    limiter.configure(3.0f, 30.0f, -6.0f, 0.0f, channels, sampleRate);
+    limiter.setStatisticsEnabled(true);
+
+    std::atomic<bool> done = false;
+    std::int64_t polledFrames = 0;
+    std::int64_t histogramFrames = 0;
+    bool validGains = true;
+    auto poll = [&]
+    {
+        edsp::GainReductionStatistics statistics;
+        if (!limiter.pollStatistics(statistics))
+            return;
+        polledFrames += statistics.frames;
+        for (const std::int64_t frames : statistics.histogram)
+            histogramFrames += frames;
+        // the average is a float sum, so it can round below the minimum or above 1
+        validGains &= statistics.minGain > 0.0f && statistics.minGain <= statistics.averageGain + 1e-6f && statistics.averageGain <= 1.0f + 1e-6f;
+    };
+
+    std::thread monitor([&]
+                        {
+                            while (!done.load(std::memory_order_acquire))
+                            {
+                                poll();
+                                std::this_thread::yield();
+                            } });
+
+    std::minstd_rand random{15};
+    for (int blockStart = 0; blockStart < samples - 1;)
+    {
+        const int blockSamples = std::min(static_cast<int>(random() % 300) + 1, samples - 1 - blockStart);
+        limiter.process(buffer.data() + static_cast<std::ptrdiff_t>(blockStart) * channels, blockSamples);
+        blockStart += blockSamples;
+    }
+    done.store(true, std::memory_order_release);
+    monitor.join();
+    poll();
+    limiter.process(buffer.data() + static_cast<std::ptrdiff_t>(samples - 1) * channels, 1);
+    poll();
+
+    return check(polledFrames == samples, "frames " + std::to_string(polledFrames)) && check(histogramFrames == samples, "the histograms hold every frame") && check(validGains, "minimum and average gain");
+}
+
+// the bank computes the envelope and the sliding maximum for every block, the limiter skips both while the window is below the threshold
+// so the output must be the same, also when a peak arrives right after a quiet window and when the window spans several blocks
+static bool testQuietWindow()
+{
+    constexpr int samples = 96000;
+    constexpr double sampleRate = 48000.0;
+    constexpr float thresholdInDb = -6.0f;
+    constexpr float makeupGainInDb = 2.0f;
+    const float threshold = std::pow(10.0f, thresholdInDb / 20.0f);
+    const float makeupGain = std::pow(10.0f, makeupGainInDb / 20.0f);
+
+    bool passed = true;
+    for (const int channels : {1, 2})
+    {
+        const std::vector<float> input = createPeaksAboveQuietNoise(channels, samples, threshold, static_cast<unsigned>(16 + channels));
+        for (const auto& [attackMs, releaseMs] : {std::pair{1.0f, 10.0f}, std::pair{10.0f, 50.0f}})
+        {
+            for (const int blockSize : {1, 64, 300, 1000})
+            {
+                edsp::LookAheadLimiter limiter;
+                limiter.configure(attackMs, releaseMs, thresholdInDb, makeupGainInDb, channels, sampleRate);
+                std::vector<float> output = input;
+                processInBlocks(limiter, output.data(), channels, samples, blockSize);
+
+                edsp::LookAheadLimiterBank bank;
+                bank.configure(1, channels, sampleRate);
+                bank.configureLimiter(0, attackMs, releaseMs, thresholdInDb, makeupGainInDb);
+                std::vector<float> expected = input;
+                for (int blockStart = 0; blockStart < samples; blockStart += blockSize)
+                {
+                    float* block = expected.data() + static_cast<std::ptrdiff_t>(blockStart) * channels;
+                    bank.process(&block, std::min(blockSize, samples - blockStart));
+                }
+
+                const std::string configuration = std::to_string(channels) + " channels, " + std::to_string(static_cast<int>(attackMs)) + " ms attack, blocks of " + std::to_string(blockSize) + ": ";
+                const double maxDifference = getMaxDifference(output, expected);
+                passed &= check(maxDifference <= bankTolerance, configuration + "deviation " + std::to_string(maxDifference));
+                passed &= check(getPeak(output, channels, 0, samples) <= threshold * makeupGain * 1.000001f, configuration + "peak above the threshold");
+
+                // the release reaches a gain of exactly 1 between the peaks, so most frames are the delayed input with makeup gain
+                const int latency = limiter.getLatencyInSamples();
+                int unchangedFrames = 0;
+                for (int sample = latency; sample < samples; ++sample)
+                {
+                    bool unchanged = true;
+                    for (int channel = 0; channel < channels; ++channel)
+                        unchanged &= output[static_cast<std::size_t>(sample * channels + channel)] == input[static_cast<std::size_t>((sample - latency) * channels + channel)] * makeupGain;
+                    unchangedFrames += unchanged ? 1 : 0;
+                }
+                passed &= check(unchangedFrames > samples / 4, configuration + "frames with a gain of 1: " + std::to_string(unchangedFrames));
+            }
+        }
+    }
+    return passed;
+}
+
+// 20 limiters with different parameters and material fill one group of 16 lanes and part of a second one
+// a copy continues exactly like the original, with the pending parameter changes, the statistics and the state of the envelope
+// a moved limiter as well, also when it is copied or moved into an existing limiter
+static bool testCopyAndMove()
+{
+    constexpr int channels = 2;
+    constexpr int samples = 48000;
+    constexpr int copySample = 20000;
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 300;
+    const std::vector<float> input = createBursts(channels, samples, 17);
+
+    edsp::LookAheadLimiter original;
+    original.prepare(10.0f, channels, sampleRate);
+    original.setThreshold(-3.0f);
+    original.reset();
+    original.setStatisticsEnabled(true);
+    std::vector<float> expected = input;
+    processInBlocks(original, expected.data(), channels, copySample, blockSize);
+
+    // not applied before the next block
+    original.setThreshold(-6.0f);
+    original.setAttack(4.0f);
+
+    edsp::LookAheadLimiter copied{original};
+    edsp::LookAheadLimiter moved{edsp::LookAheadLimiter{original}};
+    edsp::LookAheadLimiter copyAssigned;
+    copyAssigned = original;
+    edsp::LookAheadLimiter moveAssigned;
+    moveAssigned.configure(1.0f, 10.0f, 0.0f, 0.0f, 1, 44100.0);
+    moveAssigned = edsp::LookAheadLimiter{original};
+
+    edsp::GainReductionStatistics expectedStatistics;
+    original.pollStatistics(expectedStatistics);
+    processInBlocks(original, expected.data() + copySample * channels, channels, samples - copySample, blockSize);
+
+    bool passed = true;
+    for (const auto& [name, limiter] : {std::pair{"copy constructed", &copied}, std::pair{"move constructed", &moved}, std::pair{"copy assigned", &copyAssigned}, std::pair{"move assigned", &moveAssigned}})
+    {
+        edsp::GainReductionStatistics statistics;
+        passed &= check(limiter->pollStatistics(statistics) && statistics.frames == expectedStatistics.frames && statistics.minGain == expectedStatistics.minGain,
+                        std::string(name) + ": statistics of the original");
+
+        std::vector<float> output = input;
+        processInBlocks(*limiter, output.data() + copySample * channels, channels, samples - copySample, blockSize);
+        passed &= check(std::equal(output.begin() + copySample * channels, output.end(), expected.begin() + copySample * channels), std::string(name) + ": same output as the original");
+    }
+    return passed;
+}
+
+// the limiters can be used like before they had atomic members: copied, moved, returned by value and kept in a std::vector
+template <typename Limiter>
+static constexpr bool isCopyableAndMovable = std::is_copy_constructible_v<Limiter> && std::is_copy_assignable_v<Limiter> && std::is_move_constructible_v<Limiter> && std::is_move_assignable_v<Limiter>;
+static_assert(isCopyableAndMovable<edsp::LookAheadLimiter>);
+static_assert(isCopyableAndMovable<edsp::BasicLookAheadLimiter<double>>);
+static_assert(isCopyableAndMovable<edsp::BasicLookAheadLimiter<float, 2>>);
+
+template <typename SampleType, int CHANNELS>
+static edsp::BasicLookAheadLimiter<SampleType, CHANNELS> createLimiter(int channels, double sampleRate)
+{
+    edsp::BasicLookAheadLimiter<SampleType, CHANNELS> limiter;
+    limiter.configure(2.0f, 20.0f, -3.0f, 1.0f, channels, sampleRate);
+    return limiter;
+}
+
+// limiters that are returned by value and moved while a std::vector grows give the same output as a limiter that stays in place
+template <typename SampleType, int CHANNELS>
+static bool checkLimitersInVector(const std::string& name)
+{
+    constexpr int channels = 2;
+    constexpr int samples = 9600;
+    constexpr double sampleRate = 48000.0;
+    const std::vector<float> noise = createNoise(channels, samples, 18);
+    const std::vector<SampleType> input(noise.begin(), noise.end());
+
+    edsp::BasicLookAheadLimiter<SampleType, CHANNELS> inPlace;
+    inPlace.configure(2.0f, 20.0f, -3.0f, 1.0f, channels, sampleRate);
+    std::vector<SampleType> expected = input;
+    processInBlocks(inPlace, expected.data(), channels, samples / 2, 256);
+
+    std::vector<edsp::BasicLookAheadLimiter<SampleType, CHANNELS>> limiters;
+    limiters.push_back(createLimiter<SampleType, CHANNELS>(channels, sampleRate));
+    std::vector<SampleType> output = input;
+    processInBlocks(limiters.front(), output.data(), channels, samples / 2, 256);
+
+    // reallocates and moves the first limiter
+    limiters.emplace_back(limiters.front());
+    limiters.resize(8);
+    limiters.back() = limiters.front();
+    processInBlocks(inPlace, expected.data() + samples / 2 * channels, channels, samples / 2, 256);
+
+    bool passed = true;
+    for (const std::size_t index : {std::size_t{0}, std::size_t{1}, limiters.size() - 1})
+    {
+        std::vector<SampleType> limiterOutput = output;
+        processInBlocks(limiters[index], limiterOutput.data() + samples / 2 * channels, channels, samples / 2, 256);
+        passed &= check(limiterOutput == expected, name + ": limiter " + std::to_string(index) + " in the vector");
+    }
+    return passed;
+}
+
+static bool testLimitersInVector()
+{
+    bool passed = checkLimitersInVector<float, 0>("float");
+    passed &= checkLimitersInVector<double, 0>("double");
+    passed &= checkLimitersInVector<float, 2>("float, 2 channels");
+    return passed;
+}
+
+static bool testBankMatchesLimiters()
+{
+    constexpr int limiters = 20;
+    constexpr int channels = 2;
+    constexpr int samples = 24000;
+    constexpr double sampleRate = 48000.0;
+    const int blockSizes[] = {1, 64, 300, 700, 37};
+
+    edsp::LookAheadLimiterBank interleavedBank;
+    edsp::LookAheadLimiterBank planarBank;
+    interleavedBank.configure(limiters, channels, sampleRate);
+    planarBank.configure(limiters, channels, sampleRate);
+
+    std::vector<edsp::LookAheadLimiter> references(limiters);
+    std::vector<std::vector<float>> expected;
+    std::vector<std::vector<float>> interleavedOutputs;
+    std::vector<edsp::AudioBuffer<float, channels>> planarOutputs;
+    for (int limiter = 0; limiter < limiters; ++limiter)
+    {
+        const float attackMs = 0.5f + 0.4f * static_cast<float>(limiter);
+        const float releaseMs = 1.0f + 7.0f * static_cast<float>(limiter);
+        const float thresholdInDb = -1.0f - 0.5f * static_cast<float>(limiter);
+        const float makeupGainInDb = 0.2f * static_cast<float>(limiter);
+        interleavedBank.configureLimiter(limiter, attackMs, releaseMs, thresholdInDb, makeupGainInDb);
+        planarBank.configureLimiter(limiter, attackMs, releaseMs, thresholdInDb, makeupGainInDb);
+        references[static_cast<std::size_t>(limiter)].configure(attackMs, releaseMs, thresholdInDb, makeupGainInDb, channels, sampleRate);
+
+        const std::vector<float> input = limiter % 4 == 3 ? createNoise(channels, samples, static_cast<unsigned>(limiter)) : createBursts(channels, samples, static_cast<unsigned>(limiter));
+        expected.push_back(input);
+        interleavedOutputs.push_back(input);
+        planarOutputs.emplace_back(channels, samples);
+        edsp::deinterleaveSamples(edsp::AudioBufferInterleavedView<const float>{input.data(), channels, samples}, planarOutputs.back().getWriteView());
+    }
+
+    // every process() call gets the same number of samples as the calls of the separate limiters, so the blocks are the same
+    std::vector<float*> interleavedPointers(limiters);
+    std::vector<edsp::AudioBufferView<float>> planarViews(limiters);
+    int blockStart = 0;
+    for (int block = 0; blockStart < samples; ++block)
+    {
+        const int blockSamples = std::min(blockSizes[block % std::size(blockSizes)], samples - blockStart);
+        for (std::size_t limiter = 0; limiter < static_cast<std::size_t>(limiters); ++limiter)
+        {
+            references[limiter].process(expected[limiter].data() + static_cast<std::ptrdiff_t>(blockStart) * channels, blockSamples);
+            interleavedPointers[limiter] = interleavedOutputs[limiter].data() + static_cast<std::ptrdiff_t>(blockStart) * channels;
+            planarViews[limiter] = planarOutputs[limiter].getWriteView().getSubBlock(blockStart, blockSamples);
+        }
+        interleavedBank.process(interleavedPointers.data(), blockSamples);
+        planarBank.process(planarViews.data());
+        blockStart += blockSamples;
+    }
+
+    bool passed = true;
+    for (std::size_t limiter = 0; limiter < static_cast<std::size_t>(limiters); ++limiter)
+    {
+        std::vector<float> planarOutput(expected[limiter].size());
+        edsp::interleaveSamples(planarOutputs[limiter].getReadView(), edsp::AudioBufferInterleavedView<float>{planarOutput.data(), channels, samples});
+
+        const double interleavedDifference = getMaxDifference(interleavedOutputs[limiter], expected[limiter]);
+        const double planarDifference = getMaxDifference(planarOutput, expected[limiter]);
+        passed &= check(interleavedDifference <= bankTolerance, "interleaved limiter " + std::to_string(limiter) + ": deviation " + std::to_string(interleavedDifference));
+        passed &= check(planarDifference <= bankTolerance, "planar limiter " + std::to_string(limiter) + ": deviation " + std::to_string(planarDifference));
+    }
+    return passed;
+}
+
+// the SIMD envelope kernels of the bank return the same gains as the scalar kernel, for every level the CPU supports
+static bool testBankKernels()
+{
+    constexpr int limiters = 48;
+    constexpr int frames = 256;
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> peak(0.0f, 3.0f);
+
+    edsp::detail::EnvelopeLanes lanes;
+    lanes.resize(limiters);
+    for (std::size_t lane = 0; lane < lanes.size(); ++lane)
+    {
+        lanes.threshold[lane] = 0.2f + 0.02f * static_cast<float>(lane);
+        lanes.setCoefficients(lane, edsp::detail::EnvelopeCoefficients{0.1f + 0.05f * static_cast<float>(lane), 5.0f + static_cast<float>(lane), 48000.0});
+    }
+
+    // the kernels expect peaks of at least the threshold, like the sliding maxima of the bank
+    std::vector<float> peaks(lanes.size() * frames);
+    for (std::size_t lane = 0; lane < lanes.size(); ++lane)
+        for (int frame = 0; frame < frames; ++frame)
+            peaks[edsp::detail::getEnvelopeIndex(lane, frame, frames)] = std::max(lanes.threshold[lane], peak(generator));
+
+    // two blocks, so the state is carried over
+    auto run = [&](void (*computeEnvelopes)(edsp::detail::EnvelopeLanes&, float*, int))
+    {
+        edsp::detail::EnvelopeLanes kernelLanes = lanes;
+        std::vector<float> gains = peaks;
+        computeEnvelopes(kernelLanes, gains.data(), frames);
+        std::vector<float> secondGains = peaks;
+        computeEnvelopes(kernelLanes, secondGains.data(), frames);
+        gains.insert(gains.end(), secondGains.begin(), secondGains.end());
+        return gains;
+    };
+
+    const std::vector<float> expected = run(edsp::detail::computeEnvelopesScalar);
+    bool passed = true;
+#if defined(EDSP_SIMD_X86)
+    const edsp::SimdLevel level = edsp::detectSimdLevel();
+    if (level >= edsp::SimdLevel::Sse2)
+        passed &= check(getMaxDifference(run(edsp::detail::computeEnvelopesSse2), expected) <= bankTolerance, "SSE2 kernel");
+    if (level >= edsp::SimdLevel::Avx2)
+        passed &= check(getMaxDifference(run(edsp::detail::computeEnvelopesAvx2), expected) <= bankTolerance, "AVX2 kernel");
+    if (level >= edsp::SimdLevel::Avx512)
+        passed &= check(getMaxDifference(run(edsp::detail::computeEnvelopesAvx512), expected) <= bankTolerance, "AVX-512 kernel");
+#elif defined(EDSP_SIMD_NEON_DIVISION)
+    passed &= check(getMaxDifference(run(edsp::detail::computeEnvelopesNeon), expected) <= bankTolerance, "NEON kernel");
+#endif
+    return passed;
+}
+
+int main()
+{
+    bool passed = true;
+    for (const auto& [name, test] : {std::pair{"output unchanged", testOutputUnchanged},
+                                     std::pair{"matches the per-sample reference", testMatchesReference},
+                                     std::pair{"planar matches interleaved", testPlanarMatchesInterleaved},
+                                     std::pair{"true-peak detection", testTruePeak},
+                                     std::pair{"prepared matches configured", testPreparedMatchesConfigured},
+                                     std::pair{"parameter changes", testParameterChanges},
+                                     std::pair{"concurrent parameter changes", testConcurrentParameterChanges},
+                                     std::pair{"sample types and fixed channel count", testSampleTypesAndChannels},
+                                     std::pair{"statistics", testStatistics},
+                                     std::pair{"concurrent statistics", testConcurrentStatistics},
+                                     std::pair{"quiet window matches the envelope", testQuietWindow},
+                                     std::pair{"copy and move", testCopyAndMove},
+                                     std::pair{"limiters in a std::vector", testLimitersInVector},
+                                     std::pair{"bank matches separate limiters", testBankMatchesLimiters},
+                                     std::pair{"bank envelope kernels", testBankKernels}})
+    {
+        const bool testPassed = test();
+        std::cout << name << (testPassed ? " passed.\n" : " failed!\n");
+        passed &= testPassed;
+    }
+    return passed ? 0 : 1;
 }
@@ -0,0 +1,194 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+// asynchronous sample rate converter for audio between devices whose clocks drift apart
+// the input device pushes into a FIFO, the output device pulls, and a PI controller corrects the ratio so the fill level of the FIFO stays at the target
+// the ratio changes slowly and libsamplerate moves it linearly over every block, so the corrections are inaudible
+
+#include "../AudioBuffer/AudioBufferView.h"
+#include "../AudioFifo/AudioFifo.h"
+#include "Resampler.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+
+namespace edsp
+{
+
+// push() and pull() can be called from two different threads (single producer, single consumer), the getters from any thread
+class AsyncResampler
+{
+public:
+    // allocates, call e.g. at application start
+    // the sample rates are the nominal rates of the two devices, maxOutputSamples is the largest block of pull()
+    // targetLatency is the fill level in input frames the controller keeps, it has to cover the block sizes and the jitter of both devices
+    AsyncResampler(int channels, double inputSampleRate, double outputSampleRate, int maxOutputSamples, int targetLatency, ResamplerQuality quality = ResamplerQuality::Medium)
+            : mResampler(channels, Resampler::getConverterType(quality)),
+              mChannels(channels),
+              mMaxOutputSamples(maxOutputSamples),
+              mTargetLatency(targetLatency),
+              mInputSampleRate(inputSampleRate),
+              mOutputSampleRate(outputSampleRate),
+              mNominalRatio(outputSampleRate / inputSampleRate)
+    {
+        assert(maxOutputSamples > 0 && targetLatency > 0);
+
+        // twice the target leaves room for the controller to catch up, plus the input of one block of each device
+        const int maxInputSamples = static_cast<int>(std::ceil(maxOutputSamples / mNominalRatio * (1.0 + maxCorrection))) + 2;
+        mFifo.configure(channels, 2 * targetLatency + 2 * maxInputSamples);
+        reset();
+    }
+
+    // empties the FIFO, the estimated drift is kept, not thread-safe
+    void reset() noexcept
+    {
+        mResampler.reset();
+        mFifo.reset();
+        mRunning = false;
+        mFillLevel = mTargetLatency;
+        mRatio = mNominalRatio / (1.0 + mIntegral);
+        publishState();
+    }
+
+    // producer: buffers interleaved input and returns the number of frames that fit into the FIFO, the rest is dropped
+    int push(const float* inputBuffer, int inputSamples) noexcept
+    {
+        assert(inputSamples >= 0);
+        if (inputSamples == 0)
+            return 0;
+        return mFifo.write(AudioBufferInterleavedView<const float>(inputBuffer, mChannels, inputSamples));
+    }
+
+    // consumer: writes exactly outputSamples interleaved frames
+    // returns false and outputs silence until the FIFO is filled up to the target latency, at the start and after the input ran dry
+    bool pull(float* outputBuffer, int outputSamples) noexcept
+    {
+        assert(outputSamples >= 0 && outputSamples <= mMaxOutputSamples);
+
+        const int fillLevel = mFifo.getNumReady();
+        if (!mRunning)
+        {
+            if (fillLevel < mTargetLatency)
+            {
+                std::fill(outputBuffer, outputBuffer + static_cast<std::ptrdiff_t>(outputSamples) * mChannels, 0.0f);
+                return false;
+            }
+            mRunning = true;
+            mFillLevel = fillLevel;
+        }
+
+        updateRatio(fillLevel, outputSamples / mOutputSampleRate);
+
+        int generated = 0;
+        while (generated < outputSamples)
+        {
+            const ResamplerProgress progress = resampleFifo(outputBuffer + static_cast<std::ptrdiff_t>(generated) * mChannels, outputSamples - generated);
+            generated += progress.outputSamplesGenerated;
+            if (progress.inputSamplesUsed == 0 && progress.outputSamplesGenerated == 0)
+                break;
+        }
+
+        if (generated == outputSamples)
+            return true;
+
+        std::fill(outputBuffer + static_cast<std::ptrdiff_t>(generated) * mChannels, outputBuffer + static_cast<std::ptrdiff_t>(outputSamples) * mChannels, 0.0f);
+        mRunning = false;
+        return false;
+    }
+
+    // the current ratio (output sample rate / input sample rate) including the correction, callable from any thread
+    double getRatio() const noexcept
+    {
+        return mPublishedRatio.load(std::memory_order_relaxed);
+    }
+
+    // how much faster the input clock runs than the output clock relative to the nominal sample rates, the integral part of the controller
+    // callable from any thread
+    double getDriftInPpm() const noexcept
+    {
+        return mPublishedIntegral.load(std::memory_order_relaxed) * 1.0e6;
+    }
+
+    // the smoothed fill level of the FIFO in input frames, the controller keeps it at getTargetLatency(), callable from any thread
+    double getFillLevel() const noexcept
+    {
+        return mPublishedFillLevel.load(std::memory_order_relaxed);
+    }
+
+    int getTargetLatency() const noexcept
+    {
+        return mTargetLatency;
+    }
+
+private:
+    // the controller settles within about a minute and doesn't overshoot (critically damped)
+    // it is slow because the fill level seen by pull() also moves with the phase between the callbacks of the two devices
+    static constexpr double controllerFrequency = 0.01;
+    // the fill level jumps by the block sizes of both devices, it is smoothed well below the block rates but above the controller frequency
+    static constexpr double fillLevelFilterFrequency = 0.1;
+    // 5000 ppm, far more than the drift of real clocks, but small enough that a correction doesn't change the pitch audibly
+    static constexpr double maxCorrection = 0.005;
+    static constexpr double pi = 3.14159265358979323846;
+
+    // the relative correction of the input rate is proportional to the error of the fill level in seconds and its integral
+    // the fill level changes with the drift minus the correction, so the gains 2 * w and w * w give a critically damped loop
+    void updateRatio(int fillLevel, double seconds) noexcept
+    {
+        mFillLevel += (1.0 - std::exp(-2.0 * pi * fillLevelFilterFrequency * seconds)) * (fillLevel - mFillLevel);
+        const double error = (mFillLevel - mTargetLatency) / mInputSampleRate;
+
+        constexpr double omega = 2.0 * pi * controllerFrequency;
+        const double integral = mIntegral + omega * omega * error * seconds;
+        const double correction = 2.0 * omega * error + integral;
+
+        // the integral is only updated while the correction is not limited, so it doesn't wind up
+        if (std::abs(correction) <= maxCorrection)
+            mIntegral = integral;
+        mRatio = mNominalRatio / (1.0 + std::clamp(correction, -maxCorrection, maxCorrection));
+        publishState();
+    }
+
+    // the controller state is written by pull(), the getters read these copies, e.g. on a monitoring thread
+    void publishState() noexcept
+    {
+        mPublishedFillLevel.store(mFillLevel, std::memory_order_relaxed);
+        mPublishedIntegral.store(mIntegral, std::memory_order_relaxed);
+        mPublishedRatio.store(mRatio, std::memory_order_relaxed);
+    }
+
+    // only passes the input that is needed for the output to libsamplerate, so the buffered input is in the FIFO where it can be measured
+    ResamplerProgress resampleFifo(float* outputBuffer, int outputSamples) noexcept
+    {
+        // the part behind the end of the storage is used by the next call
+        const auto region = mFifo.getReadRegions(mFifo.getNumReady()).first;
+        if (region.getNumSamples() == 0)
+            return {};
+
+        const int inputSamples = std::min(region.getNumSamples(), static_cast<int>(std::ceil(outputSamples / mRatio)) + 2);
+        const ResamplerProgress progress = mResampler.process(region.getReadPointer(), inputSamples, outputBuffer, outputSamples, mRatio, false);
+        mFifo.finishRead(progress.inputSamplesUsed);
+        return progress;
+    }
+
+    Resampler mResampler;
+    int mChannels;
+    int mMaxOutputSamples;
+    int mTargetLatency;
+    double mInputSampleRate;
+    double mOutputSampleRate;
+    double mNominalRatio;
+    AudioFifoInterleaved<float> mFifo;
+
+    bool mRunning = false;
+    double mFillLevel = 0.0;
+    double mIntegral = 0.0;
+    double mRatio = 1.0;
+    std::atomic<double> mPublishedFillLevel{0.0};
+    std::atomic<double> mPublishedIntegral{0.0};
+    std::atomic<double> mPublishedRatio{1.0};
+};
+
+} // namespace edsp
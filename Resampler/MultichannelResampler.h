@@ -0,0 +1,194 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+// resamples planar audio with many channels, e.g. 32 or 64 channel feeds
+// the channels are split into groups with one Resampler each, the groups can be processed in parallel on a ThreadPool
+
+#include "../AudioBuffer/AudioBufferView.h"
+#include "../ThreadPool/ThreadPool.h"
+#include "Resampler.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace edsp
+{
+
+class MultichannelResampler
+{
+public:
+    // allocates, call e.g. at application start
+    // a group should have enough channels that its work outweighs handing it to another thread
+    MultichannelResampler(int channels, double inputSampleRate, double outputSampleRate, ResamplerQuality quality = ResamplerQuality::Medium, int channelsPerGroup = 8)
+            : mState(std::make_shared<State>())
+    {
+        assert(channels > 0 && channelsPerGroup > 0);
+
+        mState->channels = channels;
+        mState->channelsPerGroup = channelsPerGroup;
+        const int groups = (channels + channelsPerGroup - 1) / channelsPerGroup;
+        mState->groups.reserve(static_cast<std::size_t>(groups));
+        for (int group = 0; group < groups; ++group)
+            mState->groups.push_back(std::make_unique<Resampler>(mState->getGroupChannels(group), inputSampleRate, outputSampleRate, quality));
+        mState->groupProgress.resize(static_cast<std::size_t>(groups));
+    }
+
+    // converts planar samples on the calling thread, see Resampler::process()
+    // all groups use the same amount of input and generate the same amount of output
+    ResamplerProgress process(AudioBufferView<const float> inputBuffer, AudioBufferView<float> outputBuffer, bool endOfInput) noexcept
+    {
+        startProcessing(inputBuffer, outputBuffer, endOfInput);
+        mState->processGroups();
+        return finishProcessing();
+    }
+
+    // the same, but the groups are processed by the calling thread and up to one task per further group on the ThreadPool
+    // the calling thread takes the groups that were not picked up by a task yet and then only waits for the tasks that are processing a group
+    // a task that starts after all groups are done returns immediately, so a busy ThreadPool does not delay the call
+    template <int MAX_QUEUE_SIZE>
+    ResamplerProgress process(ThreadPool<MAX_QUEUE_SIZE>& threadPool, AudioBufferView<const float> inputBuffer, AudioBufferView<float> outputBuffer, bool endOfInput)
+    {
+        startProcessing(inputBuffer, outputBuffer, endOfInput);
+        {
+            std::lock_guard<std::mutex> lock(mState->mutex);
+            mState->callOpen = true;
+        }
+
+        // the tasks own the state, so a task that runs after the resampler was destroyed only finds the call closed
+        for (std::size_t task = 1; task < mState->groups.size(); ++task)
+        {
+            if (!threadPool.enqueue([state = mState]
+                                    { state->runTask(); }))
+                break;
+        }
+
+        mState->processGroups();
+
+        // tasks that start from now on return without touching the call, the running ones finish their group
+        std::unique_lock<std::mutex> lock(mState->mutex);
+        mState->callOpen = false;
+        mState->taskFinished.wait(lock, [this]
+                                  { return mState->runningTasks == 0; });
+        return finishProcessing();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& group : mState->groups)
+            group->reset();
+    }
+
+    // see Resampler::getLatencyInSamples()
+    int getLatencyInSamples() const noexcept
+    {
+        return mState->groups.front()->getLatencyInSamples();
+    }
+
+    // see Resampler::getInputSamplesForOutputSamples()
+    std::int64_t getInputSamplesForOutputSamples(std::int64_t outputSamples) const noexcept
+    {
+        return mState->groups.front()->getInputSamplesForOutputSamples(outputSamples);
+    }
+
+    int getNumChannels() const noexcept
+    {
+        return mState->channels;
+    }
+
+    int getNumGroups() const noexcept
+    {
+        return static_cast<int>(mState->groups.size());
+    }
+
+private:
+    // the groups and the call that is processed, shared with the tasks on the ThreadPool
+    struct State
+    {
+        int getGroupChannels(int group) const noexcept
+        {
+            return std::min(channelsPerGroup, channels - group * channelsPerGroup);
+        }
+
+        // takes the next group until none is left
+        void processGroups() noexcept
+        {
+            const int numGroups = static_cast<int>(groups.size());
+            for (int group = nextGroup++; group < numGroups; group = nextGroup++)
+            {
+                const int firstChannel = group * channelsPerGroup;
+                const int groupChannels = getGroupChannels(group);
+
+                // an empty input only flushes
+                const AudioBufferView<const float> groupInput = input.getNumSamples() > 0 ? input.getSubView(firstChannel, groupChannels) : AudioBufferView<const float>();
+                groupProgress[static_cast<std::size_t>(group)] = groups[static_cast<std::size_t>(group)]->process(groupInput, output.getSubView(firstChannel, groupChannels), endOfInput);
+            }
+        }
+
+        // only joins a call that is still open, the calling thread waits for it from then on
+        void runTask()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!callOpen)
+                    return;
+                ++runningTasks;
+            }
+
+            processGroups();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            --runningTasks;
+            taskFinished.notify_one();
+        }
+
+        int channels = 0;
+        int channelsPerGroup = 0;
+        std::vector<std::unique_ptr<Resampler>> groups;
+        std::vector<ResamplerProgress> groupProgress;
+
+        // the call that is processed
+        AudioBufferView<const float> input;
+        AudioBufferView<float> output;
+        bool endOfInput = false;
+        std::atomic<int> nextGroup{0};
+
+        std::mutex mutex;
+        std::condition_variable taskFinished;
+        bool callOpen = false;
+        int runningTasks = 0;
+    };
+
+    // no task is processing a group between calls, so the call can be set up without the mutex
+    void startProcessing(AudioBufferView<const float> inputBuffer, AudioBufferView<float> outputBuffer, bool endOfInput) noexcept
+    {
+        assert(inputBuffer.getNumSamples() == 0 || inputBuffer.getNumChannels() == mState->channels);
+        assert(outputBuffer.getNumChannels() == mState->channels);
+
+        mState->input = inputBuffer;
+        mState->output = outputBuffer;
+        mState->endOfInput = endOfInput;
+        mState->nextGroup.store(0, std::memory_order_relaxed);
+    }
+
+    ResamplerProgress finishProcessing() const noexcept
+    {
+        for (const ResamplerProgress& progress : mState->groupProgress)
+        {
+            assert(progress.inputSamplesUsed == mState->groupProgress.front().inputSamplesUsed);
+            assert(progress.outputSamplesGenerated == mState->groupProgress.front().outputSamplesGenerated);
+            (void) progress;
+        }
+        return mState->groupProgress.front();
+    }
+
+    std::shared_ptr<State> mState;
+};
+
+} // namespace edsp
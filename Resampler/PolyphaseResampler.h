@@ -0,0 +1,382 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+// polyphase FIR resampler for fixed rational ratios, e.g. 44.1 kHz <-> 48 kHz (160 / 147) or 2x and 3x
+// the filter is a Kaiser windowed sinc, split into one set of coefficients per phase, so every output sample is one SIMD dot product
+
+#include "../AudioBuffer/AudioBufferConversion.h"
+#include "../AudioBuffer/AudioBufferHelpers.h"
+#include "../AudioBuffer/AudioBufferSimd.h"
+#include "../AudioBuffer/AudioBufferView.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace edsp
+{
+
+struct ResamplerProgress
+{
+    int inputSamplesUsed = 0;
+    int outputSamplesGenerated = 0;
+};
+
+// the stopband starts at the lower Nyquist frequency, so nothing aliases, and the latency grows with the quality, see PolyphaseResampler::getLatencyInSamples()
+enum class ResamplerQuality
+{
+    Fast,   // 32 taps per phase, 60 dB stopband attenuation, passband up to 74 % of the lower Nyquist frequency
+    Medium, // 64 taps per phase, 90 dB, 81 %
+    Best    // 128 taps per phase, 120 dB, 87 %
+};
+
+namespace detail
+{
+
+struct PolyphaseFilterDesign
+{
+    int taps;               // per phase when upsampling, a multiple of 16 for the SIMD dot products
+    double attenuationInDb; // of the stopband
+};
+
+inline PolyphaseFilterDesign getPolyphaseFilterDesign(ResamplerQuality quality) noexcept
+{
+    switch (quality)
+    {
+    case ResamplerQuality::Fast:
+        return {32, 60.0};
+    case ResamplerQuality::Medium:
+        return {64, 90.0};
+    case ResamplerQuality::Best:
+        return {128, 120.0};
+    }
+    return {64, 90.0};
+}
+
+// modified Bessel function of the first kind and order 0, for the Kaiser window
+inline double besselI0(double x) noexcept
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; ++k)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1.0e-12)
+            break;
+    }
+    return sum;
+}
+
+// the filters are designed for this much more stopband attenuation than the quality promises
+constexpr double attenuationMarginInDb = 5.0;
+
+// coefficients of every phase in ascending input order, so phase p computes sum of coefficients[p * taps + k] * x[n - taps + 1 + k]
+// the prototype runs at upFactor times the input rate and is centered at taps / 2 input samples
+// the transition band of a Kaiser window is as narrow as the filter length and the attenuation allow and ends at the lower Nyquist frequency
+inline std::vector<float> designPolyphaseFilter(int upFactor, int downFactor, int taps, double attenuationInDb)
+{
+    constexpr double pi = 3.14159265358979323846;
+    const double length = static_cast<double>(upFactor) * taps;
+    const double center = length / 2.0;
+
+    // Kaiser's estimates of the window shape and the transition width, the taps are one input sample apart
+    // the width is a fraction of the lower Nyquist frequency, which is lower than the Nyquist frequency of the input when downsampling
+    // at these filter lengths the estimates miss the attenuation by up to 2.5 dB right above the lower Nyquist frequency, so the design has a margin
+    const double designAttenuationInDb = attenuationInDb + attenuationMarginInDb;
+    const double kaiserBeta = designAttenuationInDb > 50.0 ? 0.1102 * (designAttenuationInDb - 8.7) : 0.5842 * std::pow(designAttenuationInDb - 21.0, 0.4) + 0.07886 * (designAttenuationInDb - 21.0);
+    const double transitionWidth = std::min(0.5, (designAttenuationInDb - 7.95) / (2.285 * (taps - 1) * pi) * std::max(1.0, static_cast<double>(downFactor) / upFactor));
+
+    // cutoff in the middle of the transition band, in cycles per sample of the upsampled signal
+    const double nyquist = std::min(1.0, static_cast<double>(upFactor) / downFactor) / (2.0 * upFactor);
+    const double cutoff = nyquist * (1.0 - transitionWidth / 2.0);
+
+    std::vector<float> coefficients(static_cast<std::size_t>(upFactor) * static_cast<std::size_t>(taps));
+    std::vector<double> values(static_cast<std::size_t>(taps));
+    const double windowNormalization = besselI0(kaiserBeta);
+    for (int phase = 0; phase < upFactor; ++phase)
+    {
+        float* phaseCoefficients = coefficients.data() + static_cast<std::ptrdiff_t>(phase) * taps;
+        double sum = 0.0;
+        for (int k = 0; k < taps; ++k)
+        {
+            // prototype index of the tap that multiplies x[n - k]
+            const double t = phase + static_cast<double>(k) * upFactor - center;
+            const double x = 2.0 * cutoff * t;
+            const double sinc = x == 0.0 ? 1.0 : std::sin(pi * x) / (pi * x);
+            const double relative = t / center;
+            const double window = besselI0(kaiserBeta * std::sqrt(std::max(0.0, 1.0 - relative * relative))) / windowNormalization;
+            values[static_cast<std::size_t>(k)] = sinc * window;
+            sum += values[static_cast<std::size_t>(k)];
+        }
+
+        // every phase has unity gain at DC, otherwise a constant signal would be modulated with the phase pattern
+        for (int k = 0; k < taps; ++k)
+            phaseCoefficients[taps - 1 - k] = static_cast<float>(values[static_cast<std::size_t>(k)] / sum);
+    }
+    return coefficients;
+}
+
+} // namespace detail
+
+class PolyphaseResampler
+{
+public:
+    // more phases need more memory for the coefficients (phases * taps floats) than fits into the caches
+    static constexpr int maxPhases = 1024;
+
+    // the ratio has to be representable as upFactor / downFactor with up to maxPhases phases, which needs integer sample rates
+    static bool supportsRatio(double inputSampleRate, double outputSampleRate) noexcept
+    {
+        int upFactor = 0;
+        int downFactor = 0;
+        return getFactors(inputSampleRate, outputSampleRate, upFactor, downFactor);
+    }
+
+    // allocates the coefficients and buffers, returns false if the ratio is not supported
+    bool prepare(int channels, double inputSampleRate, double outputSampleRate, ResamplerQuality quality = ResamplerQuality::Medium)
+    {
+        assert(channels > 0);
+
+        if (!getFactors(inputSampleRate, outputSampleRate, mUpFactor, mDownFactor))
+            return false;
+
+        // downsampling needs a proportionally longer filter for the same transition band relative to the output rate
+        const detail::PolyphaseFilterDesign design = detail::getPolyphaseFilterDesign(quality);
+        const int scaledTaps = static_cast<int>(std::ceil(design.taps * std::max(1.0, static_cast<double>(mDownFactor) / mUpFactor)));
+        mTaps = (scaledTaps + 15) / 16 * 16;
+        mCoefficients = detail::designPolyphaseFilter(mUpFactor, mDownFactor, mTaps, design.attenuationInDb);
+
+        mChannels = channels;
+        mLineSize = static_cast<std::size_t>(mTaps - 1 + blockSize);
+        mLines.assign(static_cast<std::size_t>(channels) * mLineSize, 0.0f);
+        mOutputBlock.assign(static_cast<std::size_t>(channels) * blockSize, 0.0f);
+        mLinePointers.resize(static_cast<std::size_t>(channels));
+        for (int channel = 0; channel < channels; ++channel)
+            mLinePointers[static_cast<std::size_t>(channel)] = mLines.data() + static_cast<std::size_t>(channel) * mLineSize + mTaps - 1;
+
+        reset();
+        return true;
+    }
+
+    void reset() noexcept
+    {
+        std::fill(mLines.begin(), mLines.end(), 0.0f);
+
+        // the first output needs the input up to the center of the filter, so the output is aligned with the input
+        mPosition = getLatencyInSamples();
+        mPhase = 0;
+        mInputSamples = 0;
+        mOutputSamples = 0;
+    }
+
+    // converts interleaved samples, the input is used as far as the output has room for the result
+    // the input that was not used has to be passed again with the next call
+    // endOfInput pads the input with silence until the output has the duration of the input, call it until no more output is generated
+    ResamplerProgress process(const float* inputBuffer, int inputSamples, float* outputBuffer, int outputSamples, bool endOfInput) noexcept
+    {
+        return processSamples(
+                inputSamples, outputSamples, endOfInput, [this, inputBuffer](int offset, int samples)
+                { deinterleaveSamples(inputBuffer + static_cast<std::ptrdiff_t>(offset) * mChannels, mLinePointers.data(), mChannels, samples); },
+                [this, outputBuffer](int channel, int offset)
+                { return outputBuffer + static_cast<std::ptrdiff_t>(offset) * mChannels + channel; },
+                mChannels, [](int, int) {});
+    }
+
+    // the same for planar samples, an empty input (default constructed view) only flushes with endOfInput
+    ResamplerProgress process(AudioBufferView<const float> inputBuffer, AudioBufferView<float> outputBuffer, bool endOfInput) noexcept
+    {
+        assert(inputBuffer.getNumSamples() == 0 || inputBuffer.getNumChannels() == mChannels);
+        assert(outputBuffer.getNumChannels() == mChannels);
+
+        return processSamples(
+                inputBuffer.getNumSamples(), outputBuffer.getNumSamples(), endOfInput, [this, &inputBuffer](int offset, int samples)
+                {
+                    for (int channel = 0; channel < mChannels; ++channel)
+                        std::copy_n(inputBuffer.getReadPointer(channel) + offset, samples, mLinePointers[static_cast<std::size_t>(channel)]); },
+                [&outputBuffer](int channel, int offset)
+                { return outputBuffer.getWritePointer(channel) + offset; },
+                1, [](int, int) {});
+    }
+
+    // the same for interleaved 16, 24 or 32 bit integer samples, the conversion is fused into loading the input and storing the output
+    // the samples are converted in blocks that stay in the L1 cache instead of separate passes over the whole buffers, 16 and 24 bit output is dithered if dither is given
+    template <typename IntegerType>
+    ResamplerProgress process(const IntegerType* inputBuffer, int inputSamples, IntegerType* outputBuffer, int outputSamples, bool endOfInput, TpdfDither* dither = nullptr) noexcept
+    {
+        static_assert(detail::isIntegerSampleType<IntegerType>, "samples must be std::int16_t, PackedInt24 or std::int32_t");
+
+        // the filter writes interleaved float samples of one batch to mOutputBlock, they are converted when the batch is complete
+        return processSamples(
+                inputSamples, outputSamples, endOfInput, [this, inputBuffer](int offset, int samples)
+                { convertSamples(inputBuffer + static_cast<std::ptrdiff_t>(offset) * mChannels, mLinePointers.data(), mChannels, samples); },
+                [this](int channel, int)
+                { return mOutputBlock.data() + channel; },
+                mChannels, [this, outputBuffer, dither](int offset, int samples)
+                { convertSamples(mOutputBlock.data(), outputBuffer + static_cast<std::ptrdiff_t>(offset) * mChannels, samples * mChannels, dither); });
+    }
+
+    // the output of an input sample is available after this many further input samples (half the filter length)
+    int getLatencyInSamples() const noexcept
+    {
+        return mTaps / 2;
+    }
+
+    // the input samples after reset() that are needed for this many output samples
+    std::int64_t getInputSamplesForOutputSamples(std::int64_t outputSamples) const noexcept
+    {
+        if (outputSamples <= 0)
+            return 0;
+        return getLatencyInSamples() + (outputSamples - 1) * mDownFactor / mUpFactor + 1;
+    }
+
+    int getTapsPerPhase() const noexcept
+    {
+        return mTaps;
+    }
+
+private:
+    static constexpr int blockSize = 256;
+
+    // loadInput(offset, samples) copies input samples to mLinePointers
+    // getOutput(channel, offset) returns the output of a channel, consecutive samples are outputStride apart
+    // storeOutput(offset, samples) is called when a batch of outputs is complete
+    template <typename LoadInputFunction, typename OutputFunction, typename StoreOutputFunction>
+    ResamplerProgress processSamples(int inputSamples, int outputSamples, bool endOfInput, LoadInputFunction loadInput, OutputFunction getOutput, int outputStride,
+                                     StoreOutputFunction storeOutput) noexcept
+    {
+        assert(mTaps > 0); // prepare must be called beforehand
+        assert(inputSamples >= 0);
+        assert(outputSamples >= 0);
+
+        ResamplerProgress progress;
+        while (inputSamples > progress.inputSamplesUsed && outputSamples > progress.outputSamplesGenerated)
+        {
+            const int blockSamples = std::min(blockSize, inputSamples - progress.inputSamplesUsed);
+            loadInput(progress.inputSamplesUsed, blockSamples);
+
+            const int generated = processBlock(blockSamples, getOutput, outputStride, storeOutput, progress.outputSamplesGenerated, outputSamples - progress.outputSamplesGenerated);
+            const int used = finishBlock(blockSamples);
+            progress.inputSamplesUsed += used;
+            progress.outputSamplesGenerated += generated;
+        }
+        mInputSamples += progress.inputSamplesUsed;
+
+        if (!endOfInput || inputSamples > progress.inputSamplesUsed)
+        {
+            mOutputSamples += progress.outputSamplesGenerated;
+            return progress;
+        }
+
+        // the output of the remaining input needs up to getLatencyInSamples() samples of silence after it
+        const std::int64_t expectedOutputSamples = (mInputSamples * mUpFactor + mDownFactor - 1) / mDownFactor;
+        while (outputSamples > progress.outputSamplesGenerated && mOutputSamples + progress.outputSamplesGenerated < expectedOutputSamples)
+        {
+            const int blockSamples = std::min(blockSize, getLatencyInSamples() + 1);
+            for (float* line : mLinePointers)
+                std::fill(line, line + blockSamples, 0.0f);
+
+            const auto missingSamples = static_cast<int>(std::min(static_cast<std::int64_t>(outputSamples - progress.outputSamplesGenerated), expectedOutputSamples - mOutputSamples - progress.outputSamplesGenerated));
+            progress.outputSamplesGenerated += processBlock(blockSamples, getOutput, outputStride, storeOutput, progress.outputSamplesGenerated, missingSamples);
+            finishBlock(blockSamples);
+        }
+
+        mOutputSamples += progress.outputSamplesGenerated;
+        return progress;
+    }
+
+    static bool getFactors(double inputSampleRate, double outputSampleRate, int& upFactor, int& downFactor) noexcept
+    {
+        if (inputSampleRate <= 0.0 || outputSampleRate <= 0.0 || inputSampleRate != std::floor(inputSampleRate) || outputSampleRate != std::floor(outputSampleRate)
+            || inputSampleRate > 1.0e7 || outputSampleRate > 1.0e7)
+            return false;
+
+        const auto input = static_cast<std::int64_t>(inputSampleRate);
+        const auto output = static_cast<std::int64_t>(outputSampleRate);
+        const std::int64_t divisor = std::gcd(input, output);
+        if (output / divisor > maxPhases)
+            return false;
+
+        upFactor = static_cast<int>(output / divisor);
+        downFactor = static_cast<int>(input / divisor);
+        return true;
+    }
+
+    // computes the outputs whose filter ends within the block in mLinePointers, starting at outputOffset, returns the number of outputs
+    template <typename OutputFunction, typename StoreOutputFunction>
+    int processBlock(int blockSamples, OutputFunction& getOutput, int outputStride, StoreOutputFunction& storeOutput, int outputOffset, int outputSamples) noexcept
+    {
+        const int positionIncrement = mDownFactor / mUpFactor;
+        const int phaseIncrement = mDownFactor % mUpFactor;
+
+        int generated = 0;
+        while (generated < outputSamples && mPosition < blockSamples)
+        {
+            // the position is the newest input sample of the filter, the filter starts mTaps - 1 samples before it
+            int outputs = 0;
+            for (; outputs < blockSize && generated + outputs < outputSamples && mPosition < blockSamples; ++outputs)
+            {
+                mPositions[static_cast<std::size_t>(outputs)] = mPosition;
+                mPhases[static_cast<std::size_t>(outputs)] = mPhase;
+                mPosition += positionIncrement;
+                mPhase += phaseIncrement;
+                if (mPhase >= mUpFactor)
+                {
+                    mPhase -= mUpFactor;
+                    ++mPosition;
+                }
+            }
+
+            for (int channel = 0; channel < mChannels; ++channel)
+                simd::polyphaseFilter(mLinePointers[static_cast<std::size_t>(channel)] - (mTaps - 1), mCoefficients.data(), mPositions.data(), mPhases.data(), mTaps,
+                                      getOutput(channel, outputOffset + generated), outputStride, outputs);
+            storeOutput(outputOffset + generated, outputs);
+            generated += outputs;
+        }
+        return generated;
+    }
+
+    // keeps the mTaps - 1 samples before the next output as history and returns the number of samples that were used
+    int finishBlock(int blockSamples) noexcept
+    {
+        const int used = std::min(mPosition, blockSamples);
+        if (used == 0)
+            return 0;
+
+        // the history moves towards the start of the line, so the forward copy is fine for overlapping ranges
+        for (float* line : mLinePointers)
+            std::copy(line + used - (mTaps - 1), line + used, line - (mTaps - 1));
+        mPosition -= used;
+        return used;
+    }
+
+    int mChannels = 0;
+    int mUpFactor = 1;
+    int mDownFactor = 1;
+    int mTaps = 0;
+    std::vector<float> mCoefficients;
+
+    // per channel mTaps - 1 samples of history followed by one block of input
+    std::size_t mLineSize = 0;
+    std::vector<float> mLines;
+    std::vector<float*> mLinePointers;
+
+    // one batch of interleaved outputs that are converted to integer samples
+    std::vector<float> mOutputBlock;
+
+    // the next output is computed from the input up to mPosition (relative to the current block) with the coefficients of mPhase
+    int mPosition = 0;
+    int mPhase = 0;
+    std::array<int, blockSize> mPositions{};
+    std::array<int, blockSize> mPhases{};
+
+    std::int64_t mInputSamples = 0;
+    std::int64_t mOutputSamples = 0;
+};
+
+} // namespace edsp
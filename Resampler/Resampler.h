@@ -3,9 +3,18 @@
 
 #pragma once
 
+#include "../AudioBuffer/AudioBufferConversion.h"
+#include "../AudioBuffer/AudioBufferHelpers.h"
+#include "../AudioBuffer/AudioBufferInterleaved.h"
+#include "../AudioBuffer/AudioBufferView.h"
 #include "../Debug/Debug.h"
+#include "PolyphaseResampler.h"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
 #include <samplerate.h>
+#include <vector>
 
 namespace edsp
 {
@@ -13,18 +22,33 @@ namespace edsp
 class Resampler
 {
 public:
-    explicit Resampler(int channels) noexcept
+    // converterType is one of the libsamplerate converters, e.g. SRC_SINC_BEST_QUALITY for offline processing
+    explicit Resampler(int channels, int converterType = SRC_SINC_FASTEST) noexcept
     {
         assert(channels > 0);
+        createState(channels, converterType);
+    }
 
-        int error = 0;
-        mState = src_new(SRC_SINC_FASTEST, channels, &error);
+    // fixed ratio, uses the PolyphaseResampler if the ratio is rational (e.g. 44.1 kHz <-> 48 kHz, 2x, 3x), otherwise libsamplerate
+    // allocates, call e.g. at application start
+    Resampler(int channels, double inputSampleRate, double outputSampleRate, ResamplerQuality quality = ResamplerQuality::Medium)
+    {
+        assert(channels > 0);
+        assert(inputSampleRate > 0.0 && outputSampleRate > 0.0);
 
-        if (mState == nullptr)
-            DBG("src_new failed with error " << src_strerror(error));
+        mFixedRatio = outputSampleRate / inputSampleRate;
+        mUsePolyphase = mPolyphase.prepare(channels, inputSampleRate, outputSampleRate, quality);
+        if (!mUsePolyphase)
+        {
+            createState(channels, getConverterType(quality));
+            measureLatency(channels);
 
-        src_reset(mState);
+            // libsamplerate only takes interleaved float samples, planar and integer samples are converted in blocks
+            mInterleavedInput.setSize(channels, interleavedBlockSize);
+            mInterleavedOutput.setSize(channels, interleavedBlockSize);
+        }
     }
+
     ~Resampler() noexcept
     {
         if (mState != nullptr)
@@ -33,11 +57,19 @@ public:
     Resampler(const Resampler&) = delete;
     Resampler& operator=(const Resampler&) = delete;
 
+    // the ratio is outputSamples / inputSamples unless a fixed ratio was given to the constructor
+    // the input that was not used is dropped and the ratio follows the block sizes, use StreamingResampler for continuous streams
     void process(float* inputBuffer, float* outputBuffer, int inputSamples, int outputSamples) noexcept
     {
         assert(inputSamples > 0);
         assert(outputSamples > 0);
 
+        if (mUsePolyphase)
+        {
+            mPolyphase.process(inputBuffer, inputSamples, outputBuffer, outputSamples, false);
+            return;
+        }
+
         if (mState == nullptr)
             return;
 
@@ -47,7 +79,7 @@ public:
         data.input_frames = inputSamples;
         data.output_frames = outputSamples;
         data.end_of_input = 0;
-        data.src_ratio = outputSamples / static_cast<double>(inputSamples);
+        data.src_ratio = mFixedRatio > 0.0 ? mFixedRatio : outputSamples / static_cast<double>(inputSamples);
 
         int error = 0;
         error = src_process(mState, &data);
@@ -55,8 +87,195 @@ public:
             DBG("src_process failed with error " << src_strerror(error));
     }
 
+    // converts with a fixed ratio (output sample rate / input sample rate) and reports how much input was used and how much output was generated
+    // the input that was not used has to be passed again with the next call, so nothing is dropped, e.g. for offline processing
+    // endOfInput flushes the samples that are still in the filter, call it until no more output is generated, then call reset() before the next stream
+    // with libsamplerate the ratio may change between calls, it moves linearly from the previous ratio to the new one over the output of the call
+    ResamplerProgress process(const float* inputBuffer, int inputSamples, float* outputBuffer, int outputSamples, double ratio, bool endOfInput) noexcept
+    {
+        assert(inputSamples >= 0);
+        assert(outputSamples > 0);
+
+        if (mUsePolyphase)
+        {
+            assert(ratio == mFixedRatio); // the polyphase filter only supports the ratio given to the constructor
+            return mPolyphase.process(inputBuffer, inputSamples, outputBuffer, outputSamples, endOfInput);
+        }
+
+        if (mState == nullptr)
+            return {};
+
+        SRC_DATA data;
+        data.data_in = inputBuffer;
+        data.data_out = outputBuffer;
+        data.input_frames = inputSamples;
+        data.output_frames = outputSamples;
+        data.end_of_input = endOfInput ? 1 : 0;
+        data.src_ratio = ratio;
+
+        const int error = src_process(mState, &data);
+        if (error != 0)
+        {
+            DBG("src_process failed with error " << src_strerror(error));
+            return {};
+        }
+
+        return {static_cast<int>(data.input_frames_used), static_cast<int>(data.output_frames_gen)};
+    }
+
+    // the same with the ratio given to the constructor
+    ResamplerProgress process(const float* inputBuffer, int inputSamples, float* outputBuffer, int outputSamples, bool endOfInput) noexcept
+    {
+        assert(mFixedRatio > 0.0); // needs the constructor with the sample rates
+        return process(inputBuffer, inputSamples, outputBuffer, outputSamples, mFixedRatio, endOfInput);
+    }
+
+    // the same for planar samples with the ratio given to the constructor, an empty input (default constructed view) only flushes with endOfInput
+    ResamplerProgress process(AudioBufferView<const float> inputBuffer, AudioBufferView<float> outputBuffer, bool endOfInput) noexcept
+    {
+        assert(mFixedRatio > 0.0); // needs the constructor with the sample rates
+        if (mUsePolyphase)
+            return mPolyphase.process(inputBuffer, outputBuffer, endOfInput);
+
+        return processInBlocks(
+                inputBuffer.getNumSamples(), outputBuffer.getNumSamples(), endOfInput, [&inputBuffer](int offset, int samples, float* destination)
+                { interleaveSamples(inputBuffer.getSubBlock(offset, samples), AudioBufferInterleavedView<float>(destination, inputBuffer.getNumChannels(), samples)); },
+                [&outputBuffer](const float* source, int offset, int samples)
+                { deinterleaveSamples(AudioBufferInterleavedView<const float>(source, outputBuffer.getNumChannels(), samples), outputBuffer.getSubBlock(offset, samples)); });
+    }
+
+    // the same for interleaved 16, 24 or 32 bit integer samples with the ratio given to the constructor
+    // the conversion is fused into the loading and storing of the filter, so the buffers are not converted in separate passes, 16 and 24 bit output is dithered if dither is given
+    template <typename IntegerType>
+    ResamplerProgress process(const IntegerType* inputBuffer, int inputSamples, IntegerType* outputBuffer, int outputSamples, bool endOfInput, TpdfDither* dither = nullptr) noexcept
+    {
+        static_assert(detail::isIntegerSampleType<IntegerType>, "samples must be std::int16_t, PackedInt24 or std::int32_t");
+        assert(mFixedRatio > 0.0); // needs the constructor with the sample rates
+        assert(inputSamples >= 0);
+        assert(outputSamples > 0);
+
+        if (mUsePolyphase)
+            return mPolyphase.process(inputBuffer, inputSamples, outputBuffer, outputSamples, endOfInput, dither);
+
+        const int channels = mInterleavedInput.getNumChannels();
+        return processInBlocks(
+                inputSamples, outputSamples, endOfInput, [inputBuffer, channels](int offset, int samples, float* destination)
+                { convertSamples(inputBuffer + static_cast<std::ptrdiff_t>(offset) * channels, destination, samples * channels); },
+                [outputBuffer, channels, dither](const float* source, int offset, int samples)
+                { convertSamples(source, outputBuffer + static_cast<std::ptrdiff_t>(offset) * channels, samples * channels, dither); });
+    }
+
+    void reset() noexcept
+    {
+        if (mUsePolyphase)
+            mPolyphase.reset();
+        else if (mState != nullptr)
+            src_reset(mState);
+    }
+
+    // the output of an input sample is available after this many further input samples, needs the constructor with the sample rates
+    int getLatencyInSamples() const noexcept
+    {
+        assert(mFixedRatio > 0.0);
+        return mUsePolyphase ? mPolyphase.getLatencyInSamples() : mLatency;
+    }
+
+    // the input samples after reset() that are needed for this many output samples, needs the constructor with the sample rates
+    // exact for the polyphase filter, one sample more than needed for libsamplerate, so the result is never too small
+    std::int64_t getInputSamplesForOutputSamples(std::int64_t outputSamples) const noexcept
+    {
+        assert(mFixedRatio > 0.0);
+        if (mUsePolyphase)
+            return mPolyphase.getInputSamplesForOutputSamples(outputSamples);
+        if (outputSamples <= 0)
+            return 0;
+        return mLatency + static_cast<std::int64_t>(std::ceil(static_cast<double>(outputSamples) / mFixedRatio)) + 1;
+    }
+
+    // the libsamplerate converter that is used for a quality if the ratio is not supported by the polyphase filter
+    static int getConverterType(ResamplerQuality quality) noexcept
+    {
+        return quality == ResamplerQuality::Fast ? SRC_SINC_FASTEST : quality == ResamplerQuality::Medium ? SRC_SINC_MEDIUM_QUALITY : SRC_SINC_BEST_QUALITY;
+    }
+
+    // true if the ratio is converted by the PolyphaseResampler instead of libsamplerate
+    bool isUsingPolyphaseFilter() const noexcept
+    {
+        return mUsePolyphase;
+    }
+
 private:
+    void createState(int channels, int converterType) noexcept
+    {
+        int error = 0;
+        mState = src_new(converterType, channels, &error);
+
+        if (mState == nullptr)
+            DBG("src_new failed with error " << src_strerror(error));
+
+        src_reset(mState);
+    }
+
+    // libsamplerate only takes interleaved float samples, so other formats are converted in blocks through mInterleavedInput and mInterleavedOutput
+    // loadInput(offset, samples, destination) converts input samples to destination, storeOutput(source, offset, samples) converts source to the output
+    template <typename LoadInputFunction, typename StoreOutputFunction>
+    ResamplerProgress processInBlocks(int inputSamples, int outputSamples, bool endOfInput, LoadInputFunction loadInput, StoreOutputFunction storeOutput) noexcept
+    {
+        if (mState == nullptr)
+            return {};
+
+        ResamplerProgress progress;
+        while (progress.outputSamplesGenerated < outputSamples)
+        {
+            const int blockInputSamples = std::min(interleavedBlockSize, inputSamples - progress.inputSamplesUsed);
+            if (blockInputSamples > 0)
+                loadInput(progress.inputSamplesUsed, blockInputSamples, mInterleavedInput.getWritePointer());
+
+            const int blockOutputSamples = std::min(interleavedBlockSize, outputSamples - progress.outputSamplesGenerated);
+            const bool lastBlock = endOfInput && progress.inputSamplesUsed + blockInputSamples == inputSamples;
+            const ResamplerProgress blockProgress = process(mInterleavedInput.getReadPointer(), blockInputSamples, mInterleavedOutput.getWritePointer(), blockOutputSamples, mFixedRatio, lastBlock);
+            if (blockProgress.outputSamplesGenerated > 0)
+                storeOutput(mInterleavedOutput.getReadPointer(), progress.outputSamplesGenerated, blockProgress.outputSamplesGenerated);
+
+            progress.inputSamplesUsed += blockProgress.inputSamplesUsed;
+            progress.outputSamplesGenerated += blockProgress.outputSamplesGenerated;
+            if ((blockProgress.inputSamplesUsed == 0 && blockProgress.outputSamplesGenerated == 0) || (!endOfInput && progress.inputSamplesUsed == inputSamples))
+                break;
+        }
+        return progress;
+    }
+
+    // libsamplerate doesn't report its latency, so it is measured by feeding silence until the first output appears
+    void measureLatency(int channels)
+    {
+        if (mState == nullptr)
+            return;
+
+        std::vector<float> input(static_cast<std::size_t>(channels), 0.0f);
+        std::vector<float> output(static_cast<std::size_t>(channels) * (static_cast<std::size_t>(std::ceil(mFixedRatio)) + 1));
+        std::int64_t inputSamplesUsed = 0;
+        for (int i = 0; i < maxLatencyInSamples; ++i)
+        {
+            const ResamplerProgress progress = process(input.data(), 1, output.data(), static_cast<int>(output.size()) / channels, mFixedRatio, false);
+            inputSamplesUsed += progress.inputSamplesUsed;
+            if (progress.outputSamplesGenerated > 0)
+                break;
+        }
+
+        mLatency = static_cast<int>(std::max(inputSamplesUsed - 1, std::int64_t{0}));
+        src_reset(mState);
+    }
+
+    static constexpr int maxLatencyInSamples = 1 << 16;
+    static constexpr int interleavedBlockSize = 1024;
+
     SRC_STATE* mState = nullptr;
+    double mFixedRatio = 0.0;
+    int mLatency = 0;
+    bool mUsePolyphase = false;
+    PolyphaseResampler mPolyphase;
+    AudioBufferInterleaved<float> mInterleavedInput;
+    AudioBufferInterleaved<float> mInterleavedOutput;
 };
 
 } // namespace edsp
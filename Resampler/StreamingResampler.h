@@ -0,0 +1,166 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+// resamples a continuous stream with a fixed ratio and returns exactly the requested number of output frames per call
+// the input is buffered in an AudioFifoInterleaved, so nothing is dropped and the ratio doesn't depend on the block sizes
+
+#include "../AudioBuffer/AudioBufferView.h"
+#include "../AudioFifo/AudioFifo.h"
+#include "Resampler.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+namespace edsp
+{
+
+// the input is either pushed with push(), also from another thread (single producer, single consumer),
+// or pulled by pull() from a callback that is called on the thread of pull()
+// only pull() with a callback or push() must be used, not both
+class StreamingResampler
+{
+public:
+    // allocates, call e.g. at application start
+    // maxOutputSamples is the largest number of frames that pull() is called with
+    StreamingResampler(int channels, double inputSampleRate, double outputSampleRate, int maxOutputSamples, ResamplerQuality quality = ResamplerQuality::Medium)
+            : mResampler(channels, inputSampleRate, outputSampleRate, quality),
+              mChannels(channels),
+              mMaxOutputSamples(maxOutputSamples)
+    {
+        assert(maxOutputSamples > 0);
+
+        // the input of the first pull() includes the latency, room for two of them lets a producer stay one block ahead
+        mFifo.configure(channels, 2 * static_cast<int>(mResampler.getInputSamplesForOutputSamples(maxOutputSamples)));
+    }
+
+    // empties the FIFO and the filter, not thread-safe
+    void reset() noexcept
+    {
+        mResampler.reset();
+        mFifo.reset();
+        mInputSamplesUsed = 0;
+        mOutputSamplesGenerated = 0;
+    }
+
+    // producer: buffers interleaved input and returns the number of frames that fit into the FIFO
+    int push(const float* inputBuffer, int inputSamples) noexcept
+    {
+        assert(inputSamples >= 0);
+        if (inputSamples == 0)
+            return 0;
+        return mFifo.write(AudioBufferInterleavedView<const float>(inputBuffer, mChannels, inputSamples));
+    }
+
+    // consumer: writes exactly outputSamples interleaved frames
+    // returns false and fills the rest with silence if there wasn't enough input, see getRequiredInputSamples()
+    bool pull(float* outputBuffer, int outputSamples) noexcept
+    {
+        return pull(outputBuffer, outputSamples, [](AudioBufferInterleavedView<float>)
+                    { return 0; });
+    }
+
+    // the same, but missing input is requested from callback(AudioBufferInterleavedView<float> destination)
+    // the callback fills up to destination.getNumSamples() frames and returns their number, fewer frames mean the input has run dry
+    template <typename InputCallback>
+    bool pull(float* outputBuffer, int outputSamples, InputCallback&& callback) noexcept
+    {
+        assert(outputSamples >= 0 && outputSamples <= mMaxOutputSamples);
+
+        int generated = 0;
+        while (generated < outputSamples)
+        {
+            const ResamplerProgress progress = resampleFifo(outputBuffer + static_cast<std::ptrdiff_t>(generated) * mChannels, outputSamples - generated);
+            generated += progress.outputSamplesGenerated;
+            if (progress.inputSamplesUsed == 0 && progress.outputSamplesGenerated == 0 && !requestInput(outputSamples - generated, callback))
+                break;
+        }
+
+        if (generated == outputSamples)
+            return true;
+
+        std::fill(outputBuffer + static_cast<std::ptrdiff_t>(generated) * mChannels, outputBuffer + static_cast<std::ptrdiff_t>(outputSamples) * mChannels, 0.0f);
+        return false;
+    }
+
+    // the frames that have to be pushed before pull(outputSamples) can return only resampled input, call from the thread of pull()
+    int getRequiredInputSamples(int outputSamples) const noexcept
+    {
+        const std::int64_t required = mResampler.getInputSamplesForOutputSamples(mOutputSamplesGenerated + outputSamples) - mInputSamplesUsed - mFifo.getNumReady();
+        return static_cast<int>(std::max(required, std::int64_t{0}));
+    }
+
+    // the latency of the filter in input samples, the frames waiting in the FIFO add to it
+    int getLatencyInSamples() const noexcept
+    {
+        return mResampler.getLatencyInSamples();
+    }
+
+    // number of frames that can be pushed, callable from any thread
+    int getFreeSpace() const noexcept
+    {
+        return mFifo.getFreeSpace();
+    }
+
+    bool isUsingPolyphaseFilter() const noexcept
+    {
+        return mResampler.isUsingPolyphaseFilter();
+    }
+
+private:
+    // resamples the buffered input, the ready frames are at most two contiguous regions
+    ResamplerProgress resampleFifo(float* outputBuffer, int outputSamples) noexcept
+    {
+        ResamplerProgress progress;
+        const auto regions = mFifo.getReadRegions(mFifo.getNumReady());
+        for (const auto& region : {regions.first, regions.second})
+        {
+            if (region.getNumSamples() == 0 || progress.outputSamplesGenerated == outputSamples)
+                break;
+
+            const ResamplerProgress regionProgress = mResampler.process(region.getReadPointer(), region.getNumSamples(),
+                                                                        outputBuffer + static_cast<std::ptrdiff_t>(progress.outputSamplesGenerated) * mChannels,
+                                                                        outputSamples - progress.outputSamplesGenerated, false);
+            progress.inputSamplesUsed += regionProgress.inputSamplesUsed;
+            progress.outputSamplesGenerated += regionProgress.outputSamplesGenerated;
+            if (regionProgress.inputSamplesUsed < region.getNumSamples())
+                break;
+        }
+
+        mFifo.finishRead(progress.inputSamplesUsed);
+        mInputSamplesUsed += progress.inputSamplesUsed;
+        mOutputSamplesGenerated += progress.outputSamplesGenerated;
+        return progress;
+    }
+
+    // fills the free space with the input for the missing output and returns false if the callback didn't provide any
+    template <typename InputCallback>
+    bool requestInput(int missingOutputSamples, InputCallback& callback) noexcept
+    {
+        const auto regions = mFifo.getWriteRegions(std::max(getRequiredInputSamples(missingOutputSamples), 1));
+        int written = 0;
+        for (const auto& region : {regions.first, regions.second})
+        {
+            if (region.getNumSamples() == 0)
+                break;
+
+            const int regionWritten = std::clamp(static_cast<int>(callback(region)), 0, region.getNumSamples());
+            written += regionWritten;
+            if (regionWritten < region.getNumSamples())
+                break;
+        }
+
+        mFifo.finishWrite(written);
+        return written > 0;
+    }
+
+    Resampler mResampler;
+    int mChannels;
+    int mMaxOutputSamples;
+    AudioFifoInterleaved<float> mFifo;
+    std::int64_t mInputSamplesUsed = 0;
+    std::int64_t mOutputSamplesGenerated = 0;
+};
+
+} // namespace edsp
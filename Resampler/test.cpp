@@ -0,0 +1,601 @@
+// SPDX-FileCopyrightText: 2023 Christian Voigt
+// SPDX-License-Identifier: MIT
+
+#include "../AudioBuffer/AudioBuffer.h"
+#include "AsyncResampler.h"
+#include "MultichannelResampler.h"
+#include "PolyphaseResampler.h"
+#include "StreamingResampler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+static constexpr double pi = 3.14159265358979323846;
+
+// the sample rates of the tested polyphase filters, upsampling and downsampling
+static constexpr std::pair<double, double> sampleRates[] = {{44100.0, 48000.0}, {48000.0, 44100.0}, {48000.0, 96000.0}, {96000.0, 48000.0}};
+
+static constexpr std::pair<const char*, edsp::ResamplerQuality> qualities[] = {{"Fast", edsp::ResamplerQuality::Fast}, {"Medium", edsp::ResamplerQuality::Medium}, {"Best", edsp::ResamplerQuality::Best}};
+
+static bool check(bool condition, const std::string& message)
+{
+    if (!condition)
+        std::cout << "  failed: " << message << "\n";
+    return condition;
+}
+
+static std::string getRatioName(std::pair<double, double> rates)
+{
+    return std::to_string(static_cast<int>(rates.first)) + " -> " + std::to_string(static_cast<int>(rates.second)) + " Hz";
+}
+
+static std::vector<float> createNoise(int channels, int samples, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    std::vector<float> buffer(static_cast<std::size_t>(channels) * static_cast<std::size_t>(samples));
+    std::generate(buffer.begin(), buffer.end(), [&]
+                  { return noise(generator); });
+    return buffer;
+}
+
+// the same sine in every channel
+static std::vector<float> createSine(int channels, int samples, double frequency, double sampleRate)
+{
+    std::vector<float> buffer(static_cast<std::size_t>(channels) * static_cast<std::size_t>(samples));
+    for (int sample = 0; sample < samples; ++sample)
+        for (int channel = 0; channel < channels; ++channel)
+            buffer[static_cast<std::size_t>(sample * channels + channel)] = static_cast<float>(std::sin(2.0 * pi * frequency * sample / sampleRate));
+    return buffer;
+}
+
+// the number of output frames with the duration of the input
+static std::int64_t getExpectedOutputSamples(std::int64_t inputSamples, std::pair<double, double> rates)
+{
+    return (inputSamples * static_cast<std::int64_t>(rates.second) + static_cast<std::int64_t>(rates.first) - 1) / static_cast<std::int64_t>(rates.first);
+}
+
+// the whole input in one call, then flushed until no more output is generated
+template <typename ResamplerType>
+static std::vector<float> resampleAtOnce(ResamplerType& resampler, const std::vector<float>& input, int channels)
+{
+    const int inputSamples = static_cast<int>(input.size()) / channels;
+    std::vector<float> output(static_cast<std::size_t>(channels) * static_cast<std::size_t>(4 * inputSamples + 1024));
+
+    int generated = 0;
+    for (edsp::ResamplerProgress progress = resampler.process(input.data(), inputSamples, output.data(), static_cast<int>(output.size()) / channels, true); progress.outputSamplesGenerated > 0;
+         progress = resampler.process(nullptr, 0, output.data() + static_cast<std::ptrdiff_t>(generated) * channels, static_cast<int>(output.size()) / channels - generated, true))
+        generated += progress.outputSamplesGenerated;
+
+    output.resize(static_cast<std::size_t>(generated) * static_cast<std::size_t>(channels));
+    return output;
+}
+
+// random amounts of input and room for output per call, the input that was not used is passed again
+// process(input, inputSamples, output, outputSamples, endOfInput) calls the resampler
+template <typename SampleType, typename ProcessFunction>
+static std::vector<SampleType> resampleInChunks(const std::vector<SampleType>& input, int channels, unsigned seed, ProcessFunction process)
+{
+    std::minstd_rand random{seed};
+    const int inputSamples = static_cast<int>(input.size()) / channels;
+    std::vector<SampleType> output;
+    std::vector<SampleType> chunk(static_cast<std::size_t>(channels) * 500);
+
+    int used = 0;
+    while (true)
+    {
+        const int chunkInputSamples = std::min(static_cast<int>(random() % 700) + 1, inputSamples - used);
+        const int chunkOutputSamples = static_cast<int>(random() % 500) + 1;
+        const bool endOfInput = used == inputSamples;
+        const edsp::ResamplerProgress progress = process(input.data() + static_cast<std::ptrdiff_t>(used) * channels, chunkInputSamples, chunk.data(), chunkOutputSamples, endOfInput);
+        used += progress.inputSamplesUsed;
+        output.insert(output.end(), chunk.begin(), chunk.begin() + progress.outputSamplesGenerated * channels);
+        if (endOfInput && progress.outputSamplesGenerated == 0)
+            break;
+    }
+    return output;
+}
+
+// the output has the duration of the input, whether it is converted at once or in chunks of any size
+// getInputSamplesForOutputSamples() is exact: one input frame less generates one output frame less
+static bool testOutputCounts()
+{
+    constexpr int channels = 2;
+    constexpr int samples = 10007;
+    const std::vector<float> input = createNoise(channels, samples, 1);
+
+    bool passed = true;
+    for (const std::pair<double, double>& rates : sampleRates)
+    {
+        const std::string ratio = getRatioName(rates) + ": ";
+        edsp::PolyphaseResampler resampler;
+        passed &= check(resampler.prepare(channels, rates.first, rates.second), ratio + "ratio is supported");
+
+        const std::vector<float> expected = resampleAtOnce(resampler, input, channels);
+        passed &= check(static_cast<std::int64_t>(expected.size()) / channels == getExpectedOutputSamples(samples, rates), ratio + "output frames " + std::to_string(expected.size() / channels));
+
+        for (const unsigned seed : {2u, 3u, 4u})
+        {
+            resampler.reset();
+            const std::vector<float> output = resampleInChunks(input, channels, seed, [&](const float* inputBuffer, int inputSamples, float* outputBuffer, int outputSamples, bool endOfInput)
+                                                               { return resampler.process(inputBuffer, inputSamples, outputBuffer, outputSamples, endOfInput); });
+            passed &= check(output == expected, ratio + "chunks give the same output as one call");
+        }
+
+        for (const int outputSamples : {1, 2, 147, 160, 1000, 4321})
+        {
+            // when upsampling, the last input frame can complete more than one output frame
+            const int maxOutputSamples = 3 * outputSamples + 3;
+            std::vector<float> output(static_cast<std::size_t>(channels) * static_cast<std::size_t>(maxOutputSamples));
+            const auto inputSamples = static_cast<int>(resampler.getInputSamplesForOutputSamples(outputSamples));
+
+            resampler.reset();
+            const edsp::ResamplerProgress progress = resampler.process(input.data(), inputSamples, output.data(), maxOutputSamples, false);
+            resampler.reset();
+            const edsp::ResamplerProgress shorterProgress = resampler.process(input.data(), inputSamples - 1, output.data(), maxOutputSamples, false);
+            passed &= check(progress.outputSamplesGenerated >= outputSamples && shorterProgress.outputSamplesGenerated < outputSamples, ratio + "input for " + std::to_string(outputSamples) + " output frames");
+        }
+    }
+    return passed;
+}
+
+// the largest deviation of the passband and the largest level of the stopband are about 10^(-attenuation / 20)
+static double getStopbandLevel(edsp::ResamplerQuality quality)
+{
+    return std::pow(10.0, -edsp::detail::getPolyphaseFilterDesign(quality).attenuationInDb / 20.0);
+}
+
+// the output is aligned with the input: an impulse appears at the same time, a sine in the passband with the same phase
+static bool testAlignment()
+{
+    constexpr int channels = 1;
+    constexpr double frequency = 1000.0;
+
+    bool passed = true;
+    for (const std::pair<double, double>& rates : sampleRates)
+    {
+        for (const auto& [qualityName, quality] : qualities)
+        {
+            const std::string configuration = getRatioName(rates) + ", " + qualityName + ": ";
+            edsp::PolyphaseResampler resampler;
+            resampler.prepare(channels, rates.first, rates.second, quality);
+
+            // 0.1 s in the middle of 0.2 s, a whole number of samples at both rates
+            const auto samples = static_cast<int>(rates.first / 5.0);
+            std::vector<float> impulse(static_cast<std::size_t>(samples), 0.0f);
+            impulse[static_cast<std::size_t>(samples / 2)] = 1.0f;
+            const std::vector<float> impulseResponse = resampleAtOnce(resampler, impulse, channels);
+            const auto peak = std::max_element(impulseResponse.begin(), impulseResponse.end()) - impulseResponse.begin();
+            passed &= check(peak == static_cast<std::ptrdiff_t>(rates.second / 10.0), configuration + "impulse at output frame " + std::to_string(peak));
+
+            // away from the beginning and the end, which are filtered together with the silence around the input
+            resampler.reset();
+            const std::vector<float> output = resampleAtOnce(resampler, createSine(channels, samples, frequency, rates.first), channels);
+            const int margin = 2 * resampler.getTapsPerPhase();
+            double maxDifference = 0.0;
+            for (int sample = margin; sample < static_cast<int>(output.size()) - margin; ++sample)
+                maxDifference = std::max(maxDifference, std::abs(output[static_cast<std::size_t>(sample)] - std::sin(2.0 * pi * frequency * sample / rates.second)));
+            passed &= check(maxDifference <= getStopbandLevel(quality), configuration + "sine deviates by " + std::to_string(maxDifference));
+        }
+    }
+    return passed;
+}
+
+// when downsampling, sines between the lower Nyquist frequency and the Nyquist frequency of the input would alias
+// the stopband has to attenuate them by 60/90/120 dB, most closely right above the lower Nyquist frequency
+static bool testStopband()
+{
+    constexpr int channels = 1;
+    constexpr int samples = 4800;
+
+    bool passed = true;
+    for (const std::pair<double, double>& rates : {std::pair{48000.0, 44100.0}, std::pair{96000.0, 48000.0}})
+    {
+        for (const auto& [qualityName, quality] : qualities)
+        {
+            edsp::PolyphaseResampler resampler;
+            resampler.prepare(channels, rates.first, rates.second, quality);
+
+            double maxLevel = 0.0;
+            const double lowerNyquist = rates.second / 2.0;
+            for (double frequency = lowerNyquist; frequency < rates.first / 2.0; frequency += frequency < lowerNyquist + 2000.0 ? 25.0 : 500.0)
+            {
+                resampler.reset();
+                const std::vector<float> output = resampleAtOnce(resampler, createSine(channels, samples, frequency, rates.first), channels);
+                const int margin = 2 * resampler.getTapsPerPhase();
+                for (int sample = margin; sample < static_cast<int>(output.size()) - margin; ++sample)
+                    maxLevel = std::max(maxLevel, static_cast<double>(std::abs(output[static_cast<std::size_t>(sample)])));
+            }
+
+            const double maxLevelInDb = 20.0 * std::log10(maxLevel);
+            passed &= check(maxLevel <= getStopbandLevel(quality), getRatioName(rates) + ", " + qualityName + ": aliases at " + std::to_string(maxLevelInDb) + " dB");
+        }
+    }
+    return passed;
+}
+
+// the output of one Resampler::process() call without endOfInput, the reference for the streamed output
+static std::vector<float> resampleOffline(const std::vector<float>& input, int channels, std::pair<double, double> rates)
+{
+    edsp::Resampler resampler(channels, rates.first, rates.second);
+    const int inputSamples = static_cast<int>(input.size()) / channels;
+    std::vector<float> output(static_cast<std::size_t>(channels) * static_cast<std::size_t>(2 * inputSamples));
+    const edsp::ResamplerProgress progress = resampler.process(input.data(), inputSamples, output.data(), static_cast<int>(output.size()) / channels, false);
+    output.resize(static_cast<std::size_t>(progress.outputSamplesGenerated) * static_cast<std::size_t>(channels));
+    return output;
+}
+
+// pulls blocks of random size until the input has run dry and compares them with the offline output
+// the last, incomplete block has to continue the offline output until it ends and be silent after that, otherwise input was dropped
+template <typename PullFunction>
+static bool checkStreamedOutput(const std::vector<float>& expected, int channels, int maxOutputSamples, unsigned seed, const std::string& name, PullFunction pull)
+{
+    std::minstd_rand random{seed};
+    std::vector<float> output;
+    std::vector<float> block(static_cast<std::size_t>(channels) * static_cast<std::size_t>(maxOutputSamples));
+
+    bool passed = true;
+    while (true)
+    {
+        const int outputSamples = static_cast<int>(random() % static_cast<unsigned>(maxOutputSamples)) + 1;
+        const bool complete = pull(block.data(), outputSamples);
+        const auto blockEnd = block.begin() + outputSamples * channels;
+        if (complete)
+        {
+            output.insert(output.end(), block.begin(), blockEnd);
+            continue;
+        }
+
+        const auto remaining = static_cast<std::ptrdiff_t>(expected.size() - std::min(output.size(), expected.size()));
+        passed &= check(output.size() <= expected.size() && remaining < blockEnd - block.begin(), name + "complete blocks until the input runs dry");
+        if (!passed)
+            return false;
+
+        output.insert(output.end(), block.begin(), block.begin() + remaining);
+        passed &= check(std::all_of(block.begin() + remaining, blockEnd, [](float sample)
+                                    { return sample == 0.0f; }),
+                        name + "silence after the input ran dry");
+        break;
+    }
+
+    passed &= check(output == expected, name + "same output as one call of Resampler::process()");
+    return passed;
+}
+
+// the streamed output is the same as the offline output, whether the input is pushed or requested by pull() in blocks of any size
+// all input is resampled, so none is dropped
+static bool testStreamingResampler()
+{
+    constexpr int channels = 2;
+    constexpr int samples = 20011;
+    constexpr int maxOutputSamples = 512;
+    const std::vector<float> input = createNoise(channels, samples, 5);
+
+    bool passed = true;
+    for (const std::pair<double, double>& rates : sampleRates)
+    {
+        const std::vector<float> expected = resampleOffline(input, channels, rates);
+        for (const unsigned seed : {6u, 7u, 8u})
+        {
+            const std::string configuration = getRatioName(rates) + ", seed " + std::to_string(seed) + ", ";
+            std::minstd_rand random{seed * 100};
+
+            edsp::StreamingResampler pullingResampler(channels, rates.first, rates.second, maxOutputSamples);
+            passed &= check(pullingResampler.isUsingPolyphaseFilter(), configuration + "polyphase filter");
+            int read = 0;
+            passed &= checkStreamedOutput(expected, channels, maxOutputSamples, seed, configuration + "callback: ", [&](float* block, int outputSamples)
+                                          { return pullingResampler.pull(block, outputSamples, [&](edsp::AudioBufferInterleavedView<float> destination)
+                                                                         {
+                                                                             // the source delivers fewer frames than requested at times
+                                                                             const int frames = std::min({destination.getNumSamples(), static_cast<int>(random() % 300) + 1, samples - read});
+                                                                             for (int sample = 0; sample < frames; ++sample)
+                                                                                 for (int channel = 0; channel < channels; ++channel)
+                                                                                     destination.setSample(channel, sample, input[static_cast<std::size_t>((read + sample) * channels + channel)]);
+                                                                             read += frames;
+                                                                             return frames; }); });
+            passed &= check(read == samples, configuration + "callback: all input requested");
+
+            // the producer pushes blocks of random size until the next block can be pulled
+            edsp::StreamingResampler pushedResampler(channels, rates.first, rates.second, maxOutputSamples);
+            int pushed = 0;
+            passed &= checkStreamedOutput(expected, channels, maxOutputSamples, seed, configuration + "push: ", [&](float* block, int outputSamples)
+                                          {
+                                              while (pushed < samples && pushedResampler.getRequiredInputSamples(outputSamples) > 0)
+                                              {
+                                                  const int frames = std::min(static_cast<int>(random() % 300) + 1, samples - pushed);
+                                                  pushed += pushedResampler.push(input.data() + static_cast<std::ptrdiff_t>(pushed) * channels, frames);
+                                              }
+                                              return pushedResampler.pull(block, outputSamples); });
+            passed &= check(pushed == samples, configuration + "push: all input pushed");
+        }
+    }
+    return passed;
+}
+
+// the input in blocks of random size and random room for output per call, then flushed, returns the output per channel
+template <typename Buffer, typename ProcessFunction>
+static std::vector<std::vector<float>> resamplePlanarInChunks(const Buffer& input, int maxOutputSamples, unsigned seed, ProcessFunction process)
+{
+    std::minstd_rand random{seed};
+    const int channels = input.getNumChannels();
+    const int inputSamples = input.getNumSamples();
+    Buffer output(channels, maxOutputSamples);
+
+    int used = 0;
+    int generated = 0;
+    while (true)
+    {
+        const int chunkInputSamples = std::min(static_cast<int>(random() % 700) + 1, inputSamples - used);
+        const int chunkOutputSamples = std::min(static_cast<int>(random() % 500) + 1, maxOutputSamples - generated);
+        const bool endOfInput = used == inputSamples;
+        const edsp::AudioBufferView<const float> inputView = chunkInputSamples > 0 ? input.getReadView().getSubBlock(used, chunkInputSamples) : edsp::AudioBufferView<const float>();
+        const edsp::ResamplerProgress progress = process(inputView, output.getWriteView().getSubBlock(generated, chunkOutputSamples), endOfInput);
+        used += progress.inputSamplesUsed;
+        generated += progress.outputSamplesGenerated;
+        if (endOfInput && progress.outputSamplesGenerated == 0)
+            break;
+    }
+
+    std::vector<std::vector<float>> channelOutputs;
+    for (int channel = 0; channel < channels; ++channel)
+        channelOutputs.emplace_back(output.getReadPointer(channel), output.getReadPointer(channel) + generated);
+    return channelOutputs;
+}
+
+// the groups are independent: processing them on a ThreadPool gives the same output as on the calling thread and as one Resampler per channel
+// also when the last group has fewer channels
+static bool testMultichannelResampler()
+{
+    constexpr int channels = 20;
+    constexpr int samples = 4801;
+    constexpr int maxOutputSamples = 2 * samples + 1024;
+
+    edsp::AudioBuffer<float, channels> input(channels, samples);
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        const std::vector<float> noise = createNoise(1, samples, 10 + static_cast<unsigned>(channel));
+        std::copy(noise.begin(), noise.end(), input.getWritePointer(channel));
+    }
+
+    edsp::ThreadPool<64> threadPool;
+    bool passed = true;
+    for (const std::pair<double, double>& rates : sampleRates)
+    {
+        std::vector<std::vector<float>> expected;
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            edsp::Resampler resampler(1, rates.first, rates.second);
+            expected.push_back(resamplePlanarInChunks(input, maxOutputSamples, 11, [&](edsp::AudioBufferView<const float> inputView, edsp::AudioBufferView<float> outputView, bool endOfInput)
+                                                      { return resampler.process(inputView.getNumSamples() > 0 ? inputView.getSubView(channel, 1) : inputView, outputView.getSubView(channel, 1), endOfInput); })[static_cast<std::size_t>(channel)]);
+        }
+
+        for (const int channelsPerGroup : {8, 3})
+        {
+            const std::string configuration = getRatioName(rates) + ", " + std::to_string(channelsPerGroup) + " channels per group: ";
+            edsp::MultichannelResampler resampler(channels, rates.first, rates.second, edsp::ResamplerQuality::Medium, channelsPerGroup);
+            const std::vector<std::vector<float>> output = resamplePlanarInChunks(input, maxOutputSamples, 12, [&](edsp::AudioBufferView<const float> inputView, edsp::AudioBufferView<float> outputView, bool endOfInput)
+                                                                                  { return resampler.process(inputView, outputView, endOfInput); });
+            passed &= check(output == expected, configuration + "calling thread gives the same output as one Resampler per channel");
+
+            resampler.reset();
+            const std::vector<std::vector<float>> threadPoolOutput = resamplePlanarInChunks(input, maxOutputSamples, 13, [&](edsp::AudioBufferView<const float> inputView, edsp::AudioBufferView<float> outputView, bool endOfInput)
+                                                                                            { return resampler.process(threadPool, inputView, outputView, endOfInput); });
+            passed &= check(threadPoolOutput == expected, configuration + "ThreadPool gives the same output as one Resampler per channel");
+        }
+    }
+    return passed;
+}
+
+// while every thread of the ThreadPool is busy with long tasks, the calling thread processes all groups and returns without waiting for them
+// the tasks that are still queued run after the resampler was destroyed and must not touch it
+static bool testBusyThreadPool()
+{
+    constexpr int channels = 20;
+    constexpr int samples = 64;
+    constexpr int blocks = 20;
+    const int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    edsp::AudioBuffer<float, channels> input(channels, samples);
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        const std::vector<float> noise = createNoise(1, samples, 30 + static_cast<unsigned>(channel));
+        std::copy(noise.begin(), noise.end(), input.getWritePointer(channel));
+    }
+
+    edsp::ThreadPool<64> threadPool;
+    std::mutex mutex;
+    std::condition_variable released;
+    bool release = false;
+    std::atomic<int> busyThreads{0};
+    for (int thread = 0; thread < threads; ++thread)
+    {
+        threadPool.enqueue([&]
+                           {
+                               ++busyThreads;
+                               std::unique_lock<std::mutex> lock(mutex);
+                               released.wait_for(lock, std::chrono::seconds(2), [&]
+                                                 { return release; }); });
+    }
+    while (busyThreads < threads)
+        std::this_thread::yield();
+
+    bool passed = true;
+    {
+        edsp::MultichannelResampler resampler(channels, 48000.0, 44100.0, edsp::ResamplerQuality::Medium, 3);
+        edsp::MultichannelResampler expectedResampler(channels, 48000.0, 44100.0, edsp::ResamplerQuality::Medium, 3);
+        edsp::AudioBuffer<float, channels> output(channels, samples);
+        edsp::AudioBuffer<float, channels> expected(channels, samples);
+
+        double maxSeconds = 0.0;
+        for (int block = 0; block < blocks; ++block)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            const edsp::ResamplerProgress progress = resampler.process(threadPool, input.getReadView(), output.getWriteView(), false);
+            maxSeconds = std::max(maxSeconds, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+            const edsp::ResamplerProgress expectedProgress = expectedResampler.process(input.getReadView(), expected.getWriteView(), false);
+            bool equal = progress.inputSamplesUsed == expectedProgress.inputSamplesUsed && progress.outputSamplesGenerated == expectedProgress.outputSamplesGenerated;
+            for (int channel = 0; channel < channels; ++channel)
+                equal &= std::equal(output.getReadPointer(channel), output.getReadPointer(channel) + progress.outputSamplesGenerated, expected.getReadPointer(channel));
+            passed &= check(equal, "block " + std::to_string(block) + " gives the same output as the calling thread");
+        }
+        passed &= check(maxSeconds < 0.5, "the longest call took " + std::to_string(maxSeconds) + " s while the ThreadPool was busy");
+    }
+
+    // the queued tasks of the destroyed resampler run now
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        release = true;
+    }
+    released.notify_all();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    return passed;
+}
+
+// the input device runs faster or slower than its nominal rate, the controller finds the drift and keeps the FIFO at the target latency
+// after it has settled, the FIFO neither runs dry nor overflows
+static bool testAsyncResamplerDrift()
+{
+    constexpr int channels = 2;
+    constexpr double sampleRate = 48000.0;
+    constexpr int inputBlockSize = 480;
+    constexpr int outputBlockSize = 512;
+    constexpr int targetLatency = 2 * inputBlockSize + 256;
+    constexpr double seconds = 300.0;
+    constexpr double settlingSeconds = 150.0;
+
+    const std::vector<float> inputBlock = createNoise(channels, inputBlockSize, 40);
+    std::vector<float> outputBlock(static_cast<std::size_t>(channels) * outputBlockSize);
+
+    bool passed = true;
+    for (const double driftInPpm : {100.0, -300.0, 2000.0})
+    {
+        const std::string configuration = std::to_string(static_cast<int>(driftInPpm)) + " ppm: ";
+        edsp::AsyncResampler resampler{channels, sampleRate, sampleRate, outputBlockSize, targetLatency};
+
+        // the callbacks of both devices in the order of their times, the input clock is off by the drift
+        const double inputBlockSeconds = inputBlockSize / (sampleRate * (1.0 + driftInPpm * 1.0e-6));
+        const double outputBlockSeconds = outputBlockSize / sampleRate;
+        double inputTime = 0.0;
+        double outputTime = 0.0;
+        int overruns = 0;
+        int underruns = 0;
+        double maxFillLevelError = 0.0;
+        while (outputTime < seconds)
+        {
+            if (inputTime <= outputTime)
+            {
+                if (resampler.push(inputBlock.data(), inputBlockSize) < inputBlockSize && inputTime >= settlingSeconds)
+                    ++overruns;
+                inputTime += inputBlockSeconds;
+            }
+            else
+            {
+                if (!resampler.pull(outputBlock.data(), outputBlockSize) && outputTime >= settlingSeconds)
+                    ++underruns;
+                if (outputTime >= settlingSeconds)
+                    maxFillLevelError = std::max(maxFillLevelError, std::abs(resampler.getFillLevel() - targetLatency));
+                outputTime += outputBlockSeconds;
+            }
+        }
+
+        const double estimatedDriftInPpm = resampler.getDriftInPpm();
+        passed &= check(std::abs(estimatedDriftInPpm - driftInPpm) <= 2.0, configuration + "estimated drift " + std::to_string(estimatedDriftInPpm) + " ppm");
+        passed &= check(maxFillLevelError <= 0.05 * targetLatency, configuration + "the fill level deviates by " + std::to_string(maxFillLevelError) + " frames");
+        passed &= check(overruns == 0 && underruns == 0, configuration + std::to_string(overruns) + " overruns and " + std::to_string(underruns) + " underruns after settling");
+    }
+    return passed;
+}
+
+template <typename IntegerType>
+static std::vector<IntegerType> createIntegerNoise(int channels, int samples, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<std::int32_t> noise(std::numeric_limits<IntegerType>::min(), std::numeric_limits<IntegerType>::max());
+    std::vector<IntegerType> buffer(static_cast<std::size_t>(channels) * static_cast<std::size_t>(samples));
+    std::generate(buffer.begin(), buffer.end(), [&]
+                  { return static_cast<IntegerType>(noise(generator)); });
+    return buffer;
+}
+
+// the conversion fused into the filter gives the same samples as converting to float, resampling and converting back
+// also for blocks of random, mostly odd size
+// dither uses its noise per conversion call, so with dither only the error is the same: 16 bit samples are at most 1 LSB away, 32 bit samples are not dithered
+template <typename IntegerType>
+static bool testIntegerSamples(const std::string& typeName)
+{
+    constexpr int channels = 2;
+    constexpr int samples = 10007;
+    const std::vector<IntegerType> input = createIntegerNoise<IntegerType>(channels, samples, 20);
+
+    std::vector<float> floatInput(input.size());
+    edsp::convertSamples(input.data(), floatInput.data(), static_cast<int>(input.size()));
+
+    bool passed = true;
+    for (const std::pair<double, double>& rates : {std::pair{44100.0, 48000.0}, std::pair{48000.0, 44100.0}, std::pair{48000.0, 96000.0}})
+    {
+        edsp::Resampler floatResampler(channels, rates.first, rates.second);
+        const std::vector<float> floatOutput = resampleAtOnce(floatResampler, floatInput, channels);
+        std::vector<IntegerType> expected(floatOutput.size());
+        edsp::convertSamples(floatOutput.data(), expected.data(), static_cast<int>(floatOutput.size()));
+
+        for (const unsigned seed : {22u, 23u})
+        {
+            const std::string configuration = typeName + ", " + getRatioName(rates) + ", seed " + std::to_string(seed) + ": ";
+            edsp::Resampler resampler(channels, rates.first, rates.second);
+            const std::vector<IntegerType> output = resampleInChunks(input, channels, seed, [&](const IntegerType* inputBuffer, int inputSamples, IntegerType* outputBuffer, int outputSamples, bool endOfInput)
+                                                                     { return resampler.process(inputBuffer, inputSamples, outputBuffer, outputSamples, endOfInput); });
+            passed &= check(output == expected, configuration + "same samples as the float path");
+
+            resampler.reset();
+            edsp::TpdfDither dither{seed};
+            const std::vector<IntegerType> ditheredOutput = resampleInChunks(input, channels, seed, [&](const IntegerType* inputBuffer, int inputSamples, IntegerType* outputBuffer, int outputSamples, bool endOfInput)
+                                                                             { return resampler.process(inputBuffer, inputSamples, outputBuffer, outputSamples, endOfInput, &dither); });
+            std::int64_t maxDifference = 0;
+            std::int64_t differentSamples = 0;
+            for (std::size_t sample = 0; sample < std::min(ditheredOutput.size(), expected.size()); ++sample)
+            {
+                const std::int64_t difference = std::abs(static_cast<std::int64_t>(ditheredOutput[sample]) - static_cast<std::int64_t>(expected[sample]));
+                maxDifference = std::max(maxDifference, difference);
+                differentSamples += difference != 0 ? 1 : 0;
+            }
+            const bool dithered = sizeof(IntegerType) < sizeof(std::int32_t);
+            passed &= check(ditheredOutput.size() == expected.size() && maxDifference <= (dithered ? 1 : 0) && (differentSamples > 0) == dithered,
+                            configuration + "dithered samples differ by up to " + std::to_string(maxDifference) + " in " + std::to_string(differentSamples) + " samples");
+        }
+    }
+    return passed;
+}
+
+int main()
+{
+    bool passed = true;
+    for (const auto& [name, test] : {std::pair{"output counts", testOutputCounts},
+                                     std::pair{"alignment", testAlignment},
+                                     std::pair{"stopband", testStopband},
+                                     std::pair{"streaming", testStreamingResampler},
+                                     std::pair{"multichannel", testMultichannelResampler},
+                                     std::pair{"busy ThreadPool", testBusyThreadPool},
+                                     std::pair{"clock drift", testAsyncResamplerDrift},
+                                     std::pair{"int16 samples", +[]
+                                               { return testIntegerSamples<std::int16_t>("int16"); }},
+                                     std::pair{"int32 samples", +[]
+                                               { return testIntegerSamples<std::int32_t>("int32"); }}})
+    {
+        const bool testPassed = test();
+        std::cout << name << (testPassed ? " passed.\n" : " failed!\n");
+        passed &= testPassed;
+    }
+    return passed ? 0 : 1;
+}